@@ -0,0 +1,47 @@
+// Parse vs. binary AST load on synthetic programs.
+//
+//   bench_ast_binary [functions]
+
+#include "bench_util.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "util/AstBinary.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    int functions = argc > 1 ? std::atoi(argv[1]) : 6250;
+    std::string source = tiger::bench::generate_program(functions);
+
+    // Trees are kept alive so neither side pays for destruction.
+    std::vector<std::unique_ptr<tiger::Program>> keep;
+    double parse_ms = tiger::bench::best_ms([&] {
+        tiger::Lexer lexer(source);
+        tiger::Parser parser(lexer);
+        keep.push_back(parser.parse());
+    });
+    std::unique_ptr<tiger::Program> prog_owner = std::move(keep.front());
+    const tiger::Program& prog = *prog_owner;
+
+    tiger::AstBinaryWriter writer;
+    std::string bytes;
+    double encode_ms = tiger::bench::best_ms([&] { bytes = writer.encode(prog); });
+
+    keep.clear();
+    double decode_ms = tiger::bench::best_ms([&] {
+        tiger::AstBinaryReader reader;
+        keep.push_back(reader.read(bytes.data(), bytes.size()));
+        if (!keep.back()) std::abort();
+    });
+
+    std::printf("source:  %zu bytes\n", source.size());
+    std::printf("binary:  %zu bytes (%.1f%% of source)\n", bytes.size(),
+                100.0 * static_cast<double>(bytes.size()) /
+                    static_cast<double>(source.size()));
+    std::printf("parse:   %8.3f ms\n", parse_ms);
+    std::printf("encode:  %8.3f ms\n", encode_ms);
+    std::printf("decode:  %8.3f ms (%.1fx faster than parse)\n", decode_ms,
+                parse_ms / decode_ms);
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Checking time of long declaration batches, to show it is linear.
+//
+// Each program is one `let` whose declarations form a single batch of n:
+//
+//   alias      type t0 = t1  ...  type t{n-1} = int
+//   alias-rev  the same chain declared last-to-first
+//   records    type r{i} = {next: r{i+1}, v: int}, the last points at r0
+//              (one strongly connected component of n records)
+//   cycle      type t{i} = t{i+1}, the last names t0 (one error)
+//   functions  function f{i}(x: int): int = f{i+1}(x), the last calls f0
+//
+// Per-declaration time should stay flat as n grows. For comparison,
+// "naive" walks each alias chain to its end without sharing (the previous
+// resolution), which is quadratic on the forward chain.
+//
+//   bench_decl_chains [max-n]   (default: 100000)
+
+#include "bench_util.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "semantic/TypeChecker.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string alias_chain(int n, bool reversed, bool cycle) {
+    std::string s = "let\n";
+    for (int k = 0; k < n; k++) {
+        int i = reversed ? n - 1 - k : k;
+        std::string target = i + 1 < n ? "t" + std::to_string(i + 1) : cycle ? "t0" : "int";
+        s += "type t" + std::to_string(i) + " = " + target + "\n";
+    }
+    return s + "in 0 end\n";
+}
+
+std::string record_ring(int n) {
+    std::string s = "let\n";
+    for (int i = 0; i < n; i++)
+        s += "type r" + std::to_string(i) + " = {next: r" + std::to_string((i + 1) % n) +
+             ", v: int}\n";
+    return s + "in 0 end\n";
+}
+
+std::string function_ring(int n) {
+    std::string s = "let\n";
+    for (int i = 0; i < n; i++)
+        s += "function f" + std::to_string(i) + "(x: int): int = f" +
+             std::to_string((i + 1) % n) + "(x)\n";
+    return s + "in f0(1) end\n";
+}
+
+// Alias resolution without memoization: every name walks its chain.
+double naive_ms(int n) {
+    std::vector<int> alias_of(n);
+    for (int i = 0; i < n; i++) alias_of[i] = i + 1 < n ? i + 1 : -1;
+    volatile long steps = 0;
+    return tiger::bench::best_ms([&] {
+        long total = 0;
+        for (int i = 0; i < n; i++)
+            for (int cur = i; cur >= 0; cur = alias_of[cur]) total++;
+        steps = total;
+    }, 1);
+}
+
+void row(const char* name, int n, const std::string& source, bool expect_errors) {
+    tiger::Lexer lexer(source);
+    tiger::Parser parser(lexer);
+    auto program = parser.parse();
+    if (lexer.has_errors() || parser.has_errors()) {
+        std::fprintf(stderr, "%s: parse error\n", name);
+        std::exit(1);
+    }
+    tiger::semantic::TypeChecker checker;
+    double ms = tiger::bench::best_ms([&] { checker.check(*program); }, 3);
+    if (checker.has_errors() != expect_errors ||
+        (expect_errors && checker.errors().size() != 1)) {
+        std::fprintf(stderr, "%s: unexpected diagnostics (%zu)\n", name, checker.errors().size());
+        std::exit(1);
+    }
+    std::printf("%-10s %8d %10.2f ms %8.1f ns/decl\n", name, n, ms, ms * 1e6 / n);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int max_n = argc > 1 ? std::atoi(argv[1]) : 100000;
+    for (int n = max_n / 8; n <= max_n; n *= 2) {
+        row("alias", n, alias_chain(n, false, false), false);
+        row("alias-rev", n, alias_chain(n, true, false), false);
+        row("records", n, record_ring(n), false);
+        row("cycle", n, alias_chain(n, false, true), true);
+        row("functions", n, function_ring(n), false);
+        if (n <= 50000) {
+            double ms = naive_ms(n);
+            std::printf("%-10s %8d %10.2f ms %8.1f ns/decl\n", "naive", n, ms, ms * 1e6 / n);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,296 @@
+// The book's C environment code (src/env/EnvTable.c, src/env/symbol.c)
+// against the C++ ports, on one recorded workload.
+//
+// The workload is recorded from the token stream of a Tiger program, the
+// way a checker would use a table: `let` opens a scope and `end` closes
+// it, the name after var/function/type is bound, and every other
+// identifier is looked up. Each phase then replays the same trace:
+//
+//   intern   every identifier occurrence       S_Symbol     / Symbol::intern
+//   scoped   enter/look/begin/end on symbols   S_table      / SymbolTable, DenseSymbolTable
+//   strings  insert/lookup/pop on names        EnvTable.c   / EnvTable
+//
+// malloc/free are interposed to count allocations and track the peak
+// number of live heap bytes in each phase (C++ new goes through malloc).
+//
+//   bench_env_c_vs_cpp [file.tig | functions]
+
+#include "bench_util.hpp"
+#include "env/EnvTable.hpp"
+#include "env/symbol.h"
+#include "env/symbol.hpp"
+#include "lexer/Lexer.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <malloc.h>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// Allocation accounting (glibc: forward to the __libc_* entry points)
+// ============================================================================
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void __libc_free(void*);
+}
+
+static size_t alloc_count = 0;
+static size_t live_bytes = 0;
+static size_t peak_bytes = 0;
+
+static void* track(void* p) {
+  if (p) {
+    alloc_count++;
+    live_bytes += malloc_usable_size(p);
+    if (live_bytes > peak_bytes) peak_bytes = live_bytes;
+  }
+  return p;
+}
+
+extern "C" {
+void* malloc(size_t n) { return track(__libc_malloc(n)); }
+void* calloc(size_t n, size_t size) { return track(__libc_calloc(n, size)); }
+void free(void* p) {
+  if (p) live_bytes -= malloc_usable_size(p);
+  __libc_free(p);
+}
+void* realloc(void* p, size_t n) {
+  if (p) live_bytes -= malloc_usable_size(p);
+  return track(__libc_realloc(p, n));
+}
+void* memalign(size_t align, size_t n) { return track(__libc_memalign(align, n)); }
+void* aligned_alloc(size_t align, size_t n) { return memalign(align, n); }
+int posix_memalign(void** out, size_t align, size_t n) {
+  *out = memalign(align, n);
+  return *out ? 0 : 12;  // ENOMEM
+}
+}
+
+// EnvTable.c has no header (EnvTable.h is an unrelated C++ class).
+namespace book {
+extern "C" {
+void insert(char* key, void* binding);
+void* lookup(char* key);
+void pop(char* key);
+}
+} // namespace book
+
+namespace {
+
+// ============================================================================
+// Recorded workload
+// ============================================================================
+
+enum class OpKind { BEGIN, END, ENTER, LOOK };
+
+struct Op {
+  OpKind kind;
+  uint32_t name;   // index into Trace::names
+};
+
+struct Trace {
+  std::vector<std::string> names;   // distinct identifiers, NUL-terminated
+  std::vector<Op> ops;
+  size_t identifiers = 0;           // ENTER + LOOK
+};
+
+Trace record(const std::string& source) {
+  Trace trace;
+  std::unordered_map<std::string, uint32_t> index;
+  tiger::Lexer lexer(source);
+  bool binding = false;
+  for (;;) {
+    tiger::Token tok = lexer.next_token();
+    if (tok.type == tiger::TokenType::END_OF_FILE) break;
+    switch (tok.type) {
+      case tiger::TokenType::LET:
+        trace.ops.push_back({OpKind::BEGIN, 0});
+        break;
+      case tiger::TokenType::END:
+        trace.ops.push_back({OpKind::END, 0});
+        break;
+      case tiger::TokenType::VAR:
+      case tiger::TokenType::FUNCTION:
+      case tiger::TokenType::TYPE:
+        binding = true;
+        break;
+      case tiger::TokenType::ID: {
+        auto [it, added] = index.emplace(tok.text, static_cast<uint32_t>(trace.names.size()));
+        if (added) trace.names.push_back(tok.text);
+        trace.ops.push_back({binding ? OpKind::ENTER : OpKind::LOOK, it->second});
+        trace.identifiers++;
+        binding = false;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return trace;
+}
+
+// ============================================================================
+// Phases
+// ============================================================================
+
+struct Result {
+  double ms;
+  size_t allocations;
+  size_t peak;
+};
+
+// Best-of-5 time of `f`; allocations and peak live bytes of one run.
+template <typename F>
+Result measure(F&& f) {
+  size_t count = alloc_count;
+  size_t base = live_bytes;
+  peak_bytes = live_bytes;
+  f();
+  Result r{0, alloc_count - count, peak_bytes - base};
+  r.ms = tiger::bench::best_ms(f);
+  return r;
+}
+
+void report(const char* phase, const char* impl, const Result& r, size_t ops) {
+  std::printf("%-8s %-21s %9.2f ns/op %12zu allocs %12zu peak bytes\n", phase,
+              impl, r.ms * 1e6 / ops, r.allocations, r.peak);
+}
+
+char* c_name(Trace& t, uint32_t i) { return t.names[i].data(); }
+
+// Replays the scoped part of the trace on a symbol-keyed table.
+template <typename Enter, typename Look, typename Begin, typename End>
+long replay_scoped(const Trace& t, Enter enter, Look look, Begin begin, End end) {
+  long found = 0;
+  for (const Op& op : t.ops) {
+    switch (op.kind) {
+      case OpKind::BEGIN: begin(); break;
+      case OpKind::END: end(); break;
+      case OpKind::ENTER: enter(op.name); break;
+      case OpKind::LOOK: found += look(op.name) != nullptr; break;
+    }
+  }
+  return found;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::string source;
+  if (argc > 1 && std::ifstream(argv[1])) {
+    std::stringstream ss;
+    ss << std::ifstream(argv[1]).rdbuf();
+    source = ss.str();
+  } else {
+    source = tiger::bench::generate_program(argc > 1 ? std::atoi(argv[1]) : 6250);
+  }
+  Trace trace = record(source);
+  size_t scoped_ops = trace.ops.size();
+  std::printf("trace: %zu ops, %zu identifiers, %zu distinct names\n\n",
+              trace.ops.size(), trace.identifiers, trace.names.size());
+
+  // --- interning ----------------------------------------------------------
+  std::vector<uint32_t> occurrences;
+  for (const Op& op : trace.ops)
+    if (op.kind == OpKind::ENTER || op.kind == OpKind::LOOK) occurrences.push_back(op.name);
+
+  std::vector<S_symbol> c_syms(trace.names.size());
+  report("intern", "C S_Symbol", measure([&] {
+    for (uint32_t i : occurrences) c_syms[i] = S_Symbol(c_name(trace, i));
+  }), occurrences.size());
+
+  std::vector<tiger::Sym> syms(trace.names.size());
+  report("intern", "C++ Symbol", measure([&] {
+    for (uint32_t i : occurrences) syms[i] = tiger::Symbol::intern(trace.names[i]);
+  }), occurrences.size());
+  std::printf("\n");
+
+  // --- scoped symbol tables -----------------------------------------------
+  static int value;
+  long checks[3];
+  report("scoped", "C S_table", measure([&] {
+    S_table t = S_empty();
+    checks[0] = replay_scoped(trace,
+        [&](uint32_t i) { S_enter(t, c_syms[i], &value); },
+        [&](uint32_t i) { return S_look(t, c_syms[i]); },
+        [&] { S_beginScope(t); }, [&] { S_endScope(t); });
+    std::free(t);
+  }), scoped_ops);
+
+  report("scoped", "C++ SymbolTable", measure([&] {
+    tiger::SymbolTable<int> t;
+    checks[1] = replay_scoped(trace,
+        [&](uint32_t i) { t.enter(syms[i], &value); },
+        [&](uint32_t i) { return t.look(syms[i]); },
+        [&] { t.beginScope(); }, [&] { t.endScope(); });
+  }), scoped_ops);
+
+  report("scoped", "C++ DenseSymbolTable", measure([&] {
+    tiger::DenseSymbolTable<int> t;
+    checks[2] = replay_scoped(trace,
+        [&](uint32_t i) { t.enter(syms[i], &value); },
+        [&](uint32_t i) { return t.look(syms[i]); },
+        [&] { t.beginScope(); }, [&] { t.endScope(); });
+  }), scoped_ops);
+  if (checks[0] != checks[1] || checks[1] != checks[2]) std::abort();
+  std::printf("\n");
+
+  // --- string-keyed tables: scopes unwound with pop(name) -----------------
+  // EnvTable.c's pop unlinks without freeing (as in the book), so its
+  // bucket memory only grows across runs.
+  std::vector<uint32_t> entered;   // names bound, with scope marks (~0u)
+  long c_found = 0, cpp_found = 0;
+  report("strings", "C EnvTable.c", measure([&] {
+    c_found = 0;
+    for (const Op& op : trace.ops) {
+      switch (op.kind) {
+        case OpKind::BEGIN: entered.push_back(~0u); break;
+        case OpKind::END:
+          while (!entered.empty()) {
+            uint32_t i = entered.back();
+            entered.pop_back();
+            if (i == ~0u) break;
+            book::pop(c_name(trace, i));
+          }
+          break;
+        case OpKind::ENTER:
+          book::insert(c_name(trace, op.name), &value);
+          entered.push_back(op.name);
+          break;
+        case OpKind::LOOK: c_found += book::lookup(c_name(trace, op.name)) != nullptr; break;
+      }
+    }
+  }), scoped_ops);
+
+  report("strings", "C++ EnvTable", measure([&] {
+    tiger::EnvTable t;
+    cpp_found = 0;
+    for (const Op& op : trace.ops) {
+      switch (op.kind) {
+        case OpKind::BEGIN: entered.push_back(~0u); break;
+        case OpKind::END:
+          while (!entered.empty()) {
+            uint32_t i = entered.back();
+            entered.pop_back();
+            if (i == ~0u) break;
+            t.pop(trace.names[i]);
+          }
+          break;
+        case OpKind::ENTER:
+          t.insert(trace.names[op.name], std::make_unique<tiger::Binding>());
+          entered.push_back(op.name);
+          break;
+        case OpKind::LOOK: cpp_found += t.lookup(trace.names[op.name]) != nullptr; break;
+      }
+    }
+  }), scoped_ops);
+  if (c_found != cpp_found) std::abort();
+  return 0;
+}
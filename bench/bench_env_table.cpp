@@ -0,0 +1,130 @@
+// EnvTable latency curves from 100 to 10M bindings: insert, hit and miss
+// lookup, and scope rollback, per operation. The previous fixed
+// 109-bucket chained table is measured alongside up to 100k bindings
+// (beyond that its chains make a run take minutes).
+//
+//   bench_env_table [max_bindings]
+
+#include "env/EnvTable.hpp"
+#include "util/util.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct IntBinding : tiger::Binding {
+  int value;
+  explicit IntBinding(int v) : value(v) {}
+};
+
+// The EnvTable before the rewrite, for comparison.
+class ChainedEnvTable {
+public:
+  ChainedEnvTable() : table_(SIZE) {}
+  void insert(const std::string& key, std::unique_ptr<tiger::Binding> binding) {
+    int index = tiger::util::hash(key) % SIZE;
+    table_[index] = std::make_unique<Bucket>(Bucket{key, std::move(binding),
+                                                    std::move(table_[index])});
+  }
+  tiger::Binding* lookup(const std::string& key) const {
+    int index = tiger::util::hash(key) % SIZE;
+    for (auto b = table_[index].get(); b; b = b->next.get())
+      if (b->key == key) return b->binding.get();
+    return nullptr;
+  }
+
+private:
+  static constexpr int SIZE = 109;
+  struct Bucket {
+    std::string key;
+    std::unique_ptr<tiger::Binding> binding;
+    std::unique_ptr<Bucket> next;
+  };
+  std::vector<std::unique_ptr<Bucket>> table_;
+};
+
+double now_ns() {
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Keys "k0".."k<n-1>" (and misses "m...") in one buffer.
+struct Keys {
+  std::string bytes;
+  std::vector<std::string_view> hit, miss;
+
+  explicit Keys(std::size_t n) {
+    std::vector<std::size_t> offsets;
+    for (std::size_t i = 0; i < 2 * n; i++) {
+      offsets.push_back(bytes.size());
+      bytes += (i < n ? "k" : "m") + std::to_string(i % n);
+    }
+    offsets.push_back(bytes.size());
+    for (std::size_t i = 0; i < 2 * n; i++) {
+      std::string_view v(bytes.data() + offsets[i], offsets[i + 1] - offsets[i]);
+      (i < n ? hit : miss).push_back(v);
+    }
+  }
+};
+
+const std::size_t PROBES = 1000000;
+long checksum = 0;
+
+template <typename Table, typename Key>
+double lookup_ns(const Table& table, const std::vector<Key>& keys,
+                 const std::vector<std::uint32_t>& order) {
+  long found = 0;
+  double start = now_ns();
+  for (std::uint32_t i : order) found += table.lookup(keys[i]) != nullptr;
+  double ns = (now_ns() - start) / order.size();
+  checksum += found;  // printed, so inlined lookups are not optimised away
+  return ns;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::size_t max_n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  std::mt19937 rng(34);
+
+  std::printf("%10s | %8s %8s %8s %8s | %8s %8s\n", "bindings", "insert", "hit",
+              "miss", "rollback", "old hit", "old miss");
+  std::printf("%10s | %35s | %17s\n", "", "EnvTable (ns/op)", "109 chains (ns/op)");
+  for (std::size_t n = 100; n <= max_n; n *= 10) {
+    Keys keys(n);
+    std::vector<std::uint32_t> order(PROBES);
+    for (auto& i : order) i = static_cast<std::uint32_t>(rng() % n);
+
+    tiger::EnvTable table;
+    tiger::EnvTable::Mark mark = table.mark();
+    double start = now_ns();
+    for (std::size_t i = 0; i < n; i++)
+      table.insert(keys.hit[i], std::make_unique<IntBinding>(static_cast<int>(i)));
+    double insert = (now_ns() - start) / n;
+    double hit = lookup_ns(table, keys.hit, order);
+    double miss = lookup_ns(table, keys.miss, order);
+    start = now_ns();
+    table.rollback(mark);
+    double rollback = (now_ns() - start) / n;
+
+    std::printf("%10zu | %8.1f %8.1f %8.1f %8.1f |", n, insert, hit, miss, rollback);
+    if (n <= 100000) {
+      ChainedEnvTable old;
+      std::vector<std::string> hit_keys(keys.hit.begin(), keys.hit.end());
+      std::vector<std::string> miss_keys(keys.miss.begin(), keys.miss.end());
+      for (std::size_t i = 0; i < n; i++)
+        old.insert(hit_keys[i], std::make_unique<IntBinding>(static_cast<int>(i)));
+      std::vector<std::uint32_t> few(order.begin(), order.begin() + PROBES / 100);
+      std::printf(" %8.1f %8.1f\n", lookup_ns(old, hit_keys, few),
+                  lookup_ns(old, miss_keys, few));
+    } else {
+      std::printf(" %8s %8s\n", "-", "-");
+    }
+  }
+  std::printf("(checksum %ld)\n", checksum);
+  return 0;
+}
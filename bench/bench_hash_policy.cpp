@@ -0,0 +1,141 @@
+// Hash policies (util.hpp) on real identifier streams.
+//
+// Corpora: every identifier occurrence lexed from the .tig files in a
+// directory (default: examples/, run from the repo root) and from the
+// generated ~50k-line program. For each corpus:
+//
+//   hash     ns per identifier for StdHash / WordHash / seeded WordHash,
+//            plus how many distinct names share a home slot in a table
+//            of 2x the distinct count (the collisions a table would see)
+//   env      EnvTable lookups, BasicEnvTable<StdHash> vs <WordHash>
+//   symbol   SymbolTable lookups, SymAddressHash vs SymCachedHash
+//
+//   bench_hash_policy [examples-dir]
+
+#include "bench_util.hpp"
+#include "env/EnvTable.hpp"
+#include "env/symbol.hpp"
+#include "lexer/Lexer.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+using namespace tiger;
+
+struct Corpus {
+  std::string label;
+  std::vector<std::string> occurrences;   // in source order
+  std::vector<std::string> distinct;
+};
+
+void lex_into(const std::string& source, Corpus& c, std::unordered_set<std::string>& seen) {
+  Lexer lexer(source);
+  for (Token tok = lexer.next_token(); tok.type != TokenType::END_OF_FILE;
+       tok = lexer.next_token()) {
+    if (tok.type != TokenType::ID) continue;
+    c.occurrences.push_back(tok.text);
+    if (seen.insert(tok.text).second) c.distinct.push_back(tok.text);
+  }
+}
+
+// Repeats the stream until it has at least `min_ops` entries, so small
+// corpora still time in milliseconds.
+std::vector<std::string_view> stream(const Corpus& c, size_t min_ops) {
+  std::vector<std::string_view> out;
+  while (out.size() < min_ops)
+    for (const std::string& s : c.occurrences) out.push_back(s);
+  return out;
+}
+
+volatile uint64_t sink;
+
+template <typename Hash>
+void hash_row(const char* name, Hash h, const Corpus& c,
+              const std::vector<std::string_view>& ops) {
+  double ms = bench::best_ms([&] {
+    uint64_t x = 0;
+    for (std::string_view s : ops) x += h(s);
+    sink = x;
+  });
+  size_t slots = 1;
+  while (slots < c.distinct.size() * 2) slots *= 2;
+  std::unordered_set<uint64_t> homes;
+  for (const std::string& s : c.distinct) homes.insert(h(s) & (slots - 1));
+  std::printf("  hash    %-18s %7.2f ns/id   %6zu of %zu names share a home slot\n",
+              name, ms * 1e6 / ops.size(), c.distinct.size() - homes.size(),
+              c.distinct.size());
+}
+
+template <typename Hash>
+void env_row(const char* name, const Corpus& c, const std::vector<std::string_view>& ops) {
+  BasicEnvTable<Hash> env;
+  for (const std::string& s : c.distinct) env.insert(s, std::make_unique<Binding>());
+  double ms = bench::best_ms([&] {
+    size_t found = 0;
+    for (std::string_view s : ops) found += env.lookup(s) != nullptr;
+    sink = found;
+  });
+  std::printf("  env     %-18s %7.2f ns/lookup\n", name, ms * 1e6 / ops.size());
+}
+
+template <typename KeyHash>
+void symbol_row(const char* name, const Corpus& c, const std::vector<std::string_view>& ops) {
+  static int value;
+  SymbolTable<int, KeyHash> table;
+  for (const std::string& s : c.distinct) table.enter(Symbol::intern(s), &value);
+  std::vector<Sym> syms;
+  for (std::string_view s : ops) syms.push_back(Symbol::intern(s));
+  double ms = bench::best_ms([&] {
+    size_t found = 0;
+    for (Sym s : syms) found += table.look(s) != nullptr;
+    sink = found;
+  });
+  std::printf("  symbol  %-18s %7.2f ns/look\n", name, ms * 1e6 / syms.size());
+}
+
+void run(const Corpus& c) {
+  size_t bytes = 0;
+  for (const std::string& s : c.distinct) bytes += s.size();
+  std::printf("%s: %zu occurrences, %zu distinct, %.1f bytes/name\n", c.label.c_str(),
+              c.occurrences.size(), c.distinct.size(),
+              c.distinct.empty() ? 0.0 : double(bytes) / c.distinct.size());
+  if (c.occurrences.empty()) return;
+  auto ops = stream(c, 1000000);
+  hash_row("StdHash", util::StdHash{}, c, ops);
+  hash_row("WordHash", util::WordHash{}, c, ops);
+  hash_row("WordHash seeded", util::WordHash{0x5eed}, c, ops);
+  env_row<util::StdHash>("StdHash", c, ops);
+  env_row<util::WordHash>("WordHash", c, ops);
+  symbol_row<SymAddressHash>("SymAddressHash", c, ops);
+  symbol_row<SymCachedHash>("SymCachedHash", c, ops);
+  std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::filesystem::path dir = argc > 1 ? argv[1] : "examples";
+
+  Corpus examples{"examples (" + dir.string() + ")", {}, {}};
+  std::unordered_set<std::string> seen;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    if (entry.path().extension() != ".tig") continue;
+    std::stringstream ss;
+    ss << std::ifstream(entry.path()).rdbuf();
+    lex_into(ss.str(), examples, seen);
+  }
+  run(examples);
+
+  Corpus generated{"generated program", {}, {}};
+  seen.clear();
+  lex_into(bench::generate_program(6250), generated, seen);
+  run(generated);
+  return 0;
+}
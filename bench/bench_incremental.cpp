@@ -0,0 +1,66 @@
+// Incremental reparse after small edits vs. a full parse of the file.
+//
+//   bench_incremental [functions]
+
+#include "bench_util.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/IncrementalParser.hpp"
+#include "parser/Parser.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Average time per apply() over `edits` edits produced by `make_edit(i)`.
+template <typename F>
+static double average_us(tiger::IncrementalParser& inc, int edits, F&& make_edit) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < edits; i++) {
+        if (!inc.apply(make_edit(i))) std::abort();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / edits;
+}
+
+int main(int argc, char* argv[]) {
+    int functions = argc > 1 ? std::atoi(argv[1]) : 6250;
+    std::string source = tiger::bench::generate_program(functions);
+
+    double full_ms = tiger::bench::best_ms([&] {
+        tiger::Lexer lexer(source);
+        tiger::Parser parser(lexer);
+        auto prog = parser.parse();
+    });
+
+    tiger::IncrementalParser inc(source);
+    if (inc.has_errors()) std::abort();
+
+    // An edit in the middle of the file: the multiplier in one function.
+    std::string marker = "function f" + std::to_string(functions / 2) + "(";
+    size_t fn = inc.source().find(marker);
+    size_t digit = inc.source().find(" * ", fn) + 3;
+    const int edits = 2000;
+
+    double same_line_us = average_us(inc, edits, [&](int i) {
+        return tiger::TextEdit{digit, 1, std::string(1, static_cast<char>('1' + i % 9))};
+    });
+
+    // Inserting and removing a line moves everything after the edit; the
+    // positions are renumbered when the tree is next read.
+    size_t eol = inc.source().find('\n', digit);
+    double new_line_us = average_us(inc, edits, [&](int i) {
+        return i % 2 == 0 ? tiger::TextEdit{eol, 0, "\n"} : tiger::TextEdit{eol, 1, ""};
+    });
+    auto start = std::chrono::steady_clock::now();
+    inc.program();
+    double renumber_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::printf("source:              %zu bytes, %d functions\n", source.size(), functions);
+    std::printf("full parse:          %9.3f ms\n", full_ms);
+    std::printf("edit within a line:  %9.3f ms per edit\n", same_line_us / 1000.0);
+    std::printf("insert/remove line:  %9.3f ms per edit\n", new_line_us / 1000.0);
+    std::printf("renumber on read:    %9.3f ms after them\n", renumber_ms);
+    std::printf("incremental %zu, full %zu\n", inc.incremental_count(), inc.full_count());
+    return 0;
+}
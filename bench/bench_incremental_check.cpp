@@ -0,0 +1,80 @@
+// Incremental re-checking after an edit vs. a full parse and check.
+//
+// On a generated program (6250 functions ~ 50k lines by default):
+//   full:       parse + TypeChecker::check of the whole file
+//   body edit:  the multiplier in one function's body; only that body
+//               is walked again
+//   new line:   a line inserted and removed in one body; every function
+//               after it moves, so cached diagnostics are re-positioned
+//   signature:  one function's result type toggled between int and string
+//               (its body and its caller become wrong and right again)
+//
+//   bench_incremental_check [functions]
+
+#include "bench_util.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "semantic/IncrementalChecker.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using tiger::TextEdit;
+using tiger::semantic::IncrementalChecker;
+
+// Average time per apply() over `edits` edits produced by `make_edit(i)`.
+template <typename F>
+static double average_us(IncrementalChecker& ic, int edits, F&& make_edit) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < edits; i++) ic.apply(make_edit(i));
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / edits;
+}
+
+int main(int argc, char* argv[]) {
+    int functions = argc > 1 ? std::atoi(argv[1]) : 6250;
+    std::string source = tiger::bench::generate_program(functions);
+
+    double full_ms = tiger::bench::best_ms([&] {
+        tiger::Lexer lexer(source);
+        tiger::Parser parser(lexer);
+        auto program = parser.parse();
+        tiger::semantic::TypeChecker checker;
+        checker.check(*program);
+    });
+
+    IncrementalChecker ic(source);
+    if (!ic.ok()) std::abort();
+    const int edits = 200;
+
+    std::string marker = "function f" + std::to_string(functions / 2) + "(";
+    std::size_t fn = ic.parser().source().find(marker);
+    std::size_t digit = ic.parser().source().find(" * ", fn) + 3;
+    double body_us = average_us(ic, edits, [&](int i) {
+        return TextEdit{digit, 1, std::string(1, static_cast<char>('1' + i % 9))};
+    });
+    std::size_t body_checked = ic.bodies_checked(), body_reused = ic.bodies_reused();
+
+    std::size_t eol = ic.parser().source().find('\n', digit);
+    double line_us = average_us(ic, edits, [&](int i) {
+        return i % 2 == 0 ? TextEdit{eol, 0, "\n"} : TextEdit{eol, 1, ""};
+    });
+
+    // "): int =" of the function: toggle to "): string =" and back.
+    std::size_t result = ic.parser().source().find("): int =", fn) + 3;
+    double sig_us = average_us(ic, edits, [&](int i) {
+        return i % 2 == 0 ? TextEdit{result, 3, "string"} : TextEdit{result, 6, "int"};
+    });
+    std::size_t sig_checked = ic.bodies_checked();
+    if (!ic.ok()) std::abort();
+
+    std::printf("source:            %zu bytes, %d functions\n", source.size(), functions);
+    std::printf("full parse+check:  %9.3f ms\n", full_ms);
+    std::printf("body edit:         %9.3f ms per edit (%zu bodies walked, %zu reused)\n",
+                body_us / 1000.0, body_checked, body_reused);
+    std::printf("insert/remove line:%9.3f ms per edit\n", line_us / 1000.0);
+    std::printf("signature edit:    %9.3f ms per edit (%zu bodies walked)\n",
+                sig_us / 1000.0, sig_checked);
+    return 0;
+}
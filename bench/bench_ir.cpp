@@ -0,0 +1,139 @@
+// Size and speed of the arena IR (ir/Tree.hpp) on a generated program
+// (6250 functions ~ 50k lines by default):
+//
+//   translate  ir::Translator over the checked, resolved tree: time,
+//              operator new calls, IR nodes and bytes per AST node
+//   heap tree  the same trees as heap objects the textbook way (a node
+//              per allocation, owning child pointers, std::string labels
+//              and temps as "L12" / "t3"), built from the arena IR so the
+//              shapes match: bytes requested and allocations
+//   dump       Module::dump of the whole program
+//
+// AST bytes are AstStats' count of the node structs alone (no strings or
+// vector buffers), so they understate the tree being translated.
+//
+//   bench_ir [functions]
+
+#include "bench_util.hpp"
+#include "ir/Translate.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "semantic/Resolver.hpp"
+#include "semantic/TypeChecker.hpp"
+#include "util/AstStats.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+static size_t allocations = 0;
+static size_t allocated_bytes = 0;
+
+void* operator new(std::size_t n) {
+    allocations++;
+    allocated_bytes += n;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace tiger;
+
+namespace {
+
+// A T_exp / T_stm node as a heap object.
+struct HeapNode {
+    ir::Kind kind;
+    uint8_t op = 0;
+    int32_t value = 0;
+    std::string name;                                  // label or temp
+    std::unique_ptr<HeapNode> left, right;
+    std::vector<std::unique_ptr<HeapNode>> args;       // CALL
+    std::string true_label, false_label;               // CJUMP
+};
+
+std::string label_name(ir::Label l) { return "L" + std::to_string(l); }
+
+std::unique_ptr<HeapNode> to_heap(const ir::Function& f, ir::NodeId id) {
+    const ir::Node& n = f[id];
+    auto h = std::make_unique<HeapNode>();
+    h->kind = n.kind;
+    h->op = n.op;
+    switch (n.kind) {
+        case ir::Kind::CONST: h->value = static_cast<int32_t>(n.a); break;
+        case ir::Kind::NAME:
+        case ir::Kind::JUMP:
+        case ir::Kind::LABEL: h->name = label_name(n.a); break;
+        case ir::Kind::TEMP: h->name = "t" + std::to_string(n.a); break;
+        case ir::Kind::MEM:
+        case ir::Kind::EXP: h->left = to_heap(f, n.a); break;
+        case ir::Kind::CALL:
+            h->left = to_heap(f, n.a);
+            for (uint32_t i = 0; i < n.c; i++)
+                h->args.push_back(to_heap(f, f.operands()[n.b + i]));
+            break;
+        case ir::Kind::CJUMP:
+            h->true_label = label_name(f.operands()[n.c]);
+            h->false_label = label_name(f.operands()[n.c + 1]);
+            [[fallthrough]];
+        default:
+            h->left = to_heap(f, n.a);
+            h->right = to_heap(f, n.b);
+            break;
+    }
+    return h;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int functions = argc > 1 ? std::atoi(argv[1]) : 6250;
+    std::string source = bench::generate_program(functions);
+
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto program = parser.parse();
+    semantic::TypeChecker checker;
+    if (!checker.check(*program)) {
+        std::fprintf(stderr, "generated program does not type-check\n");
+        return 1;
+    }
+    semantic::Resolver resolver;
+    resolver.resolve(*program);
+    AstStats ast = AstStatsCollector().collect(*program);
+
+    ir::Translator translator(checker);
+    double translate_ms = bench::best_ms([&] { translator.translate(*program, resolver); });
+    size_t before = allocations;
+    ir::Module module = translator.translate(*program, resolver);
+    size_t translate_allocs = allocations - before;
+
+    size_t heap_allocs = 0, heap_bytes = 0;
+    double heap_ms = bench::best_ms([&] {
+        size_t a = allocations, b = allocated_bytes;
+        std::vector<std::unique_ptr<HeapNode>> bodies;
+        bodies.reserve(module.functions().size());
+        for (const ir::Function& f : module.functions()) bodies.push_back(to_heap(f, f.body()));
+        heap_allocs = allocations - a;
+        heap_bytes = allocated_bytes - b;
+    });
+
+    std::size_t dump_bytes = 0;
+    double dump_ms = bench::best_ms([&] { dump_bytes = module.dump().size(); });
+
+    double ast_nodes = static_cast<double>(ast.total_nodes());
+    std::printf("program: %d functions, %zu AST nodes (%zu bytes of node structs)\n",
+                functions, ast.total_nodes(), ast.total_bytes());
+    std::printf("translate: %8.2f ms  %6.1f ns/AST node  %zu operator new calls\n",
+                translate_ms, translate_ms * 1e6 / ast_nodes, translate_allocs);
+    std::printf("arena IR:  %zu nodes (%.2f per AST node), %zu bytes = %.1f bytes/AST node\n",
+                module.nodes(), static_cast<double>(module.nodes()) / ast_nodes, module.bytes(),
+                static_cast<double>(module.bytes()) / ast_nodes);
+    std::printf("heap tree: %8.2f ms  %zu allocations, %zu bytes = %.1f bytes/AST node\n",
+                heap_ms, heap_allocs, heap_bytes, static_cast<double>(heap_bytes) / ast_nodes);
+    std::printf("dump:      %8.2f ms  %zu bytes of text\n", dump_ms, dump_bytes);
+    return 0;
+}
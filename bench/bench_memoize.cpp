@@ -0,0 +1,119 @@
+// Purity analysis and --memoize: what the result cache buys and costs.
+//
+// Three programs, each run by the Interpreter without and with memoization:
+//   fib        doubly recursive fib(n): exponentially many repeated calls
+//   digits     a pure digit sum called with few distinct arguments in a
+//              loop: repeats without recursion
+//   impure     a function that bumps a global counter: never cached, so the
+//              column shows the bookkeeping overhead alone
+// plus the cost of Purity::analyze on the generated 6250-function program.
+//
+//   bench_memoize [fib_n] [loop_iterations]
+
+#include "bench_util.hpp"
+#include "interp/Interpreter.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "semantic/Purity.hpp"
+#include "semantic/Resolver.hpp"
+#include "semantic/TypeChecker.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace tiger;
+
+namespace {
+
+struct Compiled {
+    std::unique_ptr<Program> program;
+    semantic::Resolver resolver;
+    semantic::Purity purity;
+};
+
+std::unique_ptr<Compiled> compile(const std::string& source) {
+    auto c = std::make_unique<Compiled>();
+    Lexer lexer(source);
+    Parser parser(lexer);
+    c->program = parser.parse();
+    semantic::TypeChecker checker;
+    if (parser.has_errors() || !checker.check(*c->program)) {
+        std::fprintf(stderr, "program does not check\n");
+        std::exit(1);
+    }
+    c->resolver.resolve(*c->program);
+    c->purity.analyze(*c->program, c->resolver);
+    return c;
+}
+
+struct Row {
+    double ms;
+    int32_t result;
+    std::size_t calls;
+    std::size_t hits;
+};
+
+Row run(const Compiled& c, bool memoize) {
+    Row row{};
+    row.ms = bench::best_ms([&] {
+        std::ostringstream out;
+        std::istringstream in;
+        Interpreter::Options options;
+        if (memoize) options.memoize = &c.purity;
+        Interpreter interp(out, in, options);
+        if (!interp.run(*c.program, c.resolver)) {
+            std::fprintf(stderr, "%s\n", interp.errors()[0].c_str());
+            std::exit(1);
+        }
+        row.result = interp.result().i;
+        row.calls = interp.calls();
+        row.hits = interp.cache_hits();
+    }, 3);
+    return row;
+}
+
+void report(const char* name, const Compiled& c) {
+    Row plain = run(c, false), memo = run(c, true);
+    if (plain.result != memo.result) {
+        std::fprintf(stderr, "%s: results differ\n", name);
+        std::exit(1);
+    }
+    std::printf("%-8s %10.2f %10.2f %8.2fx %12zu %12zu %10zu\n", name, plain.ms, memo.ms,
+                plain.ms / memo.ms, plain.calls, memo.calls, memo.hits);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int fib_n = argc > 1 ? std::atoi(argv[1]) : 27;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 200000;
+    std::string n = std::to_string(fib_n), iters = std::to_string(iterations);
+
+    auto fib = compile(
+        "let function fib(n: int): int = if n < 2 then n else fib(n - 1) + fib(n - 2)\n"
+        "in fib(" + n + ") end");
+    auto digits = compile(
+        "let function digits(n: int): int =\n"
+        "        let var s := 0 var m := n in while m > 0 do (s := s + m - m / 10 * 10; m := m / 10); s end\n"
+        "    var sum := 0\n"
+        "in for i := 1 to " + iters + " do sum := sum + digits(100000 + i - i / 64 * 64); sum end");
+    auto impure = compile(
+        "let var count := 0\n"
+        "    function tick(n: int): int = (count := count + 1; n + count - count)\n"
+        "    var sum := 0\n"
+        "in for i := 1 to " + iters + " do sum := sum + tick(i - i / 64 * 64); sum end");
+
+    std::printf("%-8s %10s %10s %9s %12s %12s %10s\n", "program", "plain ms", "memo ms",
+                "speedup", "plain calls", "memo calls", "hits");
+    report("fib", *fib);
+    report("digits", *digits);
+    report("impure", *impure);
+
+    auto large = compile(bench::generate_program(6250));
+    double analyze_ms = bench::best_ms([&] { large->purity.analyze(*large->program, large->resolver); });
+    std::printf("\nPurity::analyze, %zu functions: %.2f ms (%zu pure)\n",
+                large->purity.function_count(), analyze_ms, large->purity.pure_count());
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Scaling of parallel type checking over the number of threads.
+//
+// For each program size, times TypeChecker::check (best of 5) sequentially
+// and on ThreadPools of increasing size, and reports the speedup over the
+// sequential run and the number of stolen tasks. Every parallel run must
+// produce the same diagnostics as the sequential one.
+//
+// The generated programs are one batch of thousands of functions, the
+// case the parallel checker targets. Speedup is bounded by the cores of
+// the machine (printed first); beyond that the extra threads only add
+// scheduling overhead.
+//
+//   bench_parallel_check [functions...]   (default: 2000 6250 25000)
+
+#include "bench_util.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "semantic/TypeChecker.hpp"
+#include "util/ThreadPool.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(std::atoi(argv[i]));
+    if (sizes.empty()) sizes = {2000, 6250, 25000};
+
+    std::printf("hardware threads: %u\n\n", std::thread::hardware_concurrency());
+    std::printf("%10s %10s %8s %12s %10s %10s\n", "functions", "nodes", "threads",
+                "check ms", "speedup", "steals");
+    for (int functions : sizes) {
+        std::string source = tiger::bench::generate_program(functions);
+        tiger::Lexer lexer(source);
+        tiger::Parser parser(lexer);
+        auto program = parser.parse();
+
+        tiger::semantic::TypeChecker sequential;
+        if (!sequential.check(*program)) {
+            for (const auto& err : sequential.errors()) std::fprintf(stderr, "%s\n", err.c_str());
+            return 1;
+        }
+        double base_ms = tiger::bench::best_ms([&] { sequential.check(*program); });
+        std::printf("%10d %10zu %8s %12.2f %10s %10s\n", functions, sequential.nodes(),
+                    "seq", base_ms, "1.00x", "-");
+
+        for (unsigned threads : {1u, 2u, 4u, 8u}) {
+            tiger::ThreadPool pool(threads);
+            tiger::semantic::TypeChecker checker(&pool);
+            double ms = tiger::bench::best_ms([&] { checker.check(*program); });
+            if (checker.errors() != sequential.errors() || checker.nodes() != sequential.nodes()) {
+                std::fprintf(stderr, "parallel result differs at %u threads\n", threads);
+                return 1;
+            }
+            std::printf("%10s %10s %8u %12.2f %9.2fx %10zu\n", "", "", threads, ms,
+                        base_ms / ms, pool.steals());
+        }
+    }
+    return 0;
+}
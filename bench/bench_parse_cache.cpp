@@ -0,0 +1,66 @@
+// Cold (lex + parse + store) vs. warm (cache hit) runs of the parse cache.
+//
+//   bench_parse_cache [functions]
+
+#include "bench_util.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "util/ParseCache.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char* argv[]) {
+    int functions = argc > 1 ? std::atoi(argv[1]) : 6250;
+    std::string source = tiger::bench::generate_program(functions);
+    std::string dir = "bench_parse_cache.dir";
+
+    // Trees are kept alive so no run pays for destruction; cleared between
+    // phases so every phase starts from the same heap state.
+    std::vector<std::unique_ptr<tiger::Program>> keep;
+
+    // Cold: empty cache every time, so each run parses and writes an entry.
+    double cold_ms = tiger::bench::best_ms([&] {
+        fs::remove_all(dir);
+        tiger::ParseCache cache(dir);
+        tiger::CachedParse cached;
+        if (cache.lookup(source, cached)) std::abort();
+        tiger::Lexer lexer(source);
+        tiger::Parser parser(lexer);
+        keep.push_back(parser.parse());
+        cache.store(source, *keep.back(), lexer.errors(), parser.errors(),
+                    lexer.token_counts());
+    });
+
+    keep.clear();
+    double parse_ms = tiger::bench::best_ms([&] {
+        tiger::Lexer lexer(source);
+        tiger::Parser parser(lexer);
+        keep.push_back(parser.parse());
+    });
+
+    keep.clear();
+    tiger::ParseCache cache(dir);
+    double warm_ms = tiger::bench::best_ms([&] {
+        tiger::CachedParse cached;
+        if (!cache.lookup(source, cached)) std::abort();
+        keep.push_back(std::move(cached.program));
+    });
+
+    std::printf("source:       %zu bytes\n", source.size());
+    std::printf("cache entry:  %llu bytes\n",
+                static_cast<unsigned long long>(cache.size_bytes()));
+    std::printf("parse only:   %8.3f ms\n", parse_ms);
+    std::printf("cold (miss):  %8.3f ms\n", cold_ms);
+    std::printf("warm (hit):   %8.3f ms (%.1fx faster than parse)\n", warm_ms,
+                parse_ms / warm_ms);
+    std::printf("hits %llu, misses %llu\n",
+                static_cast<unsigned long long>(cache.hits()),
+                static_cast<unsigned long long>(cache.misses()));
+
+    fs::remove_all(dir);
+    return 0;
+}
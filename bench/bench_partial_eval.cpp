@@ -0,0 +1,146 @@
+// Partial evaluation: run time saved, and what it costs at compile time.
+//
+// Two generated programs over the same pure helpers (factorial, Fibonacci,
+// digit sum, string padding):
+//   tables     a top-level let that builds its constants from pure calls
+//              and literal arithmetic, then sums them: startup work
+//   loop       a loop whose body uses constant calls and arithmetic on
+//              every iteration
+// For each:
+//   run        Interpreter::run on the checked, resolved tree
+//   peval      PartialEvaluator::evaluate (what the saving costs)
+//   run'       Interpreter::run on the evaluated tree
+// The results of both runs are compared.
+//
+//   bench_partial_eval [tables] [iterations] [step_budget]
+
+#include "bench_util.hpp"
+#include "interp/Interpreter.hpp"
+#include "interp/PartialEvaluator.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "semantic/Purity.hpp"
+#include "semantic/Resolver.hpp"
+#include "semantic/TypeChecker.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace tiger;
+
+namespace {
+
+const char* HELPERS =
+    "let function fact(n: int): int = if n < 2 then 1 else n * fact(n - 1)\n"
+    "    function fib(n: int): int = if n < 2 then n else fib(n - 1) + fib(n - 2)\n"
+    "    function digits(n: int): int =\n"
+    "        let var s := 0 var m := n in while m > 0 do (s := s + m - m / 10 * 10; m := m / 10); s end\n"
+    "    function pad(s: string, n: int): string = if size(s) >= n then s else pad(concat(\"0\", s), n)\n"
+    "    var total := 0\n";
+
+std::string generate_tables(int tables) {
+    std::string s = HELPERS;
+    for (int i = 0; i < tables; i++) {
+        std::string n = std::to_string(i);
+        std::string k = std::to_string(i % 12 + 1);
+        s += "    var a" + n + " := fact(" + k + ") + fib(" + std::to_string(i % 10 + 8) + ") * (2 * 3 - 1)\n";
+        s += "    var b" + n + " := digits(fact(" + k + ")) - -" + n + "\n";
+        s += "    var c" + n + " := pad(chr(65 + " + std::to_string(i % 26) + "), " + k + ")\n";
+    }
+    s += "in\n";
+    for (int i = 0; i < tables; i++) {
+        std::string n = std::to_string(i);
+        s += "    total := total + a" + n + " + b" + n + " + size(c" + n + ");\n";
+    }
+    s += "    total\n";
+    s += "end\n";
+    return s;
+}
+
+std::string generate_loop(int iterations) {
+    std::string s = HELPERS;
+    s += "in\n";
+    s += "    for i := 1 to " + std::to_string(iterations) + " do\n";
+    s += "        total := total + i * fact(6) + digits(fact(7)) - size(pad(\"x\", 2 + 2)) * (60 * 60);\n";
+    s += "    total\n";
+    s += "end\n";
+    return s;
+}
+
+struct Compiled {
+    std::unique_ptr<Program> program;
+    semantic::Resolver resolver;
+    semantic::Purity purity;
+};
+
+std::unique_ptr<Compiled> compile(const std::string& source) {
+    auto c = std::make_unique<Compiled>();
+    Lexer lexer(source);
+    Parser parser(lexer);
+    c->program = parser.parse();
+    semantic::TypeChecker checker;
+    if (parser.has_errors() || !checker.check(*c->program)) {
+        std::fprintf(stderr, "program does not check\n");
+        std::exit(1);
+    }
+    c->resolver.resolve(*c->program);
+    c->purity.analyze(*c->program, c->resolver);
+    return c;
+}
+
+int32_t run(const Compiled& c) {
+    std::ostringstream out;
+    std::istringstream in;
+    Interpreter interp(out, in);
+    if (!interp.run(*c.program, c.resolver)) {
+        std::fprintf(stderr, "%s\n", interp.errors()[0].c_str());
+        std::exit(1);
+    }
+    return interp.result().i;
+}
+
+void report(const char* name, const std::string& source,
+            const PartialEvaluator::Options& options) {
+    auto c = compile(source);
+    int32_t before = 0, after = 0;
+    double run_ms = bench::best_ms([&] { before = run(*c); });
+
+    // Evaluation rewrites the tree, so each repetition needs a fresh one.
+    PartialEvaluator evaluator(options);
+    double peval_ms = 1e300;
+    for (int rep = 0; rep < 5; rep++) {
+        c = compile(source);
+        peval_ms = std::min(peval_ms, bench::best_ms([&] {
+            evaluator.evaluate(*c->program, c->resolver, c->purity);
+        }, 1));
+    }
+    double evaluated_ms = bench::best_ms([&] { after = run(*c); });
+
+    if (before != after) {
+        std::fprintf(stderr, "%s: results differ: %d vs %d\n", name, before, after);
+        std::exit(1);
+    }
+    std::printf("%-8s %10.2f %10.2f %10.2f %10.2f %8zu %8zu %6zu %12llu\n", name, run_ms,
+                peval_ms, evaluated_ms, run_ms - evaluated_ms, evaluator.folded_calls(),
+                evaluator.folded_ops(), evaluator.left_for_run_time(),
+                static_cast<unsigned long long>(evaluator.steps()));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int tables = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 200000;
+    PartialEvaluator::Options options;
+    if (argc > 3) options.step_budget = std::strtoull(argv[3], nullptr, 10);
+
+    std::printf("tables %d, iterations %d, step budget %llu\n\n", tables, iterations,
+                static_cast<unsigned long long>(options.step_budget));
+    std::printf("%-8s %10s %10s %10s %10s %8s %8s %6s %12s\n", "program", "run ms",
+                "peval ms", "run' ms", "saved ms", "calls", "ops", "left", "steps");
+    report("tables", generate_tables(tables), options);
+    report("loop", generate_loop(iterations), options);
+    return 0;
+}
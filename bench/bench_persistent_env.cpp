@@ -0,0 +1,157 @@
+// PersistentSymbolTable (HAMT) against the destructive SymbolTable and
+// DenseSymbolTable on the same workloads:
+//
+//   churn:    bench_scope_churn's recursive descent; a scope of the
+//             persistent table is just the version saved before it.
+//   snapshot: the same descent, keeping a view of the environment at every
+//             level (what a checker thread or an IDE query would hold).
+//             The destructive tables must be copied; the HAMT copies a
+//             root pointer.
+//   flat:     n names bound in one scope, then every name looked up.
+//
+// Heap allocations are counted through operator new.
+//
+//   bench_persistent_env [depth] [rounds] [flat names]
+
+#include "bench_util.hpp"
+#include "env/symbol.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+static size_t allocations = 0;
+
+void* operator new(std::size_t n) {
+  allocations++;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Persistent = tiger::PersistentSymbolTable<int>;
+
+std::vector<tiger::Sym> names;
+int value;
+
+// ----------------------------------------------------------------------------
+// Scoped tables (SymbolTable, DenseSymbolTable)
+// ----------------------------------------------------------------------------
+
+template <typename Table>
+long descend(Table& table, int depth, int level, std::vector<Table>* views) {
+  if (level == depth) return 0;
+  table.beginScope();
+  for (int i = 0; i < 8; i++) table.enter(names[i], &value);
+  table.enter(names[8 + level % (names.size() - 8)], &value);
+  if (views) views->push_back(table);
+  long found = 0;
+  for (int i = 0; i < 12; i++) found += table.look(names[i % 10]) != nullptr;
+  found += descend(table, depth, level + 1, views);
+  table.endScope();
+  return found;
+}
+
+// ----------------------------------------------------------------------------
+// Persistent table: the caller's version is the scope to return to
+// ----------------------------------------------------------------------------
+
+long descend_persistent(const Persistent& outer, int depth, int level, std::vector<Persistent>* views) {
+  if (level == depth) return 0;
+  Persistent table = outer;
+  for (int i = 0; i < 8; i++) table = std::move(table).enter(names[i], &value);
+  table = std::move(table).enter(names[8 + level % (names.size() - 8)], &value);
+  if (views) views->push_back(table);
+  long found = 0;
+  for (int i = 0; i < 12; i++) found += table.look(names[i % 10]) != nullptr;
+  return found + descend_persistent(table, depth, level + 1, views);
+}
+
+template <typename Table>
+void measure(const char* label, int depth, int rounds, bool snapshot) {
+  Table table;
+  std::vector<Table> views;
+  long found = 0;
+  size_t before = allocations;
+  double ms = tiger::bench::best_ms([&] {
+    for (int r = 0; r < rounds; r++) {
+      views.clear();
+      views.reserve(depth);
+      std::vector<Table>* keep = snapshot ? &views : nullptr;
+      if constexpr (std::is_same_v<Table, Persistent>) {
+        found += descend_persistent(table, depth, 0, keep);
+      } else {
+        found += descend(table, depth, 0, keep);
+      }
+    }
+  });
+  double per_round = static_cast<double>(allocations - before) / (5.0 * rounds);
+  std::printf("  %-22s %9.3f ms  %10.1f allocations/round  (%ld)\n", label, ms,
+              per_round, found);
+}
+
+template <typename Table>
+void measure_flat(const char* label, int n) {
+  Table table;
+  size_t before = allocations;
+  double enter_ms = tiger::bench::best_ms([&] {
+    table = Table();
+    for (int i = 0; i < n; i++) table.enter(names[i], &value);
+  }, 1);
+  size_t enter_allocs = allocations - before;
+  long found = 0;
+  double look_ms = tiger::bench::best_ms([&] {
+    for (int i = 0; i < n; i++) found += table.look(names[i]) != nullptr;
+  });
+  std::printf("  %-22s enter %8.3f ms (%7zu allocations)  look %8.3f ms  (%ld)\n", label,
+              enter_ms, enter_allocs, look_ms, found);
+}
+
+template <>
+void measure_flat<Persistent>(const char* label, int n) {
+  Persistent table;
+  size_t before = allocations;
+  double enter_ms = tiger::bench::best_ms([&] {
+    table = Persistent();
+    for (int i = 0; i < n; i++) table = std::move(table).enter(names[i], &value);
+  }, 1);
+  size_t enter_allocs = allocations - before;
+  long found = 0;
+  double look_ms = tiger::bench::best_ms([&] {
+    for (int i = 0; i < n; i++) found += table.look(names[i]) != nullptr;
+  });
+  std::printf("  %-22s enter %8.3f ms (%7zu allocations)  look %8.3f ms  (%ld)\n", label,
+              enter_ms, enter_allocs, look_ms, found);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  int depth = argc > 1 ? std::atoi(argv[1]) : 2000;
+  int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+  int flat = argc > 3 ? std::atoi(argv[3]) : 100000;
+  int count = std::max(8 + depth, flat);
+  for (int i = 0; i < count; i++)
+    names.push_back(tiger::Symbol::intern("n" + std::to_string(i)));
+
+  std::printf("churn: depth %d, %d rounds, 9 binds + 12 lookups per level\n", depth, rounds);
+  measure<tiger::SymbolTable<int>>("SymbolTable", depth, rounds, false);
+  measure<tiger::DenseSymbolTable<int>>("DenseSymbolTable", depth, rounds, false);
+  measure<Persistent>("PersistentSymbolTable", depth, rounds, false);
+
+  std::printf("\nsnapshot: churn plus a view kept at every level\n");
+  measure<tiger::SymbolTable<int>>("SymbolTable (copy)", depth, rounds, true);
+  measure<tiger::DenseSymbolTable<int>>("DenseSymbolTable (copy)", depth, rounds, true);
+  measure<Persistent>("PersistentSymbolTable", depth, rounds, true);
+
+  std::printf("\nflat: %d names in one scope\n", flat);
+  measure_flat<tiger::SymbolTable<int>>("SymbolTable", flat);
+  measure_flat<tiger::DenseSymbolTable<int>>("DenseSymbolTable", flat);
+  measure_flat<Persistent>("PersistentSymbolTable", flat);
+  return 0;
+}
@@ -0,0 +1,246 @@
+// Static resolution: cost of the pass, and what it buys a tree walker.
+//
+// On a generated program (6250 functions ~ 50k lines by default):
+//   resolve:   Resolver::resolve over the parsed tree, next to the parse
+//   access:    every variable use of every function body read once per
+//              "call", with the body's parameters and locals bound
+//                name   interned and looked up in a scoped SymbolTable
+//                         that the call fills and pops
+//                slot   frame[slot] after `depth` static links
+//              each read from the AST nodes, then from arrays packed per
+//              body beforehand (interned names / depth-slot pairs), which
+//              takes the scattered nodes out of the comparison
+//
+//   bench_resolve [functions] [calls]
+
+#include "bench_util.hpp"
+#include "env/symbol.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "semantic/Resolver.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace tiger;
+
+namespace {
+
+// The variable uses and declarations of one function body (not of the
+// functions nested in it, which this generator does not produce).
+struct Body {
+    const FunctionDec* dec;
+    std::vector<const SimpleVar*> uses;
+    std::vector<const VarDec*> locals;
+};
+
+void collect_var(const Var& var, Body& body);
+
+void collect(const Exp& exp, Body& body) {
+    switch (exp.kind) {
+        case ExpKind::VAR: collect_var(*static_cast<const VarExp&>(exp).var, body); break;
+        case ExpKind::CALL:
+            for (const auto& a : static_cast<const CallExp&>(exp).args) collect(*a, body);
+            break;
+        case ExpKind::OP:
+            collect(*static_cast<const OpExp&>(exp).left, body);
+            collect(*static_cast<const OpExp&>(exp).right, body);
+            break;
+        case ExpKind::RECORD:
+            for (const auto& f : static_cast<const RecordExp&>(exp).fields) collect(*f.exp, body);
+            break;
+        case ExpKind::SEQ:
+            for (const auto& e : static_cast<const SeqExp&>(exp).exps) collect(*e, body);
+            break;
+        case ExpKind::ASSIGN:
+            collect_var(*static_cast<const AssignExp&>(exp).var, body);
+            collect(*static_cast<const AssignExp&>(exp).exp, body);
+            break;
+        case ExpKind::IF: {
+            auto& i = static_cast<const IfExp&>(exp);
+            collect(*i.test, body);
+            collect(*i.then_exp, body);
+            if (i.else_exp) collect(*i.else_exp, body);
+            break;
+        }
+        case ExpKind::ARRAY:
+            collect(*static_cast<const ArrayExp&>(exp).size, body);
+            collect(*static_cast<const ArrayExp&>(exp).init, body);
+            break;
+        case ExpKind::LET: {
+            auto& let = static_cast<const LetExp&>(exp);
+            for (const auto& d : let.decs) {
+                if (d->kind != DecKind::VAR) continue;
+                auto& v = static_cast<const VarDec&>(*d);
+                collect(*v.init, body);
+                body.locals.push_back(&v);
+            }
+            for (const auto& e : let.body) collect(*e, body);
+            break;
+        }
+        default: break;
+    }
+}
+
+void collect_var(const Var& var, Body& body) {
+    switch (var.kind) {
+        case VarKind::SIMPLE: body.uses.push_back(&static_cast<const SimpleVar&>(var)); break;
+        case VarKind::FIELD: collect_var(*static_cast<const FieldVar&>(var).var, body); break;
+        case VarKind::SUBSCRIPT:
+            collect_var(*static_cast<const SubscriptVar&>(var).var, body);
+            collect(*static_cast<const SubscriptVar&>(var).index, body);
+            break;
+    }
+}
+
+struct Frame {
+    const Frame* link;
+    int64_t* slots;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int functions = argc > 1 ? std::atoi(argv[1]) : 6250;
+    int calls = argc > 2 ? std::atoi(argv[2]) : 20;
+    std::string source = bench::generate_program(functions);
+
+    double parse_ms = bench::best_ms([&] {
+        Lexer lexer(source);
+        Parser parser(lexer);
+        parser.parse();
+    });
+
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto program = parser.parse();
+    semantic::Resolver resolver;
+    double resolve_ms = bench::best_ms([&] { resolver.resolve(*program); });
+    if (resolver.unresolved() != 0) std::abort();
+
+    std::vector<Body> bodies;
+    std::size_t uses = 0;
+    for (FunctionDec* dec : resolver.functions()) {
+        bodies.push_back({dec, {}, {}});
+        collect(*dec->body, bodies.back());
+        uses += bodies.back().uses.size();
+    }
+
+    // Top-level variables (the generator's `counter`).
+    auto& let = static_cast<const LetExp&>(*program->exp);
+    std::vector<const VarDec*> globals;
+    for (const auto& d : let.decs)
+        if (d->kind == DecKind::VAR) globals.push_back(static_cast<const VarDec*>(d.get()));
+
+    std::vector<int64_t> values(64);
+    for (std::size_t i = 0; i < values.size(); i++) values[i] = static_cast<int64_t>(i);
+
+    // name: a call binds its parameters and locals, every use is a lookup
+    int64_t name_sum = 0;
+    double name_ms = bench::best_ms([&] {
+        SymbolTable<int64_t> env;
+        env.beginScope();
+        for (std::size_t i = 0; i < globals.size(); i++)
+            env.enter(Symbol::intern(globals[i]->name), &values[i]);
+        for (int c = 0; c < calls; c++) {
+            for (const Body& body : bodies) {
+                env.beginScope();
+                std::size_t v = 1;
+                for (const auto& p : body.dec->params) env.enter(Symbol::intern(p.name), &values[v++]);
+                for (const VarDec* local : body.locals) env.enter(Symbol::intern(local->name), &values[v++]);
+                for (const SimpleVar* use : body.uses) name_sum += *env.look(Symbol::intern(use->name));
+                env.endScope();
+            }
+        }
+        env.endScope();
+    });
+
+    // packed names: as above, without interning or touching the nodes
+    std::vector<std::vector<Sym>> binds(bodies.size()), looks(bodies.size());
+    for (std::size_t b = 0; b < bodies.size(); b++) {
+        for (const auto& p : bodies[b].dec->params) binds[b].push_back(Symbol::intern(p.name));
+        for (const VarDec* local : bodies[b].locals) binds[b].push_back(Symbol::intern(local->name));
+        for (const SimpleVar* use : bodies[b].uses) looks[b].push_back(Symbol::intern(use->name));
+    }
+    int64_t packed_name_sum = 0;
+    double packed_name_ms = bench::best_ms([&] {
+        SymbolTable<int64_t> env;
+        env.beginScope();
+        for (std::size_t i = 0; i < globals.size(); i++)
+            env.enter(Symbol::intern(globals[i]->name), &values[i]);
+        for (int c = 0; c < calls; c++) {
+            for (std::size_t b = 0; b < bodies.size(); b++) {
+                env.beginScope();
+                std::size_t v = 1;
+                for (Sym s : binds[b]) env.enter(s, &values[v++]);
+                for (Sym s : looks[b]) packed_name_sum += *env.look(s);
+                env.endScope();
+            }
+        }
+        env.endScope();
+    });
+
+    // slot: a call gets a frame linked to the top-level one. `read(b, f)`
+    // reads every use in body b from frame f.
+    auto time_slots = [&](int64_t& sum, auto&& read) {
+        return bench::best_ms([&] {
+            std::vector<int64_t> top(program->frame_size);
+            for (const VarDec* g : globals) top[g->slot] = values[0];
+            Frame top_frame{nullptr, top.data()};
+            std::vector<int64_t> slots(values.size());
+            for (int c = 0; c < calls; c++) {
+                for (std::size_t b = 0; b < bodies.size(); b++) {
+                    uint32_t size = bodies[b].dec->frame_size;
+                    for (uint32_t s = 0; s < size; s++) slots[s] = values[s + 1];
+                    Frame frame{&top_frame, slots.data()};
+                    sum += read(b, frame);
+                }
+            }
+        });
+    };
+    auto load = [](const Frame& frame, uint32_t depth, uint32_t slot) {
+        const Frame* f = &frame;
+        for (uint32_t d = 0; d < depth; d++) f = f->link;
+        return f->slots[slot];
+    };
+
+    int64_t slot_sum = 0;
+    double slot_ms = time_slots(slot_sum, [&](std::size_t b, const Frame& frame) {
+        int64_t sum = 0;
+        for (const SimpleVar* use : bodies[b].uses) sum += load(frame, use->depth, use->slot);
+        return sum;
+    });
+
+    struct Ref {
+        uint32_t depth, slot;
+    };
+    std::vector<std::vector<Ref>> refs(bodies.size());
+    for (std::size_t b = 0; b < bodies.size(); b++)
+        for (const SimpleVar* use : bodies[b].uses) refs[b].push_back({use->depth, use->slot});
+    int64_t packed_slot_sum = 0;
+    double packed_slot_ms = time_slots(packed_slot_sum, [&](std::size_t b, const Frame& frame) {
+        int64_t sum = 0;
+        for (Ref r : refs[b]) sum += load(frame, r.depth, r.slot);
+        return sum;
+    });
+
+    if (name_sum != packed_name_sum || name_sum != slot_sum || name_sum != packed_slot_sum) {
+        std::fprintf(stderr, "sums differ\n");
+        return 1;
+    }
+
+    double reads = static_cast<double>(uses) * calls;
+    std::printf("functions %d, variable uses %zu, calls per function %d\n",
+                functions, uses, calls);
+    std::printf("%-10s %10.2f ms\n", "parse", parse_ms);
+    std::printf("%-10s %10.2f ms  (%.1f%% of parse)\n", "resolve", resolve_ms,
+                100.0 * resolve_ms / parse_ms);
+    std::printf("%-10s %10s %12s %12s\n", "access", "", "ns/read", "packed ns");
+    std::printf("%-10s %10s %12.2f %12.2f\n", "name", "", name_ms * 1e6 / reads,
+                packed_name_ms * 1e6 / reads);
+    std::printf("%-10s %10s %12.2f %12.2f  (%.1fx / %.1fx vs name)\n", "slot", "",
+                slot_ms * 1e6 / reads, packed_slot_ms * 1e6 / reads, name_ms / slot_ms,
+                packed_name_ms / packed_slot_ms);
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Deep, recursion-heavy scope churn: every level of a recursive descent
+// opens a scope and rebinds the same handful of names (shadowing all the
+// levels above), looks a few up, then unwinds. Compares the previous
+// SymbolTable layout (per-symbol vectors in an unordered_map) with the
+// binder-stack SymbolTable and DenseSymbolTable; heap allocations are
+// counted through operator new.
+//
+//   bench_scope_churn [depth] [rounds]
+
+#include "bench_util.hpp"
+#include "env/symbol.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static size_t allocations = 0;
+
+void* operator new(std::size_t n) {
+  allocations++;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// The SymbolTable layout before the binder stack, for comparison.
+template <typename Value>
+class MapSymbolTable {
+public:
+  void enter(tiger::Sym sym, Value* value) {
+    bindings_[sym].push_back(value);
+    undo_stack_.push_back(sym);
+  }
+  Value* look(tiger::Sym sym) const {
+    auto it = bindings_.find(sym);
+    if (it != bindings_.end() && !it->second.empty()) return it->second.back();
+    return nullptr;
+  }
+  void beginScope() { undo_stack_.push_back(nullptr); }
+  void endScope() {
+    while (!undo_stack_.empty()) {
+      auto sym = undo_stack_.back();
+      undo_stack_.pop_back();
+      if (!sym) break;
+      bindings_[sym].pop_back();
+    }
+  }
+
+private:
+  std::unordered_map<tiger::Sym, std::vector<Value*>> bindings_;
+  std::vector<tiger::Sym> undo_stack_;
+};
+
+std::vector<tiger::Sym> names;
+int value;
+
+template <typename Table>
+long descend(Table& table, int depth, int level) {
+  if (level == depth) return 0;
+  table.beginScope();
+  // A recursive function's params and locals, plus one name unique to
+  // this level (a fresh symbol being bound for the first time).
+  for (int i = 0; i < 8; i++) table.enter(names[i], &value);
+  table.enter(names[8 + level % (names.size() - 8)], &value);
+  long found = 0;
+  for (int i = 0; i < 12; i++) found += table.look(names[i % 10]) != nullptr;
+  found += descend(table, depth, level + 1);
+  table.endScope();
+  return found;
+}
+
+template <typename Table>
+void measure(const char* label, int depth, int rounds) {
+  Table table;
+  size_t before = allocations;
+  long found = descend(table, depth, 0);
+  size_t cold = allocations - before;
+  before = allocations;
+  double ms = tiger::bench::best_ms([&] {
+    for (int r = 0; r < rounds; r++) found += descend(table, depth, 0);
+  });
+  double per_round = static_cast<double>(allocations - before) / (5.0 * rounds);
+  std::printf("%-18s %9.3f ms  allocations: %6zu first round, %6.1f per round after"
+              "  (%ld)\n", label, ms, cold, per_round, found);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  int depth = argc > 1 ? std::atoi(argv[1]) : 2000;
+  int rounds = argc > 2 ? std::atoi(argv[2]) : 200;
+  for (int i = 0; i < 8 + depth; i++)
+    names.push_back(tiger::Symbol::intern("n" + std::to_string(i)));
+
+  std::printf("depth %d, %d rounds, 9 binds + 12 lookups per level\n", depth, rounds);
+  measure<MapSymbolTable<int>>("map + vectors", depth, rounds);
+  measure<tiger::SymbolTable<int>>("SymbolTable", depth, rounds);
+  measure<tiger::DenseSymbolTable<int>>("DenseSymbolTable", depth, rounds);
+  return 0;
+}
@@ -0,0 +1,128 @@
+// Process startup cost of the base environment.
+//
+// Each mode runs in a fresh process (the benchmark re-executes itself),
+// because what matters is the first use in a short-lived compile:
+//
+//   empty     exit immediately (process creation baseline)
+//   built     build int/string and the nine library functions at startup
+//             the straightforward way: intern the names, build a
+//             parameter vector per function, bind them in SymbolTables
+//   constant  look the same names up in semantic/BaseEnv.hpp
+//
+// Reports wall time per process (best of several batches) and the number
+// of operator new calls the mode made.
+//
+//   bench_startup [processes-per-batch]
+
+#include "bench_util.hpp"
+#include "env/symbol.hpp"
+#include "semantic/BaseEnv.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <new>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+static size_t allocations = 0;
+
+void* operator new(size_t n) {
+  allocations++;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+using namespace tiger;
+using namespace tiger::semantic;
+
+struct BuiltSig {
+  std::vector<const Type*> params;
+  const Type* result;
+};
+
+struct BuiltEnv {
+  SymbolTable<const Type> types;
+  SymbolTable<BuiltSig> functions;
+  std::deque<BuiltSig> sigs;
+};
+
+void build(BuiltEnv& env) {
+  env.types.enter(Symbol::intern("int"), &INT_TYPE);
+  env.types.enter(Symbol::intern("string"), &STRING_TYPE);
+  auto fun = [&](const char* name, std::vector<const Type*> params, const Type* result) {
+    env.sigs.push_back(BuiltSig{std::move(params), result});
+    env.functions.enter(Symbol::intern(name), &env.sigs.back());
+  };
+  const Type* s = &STRING_TYPE;
+  const Type* i = &INT_TYPE;
+  fun("print", {s}, &UNIT_TYPE);
+  fun("getchar", {}, s);
+  fun("ord", {s}, i);
+  fun("chr", {i}, s);
+  fun("size", {s}, i);
+  fun("substring", {s, i, i}, s);
+  fun("concat", {s, s}, s);
+  fun("not", {i}, i);
+  fun("exit", {i}, &UNIT_TYPE);
+}
+
+const char* NAMES[] = {"print", "getchar", "ord", "chr", "size",
+                       "substring", "concat", "not", "exit"};
+
+// Runs one mode in this process; the exit status carries a checksum so
+// the work cannot be dropped.
+int run_mode(const char* mode) {
+  size_t params = 0;
+  if (std::strcmp(mode, "built") == 0) {
+    BuiltEnv env;
+    build(env);
+    for (const char* n : NAMES) params += env.functions.look(Symbol::intern(n))->params.size();
+  } else if (std::strcmp(mode, "constant") == 0) {
+    for (const char* n : NAMES) params += base_env::function(Symbol::intern(n))->param_count;
+  }
+  if (const char* report = std::getenv("BENCH_STARTUP_REPORT"); report && *report)
+    std::fprintf(stderr, "%zu\n", allocations);
+  return static_cast<int>(params);
+}
+
+int spawn(const char* self, const char* mode, bool report) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    if (report) setenv("BENCH_STARTUP_REPORT", "1", 1);
+    execl(self, self, "--mode", mode, static_cast<char*>(nullptr));
+    _exit(127);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc > 2 && std::strcmp(argv[1], "--mode") == 0) return run_mode(argv[2]);
+
+  int batch = argc > 1 ? std::atoi(argv[1]) : 200;
+  char self[4096];
+  ssize_t len = readlink("/proc/self/exe", self, sizeof(self) - 1);
+  if (len <= 0) return 1;
+  self[len] = '\0';
+
+  for (const char* mode : {"empty", "built", "constant"}) {
+    std::printf("%-9s allocations: ", mode);
+    std::fflush(stdout);
+    spawn(self, mode, true);   // child prints its count to stderr
+    double ms = bench::best_ms([&] {
+      for (int i = 0; i < batch; i++) spawn(self, mode, false);
+    });
+    std::printf("%-9s %8.1f us/process\n", mode, ms * 1e3 / batch);
+  }
+  return 0;
+}
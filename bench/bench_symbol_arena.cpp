@@ -0,0 +1,100 @@
+// Interning from source slices: arena-backed Symbol pool vs. the original
+// std::unordered_set<std::string> pool (which needs a std::string to probe).
+//
+//   bench_symbol_arena [functions] [fresh_names]
+
+#include "bench_util.hpp"
+#include "env/symbol.hpp"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// Every identifier-shaped slice of `source`, as the lexer would see them.
+std::vector<std::string_view> identifiers(const std::string& source) {
+  std::vector<std::string_view> out;
+  for (size_t i = 0; i < source.size();) {
+    if (std::isalpha(static_cast<unsigned char>(source[i]))) {
+      size_t start = i;
+      while (i < source.size() &&
+             (std::isalnum(static_cast<unsigned char>(source[i])) || source[i] == '_'))
+        i++;
+      out.push_back(std::string_view(source).substr(start, i - start));
+    } else {
+      i++;
+    }
+  }
+  return out;
+}
+
+size_t heap_in_use() { return mallinfo2().uordblks; }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  int functions = argc > 1 ? std::atoi(argv[1]) : 6250;
+  int fresh = argc > 2 ? std::atoi(argv[2]) : 200000;
+
+  std::string source = tiger::bench::generate_program(functions);
+  std::vector<std::string_view> idents = identifiers(source);
+
+  // Hit-heavy: intern every identifier occurrence; after the first pass
+  // nearly all are hits.
+  std::unordered_set<std::string> old_pool;
+  double old_hit_ms = tiger::bench::best_ms([&] {
+    for (std::string_view id : idents) old_pool.insert(std::string(id));
+  });
+  double new_hit_ms = tiger::bench::best_ms([&] {
+    for (std::string_view id : idents) tiger::Symbol::intern(id);
+  });
+
+  // Miss-heavy: names never seen before (distinct per run), with heap
+  // growth measured over the first run.
+  std::vector<std::string> names;
+  for (int rep = 0; rep < 6; rep++)
+    for (int i = 0; i < fresh; i++)
+      names.push_back("fresh_" + std::to_string(rep) + "_" + std::to_string(i));
+
+  int rep = 0;
+  std::unordered_set<std::string> old_miss;
+  size_t old_heap = 0;
+  double old_miss_ms = tiger::bench::best_ms([&] {
+    old_miss.clear();
+    size_t before = heap_in_use();
+    for (int i = 0; i < fresh; i++) old_miss.insert(names[i]);
+    if (rep++ == 0) old_heap = heap_in_use() - before;
+  });
+
+  rep = 0;
+  size_t new_heap = 0;
+  tiger::SymbolPoolStats before_stats = tiger::Symbol::stats();
+  tiger::SymbolPoolStats first_stats;
+  double new_miss_ms = tiger::bench::best_ms([&] {
+    size_t before = heap_in_use();
+    const std::string* batch = names.data() + static_cast<size_t>(rep) * fresh;
+    for (int i = 0; i < fresh; i++) tiger::Symbol::intern(batch[i]);
+    if (rep++ == 0) {
+      new_heap = heap_in_use() - before;
+      first_stats = tiger::Symbol::stats();
+    }
+  });
+  size_t new_symbols = first_stats.symbols - before_stats.symbols;
+  size_t new_names = first_stats.name_bytes - before_stats.name_bytes;
+
+  std::printf("identifier occurrences: %zu\n", idents.size());
+  std::printf("%-28s %12s %12s\n", "", "unordered_set", "arena");
+  std::printf("%-28s %12.3f %12.3f\n", "hit-heavy (ms)", old_hit_ms, new_hit_ms);
+  std::printf("%-28s %12.3f %12.3f\n", "miss-heavy (ms)", old_miss_ms, new_miss_ms);
+  std::printf("%-28s %12.1f %12.1f\n", "heap bytes/symbol",
+              static_cast<double>(old_heap) / fresh,
+              static_cast<double>(new_heap) / fresh);
+  std::printf("arena bytes/symbol (header + name): %.1f over %zu symbols\n",
+              static_cast<double>(new_names) / new_symbols, new_symbols);
+  return 0;
+}
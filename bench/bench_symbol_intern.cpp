@@ -0,0 +1,70 @@
+// Multi-threaded interning: Symbol::intern vs. the previous design, one
+// std::unordered_set<std::string> behind a mutex.
+//
+//   bench_symbol_intern [max_threads]
+
+#include "bench_util.hpp"
+#include "env/symbol.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+class MutexPool {
+public:
+  const std::string* intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return &*pool_.insert(name).first;
+  }
+
+private:
+  std::unordered_set<std::string> pool_;
+  std::mutex mutex_;
+};
+
+// Runs `per_thread(t)` on `threads` threads; best-of-3 wall time in ms.
+template <typename F>
+double run(int threads, F&& per_thread) {
+  return tiger::bench::best_ms([&] {
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) pool.emplace_back(per_thread, t);
+    for (auto& th : pool) th.join();
+  }, 3);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  int max_threads = argc > 1 ? std::atoi(argv[1]) : 8;
+  const int vocabulary = 20000;  // identifiers in a large program
+  const int ops = 1000000;       // interns per thread
+
+  std::vector<std::string> names;
+  for (int i = 0; i < vocabulary; i++) names.push_back("ident_" + std::to_string(i));
+  for (const auto& n : names) tiger::Symbol::intern(n);
+
+  std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+  std::printf("%-8s %14s %14s %8s\n", "threads", "mutex Mops/s", "sharded Mops/s", "speedup");
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    MutexPool mutex_pool;
+    for (const auto& n : names) mutex_pool.intern(n);
+
+    // Hit-heavy: every name is already interned, as when lexing.
+    double mutex_ms = run(threads, [&](int t) {
+      for (int i = 0; i < ops; i++) mutex_pool.intern(names[(i * 31 + t) % vocabulary]);
+    });
+    double sharded_ms = run(threads, [&](int t) {
+      for (int i = 0; i < ops; i++) tiger::Symbol::intern(names[(i * 31 + t) % vocabulary]);
+    });
+
+    double total = static_cast<double>(ops) * threads / 1e6;
+    std::printf("%-8d %14.1f %14.1f %7.2fx\n", threads, total / (mutex_ms / 1e3),
+                total / (sharded_ms / 1e3), mutex_ms / sharded_ms);
+  }
+  return 0;
+}
@@ -0,0 +1,96 @@
+// Scoped symbol tables under a type-checker access pattern: a few hundred
+// globals, then per function a shallow scope of params/locals, a nested
+// let, and many lookups of both.
+//
+//   bench_symbol_table [functions]
+
+#include "bench_util.hpp"
+#include "env/symbol.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Workload {
+  std::vector<tiger::Sym> globals;
+  std::vector<tiger::Sym> locals;   // 6 per function: 4 params, 2 let vars
+  std::vector<tiger::Sym> lookups;  // 80 per function
+};
+
+Workload make_workload(int functions) {
+  Workload w;
+  std::mt19937 rng(7);
+  for (int i = 0; i < 300; i++)
+    w.globals.push_back(tiger::Symbol::intern("g" + std::to_string(i)));
+  std::vector<tiger::Sym> pool;
+  for (int i = 0; i < 2000; i++)
+    pool.push_back(tiger::Symbol::intern("v" + std::to_string(i)));
+
+  for (int f = 0; f < functions; f++) {
+    size_t base = w.locals.size();
+    for (int i = 0; i < 6; i++) w.locals.push_back(pool[rng() % pool.size()]);
+    for (int i = 0; i < 80; i++) {
+      // Mostly locals (params, let vars), the rest globals.
+      if (rng() % 3 != 0) {
+        w.lookups.push_back(w.locals[base + rng() % 6]);
+      } else {
+        w.lookups.push_back(w.globals[rng() % w.globals.size()]);
+      }
+    }
+  }
+  return w;
+}
+
+template <typename Table>
+long run(const Workload& w, int functions) {
+  static int value;
+  Table table;
+  table.beginScope();
+  for (tiger::Sym g : w.globals) table.enter(g, &value);
+
+  long found = 0;
+  const tiger::Sym* local = w.locals.data();
+  const tiger::Sym* look = w.lookups.data();
+  for (int f = 0; f < functions; f++, local += 6, look += 80) {
+    table.beginScope();
+    for (int i = 0; i < 4; i++) table.enter(local[i], &value);
+    for (int i = 0; i < 50; i++) found += table.look(look[i]) != nullptr;
+    table.beginScope();
+    table.enter(local[4], &value);
+    table.enter(local[5], &value);
+    for (int i = 50; i < 80; i++) found += table.look(look[i]) != nullptr;
+    table.endScope();
+    table.endScope();
+  }
+  table.endScope();
+  return found;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  int functions = argc > 1 ? std::atoi(argv[1]) : 100000;
+  Workload w = make_workload(functions);
+
+  long found_map = 0, found_dense = 0;
+  double map_ms = tiger::bench::best_ms([&] {
+    found_map = run<tiger::SymbolTable<int>>(w, functions);
+  });
+  double dense_ms = tiger::bench::best_ms([&] {
+    found_dense = run<tiger::DenseSymbolTable<int>>(w, functions);
+  });
+  if (found_map != found_dense) std::abort();
+
+  double lookups = static_cast<double>(w.lookups.size());
+  std::printf("%d functions, %.0f lookups, %zu binds\n", functions, lookups,
+              w.locals.size() + w.globals.size());
+  std::printf("SymbolTable:      %8.3f ms (%.2f ns/lookup incl. scopes)\n",
+              map_ms, map_ms * 1e6 / lookups);
+  std::printf("DenseSymbolTable: %8.3f ms (%.2f ns/lookup incl. scopes)\n",
+              dense_ms, dense_ms * 1e6 / lookups);
+  std::printf("speedup: %.2fx\n", map_ms / dense_ms);
+  return 0;
+}
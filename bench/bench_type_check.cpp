@@ -0,0 +1,49 @@
+// Type-checking throughput on generated programs.
+//
+// Parses each program once, then times TypeChecker::check over the tree
+// (best of 5) and reports AST nodes checked per second. The first run's
+// diagnostics must be empty: the generator only produces typed programs.
+//
+//   bench_type_check [functions...]   (default: 625 6250 25000)
+
+#include "bench_util.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "semantic/TypeChecker.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(std::atoi(argv[i]));
+    if (sizes.empty()) sizes = {625, 6250, 25000};
+
+    std::printf("%10s %10s %10s %10s %12s %12s\n", "functions", "lines", "nodes",
+                "parse ms", "check ms", "Mnodes/s");
+    for (int functions : sizes) {
+        std::string source = tiger::bench::generate_program(functions);
+        tiger::Lexer lexer(source);
+        tiger::Parser parser(lexer);
+        std::unique_ptr<tiger::Program> program;
+        double parse_ms = tiger::bench::best_ms([&] {
+            tiger::Lexer l(source);
+            tiger::Parser p(l);
+            p.parse();
+        }, 1);
+        program = parser.parse();
+
+        tiger::semantic::TypeChecker checker;
+        if (!checker.check(*program)) {
+            for (const auto& err : checker.errors()) std::fprintf(stderr, "%s\n", err.c_str());
+            return 1;
+        }
+        double ms = tiger::bench::best_ms([&] { checker.check(*program); });
+
+        size_t lines = 0;
+        for (char c : source) lines += c == '\n';
+        std::printf("%10d %10zu %10zu %10.2f %12.2f %12.1f\n", functions, lines,
+                    checker.nodes(), parse_ms, ms, checker.nodes() / ms / 1e3);
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef TIGER_BENCH_UTIL_HPP
+#define TIGER_BENCH_UTIL_HPP
+
+// Shared helpers for the benchmark programs in bench/.
+//   generate_program: deterministic, well-typed synthetic Tiger source.
+//   best_ms:          best-of-N wall time of a callable.
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+namespace tiger::bench {
+
+// A let with `functions` mutually callable functions, one record type and
+// one array type. Each function is 8 lines, so 6250 functions ~ 50k lines.
+inline std::string generate_program(int functions) {
+    std::string s;
+    s.reserve(static_cast<std::size_t>(functions) * 300 + 256);
+    s += "let\n";
+    s += "    type point = {x: int, y: int}\n";
+    s += "    type ints = array of int\n";
+    s += "    var counter := 0\n";
+    for (int i = 0; i < functions; i++) {
+        std::string n = std::to_string(i);
+        std::string callee = std::to_string(i > 0 ? i - 1 : 0);
+        s += "    function f" + n + "(a: int, b: int): int =\n";
+        s += "        let var t := a * " + std::to_string(i % 7 + 1) + " + b\n";
+        s += "            var p := point{x = a, y = b}\n";
+        s += "            var xs := ints[4] of t\n";
+        s += "        in\n";
+        s += "            if t > " + n + " then t - p.x + xs[1]\n";
+        s += "            else (counter := counter + 1; f" + callee + "(p.y, t - 1))\n";
+        s += "        end\n";
+    }
+    s += "in\n";
+    s += "    f" + std::to_string(functions > 0 ? functions - 1 : 0) + "(1, 2)\n";
+    s += "end\n";
+    return s;
+}
+
+template <typename F>
+double best_ms(F&& f, int reps = 5) {
+    double best = 1e300;
+    for (int i = 0; i < reps; i++) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best,
+            std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+} // namespace tiger::bench
+
+#endif // TIGER_BENCH_UTIL_HPP
@@ -1,9 +1,13 @@
 #include "EnvTable.hpp"
 #include "util/util.hpp"
+#include <cstring>
 #include <memory>
+#include <new>
 
 namespace tiger {
 
+static constexpr std::size_t INITIAL_SLOTS = 128;   // power of two
+
 // ============================================================================
 // Constructor
 // ============================================================================
@@ -11,24 +15,71 @@ namespace tiger {
 // C version:
 //   struct bucket *table[SIZE];   // global array, zero-initialized
 //
-// C++: std::vector needs explicit sizing.
-//   table_(SIZE)  creates a vector of SIZE null unique_ptrs.
+// C++: the slot array starts small and doubles as keys are added, so a
+//      program with thousands of names does not end up scanning chains.
 
-EnvTable::EnvTable() : table_(SIZE) {}
+template <typename Hash>
+BasicEnvTable<Hash>::BasicEnvTable(Hash hash)
+    : hash_(hash), slots_(INITIAL_SLOTS, Slot{0, 0, nullptr}),
+      mask_(INITIAL_SLOTS - 1) {}
 
 // ============================================================================
-// Bucket constructor
+// Slot array (Robin Hood hashing)
 // ============================================================================
 //
-// C version:
-//   b->key = key;  b->binding = binding;  b->next = next;
-//
-// C++: Use a member initializer list.
-//   std::unique_ptr cannot be copied — use std::move() to transfer ownership.
+// Each key lives at most a few slots past its home slot (hash & mask_).
+// On insert, a key that has probed further than the resident of a slot
+// takes the slot and the resident moves on ("take from the rich"), which
+// keeps probe lengths short and lets a lookup stop as soon as it meets a
+// resident closer to home than itself.
 
-EnvTable::Bucket::Bucket(const std::string& k, std::unique_ptr<Binding> b,
-                         std::unique_ptr<Bucket> n)
-  : key(k), binding(std::move(b)), next(std::move(n)) {}
+template <typename Hash>
+auto BasicEnvTable<Hash>::find(std::string_view name, std::uint64_t hash) const -> Key* {
+  std::uint32_t tag = static_cast<std::uint32_t>(hash >> 32);
+  std::size_t i = hash & mask_;
+  for (std::uint32_t dist = 1;; dist++, i = (i + 1) & mask_) {
+    const Slot& s = slots_[i];
+    if (s.dist < dist) return nullptr;   // empty, or closer to home than us
+    if (s.dist == dist && s.tag == tag && s.key->name() == name) return s.key;
+  }
+}
+
+template <typename Hash>
+void BasicEnvTable<Hash>::place(Key* key) {
+  Slot cur{1, static_cast<std::uint32_t>(key->hash >> 32), key};
+  std::size_t i = key->hash & mask_;
+  for (;; cur.dist++, i = (i + 1) & mask_) {
+    Slot& s = slots_[i];
+    if (s.dist == 0) {
+      s = cur;
+      return;
+    }
+    if (s.dist < cur.dist) std::swap(s, cur);
+  }
+}
+
+template <typename Hash>
+void BasicEnvTable<Hash>::grow() {
+  std::vector<Slot> old(slots_.size() * 2, Slot{0, 0, nullptr});
+  old.swap(slots_);
+  mask_ = slots_.size() - 1;
+  for (const Slot& s : old) {
+    if (s.dist) place(s.key);
+  }
+}
+
+template <typename Hash>
+auto BasicEnvTable<Hash>::find_or_add(std::string_view name, std::uint64_t hash) -> Key* {
+  if (Key* key = find(name, hash)) return key;
+  // Grow at load factor 0.8.
+  if ((key_count_ + 1) * 5 > slots_.size() * 4) grow();
+  void* mem = keys_.allocate(sizeof(Key) + name.size(), alignof(Key));
+  Key* key = new (mem) Key{hash, nullptr, name.size()};
+  std::memcpy(key + 1, name.data(), name.size());
+  place(key);
+  key_count_++;
+  return key;
+}
 
 // ============================================================================
 // insert
@@ -38,15 +89,30 @@ EnvTable::Bucket::Bucket(const std::string& k, std::unique_ptr<Binding> b,
 //   int index = util::hash(key) % SIZE;
 //   table[index] = Bucket(key, binding, table[index]);
 //
-// C++: std::make_unique<Bucket>(key, std::move(binding), std::move(table_[index]))
-//      then assign it to table_[index] with std::move.
-
-void EnvTable::insert(const std::string& key, std::unique_ptr<Binding> binding) {
-  int index = util::hash(key) % SIZE;
-  // TODO: create a new Bucket and link old head as next
-  // TODO: assign it to table_[index]
-  // hint: consider data exists already in table_[index], then we should move the data to next slot of generated bucket. 
-  table_[index] = std::make_unique<Bucket>(key, std::move(binding), std::move(table_[index])) ; 
+// C++: the new Node goes on the front of its key's chain, exactly like the
+//      bucket did, but the chain only ever holds bindings of that key.
+//      Nodes are recycled through free_nodes_ instead of new/delete.
+
+template <typename Hash>
+void BasicEnvTable<Hash>::insert(std::string_view name, std::unique_ptr<Binding> binding) {
+  Key* key = find_or_add(name, hash_(name));
+
+  Node* node;
+  if (!free_nodes_.empty()) {
+    node = free_nodes_.back();
+    free_nodes_.pop_back();
+  } else {
+    node_pool_.emplace_back();
+    node = &node_pool_.back();
+  }
+  node->binding = std::move(binding);
+  node->shadowed = key->top;
+  node->key = key;
+  node->popped = false;
+
+  key->top = node;
+  log_.push_back(node);
+  live_++;
 }
 
 // ============================================================================
@@ -58,37 +124,62 @@ void EnvTable::insert(const std::string& key, std::unique_ptr<Binding> binding)
 //       if (0 == strcmp(b->key, key)) return b->binding;
 //   return NULL;
 //
-// C++: Compare strings with ==.
-//      Traverse with raw pointer: Bucket* b = table_[index].get();
+// C++: one probe sequence finds the key; its newest binding is the answer.
 //      Return binding.get() (raw pointer, caller doesn't take ownership).
-//      Return nullptr if not found.
-
-Binding* EnvTable::lookup(const std::string& key) const {
-  int index = util::hash(key) % SIZE; 
-  // TODO: traverse the chain, return b->binding.get() when b->key == key
-  // .get() method in smart pointer gives raw pointer. 
-  for (auto b = table_[index].get(); b; b =b->next.get()) {
-    if (b->key == key) {
-      return b->binding.get(); 
-    }
-  }
-  return nullptr;
+
+template <typename Hash>
+Binding* BasicEnvTable<Hash>::lookup(std::string_view name) const {
+  Key* key = find(name, hash_(name));
+  return key && key->top ? key->top->binding.get() : nullptr;
 }
 
 // ============================================================================
-// pop
+// pop / mark / rollback
 // ============================================================================
 //
 // C version:
 //   table[index] = table[index]->next;
 //
-// C++: std::move the next pointer into table_[index].
-//      The old head is automatically freed.
+// C++: pop removes the newest binding of `key` and flags its node. Flagged
+//      nodes at the end of the log are recycled now, so a binding popped
+//      out of order goes as soon as the ones logged after it are popped
+//      too; the others stay until rollback passes over them. The log is
+//      never cut below the newest mark: an insert after it must still be
+//      undone by rollback(mark).
+
+template <typename Hash>
+void BasicEnvTable<Hash>::unlink(Node* node) {
+  node->key->top = node->shadowed;
+  node->binding.reset();
+  live_--;
+}
+
+template <typename Hash>
+void BasicEnvTable<Hash>::pop(std::string_view name) {
+  Key* key = find(name, hash_(name));
+  if (!key || !key->top) return;
 
-void EnvTable::pop(const std::string& key) {
-  int index = util::hash(key) % SIZE;
-  // TODO: move table_[index]->next into table_[index]
-  table_[index] = std::move(table_[index]->next);  
+  Node* node = key->top;
+  unlink(node);
+  node->popped = true;
+  while (log_.size() > floor_ && log_.back()->popped) {
+    free_nodes_.push_back(log_.back());
+    log_.pop_back();
+  }
 }
 
+template <typename Hash>
+void BasicEnvTable<Hash>::rollback(Mark mark) {
+  while (log_.size() > mark) {
+    Node* node = log_.back();
+    log_.pop_back();
+    if (!node->popped) unlink(node);
+    free_nodes_.push_back(node);
+  }
+  if (floor_ > mark) floor_ = mark;
+}
+
+template class BasicEnvTable<util::StdHash>;
+template class BasicEnvTable<util::WordHash>;
+
 } // namespace tiger
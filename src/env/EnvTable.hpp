@@ -2,11 +2,38 @@
 #define TIGER_ENV_TABLE_HPP
 
 //  C:   void *binding;             →  C++: std::unique_ptr<Binding> (virtual base)
-//  C:   struct bucket *table[109]; →  C++: std::vector<std::unique_ptr<Bucket>>
-//  C:   typedef char *string;      →  C++: std::string
+//  C:   struct bucket *table[109]; →  C++: growable Robin Hood slot array
+//  C:   typedef char *string;      →  C++: std::string_view into a key arena
+//
+// Layout:
+//   slots_   open addressing with Robin Hood displacement, one slot per
+//            distinct key; doubles when the load factor passes 0.8.
+//   Key      one per distinct key, in the arena with the key bytes right
+//            after it (copied once): hash, length and the newest binding.
+//   Node     one per insert, pooled: the binding and the binding it shadows.
+//   log_     nodes in insertion order, so mark()/rollback() can undo a
+//            whole scope without hashing any key. pop() flags its node;
+//            flagged nodes at the end of the log are recycled at once,
+//            down to the newest mark, so popping in any order does not
+//            grow the log.
+//
+// A key stays in the table after its last binding is removed (lookup
+// returns nullptr), so slots only ever fill up; the table holds one slot
+// per distinct name ever bound.
+//
+// The hash function is a policy (util.hpp): EnvTable uses util::DefaultHash,
+// BasicEnvTable<util::StdHash> the standard library's. A key is hashed once
+// per call and the value is kept in its Key, so growing never rehashes.
+// The member functions are defined in EnvTable.cpp and instantiated there
+// for StdHash and WordHash; another policy needs a line there too.
 
+#include "util/Arena.hpp"
+#include "util/util.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <memory>    // std::unique_ptr, std::make_unique
-#include <string>    // c++ string.
+#include <string_view>
 #include <vector>    // standard container.
 
 namespace tiger {
@@ -22,31 +49,83 @@ struct Binding {
   virtual ~Binding() = default;
 };
 
-class EnvTable {
+template <typename Hash = util::DefaultHash>
+class BasicEnvTable {
 public:
-  EnvTable();
+  // Position in the insertion log; see mark().
+  using Mark = std::size_t;
+
+  explicit BasicEnvTable(Hash hash = Hash());
 
-  void     insert(const std::string& key, std::unique_ptr<Binding> binding);
-  Binding* lookup(const std::string& key) const;
-  void     pop(const std::string& key);
+  void     insert(std::string_view key, std::unique_ptr<Binding> binding);
+  Binding* lookup(std::string_view key) const;
+  void     pop(std::string_view key);
+
+  // Scopes: rollback(mark()) removes every binding inserted since the
+  // mark, newest first, restoring what they shadowed.
+  //
+  //   EnvTable::Mark m = env.mark();
+  //   env.insert("x", ...); env.insert("y", ...);
+  //   env.rollback(m);  // x and y are back to their outer bindings
+  Mark mark() const { return floor_ = log_.size(); }
+  void rollback(Mark mark);
+
+  // Live bindings, and distinct keys ever inserted.
+  std::size_t size() const { return live_; }
+  std::size_t key_count() const { return key_count_; }
 
 private:
-  static constexpr int SIZE = 109;
+  struct Node;
+
+  // Followed in memory by `length` bytes of the key.
+  struct Key {
+    std::uint64_t hash;
+    Node* top;               // newest binding, nullptr if none
+    std::size_t length;
 
-  struct Bucket {
-    std::string key;
+    std::string_view name() const {
+      return {reinterpret_cast<const char*>(this + 1), length};
+    }
+  };
+
+  struct Node {
     std::unique_ptr<Binding> binding;
-    std::unique_ptr<Bucket> next;
+    Node* shadowed;          // previous binding of the same key
+    Key* key;
+    bool popped;             // removed by pop() before its scope ended
+  };
 
-    Bucket(const std::string& k, std::unique_ptr<Binding> b,
-           std::unique_ptr<Bucket> n);
+  // dist is the probe distance + 1; 0 marks an empty slot.
+  struct Slot {
+    std::uint32_t dist;
+    std::uint32_t tag;       // high half of the key's hash
+    Key* key;
   };
 
-  std::vector<std::unique_ptr<Bucket>> table_;
+  Hash hash_;
+  std::vector<Slot> slots_;
+  std::size_t mask_;
+  std::size_t key_count_ = 0;
+  std::size_t live_ = 0;
 
-  // hash lives in util::hash — no private copy needed.
+  Arena keys_;
+  std::deque<Node> node_pool_;
+  std::vector<Node*> free_nodes_;
+  std::vector<Node*> log_;
+  mutable Mark floor_ = 0;   // newest mark; pop() keeps the log this long
+
+  Key* find(std::string_view name, std::uint64_t hash) const;
+  Key* find_or_add(std::string_view name, std::uint64_t hash);
+  void place(Key* key);
+  void grow();
+  void unlink(Node* node);
 };
 
+extern template class BasicEnvTable<util::StdHash>;
+extern template class BasicEnvTable<util::WordHash>;
+
+using EnvTable = BasicEnvTable<>;
+
 } // namespace tiger
 
 #endif // TIGER_ENV_TABLE_HPP
@@ -33,7 +33,7 @@
  * removes it, enabling scope unwinding.
  */
 
-const int SIZE = 109; 
+#define SIZE 109   /* same prime as EnvTable */
 
 struct binder_ {
   void *key;
@@ -105,19 +105,17 @@ void *TAB_pop(TAB_table t) {
 
 struct S_symbol_ {
   string name;
-  S_Symbol next;
+  S_symbol next;
 };
 
-static S_Symbol mksymbol(string name, S_Symbol next) {
-  S_Symbol s = malloc(sizeof(*s));
+static S_symbol mksymbol(string name, S_symbol next) {
+  S_symbol s = malloc(sizeof(*s));
   s->name = name;
   s->next = next;
   return s;
 }
 
-#define SIZE 109   /* same prime as EnvTable */
-
-static S_Symbol hashtable[SIZE];
+static S_symbol hashtable[SIZE];
 
 static unsigned int hash(char *s) {
   unsigned int h = 0;
@@ -132,9 +130,9 @@ static unsigned int hash(char *s) {
  *   - If found, return existing symbol (interned).
  *   - If not, create a new symbol and prepend to chain.
  */
-S_Symbol S_Symbol(string name) {
+S_symbol S_Symbol(string name) {
   int index = hash(name) % SIZE;
-  S_Symbol syms = hashtable[index], sym;
+  S_symbol syms = hashtable[index], sym;
 
   for (sym = syms; sym; sym = sym->next)
     if (strcmp(sym->name, name) == 0)
@@ -145,7 +143,7 @@ S_Symbol S_Symbol(string name) {
   return sym;
 }
 
-string S_name(S_Symbol s) {
+string S_name(S_symbol s) {
   return s->name;
 }
 
@@ -170,11 +168,11 @@ S_table S_empty(void) {
   return TAB_empty();
 }
 
-void S_enter(S_table t, S_Symbol sym, void *value) {
+void S_enter(S_table t, S_symbol sym, void *value) {
   TAB_enter(t, sym, value);
 }
 
-void *S_look(S_table t, S_Symbol sym) {
+void *S_look(S_table t, S_symbol sym) {
   return TAB_look(t, sym);
 }
 
@@ -192,7 +190,7 @@ void S_beginScope(S_table t) {
  * binding for a given key — exactly the stack-like behavior we discussed.
  */
 void S_endScope(S_table t) {
-  S_Symbol s;
+  S_symbol s;
   do {
     s = TAB_pop(t);
   } while (s != &marksym);
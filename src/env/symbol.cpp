@@ -1,20 +1,181 @@
 #include "symbol.hpp"
+#include "util/Arena.hpp"
+#include "util/util.hpp"
+#include <atomic>
+#include <cstddef>     // offsetof
+#include <cstring>
+#include <memory>
+#include <mutex>
 
 namespace tiger {
 
 // ============================================================================
-// Symbol 정적 멤버 정의
+// 샤딩된 인터닝 풀 (Sharded interning pool)
 // ============================================================================
 //
-// 헤더에서 선언만 한 static 멤버를 여기서 정의.
-//   inline static (C++17)을 쓰면 헤더에서 정의 가능하지만,
-//   .hpp/.cpp 분리 시에는 전통적 방식이 더 명확함:
-//     - 헤더: static std::unordered_set<std::string> pool_;  (선언)
-//     - 소스: std::unordered_set<std::string> Symbol::pool_;  (정의)
+// 구조:
+//   - 해시의 하위 SHARD_BITS 비트로 샤드를 고름 (샤드 16개).
+//   - 샤드마다 open addressing 테이블. 슬롯은 std::atomic<const SymbolEntry*>.
+//   - 읽기(이미 인터닝된 이름): 락 없이 acquire load로만 탐색.
+//   - 쓰기(처음 보는 이름): 샤드 mutex를 잡고 다시 탐색한 뒤 삽입.
+//     엔트리를 다 만든 다음 release store로 슬롯에 공개하므로,
+//     읽는 쪽은 완성된 엔트리만 보게 됨.
+//   - 테이블이 절반 이상 차면 두 배 크기의 새 테이블을 만들어 공개.
+//     옛 테이블은 다른 스레드가 아직 읽고 있을 수 있으므로 해제하지 않음
+//     (크기가 기하급수적으로 늘어나므로 합쳐도 최종 테이블의 2배 이하).
 //
-//   이렇게 하면 pool_이 정확히 하나의 번역 단위(translation unit)에 존재.
+// 저장 방식 (arena):
+//   예전: unordered_set<std::string> → 이름마다 노드 할당 + (긴 이름은) 문자열 할당.
+//   지금: 샤드마다 청크 단위 arena (util/Arena.hpp).
+//     엔트리 헤더(hash, length) 바로 뒤에 이름 바이트 + '\0'을 붙여서 연속으로 저장.
+//     → 이름 하나당 malloc 0번, 청크(64KiB)가 찰 때만 할당.
+//     → arena는 해제/이동하지 않으므로 핸들(SymbolEntry*)은 영원히 안정적.
+//
+// builtin 심볼 (symbol.hpp의 builtin::ALL):
+//   컴파일 타임 상수 엔트리. 풀을 처음 쓸 때 자기 샤드의 테이블에 끼워 넣음.
+//   첫 테이블은 샤드 안에 들어 있으므로 여기까지 malloc 0번.
+
+namespace {
+
+constexpr size_t SHARD_BITS = 4;
+constexpr size_t NUM_SHARDS = size_t(1) << SHARD_BITS;
+constexpr size_t INITIAL_CAPACITY = 64;
+
+static_assert(offsetof(StaticSymbol<1>, bytes) == sizeof(SymbolEntry),
+              "StaticSymbol must lay out like an arena entry");
+
+// 다음에 매길 dense id. 샤드 락 안에서 새 엔트리를 만들 때만 증가하므로
+// 빈 번호 없이 0..count-1이 채워짐. 0..builtin::COUNT-1은 예약.
+std::atomic<uint32_t> next_id{builtin::COUNT};
+
+// 슬롯에는 const 엔트리(builtin)도 들어가지만 아무도 엔트리를 고치지 않음.
+using Slot = std::atomic<const SymbolEntry*>;
+
+struct Table {
+  size_t mask;
+  Slot* slots;
+  std::unique_ptr<Slot[]> owned;   // 키운 테이블만 힙에 있음
+
+  explicit Table(size_t capacity) : Table(capacity, new Slot[capacity]) {
+    owned.reset(slots);
+  }
+  Table(size_t capacity, Slot* storage) : mask(capacity - 1), slots(storage) {
+    for (size_t i = 0; i < capacity; i++)
+      slots[i].store(nullptr, std::memory_order_relaxed);
+  }
+};
+
+bool matches(const SymbolEntry* e, uint64_t hash, std::string_view name) {
+  return e->hash == hash && e->length == name.size() &&
+         std::memcmp(e->data(), name.data(), name.size()) == 0;
+}
+
+class Shard {
+public:
+  Shard() : initial_(INITIAL_CAPACITY, initial_slots_) {
+    table_.store(&initial_, std::memory_order_release);
+  }
+
+  // 풀 초기화 때(다른 스레드가 보기 전에) builtin 엔트리를 끼워 넣음.
+  void seed(Sym sym) {
+    place(&initial_, sym);
+    count_++;
+  }
+
+  // 락 없는 읽기 경로. 없으면 nullptr.
+  Sym find(uint64_t hash, std::string_view name) const {
+    const Table* t = table_.load(std::memory_order_acquire);
+    for (size_t i = probe_start(hash, t);; i = (i + 1) & t->mask) {
+      Sym e = t->slots[i].load(std::memory_order_acquire);
+      if (!e) return nullptr;
+      if (matches(e, hash, name)) return e;
+    }
+  }
+
+  // 쓰기 경로. 락을 잡은 뒤 다시 찾아봄 (다른 스레드가 먼저 넣었을 수 있음).
+  Sym insert(uint64_t hash, std::string_view name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Sym found = find(hash, name)) return found;
+
+    Table* t = table_.load(std::memory_order_relaxed);
+    if ((count_ + 1) * 2 > t->mask + 1) t = grow(t);
+
+    void* mem = arena_.allocate(sizeof(SymbolEntry) + name.size() + 1,
+                                alignof(SymbolEntry));
+    auto* e = new (mem) SymbolEntry{hash, static_cast<uint32_t>(name.size()),
+                                    next_id.fetch_add(1, std::memory_order_relaxed)};
+    char* bytes = const_cast<char*>(e->data());
+    std::memcpy(bytes, name.data(), name.size());
+    bytes[name.size()] = '\0';
+
+    place(t, e);
+    count_++;
+    return e;
+  }
+
+  SymbolPoolStats stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Table* t = table_.load(std::memory_order_relaxed);
+    return {count_, arena_.used(), arena_.reserved(),
+            (t->mask + 1) * sizeof(Slot)};
+  }
 
-std::unordered_set<std::string> Symbol::pool_;
+private:
+  std::atomic<Table*> table_{nullptr};
+  Slot initial_slots_[INITIAL_CAPACITY];
+  Table initial_;
+  std::vector<std::unique_ptr<Table>> tables_;  // 키우면서 공개했던 테이블
+  Arena arena_;
+  std::mutex mutex_;
+  size_t count_ = 0;
+
+  static size_t probe_start(uint64_t hash, const Table* t) {
+    return (hash >> SHARD_BITS) & t->mask;
+  }
+
+  static void place(Table* t, Sym e) {
+    size_t i = probe_start(e->hash, t);
+    while (t->slots[i].load(std::memory_order_relaxed))
+      i = (i + 1) & t->mask;
+    t->slots[i].store(e, std::memory_order_release);
+  }
+
+  // 옛 테이블의 슬롯을 그대로 옮겨 담음 (엔트리 자체는 이동 없음).
+  Table* grow(Table* old) {
+    tables_.push_back(std::make_unique<Table>((old->mask + 1) * 2));
+    Table* t = tables_.back().get();
+    for (size_t i = 0; i <= old->mask; i++) {
+      if (Sym e = old->slots[i].load(std::memory_order_relaxed))
+        place(t, e);
+    }
+    table_.store(t, std::memory_order_release);
+    return t;
+  }
+};
+
+// 함수 안 static: 첫 호출 때 스레드 안전하게 초기화됨 (C++11 magic static).
+//   전역 static 초기화 순서 문제(static initialization order fiasco)도 피함.
+struct Pool {
+  Shard shards[NUM_SHARDS];
+
+  Pool() {
+    for (Sym sym : builtin::ALL) shards[sym->hash & (NUM_SHARDS - 1)].seed(sym);
+  }
+};
+
+Shard* shards() {
+  static Pool pool;
+  return pool.shards;
+}
+
+// 스레드별 캐시: 최근에 intern한 이름을 direct-mapped로 기억.
+//   같은 이름을 반복해서 intern하는 lexer/checker에서는
+//   공유 테이블까지 가지 않고 여기서 끝남.
+constexpr size_t CACHE_SIZE = 256;
+
+thread_local Sym cache[CACHE_SIZE];
+
+} // namespace
 
 // ============================================================================
 // intern
@@ -22,18 +183,20 @@ std::unordered_set<std::string> Symbol::pool_;
 //
 // C 원본: S_Symbol S_Symbol(string name)
 //
-// unordered_set::insert는 {iterator, bool}을 반환.
-//   이미 있으면 기존 원소의 iterator, 없으면 새로 삽입한 iterator.
-//   어느 쪽이든 &(*it)로 안정적인 포인터를 얻음.
-//
-// 구조화된 바인딩(structured binding, C++17):
-//   auto [it, inserted] = pool_.insert(name);
-//   → std::pair를 it과 inserted 두 변수로 분해.
-//   inserted는 사용하지 않으므로 _로 표기 (관례).
-
-const std::string* Symbol::intern(const std::string& name) {
-  auto [it, _] = pool_.insert(name);
-  return &(*it);
+// 1) 스레드 캐시 → 2) 샤드 테이블 (락 없음) → 3) 샤드 락 잡고 삽입.
+// string_view로 받으므로 소스 버퍼의 일부를 그대로 넘겨도 됨 (임시 string 없음).
+
+Sym Symbol::intern(std::string_view name) {
+  uint64_t hash = SymbolHash{}(name);
+  Sym& slot = cache[(hash >> SHARD_BITS) % CACHE_SIZE];
+  if (slot && matches(slot, hash, name)) return slot;
+
+  Shard& shard = shards()[hash & (NUM_SHARDS - 1)];
+  Sym sym = shard.find(hash, name);
+  if (!sym) sym = shard.insert(hash, name);
+
+  slot = sym;
+  return sym;
 }
 
 // ============================================================================
@@ -42,11 +205,26 @@ const std::string* Symbol::intern(const std::string& name) {
 //
 // C 원본: string S_name(S_Symbol s) { return s->name; }
 //
-// intern()이 반환한 포인터를 역참조하여 원래 문자열을 돌려줌.
-// const 참조를 반환 → 복사 없음.
+// arena에 있는 바이트를 가리키는 string_view → 복사 없음.
+
+std::string_view Symbol::name(Sym sym) {
+  return sym->view();
+}
+
+uint32_t Symbol::count() {
+  return next_id.load(std::memory_order_relaxed);
+}
 
-const std::string& Symbol::name(const std::string* sym) {
-  return *sym;
+SymbolPoolStats Symbol::stats() {
+  SymbolPoolStats total;
+  for (size_t i = 0; i < NUM_SHARDS; i++) {
+    SymbolPoolStats s = shards()[i].stats();
+    total.symbols += s.symbols;
+    total.name_bytes += s.name_bytes;
+    total.arena_bytes += s.arena_bytes;
+    total.table_bytes += s.table_bytes;
+  }
+  return total;
 }
 
 } // namespace tiger
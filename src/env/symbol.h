@@ -15,6 +15,10 @@
 #ifndef SYMBOL_H
 #define SYMBOL_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /*
  * In the original Tiger book, util.h defines:
  *   typedef char *string;
@@ -25,13 +29,15 @@
 typedef char *string;
 
 
-typedef struct S_symbol_ *S_Symbol;
+/* The book spells the type S_symbol and the constructor S_Symbol; C
+ * cannot have a typedef and a function with the same name. */
+typedef struct S_symbol_ *S_symbol;
 
 /* Intern a string: returns the unique symbol for that name. */
-S_Symbol S_Symbol(string name);
+S_symbol S_Symbol(string name);
 
 /* Retrieve the original string from a symbol. */
-string S_name(S_Symbol sym);
+string S_name(S_symbol sym);
 
 /* ---- TAB_table: generic hash table (from table.h in Tiger book) ---- */
 
@@ -47,8 +53,8 @@ void     *TAB_pop  (TAB_table t);                        /* pop most recent key
 typedef TAB_table S_table;  /* S_table is just a TAB_table */
 
 S_table  S_empty(void);                         /* create empty table       */
-void     S_enter(S_table t, S_Symbol sym, void *value);  /* bind sym→value */
-void    *S_look(S_table t, S_Symbol sym);        /* lookup binding           */
+void     S_enter(S_table t, S_symbol sym, void *value);  /* bind sym→value */
+void    *S_look(S_table t, S_symbol sym);        /* lookup binding           */
 
 void     S_beginScope(S_table t);                /* push scope marker        */
 void     S_endScope(S_table t);                  /* pop all bindings in scope*/
@@ -56,7 +62,7 @@ void     S_endScope(S_table t);                  /* pop all bindings in scope*/
 /*
  * Internal representation:
  *
- *   struct S_symbol_ { string name; S_Symbol next; };
+ *   struct S_symbol_ { string name; S_symbol next; };
  *
  *   - Symbols are stored in a separate hash table (the "intern table")
  *     so that S_Symbol("foo") == S_Symbol("foo") (pointer equality).
@@ -67,4 +73,8 @@ void     S_endScope(S_table t);                  /* pop all bindings in scope*/
  *     we need to undo bindings in reverse order.
  */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -9,6 +9,8 @@
 // 구조:
 //   Part 1: Symbol         — 문자열 인터닝 (선언만, 구현은 symbol.cpp)
 //   Part 2: SymbolTable<V> — 스코프 심볼 테이블 (템플릿 → 헤더에 구현)
+//   Part 3: DenseSymbolTable<V> — id 배열로 찾는 스코프 심볼 테이블
+//   Part 4: PersistentSymbolTable<V> — 불변(persistent) HAMT, O(1) 스냅샷
 //
 // 왜 분리하는가?
 //   Symbol: 일반 클래스 → 선언(.hpp)과 구현(.cpp) 분리 가능.
@@ -16,10 +18,16 @@
 //     구현이 반드시 헤더에 있어야 함. .cpp에 넣으면 링크 에러 발생.
 // ============================================================================
 
+#include "util/util.hpp"    // 해시 정책 (util::WordHash 등)
+#include <algorithm>       // std::max
+#include <atomic>          // PersistentSymbolTable 노드 참조 카운트
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <unordered_set>   // Symbol 인터닝 풀
-#include <unordered_map>   // SymbolTable 바인딩 저장
-#include <vector>          // SymbolTable undo 스택 + 값 스택
+#include <string_view>
+#include <new>             // PersistentSymbolTable 노드 (가변 길이) 할당
+#include <utility>
+#include <vector>          // SymbolTable binder 스택, DenseSymbolTable 배열
 
 namespace tiger {
 
@@ -28,32 +36,132 @@ namespace tiger {
 // ============================================================================
 //
 // 핵심 아이디어:
-//   "foo"를 여러 번 intern하면, 항상 같은 const std::string* 포인터를 반환.
+//   "foo"를 여러 번 intern하면, 항상 같은 Sym(엔트리 포인터)을 반환.
 //   → 문자열 비교가 포인터 비교(O(1))로 바뀜.
 //
-// C 원본에서는 struct S_symbol_ + 수동 해시 체이닝이었지만,
-// std::unordered_set이 이 모든 걸 해줌:
-//   - 해시 계산, 충돌 처리, 동적 리사이징 전부 자동.
-//   - 중요: unordered_set은 원소의 포인터가 안정적(stable).
-//     즉, insert 후에도 기존 원소의 주소가 변하지 않음.
-//     → 인터닝에 딱 맞는 컨테이너.
+// C 원본에서는 struct S_symbol_ + 수동 해시 체이닝이었음.
+// 여기서는 해시로 나눈 샤드 16개 + 샤드별 open addressing 테이블 (symbol.cpp).
+//   - 스레드 안전: 여러 스레드가 동시에 lex/parse/check하며 intern해도 됨.
+//   - 이미 있는 이름 찾기는 락 없이(lock-free) 동작.
+//     처음 보는 이름만 해당 샤드의 mutex를 잡음.
+//   - 스레드마다 작은 캐시가 공유 풀 앞에 있음.
+//   - 이름 바이트는 청크 arena에 연속으로 저장 (이름마다 할당하지 않음).
+//   - 반환한 Sym은 프로그램이 끝날 때까지 안정적(stable).
 // ============================================================================
 
+// SymbolHash: 인터너가 이름을 해시할 때 쓰는 정책 (util.hpp의 해시 정책).
+//   해시는 인터닝할 때 한 번만 계산해서 SymbolEntry::hash에 저장해 둠.
+//   → Symbol::hash(sym)로 다시 계산 없이 꺼내 쓸 수 있음.
+//   정책을 바꾸면 풀 전체가 바뀌므로 컴파일 타임에 하나만 고름.
+using SymbolHash = util::DefaultHash;
+
+// SymbolEntry: arena에 놓이는 심볼 하나.
+//   C 원본: struct S_symbol_ { string name; S_symbol next; }
+//   헤더 바로 뒤에 이름 바이트와 '\0'이 붙어 있음 (가변 길이 구조체).
+//   id: 인터닝 순서대로 0, 1, 2, ... 로 매기는 조밀한(dense) 번호.
+//       → 심볼별 정보를 해시 없이 배열 인덱스로 찾을 수 있음 (DenseSymbolTable).
+struct SymbolEntry {
+  uint64_t hash;           // SymbolHash{}(이름)
+  uint32_t length;
+  uint32_t id;
+
+  const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+  std::string_view view() const { return {data(), length}; }
+};
+
+// Sym: 인터닝된 심볼의 핸들. 같은 이름 ⇔ 같은 포인터.
+using Sym = const SymbolEntry*;
+
+// StaticSymbol: 컴파일 타임에 만들어지는 심볼 (상수 데이터, .rodata).
+//   SymbolEntry와 같은 레이아웃: 헤더 바로 뒤에 이름 + '\0'.
+//   해시는 constexpr SymbolHash로 미리 계산됨.
+//   인터너는 시작할 때 이 엔트리들을 테이블에 끼워 넣기만 함 (할당 없음).
+template <size_t N>
+struct StaticSymbol {
+  SymbolEntry entry;
+  char bytes[N];   // 이름 + '\0'
+
+  constexpr StaticSymbol(const char (&name)[N], uint32_t id)
+      : entry{SymbolHash{}(std::string_view(name, N - 1)),
+              static_cast<uint32_t>(N - 1), id},
+        bytes{} {
+    for (size_t i = 0; i < N; i++) bytes[i] = name[i];
+  }
+
+  constexpr Sym sym() const { return &entry; }
+};
+
+// builtin: Tiger 기본 환경(base environment)의 이름들.
+//   id 0..COUNT-1이 예약되어 있고, 실행 중에 인터닝되는 심볼은 COUNT부터 번호를 받음.
+//   Symbol::intern("print") == builtin::PRINT.sym() (같은 포인터).
+//   → 타입 체커의 기본 환경을 상수 테이블로 만들 수 있음 (semantic/BaseEnv.hpp).
+namespace builtin {
+
+enum : uint32_t {
+  INT_ID, STRING_ID,
+  PRINT_ID, GETCHAR_ID, ORD_ID, CHR_ID, SIZE_ID,
+  SUBSTRING_ID, CONCAT_ID, NOT_ID, EXIT_ID,
+  COUNT
+};
+
+inline constexpr StaticSymbol INT{"int", INT_ID};
+inline constexpr StaticSymbol STRING{"string", STRING_ID};
+inline constexpr StaticSymbol PRINT{"print", PRINT_ID};
+inline constexpr StaticSymbol GETCHAR{"getchar", GETCHAR_ID};
+inline constexpr StaticSymbol ORD{"ord", ORD_ID};
+inline constexpr StaticSymbol CHR{"chr", CHR_ID};
+inline constexpr StaticSymbol SIZE{"size", SIZE_ID};
+inline constexpr StaticSymbol SUBSTRING{"substring", SUBSTRING_ID};
+inline constexpr StaticSymbol CONCAT{"concat", CONCAT_ID};
+inline constexpr StaticSymbol NOT{"not", NOT_ID};
+inline constexpr StaticSymbol EXIT{"exit", EXIT_ID};
+
+// id 순서.
+inline constexpr Sym ALL[COUNT] = {
+  INT.sym(), STRING.sym(),
+  PRINT.sym(), GETCHAR.sym(), ORD.sym(), CHR.sym(), SIZE.sym(),
+  SUBSTRING.sym(), CONCAT.sym(), NOT.sym(), EXIT.sym(),
+};
+
+constexpr bool ids_match() {
+  for (uint32_t i = 0; i < COUNT; i++)
+    if (ALL[i]->id != i) return false;
+  return true;
+}
+static_assert(ids_match(), "builtin::ALL must be in id order");
+
+} // namespace builtin
+
+// 풀 전체의 메모리 사용량 (벤치마크용).
+struct SymbolPoolStats {
+  size_t symbols = 0;
+  size_t name_bytes = 0;   // arena에서 실제로 쓴 바이트 (헤더 + 이름 + '\0')
+  size_t arena_bytes = 0;  // arena가 잡아 둔 청크 전체
+  size_t table_bytes = 0;  // 현재 해시 테이블의 슬롯 배열
+};
+
 class Symbol {
 public:
-  // intern: 문자열을 인터닝하여 고유한 const string*를 반환.
+  // intern: 이름을 인터닝하여 고유한 Sym을 반환.
   //   C 원본: S_Symbol S_Symbol(string name)
-  static const std::string* intern(const std::string& name);
+  //   어느 스레드에서 호출해도 같은 이름이면 같은 Sym.
+  //   string_view를 받으므로 소스 버퍼 조각을 그대로 넘겨도 됨.
+  static Sym intern(std::string_view name);
 
-  // name: 심볼에서 원래 문자열을 꺼냄.
+  // name: 심볼에서 원래 문자열을 꺼냄 (arena를 가리키는 view, 복사 없음).
   //   C 원본: string S_name(S_Symbol s) { return s->name; }
-  static const std::string& name(const std::string* sym);
+  static std::string_view name(Sym sym);
 
-private:
-  // 인터닝 풀: 프로그램 전체에서 하나만 존재 (static).
-  //   C 원본: static S_Symbol hashtable[SIZE]; + 수동 체이닝
-  //   C++:    unordered_set이 해시/충돌/리사이징 전부 처리.
-  static std::unordered_set<std::string> pool_;
+  // id: 심볼의 dense 번호. 항상 count()보다 작음.
+  static uint32_t id(Sym sym) { return sym->id; }
+
+  // hash: 인터닝할 때 계산해 둔 SymbolHash 값 (다시 계산하지 않음).
+  static uint64_t hash(Sym sym) { return sym->hash; }
+
+  // count: 지금까지 인터닝된 심볼 수 (= 다음에 매길 id). builtin 포함.
+  static uint32_t count();
+
+  static SymbolPoolStats stats();
 };
 
 // ============================================================================
@@ -61,77 +169,520 @@ private:
 // ============================================================================
 //
 // C 원본에서 TAB_table + S_table이 하던 역할을 하나의 클래스 템플릿으로 통합.
+// 레이아웃도 책(symbol.c / table.c)과 같은 binder 방식:
 //
-// C → C++ 주요 변환:
-//   C:   void* value                →  C++: Value* (템플릿 파라미터)
-//   C:   고정 해시 + binder 체인     →  C++: unordered_map + vector
-//   C:   TAB_pop (linked list)      →  C++: vector::pop_back
+//   1. binders_: enter 한 번마다 binder 하나를 연속된 vector에 push.
+//      binder는 "같은 심볼의 바로 이전 binder" 인덱스(prev)를 가짐.
+//      → 섀도잉 체인이 binder들 사이에 끼워져(intrusive) 있음.
+//      C 원본: struct binder_ { key; value; next; prevtop; }
+//              next = 같은 버킷 체인, prevtop = enter 순서
+//      여기서는 enter 순서 = vector 순서라서 prevtop이 필요 없음.
 //
-// 스코프 메커니즘:
-//   C에서는 linked-list의 LIFO 특성을 이용했지만,
-//   C++에서는 두 개의 vector로 더 명확하게 표현:
+//   2. heads_: 심볼 → 가장 최근 binder 인덱스 (open addressing).
+//      키 해시는 KeyHash 정책이 정함 (아래 SymAddressHash / SymCachedHash).
+//      binder는 자기 심볼의 head 슬롯 번호(slot)도 기억함.
 //
-//   1. bindings_: 심볼 → 값 스택 (vector<Value*>)
-//      같은 심볼에 여러 값을 바인딩 가능 (섀도잉).
-//      back()이 현재 스코프의 값, pop_back()으로 이전 스코프 복원.
+//   beginScope: 마커 binder (sym == nullptr) push.
+//   endScope:   마커까지 binder를 pop하며 heads_[b.slot].top = b.prev.
+//               → pop할 때 해시 탐색이 없음, 심볼별 vector도 없음.
 //
-//   2. undo_stack_: enter 순서를 기록.
-//      beginScope()는 nullptr 마커를 push.
-//      endScope()는 마커까지 pop하며 bindings_에서도 제거.
-//
-//   C의 "linked-list를 스택처럼 사용" = C++의 "vector 두 개".
+// 예전 구현(unordered_map<Sym, vector<Value*>>)과 비교:
+//   - 새로 바인딩되는 이름마다 map 노드 + vector 버퍼 할당 → 없음.
+//   - endScope가 bindings_[sym]으로 해시 탐색 → 인덱스 대입 한 번.
 // ============================================================================
 
-template <typename Value>
+// Sym 키용 해시 정책. Sym은 이름마다 유일한 포인터이므로 문자열을
+// 다시 해시할 필요가 없음. 둘 중 하나를 고르면 됨:
+//   SymAddressHash: 포인터 값을 곱셈으로 섞음 → 엔트리를 역참조하지 않음 (기본값).
+//   SymCachedHash:  인터너가 저장해 둔 SymbolHash 값 → 엔트리를 한 번 읽음.
+//                   실행마다 주소가 달라도 같은 이름이면 같은 슬롯 순서.
+struct SymAddressHash {
+  uint64_t operator()(Sym sym) const {
+    return (reinterpret_cast<uintptr_t>(sym) * 0x9e3779b97f4a7c15ULL) >> 32;
+  }
+};
+
+struct SymCachedHash {
+  uint64_t operator()(Sym sym) const { return sym->hash; }
+};
+
+template <typename Value, typename KeyHash = SymAddressHash>
 class SymbolTable {
 public:
+  SymbolTable() : heads_(INITIAL_HEADS) {}
+
   // enter: 심볼에 값을 바인딩.
   //   C 원본: void S_enter(S_table t, S_Symbol sym, void *value)
-  void enter(const std::string* sym, Value* value) {
-    bindings_[sym].push_back(value);
-    undo_stack_.push_back(sym);
+  void enter(Sym sym, Value* value) {
+    if ((used_ + 1) * 4 > heads_.size()) rehash();
+    uint32_t slot = find_slot(sym);
+    Head& head = heads_[slot];
+    if (!head.sym) {
+      head.sym = sym;
+      used_++;
+    }
+    binders_.push_back({sym, value, head.top, slot});
+    head.top = static_cast<uint32_t>(binders_.size() - 1);
   }
 
   // look: 심볼에 바인딩된 값을 검색. 없으면 nullptr.
   //   C 원본: void *S_look(S_table t, S_Symbol sym)
-  //
-  //   vector의 back()이 가장 최근 바인딩 (현재 스코프).
-  Value* look(const std::string* sym) const {
-    auto it = bindings_.find(sym);
-    if (it != bindings_.end() && !it->second.empty())
-      return it->second.back();
-    return nullptr;
+  Value* look(Sym sym) const {
+    const Head& head = heads_[find_slot(sym)];
+    return head.top == NONE ? nullptr : binders_[head.top].value;
   }
 
   // beginScope: 스코프 시작 마커를 삽입.
   //   C 원본: S_beginScope → &marksym를 key로 삽입
-  //   C++:    nullptr을 undo_stack에 push (별도 마커 심볼 불필요).
+  //   C++:    sym이 nullptr인 binder를 push (별도 마커 심볼 불필요).
   void beginScope() {
-    undo_stack_.push_back(nullptr);
+    binders_.push_back({nullptr, nullptr, NONE, NONE});
   }
 
   // endScope: 현재 스코프의 모든 바인딩을 제거.
   //   C 원본: do { s = TAB_pop(t); } while (s != &marksym);
-  //
-  //   undo_stack을 역순으로 pop하며 bindings_에서도 제거.
-  //   nullptr(마커)를 만나면 종료.
+  void endScope() {
+    while (!binders_.empty()) {
+      Binder b = binders_.back();
+      binders_.pop_back();
+      if (!b.sym) break;            // 마커 도달 → 스코프 끝
+      heads_[b.slot].top = b.prev;
+    }
+  }
+
+private:
+  static constexpr uint32_t NONE = UINT32_MAX;
+  static constexpr size_t INITIAL_HEADS = 64;
+
+  struct Binder {
+    Sym sym;          // nullptr이면 스코프 마커
+    Value* value;
+    uint32_t prev;    // 같은 심볼의 이전 binder (없으면 NONE)
+    uint32_t slot;    // 이 심볼의 heads_ 슬롯
+  };
+
+  // 한 번 자리를 잡은 심볼은 바인딩이 모두 사라져도(top == NONE)
+  // rehash 전까지 슬롯을 유지 → 삭제 표시(tombstone)가 필요 없음.
+  struct Head {
+    Sym sym = nullptr;
+    uint32_t top = NONE;
+  };
+
+  std::vector<Binder> binders_;
+  std::vector<Head> heads_;
+  size_t used_ = 0;   // sym이 채워진 슬롯 수
+
+  // sym의 슬롯, 없으면 sym이 들어갈 빈 슬롯.
+  uint32_t find_slot(Sym sym) const {
+    size_t mask = heads_.size() - 1;
+    size_t i = static_cast<size_t>(KeyHash{}(sym)) & mask;
+    while (heads_[i].sym && heads_[i].sym != sym) i = (i + 1) & mask;
+    return static_cast<uint32_t>(i);
+  }
+
+  // 살아 있는 binder가 있는 심볼만 새 테이블로 옮기고,
+  // binder들의 slot 번호를 새 위치로 고침.
+  void rehash() {
+    size_t live = 0;
+    for (const Head& h : heads_) live += h.top != NONE;
+    size_t size = heads_.size();
+    while ((live + 1) * 8 > size) size *= 2;
+
+    std::vector<Head> old(size);
+    old.swap(heads_);
+    used_ = 0;
+    for (const Head& h : old) {
+      if (h.top == NONE) continue;
+      uint32_t slot = find_slot(h.sym);
+      heads_[slot] = h;
+      used_++;
+    }
+    for (Binder& b : binders_) {
+      if (b.sym) b.slot = find_slot(b.sym);
+    }
+  }
+};
+
+// ============================================================================
+// Part 3: DenseSymbolTable<Value> — id로 인덱싱하는 스코프 심볼 테이블
+// ============================================================================
+//
+// SymbolTable과 인터페이스/의미는 같고 저장 방식만 다름.
+//
+//   SymbolTable:      look = heads_ 오픈 어드레싱 탐색(포인터 해시 + 선형
+//                     탐사, 부하율 1/4 이하라 보통 1~2칸) 후
+//                     binders_[head.top] 로드 한 번
+//   DenseSymbolTable: look = current_[id] 배열 로드 한 번 (해시·탐사 없음)
+//
+// 섀도잉 처리:
+//   current_[id]에는 "지금 보이는" 값 하나만 둠.
+//   enter할 때 덮어쓰기 전의 값을 undo_stack_에 같이 저장해 두고,
+//   endScope에서 그 값을 되돌려 놓음 → 심볼별 vector가 필요 없음.
+//
+// 타입 체커처럼 lookup이 많고 스코프가 얕은 경우에 유리.
+// 메모리는 (지금까지 인터닝된 심볼 수) × 포인터 크기.
+// ============================================================================
+
+template <typename Value>
+class DenseSymbolTable {
+public:
+  DenseSymbolTable() : current_(Symbol::count(), nullptr) {}
+
+  void enter(Sym sym, Value* value) {
+    uint32_t id = sym->id;
+    if (id >= current_.size())
+      current_.resize(std::max<size_t>(Symbol::count(), id + 1), nullptr);
+    undo_stack_.push_back({sym, current_[id]});
+    current_[id] = value;
+  }
+
+  Value* look(Sym sym) const {
+    uint32_t id = sym->id;
+    return id < current_.size() ? current_[id] : nullptr;
+  }
+
+  // 마커: sym이 nullptr인 항목.
+  void beginScope() {
+    undo_stack_.push_back({nullptr, nullptr});
+  }
+
   void endScope() {
     while (!undo_stack_.empty()) {
-      auto sym = undo_stack_.back();
+      Undo u = undo_stack_.back();
       undo_stack_.pop_back();
-      if (!sym) break;              // 마커 도달 → 스코프 끝
-      bindings_[sym].pop_back();
+      if (!u.sym) break;            // 마커 도달 → 스코프 끝
+      current_[u.sym->id] = u.prev;
     }
   }
 
 private:
-  // bindings_: 심볼 → 값 스택.
-  //   vector로 섀도잉 처리: push_back(새 값), pop_back(스코프 해제).
-  std::unordered_map<const std::string*, std::vector<Value*>> bindings_;
+  struct Undo {
+    Sym sym;
+    Value* prev;   // enter 직전에 보이던 값 (없었으면 nullptr)
+  };
 
-  // undo_stack_: enter 순서 기록 + 스코프 마커(nullptr).
-  //   C의 "top + prevtop 체인"을 하나의 vector로 대체.
-  std::vector<const std::string*> undo_stack_;
+  // current_: id → 현재 값.
+  std::vector<Value*> current_;
+
+  // undo_stack_: enter 순서 기록 + 스코프 마커.
+  std::vector<Undo> undo_stack_;
+};
+
+// ============================================================================
+// Part 4: PersistentSymbolTable<Value> — 불변 HAMT (hash array mapped trie)
+// ============================================================================
+//
+// SymbolTable / DenseSymbolTable은 제자리에서 바뀌는(destructive) 구조라서
+// "지금 환경"을 따로 들고 있으려면 테이블 전체를 복사해야 함.
+// PersistentSymbolTable은 한 번 만든 버전이 절대 바뀌지 않음:
+//
+//   auto outer = PersistentSymbolTable<V>().enter(x, &vx);
+//   auto inner = outer.enter(y, &vy);    // outer는 그대로, inner만 y를 봄
+//   auto snap  = inner;                   // 스냅샷 = 루트 포인터 복사, O(1)
+//
+//   beginScope/endScope가 필요 없음: 바깥 버전을 들고 있다가 돌아가면 끝.
+//   같은 심볼을 다시 enter하면 새 버전에서만 값이 바뀜 (= 섀도잉).
+//
+// 구조 (Bagwell의 HAMT):
+//   키 해시(KeyHash, 기본은 인터너가 저장해 둔 SymbolHash)를 5비트씩 잘라
+//   32갈래 트라이를 내려감. 노드는 32칸 중 채워진 칸만 bitmap + 빽빽한
+//   배열로 저장 → 칸 위치 = popcount(bitmap & (bit - 1)).
+//   한 칸에는 리프(sym, value) 또는 자식 노드가 들어감.
+//   64비트 해시를 다 써도 같은 심볼들은 collision 노드(선형 탐색)에 모음.
+//
+//   look:  O(log32 n) 노드 방문, 할당 없음.
+//   enter: 루트부터 바뀐 칸까지의 경로만 새로 만들고 (path copying),
+//          나머지 서브트리는 이전 버전과 공유 (structural sharing).
+//          O(log32 n)개 노드 할당.
+//
+// 메모리 관리:
+//   노드마다 원자적(atomic) 참조 카운트. 노드 헤더 바로 뒤에 칸 배열이
+//   붙은 가변 길이 할당 하나 (SymbolEntry의 이름 바이트와 같은 방식).
+//   만들어진 노드는 바뀌지 않으므로 여러 스레드가 같은 버전을 동시에 읽고
+//   복사해도 됨 (병렬 체커, 증분 재분석, IDE 질의가 스냅샷을 나눠 가짐).
+//   한 테이블 객체 자체를 여러 스레드가 동시에 대입하는 것은 안 됨.
+// ============================================================================
+
+namespace detail {
+
+// popcnt 명령이 없는 타깃에서는 __builtin_popcount가 라이브러리 호출이 되므로
+// 그때는 비트 연산 몇 개로 직접 셈.
+inline uint32_t popcount32(uint32_t x) {
+#if defined(__POPCNT__)
+  return static_cast<uint32_t>(__builtin_popcount(x));
+#else
+  x = x - ((x >> 1) & 0x55555555u);
+  x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+  return (((x + (x >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24;
+#endif
+}
+
+} // namespace detail
+
+template <typename Value, typename KeyHash = SymCachedHash>
+class PersistentSymbolTable {
+  struct Node;
+
+public:
+  PersistentSymbolTable() = default;
+
+  // 복사 = 스냅샷: 루트 참조 카운트만 올림.
+  PersistentSymbolTable(const PersistentSymbolTable& other)
+      : root_(other.root_), size_(other.size_) {
+    retain(root_);
+  }
+
+  PersistentSymbolTable(PersistentSymbolTable&& other) noexcept
+      : root_(other.root_), size_(other.size_) {
+    other.root_ = nullptr;
+    other.size_ = 0;
+  }
+
+  PersistentSymbolTable& operator=(PersistentSymbolTable other) noexcept {
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+
+  ~PersistentSymbolTable() { release(root_); }
+
+  // look: 심볼에 바인딩된 값. 없으면 nullptr.
+  Value* look(Sym sym) const {
+    const Node* node = root_;
+    uint64_t h = KeyHash{}(sym);
+    for (unsigned shift = 0; node; shift += BITS) {
+      if (shift >= HASH_BITS) {                 // collision 노드
+        for (uint32_t i = 0; i < node->count; i++)
+          if (node->slots()[i].sym == sym) return node->slots()[i].value;
+        return nullptr;
+      }
+      uint32_t bit = 1u << ((h >> shift) & MASK);
+      if (!(node->bitmap & bit)) return nullptr;
+      const Slot& slot = node->slots()[detail::popcount32(node->bitmap & (bit - 1))];
+      if (!slot.sym) {
+        node = slot.child;
+      } else {
+        return slot.sym == sym ? slot.value : nullptr;
+      }
+    }
+    return nullptr;
+  }
+
+  // enter: sym을 value에 바인딩한 새 버전. *this는 바뀌지 않음.
+  PersistentSymbolTable enter(Sym sym, Value* value) const& {
+    bool added = false;
+    Node* root = root_ ? insert(root_, sym, value, KeyHash{}(sym), 0, added)
+                       : leaf_node(sym, value, KeyHash{}(sym), 0);
+    return PersistentSymbolTable(root, size_ + (root_ ? added : 1));
+  }
+
+  // 이 버전을 더 쓰지 않을 때: table = std::move(table).enter(sym, value);
+  //   다른 버전과 공유하지 않는 노드(참조 카운트 1)는 복사하지 않고 제자리에서
+  //   고침 → 같은 스코프에서 연달아 enter할 때 루트를 매번 복사하지 않음.
+  //   공유된 노드를 만나면 그 아래부터는 위의 enter처럼 경로를 복사함.
+  PersistentSymbolTable enter(Sym sym, Value* value) && {
+    if (!root_ || root_->refs.load(std::memory_order_acquire) != 1)
+      return static_cast<const PersistentSymbolTable&>(*this).enter(sym, value);
+    bool added = false;
+    root_ = update(root_, sym, value, KeyHash{}(sym), 0, added);
+    size_ += added;
+    return std::move(*this);
+  }
+
+  // 바인딩된 서로 다른 심볼 수.
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // 두 버전이 같은 트리인지 (스냅샷 이후 아무것도 enter하지 않았는지).
+  bool same(const PersistentSymbolTable& other) const { return root_ == other.root_; }
+
+private:
+  static constexpr unsigned BITS = 5;           // 레벨당 32갈래
+  static constexpr uint64_t MASK = 31;
+  static constexpr unsigned HASH_BITS = 64;     // 이 깊이부터는 collision 노드
+
+  // 칸 하나: sym != nullptr이면 리프, nullptr이면 child가 자식 노드.
+  struct Slot {
+    Sym sym;
+    union {
+      Value* value;
+      Node* child;
+    };
+  };
+
+  struct Node {
+    std::atomic<uint32_t> refs{1};
+    uint32_t bitmap;   // 채워진 칸 (collision 노드는 0)
+    uint32_t count;    // slots() 길이
+    uint32_t unused = 0;
+
+    Node(uint32_t b, uint32_t c) : bitmap(b), count(c) {}
+
+    // 헤더 바로 뒤의 칸 배열.
+    Slot* slots() { return reinterpret_cast<Slot*>(this + 1); }
+    const Slot* slots() const { return reinterpret_cast<const Slot*>(this + 1); }
+  };
+  static_assert(sizeof(Node) % alignof(Slot) == 0, "slots must follow the header");
+
+  Node* root_ = nullptr;
+  size_t size_ = 0;
+
+  PersistentSymbolTable(Node* root, size_t size) : root_(root), size_(size) {}
+
+  static Node* make_node(uint32_t bitmap, uint32_t count) {
+    void* mem = ::operator new(sizeof(Node) + count * sizeof(Slot));
+    return new (mem) Node(bitmap, count);
+  }
+
+  static void retain(const Node* node) {
+    if (node) const_cast<Node*>(node)->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // 마지막 참조였으면 자식들을 놓고 해제. 깊이는 최대 14레벨.
+  static void release(Node* node) {
+    if (!node || node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    for (uint32_t i = 0; i < node->count; i++)
+      if (!node->slots()[i].sym) release(node->slots()[i].child);
+    node->~Node();
+    ::operator delete(node);
+  }
+
+  static Slot leaf(Sym sym, Value* value) {
+    Slot slot;
+    slot.sym = sym;
+    slot.value = value;
+    return slot;
+  }
+
+  static Slot branch(Node* child) {
+    Slot slot;
+    slot.sym = nullptr;
+    slot.child = child;
+    return slot;
+  }
+
+  // 리프 하나만 있는 노드.
+  static Node* leaf_node(Sym sym, Value* value, uint64_t h, unsigned shift) {
+    Node* node = make_node(shift >= HASH_BITS ? 0 : 1u << ((h >> shift) & MASK), 1);
+    node->slots()[0] = leaf(sym, value);
+    return node;
+  }
+
+  // node를 복사하면서 칸 pos에 slot을 끼우거나(insert) 바꾼 새 노드.
+  // 그대로 옮긴 자식들은 새 노드도 참조하므로 카운트를 올림.
+  static Node* copy_with(const Node* node, uint32_t bitmap, uint32_t pos, Slot slot,
+                         bool insert) {
+    uint32_t count = node->count + (insert ? 1 : 0);
+    Node* copy = make_node(bitmap, count);
+    const Slot* src = node->slots();
+    Slot* dst = copy->slots();
+    uint32_t skip = insert ? 0 : 1;
+    for (uint32_t i = 0; i < node->count; i++) {
+      if (i == pos && skip) continue;
+      if (!src[i].sym) retain(src[i].child);
+      dst[i < pos ? i : i + (insert ? 1 : 0)] = src[i];
+    }
+    dst[pos] = slot;
+    return copy;
+  }
+
+  // 해시가 shift 비트까지 같은 두 리프를 담는 서브트리.
+  static Node* pair(Sym a, Value* va, uint64_t ha, Sym b, Value* vb, uint64_t hb,
+                    unsigned shift) {
+    if (shift >= HASH_BITS) {
+      Node* node = make_node(0, 2);
+      node->slots()[0] = leaf(a, va);
+      node->slots()[1] = leaf(b, vb);
+      return node;
+    }
+    uint32_t ia = static_cast<uint32_t>((ha >> shift) & MASK);
+    uint32_t ib = static_cast<uint32_t>((hb >> shift) & MASK);
+    if (ia == ib) {
+      Node* node = make_node(1u << ia, 1);
+      node->slots()[0] = branch(pair(a, va, ha, b, vb, hb, shift + BITS));
+      return node;
+    }
+    Node* node = make_node((1u << ia) | (1u << ib), 2);
+    node->slots()[ia < ib ? 0 : 1] = leaf(a, va);
+    node->slots()[ia < ib ? 1 : 0] = leaf(b, vb);
+    return node;
+  }
+
+  // node 아래에 (sym, value)를 넣은 새 서브트리. 새 심볼이면 added = true.
+  static Node* insert(const Node* node, Sym sym, Value* value, uint64_t h,
+                      unsigned shift, bool& added) {
+    if (shift >= HASH_BITS) {
+      for (uint32_t i = 0; i < node->count; i++)
+        if (node->slots()[i].sym == sym) return copy_with(node, 0, i, leaf(sym, value), false);
+      added = true;
+      return copy_with(node, 0, node->count, leaf(sym, value), true);
+    }
+
+    uint32_t bit = 1u << ((h >> shift) & MASK);
+    uint32_t pos = detail::popcount32(node->bitmap & (bit - 1));
+    if (!(node->bitmap & bit)) {
+      added = true;
+      return copy_with(node, node->bitmap | bit, pos, leaf(sym, value), true);
+    }
+
+    const Slot& slot = node->slots()[pos];
+    Slot replacement;
+    if (!slot.sym) {
+      replacement = branch(insert(slot.child, sym, value, h, shift + BITS, added));
+    } else if (slot.sym == sym) {
+      replacement = leaf(sym, value);
+    } else {
+      added = true;
+      replacement = branch(pair(slot.sym, slot.value, KeyHash{}(slot.sym),
+                                sym, value, h, shift + BITS));
+    }
+    return copy_with(node, node->bitmap, pos, replacement, false);
+  }
+
+  // insert와 같지만 node를 이 테이블만 참조하고 있음 (refs == 1):
+  // 칸 수가 그대로면 제자리에서 고치고, 늘어나면 새 노드로 옮긴 뒤 놓음.
+  static Node* update(Node* node, Sym sym, Value* value, uint64_t h, unsigned shift,
+                      bool& added) {
+    if (shift >= HASH_BITS) {
+      for (uint32_t i = 0; i < node->count; i++) {
+        if (node->slots()[i].sym == sym) {
+          node->slots()[i].value = value;
+          return node;
+        }
+      }
+      added = true;
+      Node* grown = copy_with(node, 0, node->count, leaf(sym, value), true);
+      release(node);
+      return grown;
+    }
+
+    uint32_t bit = 1u << ((h >> shift) & MASK);
+    uint32_t pos = detail::popcount32(node->bitmap & (bit - 1));
+    if (!(node->bitmap & bit)) {
+      added = true;
+      Node* grown = copy_with(node, node->bitmap | bit, pos, leaf(sym, value), true);
+      release(node);
+      return grown;
+    }
+
+    Slot& slot = node->slots()[pos];
+    if (!slot.sym) {
+      Node* child = slot.child;
+      if (child->refs.load(std::memory_order_acquire) == 1) {
+        slot.child = update(child, sym, value, h, shift + BITS, added);
+      } else {
+        slot.child = insert(child, sym, value, h, shift + BITS, added);
+        release(child);
+      }
+    } else if (slot.sym == sym) {
+      slot.value = value;
+    } else {
+      added = true;
+      slot = branch(pair(slot.sym, slot.value, KeyHash{}(slot.sym), sym, value, h,
+                         shift + BITS));
+    }
+    return node;
+  }
 };
 
 } // namespace tiger
@@ -0,0 +1,51 @@
+#ifndef TIGER_ARITH_HPP
+#define TIGER_ARITH_HPP
+
+// ============================================================================
+// Tiger integer semantics, shared by the Interpreter and ConstantFolder so
+// that folding a constant at compile time gives what running it would.
+//
+// Ints are 32-bit and wrap on overflow (INT_MIN / -1 included); division
+// truncates toward zero, and division by zero is a runtime error, which
+// apply() reports by returning false. Comparisons yield 1 or 0.
+// ============================================================================
+
+#include "parser/AST.hpp"
+#include <cstdint>
+
+namespace tiger::arith {
+
+inline int32_t wrap(int64_t v) { return static_cast<int32_t>(static_cast<uint32_t>(v)); }
+
+// `order` is the sign of a three-way comparison of the operands (ints, or
+// strings by content); `op` is one of EQ..GE.
+inline int32_t compare(Op op, int order) {
+    switch (op) {
+        case Op::EQ: return order == 0;
+        case Op::NEQ: return order != 0;
+        case Op::LT: return order < 0;
+        case Op::LE: return order <= 0;
+        case Op::GT: return order > 0;
+        default: return order >= 0;
+    }
+}
+
+// `a op b` on ints; false on division by zero.
+inline bool apply(Op op, int32_t a, int32_t b, int32_t& result) {
+    switch (op) {
+        case Op::PLUS: result = wrap(int64_t{a} + b); return true;
+        case Op::MINUS: result = wrap(int64_t{a} - b); return true;
+        case Op::TIMES: result = wrap(int64_t{a} * b); return true;
+        case Op::DIVIDE:
+            if (b == 0) return false;
+            result = wrap(int64_t{a} / b);
+            return true;
+        default:
+            result = compare(op, (a > b) - (a < b));
+            return true;
+    }
+}
+
+} // namespace tiger::arith
+
+#endif // TIGER_ARITH_HPP
@@ -0,0 +1,479 @@
+#include "interp/Interpreter.hpp"
+#include "interp/Arith.hpp"
+#include "semantic/BaseEnv.hpp"
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+namespace tiger {
+
+namespace {
+
+// chr(i) points into this table, so it never allocates.
+struct CharTable {
+    char chars[256];
+    constexpr CharTable() : chars() {
+        for (int i = 0; i < 256; i++) chars[i] = static_cast<char>(i);
+    }
+};
+constexpr CharTable CHARS;
+
+} // namespace
+
+Interpreter::Interpreter(std::ostream& out, std::istream& in, Options options)
+    : out_(out), in_(in), options_(options) {}
+
+bool Interpreter::run(const Program& prog, const semantic::Resolver& resolver) {
+    stack_base_ = static_cast<const char*>(__builtin_frame_address(0));
+    reset(resolver, prog.frame_size);
+    Value result = prog.exp ? eval(*prog.exp) : Value{};
+    if (unwind_ == Unwind::NONE) result_ = result;
+    out_.flush();
+    return unwind_ != Unwind::TRAP;
+}
+
+bool Interpreter::evaluate(const Exp& exp, const semantic::Resolver& resolver) {
+    // No variable is read, so one empty frame that links to itself stands
+    // in for every enclosing frame a call's static link could point to.
+    stack_base_ = static_cast<const char*>(__builtin_frame_address(0));
+    reset(resolver, 0);
+    Value result = eval(exp);
+    if (unwind_ == Unwind::NONE) result_ = result;
+    return unwind_ == Unwind::NONE;
+}
+
+void Interpreter::reset(const semantic::Resolver& resolver, uint32_t frame_size) {
+    functions_ = &resolver.functions();
+    stack_.assign(frame_size, Value{});
+    frames_.assign(1, Frame{0, 0});
+    unwind_ = Unwind::NONE;
+    heap_ = Arena();
+    memos_.assign(functions_->size(), Memo{});
+    memo_args_.clear();
+    result_ = Value{};
+    exit_code_ = 0;
+    errors_.clear();
+    calls_ = 0;
+    cache_hits_ = 0;
+    steps_ = 0;
+    step_limit_ = options_.max_steps ? options_.max_steps : UINT64_MAX;
+}
+
+Value Interpreter::trap(Position pos, const std::string& msg) {
+    std::ostringstream oss;
+    oss << pos.line << ":" << pos.column << ": error: " << msg;
+    errors_.push_back(oss.str());
+    unwind_ = Unwind::TRAP;
+    return Value{};
+}
+
+char* Interpreter::new_string(std::size_t length) {
+    return static_cast<char*>(heap_.allocate(length ? length : 1, 1));
+}
+
+Value* Interpreter::new_slots(std::size_t count) {
+    return static_cast<Value*>(heap_.allocate((count ? count : 1) * sizeof(Value),
+                                              alignof(Value)));
+}
+
+Value& Interpreter::slot(uint32_t depth, uint32_t slot) {
+    uint32_t frame = static_cast<uint32_t>(frames_.size() - 1);
+    for (uint32_t d = 0; d < depth; d++) frame = frames_[frame].link;
+    return stack_[frames_[frame].base + slot];
+}
+
+// Bytes of C stack below stack_base_ (the stack grows down). The frame
+// address, unlike that of a local, is on the real stack even when a
+// sanitizer moves locals elsewhere.
+std::size_t Interpreter::stack_used() const {
+    const char* here = static_cast<const char*>(__builtin_frame_address(0));
+    return here < stack_base_ ? static_cast<std::size_t>(stack_base_ - here) : 0;
+}
+
+bool Interpreter::same(const Value& a, const Value& b) {
+    switch (a.kind) {
+        case ValueKind::UNIT: return b.kind == ValueKind::UNIT;
+        case ValueKind::INT: return a.i == b.i;
+        case ValueKind::STRING: return a.str() == b.str();
+        default: return a.p == b.p;   // records, arrays and nil by identity
+    }
+}
+
+// ============================================================================
+// Expressions
+// ============================================================================
+//
+// After any subexpression, unwind_ != NONE means stop and return at once;
+// the value returned then is never used.
+
+Value Interpreter::eval(const Exp& exp) {
+    if (++steps_ > step_limit_)
+        return trap(exp.pos, "step budget (" + std::to_string(options_.max_steps) + ") exceeded");
+    switch (exp.kind) {
+        case ExpKind::VAR: {
+            Value* v = lvalue(*static_cast<const VarExp&>(exp).var);
+            return v ? *v : Value{};
+        }
+
+        case ExpKind::NIL:
+            return {ValueKind::NIL, 0, nullptr};
+
+        case ExpKind::INT:
+            return Value::integer(static_cast<const IntExp&>(exp).value);
+
+        case ExpKind::STRING:
+            return Value::string(static_cast<const StringExp&>(exp).value);
+
+        case ExpKind::CALL:
+            return eval_call(static_cast<const CallExp&>(exp));
+
+        case ExpKind::OP:
+            return eval_op(static_cast<const OpExp&>(exp));
+
+        case ExpKind::RECORD: {
+            auto& rec = static_cast<const RecordExp&>(exp);
+            Value* slots = new_slots(rec.fields.size());
+            for (const Field& field : rec.fields) {
+                Value v = eval(*field.exp);
+                if (unwind_ != Unwind::NONE) return {};
+                slots[field.slot] = v;
+            }
+            return {ValueKind::RECORD, 0, slots};
+        }
+
+        case ExpKind::SEQ: {
+            Value v;
+            for (const auto& e : static_cast<const SeqExp&>(exp).exps) {
+                v = eval(*e);
+                if (unwind_ != Unwind::NONE) return {};
+            }
+            return v;
+        }
+
+        case ExpKind::ASSIGN: {
+            auto& assign = static_cast<const AssignExp&>(exp);
+            if (assign.var->kind == VarKind::SIMPLE) {
+                // The right-hand side may grow the stack: find the slot after.
+                Value v = eval(*assign.exp);
+                if (unwind_ != Unwind::NONE) return {};
+                auto& simple = static_cast<const SimpleVar&>(*assign.var);
+                slot(simple.depth, simple.slot) = v;
+            } else {
+                Value* target = lvalue(*assign.var);   // a record or array slot
+                if (!target) return {};
+                Value v = eval(*assign.exp);
+                if (unwind_ != Unwind::NONE) return {};
+                *target = v;
+            }
+            return {};
+        }
+
+        case ExpKind::IF: {
+            auto& if_exp = static_cast<const IfExp&>(exp);
+            Value test = eval(*if_exp.test);
+            if (unwind_ != Unwind::NONE) return {};
+            if (test.i != 0) return eval(*if_exp.then_exp);
+            return if_exp.else_exp ? eval(*if_exp.else_exp) : Value{};
+        }
+
+        case ExpKind::WHILE: {
+            auto& loop = static_cast<const WhileExp&>(exp);
+            while (true) {
+                Value test = eval(*loop.test);
+                if (unwind_ != Unwind::NONE || test.i == 0) break;
+                eval(*loop.body);
+                if (unwind_ != Unwind::NONE) break;
+            }
+            if (unwind_ == Unwind::BREAK) unwind_ = Unwind::NONE;
+            return {};
+        }
+
+        case ExpKind::FOR: {
+            auto& loop = static_cast<const ForExp&>(exp);
+            Value lo = eval(*loop.lo);
+            if (unwind_ != Unwind::NONE) return {};
+            Value hi = eval(*loop.hi);
+            if (unwind_ != Unwind::NONE) return {};
+            for (int64_t i = lo.i; i <= hi.i; i++) {
+                slot(0, loop.slot) = Value::integer(static_cast<int32_t>(i));
+                eval(*loop.body);
+                if (unwind_ != Unwind::NONE) break;
+            }
+            if (unwind_ == Unwind::BREAK) unwind_ = Unwind::NONE;
+            return {};
+        }
+
+        case ExpKind::BREAK:
+            unwind_ = Unwind::BREAK;
+            return {};
+
+        case ExpKind::LET:
+            return eval_let(static_cast<const LetExp&>(exp));
+
+        case ExpKind::ARRAY: {
+            auto& array = static_cast<const ArrayExp&>(exp);
+            Value size = eval(*array.size);
+            if (unwind_ != Unwind::NONE) return {};
+            Value init = eval(*array.init);
+            if (unwind_ != Unwind::NONE) return {};
+            if (size.i < 0)
+                return trap(array.pos, "negative array size " + std::to_string(size.i));
+            Value* slots = new_slots(static_cast<std::size_t>(size.i));
+            for (int32_t i = 0; i < size.i; i++) slots[i] = init;
+            return {ValueKind::ARRAY, size.i, slots};
+        }
+    }
+    return {};
+}
+
+Value Interpreter::eval_op(const OpExp& op) {
+    Value left = eval(*op.left);
+    if (unwind_ != Unwind::NONE) return {};
+    Value right = eval(*op.right);
+    if (unwind_ != Unwind::NONE) return {};
+
+    switch (op.op) {
+        case Op::EQ: return Value::integer(same(left, right));
+        case Op::NEQ: return Value::integer(!same(left, right));
+        default: break;
+    }
+    if (left.kind == ValueKind::STRING)
+        return Value::integer(arith::compare(op.op, left.str().compare(right.str())));
+
+    int32_t result;
+    if (!arith::apply(op.op, left.i, right.i, result)) return trap(op.pos, "division by zero");
+    return Value::integer(result);
+}
+
+Value Interpreter::eval_let(const LetExp& let) {
+    for (const auto& dec : let.decs) {
+        if (dec->kind != DecKind::VAR) continue;   // functions and types are static
+        auto& var = static_cast<const VarDec&>(*dec);
+        Value v = eval(*var.init);
+        if (unwind_ != Unwind::NONE) return {};
+        slot(0, var.slot) = v;
+    }
+    Value v;
+    for (const auto& e : let.body) {
+        v = eval(*e);
+        if (unwind_ != Unwind::NONE) return {};
+    }
+    return v;
+}
+
+// ============================================================================
+// Variables
+// ============================================================================
+
+Value* Interpreter::lvalue(const Var& var) {
+    switch (var.kind) {
+        case VarKind::SIMPLE: {
+            auto& simple = static_cast<const SimpleVar&>(var);
+            return &slot(simple.depth, simple.slot);
+        }
+
+        case VarKind::FIELD: {
+            auto& field = static_cast<const FieldVar&>(var);
+            Value* base = lvalue(*field.var);
+            if (!base) return nullptr;
+            if (!base->p) {
+                trap(field.pos, "field " + field.field + " of nil record");
+                return nullptr;
+            }
+            return &base->slots()[field.slot];
+        }
+
+        case VarKind::SUBSCRIPT: {
+            auto& sub = static_cast<const SubscriptVar&>(var);
+            Value* base = lvalue(*sub.var);
+            if (!base) return nullptr;
+            Value array = *base;   // the index may grow the stack
+            Value index = eval(*sub.index);
+            if (unwind_ != Unwind::NONE) return nullptr;
+            if (index.i < 0 || index.i >= array.i) {
+                trap(sub.pos, "index " + std::to_string(index.i) + " out of range for array of size " +
+                              std::to_string(array.i));
+                return nullptr;
+            }
+            return &array.slots()[index.i];
+        }
+    }
+    return nullptr;
+}
+
+// ============================================================================
+// Calls
+// ============================================================================
+
+Value Interpreter::eval_call(const CallExp& call) {
+    uint32_t base = static_cast<uint32_t>(stack_.size());
+    for (const auto& arg : call.args) {
+        Value v = eval(*arg);
+        if (unwind_ != Unwind::NONE) {
+            stack_.resize(base);
+            return {};
+        }
+        stack_.push_back(v);
+    }
+
+    if (call.func_id < semantic::base_env::FUNCTION_COUNT) {
+        Value result = call_builtin(call, call.func_id, base);
+        stack_.resize(base);
+        return result;
+    }
+
+    uint32_t index = call.func_id - static_cast<uint32_t>(semantic::base_env::FUNCTION_COUNT);
+    const FunctionDec& function = *(*functions_)[index];
+    uint32_t arity = static_cast<uint32_t>(call.args.size());
+    calls_++;
+
+    Memo* memo = options_.memoize ? memo_for(index, arity) : nullptr;
+    std::size_t entry = 0;
+    if (memo && cacheable(stack_.data() + base, arity)) {
+        entry = hash(stack_.data() + base, arity) & (memo->used.size() - 1);
+        if (memo->used[entry]) {
+            const Value* key = memo->keys.data() + entry * arity;
+            bool hit = true;
+            for (uint32_t i = 0; i < arity && hit; i++) hit = same(key[i], stack_[base + i]);
+            if (hit) {
+                cache_hits_++;
+                stack_.resize(base);
+                return memo->results[entry];
+            }
+        }
+    } else {
+        memo = nullptr;
+    }
+
+    if (frames_.size() >= options_.max_call_depth)
+        return trap(call.pos, "call depth limit (" + std::to_string(options_.max_call_depth) +
+                              ") exceeded in " + call.func);
+    if (stack_used() > options_.max_stack_bytes)
+        return trap(call.pos, "stack limit (" + std::to_string(options_.max_stack_bytes) +
+                              " bytes) exceeded in " + call.func);
+
+    std::size_t saved = memo_args_.size();
+    if (memo) {
+        auto args = stack_.begin() + base;
+        memo_args_.insert(memo_args_.end(), args, args + arity);
+    }
+
+    uint32_t link = static_cast<uint32_t>(frames_.size() - 1);
+    for (uint32_t d = 0; d < call.depth; d++) link = frames_[link].link;
+    stack_.resize(base + function.frame_size);
+    frames_.push_back({base, link});
+    Value result = eval(*function.body);
+    frames_.pop_back();
+
+    if (memo && unwind_ == Unwind::NONE && result.kind != ValueKind::RECORD &&
+        result.kind != ValueKind::ARRAY) {
+        std::copy(memo_args_.begin() + saved, memo_args_.end(), memo->keys.data() + entry * arity);
+        memo->results[entry] = result;
+        memo->used[entry] = 1;
+    }
+    memo_args_.resize(saved);
+    stack_.resize(base);
+    return result;
+}
+
+Value Interpreter::call_builtin(const CallExp& call, uint32_t id, uint32_t base) {
+    const Value* args = &stack_[base];
+    switch (builtin::PRINT_ID + id) {
+        case builtin::PRINT_ID:
+            out_ << args[0].str();
+            return {};
+
+        case builtin::GETCHAR_ID: {
+            int c = in_.get();
+            if (c == std::char_traits<char>::eof()) return Value::string("");
+            return Value::string({&CHARS.chars[static_cast<unsigned char>(c)], 1});
+        }
+
+        case builtin::ORD_ID:
+            return Value::integer(args[0].i == 0 ? -1 : static_cast<unsigned char>(args[0].str()[0]));
+
+        case builtin::CHR_ID:
+            if (args[0].i < 0 || args[0].i > 255)
+                return trap(call.pos, "chr(" + std::to_string(args[0].i) + ") out of range");
+            return Value::string({&CHARS.chars[args[0].i], 1});
+
+        case builtin::SIZE_ID:
+            return Value::integer(args[0].i);
+
+        case builtin::SUBSTRING_ID: {
+            int64_t first = args[1].i, n = args[2].i;
+            if (first < 0 || n < 0 || first + n > args[0].i)
+                return trap(call.pos, "substring(" + std::to_string(first) + ", " +
+                                      std::to_string(n) + ") out of range for string of size " +
+                                      std::to_string(args[0].i));
+            return Value::string(args[0].str().substr(static_cast<std::size_t>(first),
+                                                      static_cast<std::size_t>(n)));
+        }
+
+        case builtin::CONCAT_ID: {
+            std::string_view a = args[0].str(), b = args[1].str();
+            if (a.empty()) return args[1];
+            if (b.empty()) return args[0];
+            char* s = new_string(a.size() + b.size());
+            std::memcpy(s, a.data(), a.size());
+            std::memcpy(s + a.size(), b.data(), b.size());
+            return Value::string({s, a.size() + b.size()});
+        }
+
+        case builtin::NOT_ID:
+            return Value::integer(args[0].i == 0);
+
+        case builtin::EXIT_ID:
+            exit_code_ = args[0].i;
+            unwind_ = Unwind::EXIT;
+            return {};
+    }
+    return {};
+}
+
+// ============================================================================
+// Memoization
+// ============================================================================
+
+Interpreter::Memo* Interpreter::memo_for(uint32_t index, uint32_t arity) {
+    Memo& memo = memos_[index];
+    if (!memo.used.empty()) return &memo;
+    if (++memo.calls < options_.hot_calls) return nullptr;
+    if (!options_.memoize->pure(static_cast<uint32_t>(semantic::base_env::FUNCTION_COUNT) + index)) {
+        memo.calls = 0;   // checked again after another hot_calls calls
+        return nullptr;
+    }
+    uint32_t entries = 1;
+    while (entries < options_.cache_entries) entries *= 2;
+    memo.arity = arity;
+    memo.keys.assign(static_cast<std::size_t>(entries) * arity, Value{});
+    memo.results.assign(entries, Value{});
+    memo.used.assign(entries, 0);
+    return &memo;
+}
+
+bool Interpreter::cacheable(const Value* args, uint32_t arity) {
+    for (uint32_t i = 0; i < arity; i++)
+        if (args[i].kind != ValueKind::INT && args[i].kind != ValueKind::STRING) return false;
+    return true;
+}
+
+uint64_t Interpreter::hash(const Value* args, uint32_t arity) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL;
+    for (uint32_t i = 0; i < arity; i++) {
+        uint64_t x;
+        if (args[i].kind == ValueKind::STRING) {
+            x = 0xcbf29ce484222325ULL;   // FNV-1a
+            for (char c : args[i].str()) x = (x ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+        } else {
+            x = static_cast<uint32_t>(args[i].i);
+        }
+        h = (h ^ x) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+} // namespace tiger
@@ -0,0 +1,170 @@
+#ifndef TIGER_INTERPRETER_HPP
+#define TIGER_INTERPRETER_HPP
+
+// ============================================================================
+// Tree-walking interpreter.
+//
+// Runs a program that type-checked without errors (the checker annotates
+// record field slots) and that semantic::Resolver resolved (variables are
+// frame slots, calls are function ids), so no name is looked up at run
+// time.
+//
+// Frames live on one value stack: a frame is a base index into it plus
+// the index of the frame its static link points to. A call evaluates its
+// arguments onto the top of the stack, which makes them the callee's
+// parameter slots, and pops the frame on return.
+//
+// Values are 16 bytes: ints are 32-bit and wrap on overflow; strings are
+// a pointer and a length; records and arrays are pointers to their slots
+// (Field::slot gives a field's index). Strings made at run time, records
+// and arrays are bump-allocated in an Arena that lives as long as the run;
+// there is no collector.
+//
+// Runtime errors (nil record, index out of range, division by zero, bad
+// chr/substring argument, call depth or stack limit, step budget) stop the program
+// and are reported like other diagnostics, as "line:col: error: ...".
+//
+// With a Purity analysis in Options::memoize, a pure function that has
+// been called `hot_calls` times gets a result cache: a direct-mapped
+// table of `cache_entries` argument tuples, consulted before the body is
+// run. Only calls whose arguments are all ints or strings (compared by
+// content) are cached.
+// ============================================================================
+
+#include "parser/AST.hpp"
+#include "semantic/Purity.hpp"
+#include "semantic/Resolver.hpp"
+#include "util/Arena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tiger {
+
+enum class ValueKind : uint8_t { UNIT, INT, STRING, NIL, RECORD, ARRAY };
+
+struct Value {
+    ValueKind kind = ValueKind::UNIT;
+    int32_t i = 0;              // INT: value; STRING, ARRAY: length
+    const void* p = nullptr;    // STRING: chars; RECORD, ARRAY: Value slots
+
+    static Value unit() { return {}; }
+    static Value integer(int32_t v) { return {ValueKind::INT, v, nullptr}; }
+    static Value string(std::string_view s) {
+        return {ValueKind::STRING, static_cast<int32_t>(s.size()), s.data()};
+    }
+
+    std::string_view str() const {
+        return {static_cast<const char*>(p), static_cast<std::size_t>(i)};
+    }
+    Value* slots() const { return static_cast<Value*>(const_cast<void*>(p)); }
+};
+
+class Interpreter {
+public:
+    struct Options {
+        const semantic::Purity* memoize = nullptr;   // nullptr: no caching
+        uint32_t hot_calls = 8;
+        uint32_t cache_entries = 4096;                // per function (rounded up to 2^k)
+        uint32_t max_call_depth = 10000;
+        // C stack evaluation may use below run() / evaluate(): eval
+        // recurses, and a Tiger call takes several C++ frames (far more in
+        // a Debug or sanitizer build), so this bounds recursion where
+        // max_call_depth alone could overflow. Keep it under the stack of
+        // the calling thread (8 MiB for a main thread on Linux).
+        std::size_t max_stack_bytes = 4u << 20;
+        uint64_t max_steps = 0;                       // expressions evaluated; 0: no limit
+    };
+
+    Interpreter(std::ostream& out, std::istream& in, Options options);
+    Interpreter(std::ostream& out, std::istream& in) : Interpreter(out, in, Options{}) {}
+
+    // Runs `prog`; false on a runtime error. May be called again.
+    bool run(const Program& prog, const semantic::Resolver& resolver);
+
+    // Evaluates `exp`, which must read no variable (a closed expression
+    // such as a call with literal arguments); false if it traps, exits, or
+    // runs past Options::max_steps. The value is result(), valid until the
+    // next run or evaluate.
+    bool evaluate(const Exp& exp, const semantic::Resolver& resolver);
+
+    // Value of the program's expression (unit after exit or an error).
+    Value result() const { return result_; }
+
+    // The argument of exit(), or 0.
+    int exit_code() const { return exit_code_; }
+
+    const std::vector<std::string>& errors() const { return errors_; }
+
+    std::size_t calls() const { return calls_; }
+    std::size_t cache_hits() const { return cache_hits_; }
+    uint64_t steps() const { return steps_; }
+
+private:
+    // Why evaluation is unwinding: break leaves the innermost loop, the
+    // others the whole program.
+    enum class Unwind : uint8_t { NONE, BREAK, EXIT, TRAP };
+
+    struct Frame {
+        uint32_t base;   // first slot in stack_
+        uint32_t link;   // static link (index into frames_)
+    };
+
+    // Result cache of one function; `keys` holds `arity` values per entry.
+    struct Memo {
+        uint32_t calls = 0;
+        uint32_t arity = 0;
+        std::vector<Value> keys;
+        std::vector<Value> results;
+        std::vector<uint8_t> used;
+    };
+
+    std::ostream& out_;
+    std::istream& in_;
+    Options options_;
+
+    const std::vector<FunctionDec*>* functions_ = nullptr;
+    std::vector<Value> stack_;
+    std::vector<Frame> frames_;           // the last one is the current frame
+    Unwind unwind_ = Unwind::NONE;
+    Arena heap_;
+    std::vector<Memo> memos_;
+    std::vector<Value> memo_args_;        // arguments of the memoized calls
+                                          // running, as passed: the body may
+                                          // assign its parameters
+
+    Value result_;
+    int exit_code_ = 0;
+    std::vector<std::string> errors_;
+    std::size_t calls_ = 0;
+    std::size_t cache_hits_ = 0;
+    uint64_t steps_ = 0;
+    uint64_t step_limit_ = UINT64_MAX;
+    const char* stack_base_ = nullptr;    // frame of run() / evaluate()
+
+    void reset(const semantic::Resolver& resolver, uint32_t frame_size);
+    Value eval(const Exp& exp);
+    Value eval_op(const OpExp& op);
+    Value eval_call(const CallExp& call);
+    Value eval_let(const LetExp& let);
+    Value call_builtin(const CallExp& call, uint32_t id, uint32_t base);
+    Value* lvalue(const Var& var);
+    Value& slot(uint32_t depth, uint32_t slot);
+    std::size_t stack_used() const;
+
+    Memo* memo_for(uint32_t index, uint32_t arity);
+    static bool cacheable(const Value* args, uint32_t arity);
+    static uint64_t hash(const Value* args, uint32_t arity);
+    static bool same(const Value& a, const Value& b);
+
+    char* new_string(std::size_t length);
+    Value* new_slots(std::size_t count);
+    Value trap(Position pos, const std::string& msg);
+};
+
+} // namespace tiger
+
+#endif // TIGER_INTERPRETER_HPP
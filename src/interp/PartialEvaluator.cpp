@@ -0,0 +1,179 @@
+#include "interp/PartialEvaluator.hpp"
+#include <memory>
+#include <string>
+
+namespace tiger {
+
+namespace {
+
+Interpreter::Options interpreter_options(const PartialEvaluator::Options& options) {
+    Interpreter::Options o;
+    o.max_steps = options.step_budget;
+    o.max_call_depth = options.max_call_depth;
+    return o;
+}
+
+} // namespace
+
+PartialEvaluator::PartialEvaluator(Options options)
+    : interp_(out_, in_, interpreter_options(options)) {}
+
+void PartialEvaluator::evaluate(Program& prog, const semantic::Resolver& resolver,
+                                const semantic::Purity& purity) {
+    resolver_ = &resolver;
+    purity_ = &purity;
+    folded_calls_ = 0;
+    folded_ops_ = 0;
+    left_ = 0;
+    steps_ = 0;
+    if (prog.exp) visit(prog.exp);
+}
+
+// Replaces `exp` by the literal it evaluates to; false if it trapped, ran
+// out of steps, or has no literal form.
+bool PartialEvaluator::fold(ExpPtr& exp) {
+    bool ok = interp_.evaluate(*exp, *resolver_);
+    steps_ += interp_.steps();
+    if (!ok) {
+        left_++;
+        return false;
+    }
+
+    // Build the literal before dropping `exp`: a string result may point
+    // into one of its argument literals.
+    Value v = interp_.result();
+    ExpPtr folded;
+    if (v.kind == ValueKind::INT)
+        folded = std::make_unique<IntExp>(v.i, exp->pos);
+    else if (v.kind == ValueKind::STRING)
+        folded = std::make_unique<StringExp>(std::string(v.str()), exp->pos);
+    else
+        return false;
+
+    if (exp->kind == ExpKind::CALL) folded_calls_++;
+    else folded_ops_++;
+    exp = std::move(folded);
+    return true;
+}
+
+// ============================================================================
+// Walk
+// ============================================================================
+//
+// visit(ExpPtr&) returns true if the expression is (now) a literal.
+
+bool PartialEvaluator::visit(ExpPtr& exp) {
+    switch (exp->kind) {
+        case ExpKind::VAR:
+            visit(*static_cast<VarExp&>(*exp).var);
+            return false;
+
+        case ExpKind::INT:
+        case ExpKind::STRING:
+            return true;
+
+        case ExpKind::NIL:
+        case ExpKind::BREAK:
+            return false;
+
+        case ExpKind::CALL: {
+            auto& call = static_cast<CallExp&>(*exp);
+            bool constant = true;
+            for (auto& arg : call.args) constant = visit(arg) && constant;
+            if (!constant || call.func_id == UNRESOLVED || !purity_->closed(call.func_id))
+                return false;
+            return fold(exp);
+        }
+
+        case ExpKind::OP: {
+            auto& op = static_cast<OpExp&>(*exp);
+            bool left = visit(op.left);
+            bool right = visit(op.right);
+            return left && right && fold(exp);
+        }
+
+        case ExpKind::RECORD:
+            for (auto& field : static_cast<RecordExp&>(*exp).fields) visit(field.exp);
+            return false;
+
+        case ExpKind::SEQ: {
+            auto& seq = static_cast<SeqExp&>(*exp);
+            for (auto& e : seq.exps) visit(e);
+            return false;
+        }
+
+        case ExpKind::ASSIGN: {
+            auto& assign = static_cast<AssignExp&>(*exp);
+            visit(*assign.var);
+            visit(assign.exp);
+            return false;
+        }
+
+        case ExpKind::IF: {
+            auto& if_exp = static_cast<IfExp&>(*exp);
+            visit(if_exp.test);
+            visit(if_exp.then_exp);
+            if (if_exp.else_exp) visit(if_exp.else_exp);
+            return false;
+        }
+
+        case ExpKind::WHILE: {
+            auto& loop = static_cast<WhileExp&>(*exp);
+            visit(loop.test);
+            visit(loop.body);
+            return false;
+        }
+
+        case ExpKind::FOR: {
+            auto& loop = static_cast<ForExp&>(*exp);
+            visit(loop.lo);
+            visit(loop.hi);
+            visit(loop.body);
+            return false;
+        }
+
+        case ExpKind::LET: {
+            auto& let = static_cast<LetExp&>(*exp);
+            visit(let.decs);
+            for (auto& e : let.body) visit(e);
+            return false;
+        }
+
+        case ExpKind::ARRAY: {
+            auto& array = static_cast<ArrayExp&>(*exp);
+            visit(array.size);
+            visit(array.init);
+            return false;
+        }
+    }
+    return false;
+}
+
+void PartialEvaluator::visit(Var& var) {
+    switch (var.kind) {
+        case VarKind::SIMPLE:
+            break;
+        case VarKind::FIELD:
+            visit(*static_cast<FieldVar&>(var).var);
+            break;
+        case VarKind::SUBSCRIPT: {
+            auto& sub = static_cast<SubscriptVar&>(var);
+            visit(*sub.var);
+            visit(sub.index);
+            break;
+        }
+    }
+}
+
+void PartialEvaluator::visit(std::vector<DecPtr>& decs) {
+    for (auto& dec : decs) {
+        if (dec->kind == DecKind::VAR) {
+            visit(static_cast<VarDec&>(*dec).init);
+        } else if (dec->kind == DecKind::FUNCTION) {
+            auto& function = static_cast<FunctionDec&>(*dec);
+            if (function.body) visit(function.body);
+        }
+    }
+}
+
+} // namespace tiger
@@ -0,0 +1,73 @@
+#ifndef TIGER_PARTIAL_EVALUATOR_HPP
+#define TIGER_PARTIAL_EVALUATOR_HPP
+
+// ============================================================================
+// Compile-time evaluation of closed expressions.
+//
+// An expression is constant if it is an int or string literal, an OpExp
+// whose operands are constant, or a call to a function that
+// semantic::Purity reports closed (pure, and reading nothing outside its
+// own frame) with constant arguments. Bottom-up, each constant OpExp or
+// CallExp is run by the Interpreter and replaced by an IntExp or
+// StringExp carrying its value, so `var n := fact(10)` becomes
+// `var n := 3628800` and the program no longer computes it at startup.
+//
+// Each evaluation gets Options::step_budget interpreter steps. One that
+// runs past its budget, or traps (1 / 0, chr(300), a too deep recursion),
+// is left in the tree unchanged for run time, where it behaves as before.
+// Calls whose value is unit or nil are left too.
+//
+// Runs on a tree that type-checked and that semantic::Resolver resolved;
+// the replaced nodes keep their source position.
+// ============================================================================
+
+#include "interp/Interpreter.hpp"
+#include "parser/AST.hpp"
+#include "semantic/Purity.hpp"
+#include "semantic/Resolver.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+namespace tiger {
+
+class PartialEvaluator {
+public:
+    struct Options {
+        uint64_t step_budget = 1000000;   // interpreter steps per expression
+        uint32_t max_call_depth = 1000;
+    };
+
+    PartialEvaluator() : PartialEvaluator(Options{}) {}
+    explicit PartialEvaluator(Options options);
+
+    void evaluate(Program& prog, const semantic::Resolver& resolver,
+                  const semantic::Purity& purity);
+
+    std::size_t folded_calls() const { return folded_calls_; }
+    std::size_t folded_ops() const { return folded_ops_; }
+    std::size_t left_for_run_time() const { return left_; }   // trapped or over budget
+    uint64_t steps() const { return steps_; }                  // spent, in all evaluations
+
+private:
+    std::ostringstream out_;   // pure code prints nothing; the
+    std::istringstream in_;    // interpreter just needs streams
+    Interpreter interp_;
+    const semantic::Resolver* resolver_ = nullptr;
+    const semantic::Purity* purity_ = nullptr;
+
+    std::size_t folded_calls_ = 0;
+    std::size_t folded_ops_ = 0;
+    std::size_t left_ = 0;
+    uint64_t steps_ = 0;
+
+    bool visit(ExpPtr& exp);
+    void visit(Var& var);
+    void visit(std::vector<DecPtr>& decs);
+    bool fold(ExpPtr& exp);
+};
+
+} // namespace tiger
+
+#endif // TIGER_PARTIAL_EVALUATOR_HPP
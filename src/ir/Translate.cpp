@@ -0,0 +1,454 @@
+#include "ir/Translate.hpp"
+#include "semantic/BaseEnv.hpp"
+
+namespace tiger::ir {
+
+using semantic::base_env::FUNCTION_COUNT;
+
+Module Translator::translate(const Program& prog, const semantic::Resolver& resolver) {
+    Module module;
+    module_ = &module;
+    const auto& decs = resolver.functions();
+    module.reserve_labels(static_cast<Label>(RUNTIME_LABEL_COUNT + decs.size()));
+    module.function_names().reserve(decs.size());
+    for (const FunctionDec* dec : decs) module.function_names().push_back(module.copy(dec->name));
+
+    module.functions().reserve(decs.size() + 1);
+    function(MAIN, prog.frame_size, prog.exp.get(), {}, false);
+    for (std::size_t k = 0; k < decs.size(); k++) {
+        const FunctionDec& dec = *decs[k];
+        function(static_cast<Label>(RUNTIME_LABEL_COUNT + k), dec.frame_size, dec.body.get(),
+                 dec.params, !dec.result_type.empty());
+    }
+
+    module_ = nullptr;
+    f_ = nullptr;
+    return module;
+}
+
+void Translator::function(Label label, uint32_t slots, const Exp* body,
+                          const std::vector<TypeField>& params, bool returns_value) {
+    work_.reset(label, static_cast<uint32_t>(params.size()), slots);
+    f_ = &work_;
+    in_memory_.assign(slots, false);
+    for (std::size_t i = 0; i < params.size(); i++) in_memory_[i] = params[i].escape;
+    break_to_.clear();
+    scratch_.clear();
+
+    if (!body) {
+        work_.set_body(nop());
+    } else if (returns_value) {
+        NodeId value = exp(*body);
+        work_.set_body(work_.move(work_.temp(RV), value));
+    } else {
+        work_.set_body(stm(*body));
+    }
+    module_->functions().push_back(work_);
+}
+
+// ============================================================================
+// Expressions (Ex)
+// ============================================================================
+
+NodeId Translator::exp(const Exp& e) {
+    switch (e.kind) {
+        case ExpKind::VAR:
+            return var(*static_cast<const VarExp&>(e).var);
+
+        case ExpKind::NIL:
+            return f_->constant(0);
+
+        case ExpKind::INT:
+            return f_->constant(static_cast<const IntExp&>(e).value);
+
+        case ExpKind::STRING:
+            return f_->name(module_->add_string(static_cast<const StringExp&>(e).value));
+
+        case ExpKind::CALL:
+            return call(static_cast<const CallExp&>(e));
+
+        case ExpKind::OP: {
+            const auto& op = static_cast<const OpExp&>(e);
+            BinOp bin;
+            switch (op.op) {
+                case Op::PLUS: bin = BinOp::PLUS; break;
+                case Op::MINUS: bin = BinOp::MINUS; break;
+                case Op::TIMES: bin = BinOp::MUL; break;
+                case Op::DIVIDE: bin = BinOp::DIV; break;
+                default: return cond_value(e);
+            }
+            NodeId left = exp(*op.left);
+            NodeId right = exp(*op.right);
+            return f_->binop(bin, left, right);
+        }
+
+        case ExpKind::RECORD:
+            return record(static_cast<const RecordExp&>(e));
+
+        case ExpKind::SEQ:
+            return sequence(static_cast<const SeqExp&>(e).exps, true, scratch_.size());
+
+        case ExpKind::IF: {
+            const auto& if_exp = static_cast<const IfExp&>(e);
+            if (if_exp.else_exp) return if_value(if_exp);
+            break;
+        }
+
+        case ExpKind::LET:
+            return let(static_cast<const LetExp&>(e), true);
+
+        case ExpKind::ARRAY: {
+            const auto& array = static_cast<const ArrayExp&>(e);
+            NodeId size = exp(*array.size);
+            NodeId init = exp(*array.init);
+            return runtime_call(INIT_ARRAY, size, init);
+        }
+
+        case ExpKind::ASSIGN:
+        case ExpKind::WHILE:
+        case ExpKind::FOR:
+        case ExpKind::BREAK:
+            break;
+    }
+    // No value: run it, then yield ().
+    NodeId s = stm(e);
+    return f_->eseq(s, f_->constant(0));
+}
+
+NodeId Translator::var(const Var& v) {
+    switch (v.kind) {
+        case VarKind::SIMPLE: {
+            const auto& simple = static_cast<const SimpleVar&>(v);
+            return slot(simple.depth, simple.slot);
+        }
+        case VarKind::FIELD: {
+            const auto& field = static_cast<const FieldVar&>(v);
+            NodeId record = var(*field.var);
+            return f_->mem(offset(record, static_cast<int32_t>(field.slot) * WORD_SIZE));
+        }
+        case VarKind::SUBSCRIPT: {
+            const auto& sub = static_cast<const SubscriptVar&>(v);
+            NodeId array = var(*sub.var);
+            NodeId index = exp(*sub.index);
+            NodeId bytes = f_->binop(BinOp::MUL, index, f_->constant(WORD_SIZE));
+            return f_->mem(f_->binop(BinOp::PLUS, array, bytes));
+        }
+    }
+    return f_->constant(0);
+}
+
+// The frame `depth` static links out: word 0 of each frame is its link.
+NodeId Translator::frame(uint32_t depth) {
+    NodeId fp = f_->temp(FP);
+    for (uint32_t i = 0; i < depth; i++) fp = f_->mem(fp);
+    return fp;
+}
+
+NodeId Translator::slot(uint32_t depth, uint32_t slot) {
+    if (depth == 0) return local(slot, in_memory_[slot]);
+    return f_->mem(offset(frame(depth), static_cast<int32_t>(slot + 1) * WORD_SIZE));
+}
+
+NodeId Translator::local(uint32_t slot, bool escape) {
+    if (!escape) return f_->temp(Function::slot_temp(slot));
+    return f_->mem(offset(f_->temp(FP), static_cast<int32_t>(slot + 1) * WORD_SIZE));
+}
+
+NodeId Translator::offset(NodeId base, int32_t bytes) {
+    if (bytes == 0) return base;
+    return f_->binop(BinOp::PLUS, base, f_->constant(bytes));
+}
+
+NodeId Translator::call(const CallExp& call) {
+    std::size_t base = scratch_.size();
+    Label label;
+    if (call.func_id < FUNCTION_COUNT) {
+        label = call.func_id;
+    } else {
+        label = RUNTIME_LABEL_COUNT + (call.func_id - static_cast<uint32_t>(FUNCTION_COUNT));
+        scratch_.push_back(frame(call.depth));   // static link
+    }
+    for (const auto& arg : call.args) {
+        NodeId a = exp(*arg);
+        scratch_.push_back(a);
+    }
+    NodeId name = f_->name(label);
+    NodeId id = f_->call(name, scratch_.data() + base,
+                         static_cast<uint32_t>(scratch_.size() - base));
+    scratch_.resize(base);
+    return id;
+}
+
+NodeId Translator::runtime_call(Label label, NodeId a, NodeId b) {
+    NodeId args[] = {a, b};
+    return f_->call(f_->name(label), args, 2);
+}
+
+NodeId Translator::record(const RecordExp& rec) {
+    std::size_t base = scratch_.size();
+    Temp r = f_->new_temp();
+    auto size = static_cast<int32_t>(rec.fields.size()) * WORD_SIZE;
+    NodeId bytes = f_->constant(size);
+    NodeId alloc = f_->call(f_->name(ALLOC_RECORD), &bytes, 1);
+    scratch_.push_back(f_->move(f_->temp(r), alloc));
+    for (std::size_t i = 0; i < rec.fields.size(); i++) {
+        const Field& field = rec.fields[i];
+        uint32_t index = field.slot != UNRESOLVED ? field.slot : static_cast<uint32_t>(i);
+        NodeId value = exp(*field.exp);
+        NodeId dst = f_->mem(offset(f_->temp(r), static_cast<int32_t>(index) * WORD_SIZE));
+        scratch_.push_back(f_->move(dst, value));
+    }
+    NodeId init = seq_from(base);
+    return f_->eseq(init, f_->temp(r));
+}
+
+// A condition as a value: r := 1; if not cond then r := 0.
+NodeId Translator::cond_value(const Exp& e) {
+    std::size_t base = scratch_.size();
+    Temp r = f_->new_temp();
+    Label t = module_->new_label(), f = module_->new_label();
+    scratch_.push_back(f_->move(f_->temp(r), f_->constant(1)));
+    NodeId test = cond(e, t, f);
+    scratch_.push_back(test);
+    scratch_.push_back(f_->label(f));
+    scratch_.push_back(f_->move(f_->temp(r), f_->constant(0)));
+    scratch_.push_back(f_->label(t));
+    NodeId s = seq_from(base);
+    return f_->eseq(s, f_->temp(r));
+}
+
+NodeId Translator::if_value(const IfExp& e) {
+    std::size_t base = scratch_.size();
+    Temp r = f_->new_temp();
+    Label t = module_->new_label(), f = module_->new_label(), join = module_->new_label();
+    NodeId test = cond(*e.test, t, f);
+    scratch_.push_back(test);
+    scratch_.push_back(f_->label(t));
+    NodeId then_value = exp(*e.then_exp);
+    scratch_.push_back(f_->move(f_->temp(r), then_value));
+    scratch_.push_back(f_->jump(join));
+    scratch_.push_back(f_->label(f));
+    NodeId else_value = exp(*e.else_exp);
+    scratch_.push_back(f_->move(f_->temp(r), else_value));
+    scratch_.push_back(f_->label(join));
+    NodeId s = seq_from(base);
+    return f_->eseq(s, f_->temp(r));
+}
+
+NodeId Translator::let(const LetExp& e, bool value) {
+    std::size_t base = scratch_.size();
+    for (const auto& dec : e.decs) {
+        if (dec->kind != DecKind::VAR) continue;   // functions are translated on their own
+        const auto& var_dec = static_cast<const VarDec&>(*dec);
+        NodeId init = exp(*var_dec.init);
+        in_memory_[var_dec.slot] = var_dec.escape;
+        scratch_.push_back(f_->move(local(var_dec.slot, var_dec.escape), init));
+    }
+    return sequence(e.body, value, base);
+}
+
+// The statements already on scratch_ from `base`, then `exps`; as a value,
+// the last expression gives it.
+NodeId Translator::sequence(const std::vector<ExpPtr>& exps, bool value, std::size_t base) {
+    if (!value) {
+        for (const auto& e : exps) {
+            NodeId s = stm(*e);
+            scratch_.push_back(s);
+        }
+        return seq_from(base);
+    }
+    if (exps.empty()) {
+        if (scratch_.size() == base) return f_->constant(0);
+        NodeId s = seq_from(base);
+        return f_->eseq(s, f_->constant(0));
+    }
+    for (std::size_t i = 0; i + 1 < exps.size(); i++) {
+        NodeId s = stm(*exps[i]);
+        scratch_.push_back(s);
+    }
+    NodeId last = exp(*exps.back());
+    if (scratch_.size() == base) return last;
+    NodeId s = seq_from(base);
+    return f_->eseq(s, last);
+}
+
+NodeId Translator::seq_from(std::size_t base) {
+    if (scratch_.size() == base) return nop();
+    NodeId s = scratch_.back();
+    for (std::size_t i = scratch_.size() - 1; i-- > base;) s = f_->seq(scratch_[i], s);
+    scratch_.resize(base);
+    return s;
+}
+
+bool Translator::is_string(const Exp& e) const {
+    return e.kind == ExpKind::STRING || types_.type_of(&e) == &semantic::STRING_TYPE;
+}
+
+// ============================================================================
+// Statements (Nx)
+// ============================================================================
+
+NodeId Translator::stm(const Exp& e) {
+    switch (e.kind) {
+        case ExpKind::ASSIGN: {
+            const auto& assign = static_cast<const AssignExp&>(e);
+            NodeId dst = var(*assign.var);
+            NodeId src = exp(*assign.exp);
+            return f_->move(dst, src);
+        }
+
+        case ExpKind::SEQ:
+            return sequence(static_cast<const SeqExp&>(e).exps, false, scratch_.size());
+
+        case ExpKind::IF:
+            return if_stm(static_cast<const IfExp&>(e));
+
+        case ExpKind::WHILE:
+            return while_stm(static_cast<const WhileExp&>(e));
+
+        case ExpKind::FOR:
+            return for_stm(static_cast<const ForExp&>(e));
+
+        case ExpKind::BREAK:
+            return break_to_.empty() ? nop() : f_->jump(break_to_.back());
+
+        case ExpKind::LET:
+            return let(static_cast<const LetExp&>(e), false);
+
+        default: {
+            NodeId value = exp(e);
+            return f_->exp(value);
+        }
+    }
+}
+
+NodeId Translator::if_stm(const IfExp& e) {
+    std::size_t base = scratch_.size();
+    Label t = module_->new_label(), f = module_->new_label();
+    NodeId test = cond(*e.test, t, f);
+    scratch_.push_back(test);
+    scratch_.push_back(f_->label(t));
+    NodeId then_stm = stm(*e.then_exp);
+    scratch_.push_back(then_stm);
+    if (e.else_exp) {
+        Label join = module_->new_label();
+        scratch_.push_back(f_->jump(join));
+        scratch_.push_back(f_->label(f));
+        NodeId else_stm = stm(*e.else_exp);
+        scratch_.push_back(else_stm);
+        scratch_.push_back(f_->label(join));
+    } else {
+        scratch_.push_back(f_->label(f));
+    }
+    return seq_from(base);
+}
+
+NodeId Translator::while_stm(const WhileExp& e) {
+    std::size_t base = scratch_.size();
+    Label test = module_->new_label(), body = module_->new_label(), done = module_->new_label();
+    scratch_.push_back(f_->label(test));
+    NodeId jump = cond(*e.test, body, done);
+    scratch_.push_back(jump);
+    scratch_.push_back(f_->label(body));
+    break_to_.push_back(done);
+    NodeId body_stm = stm(*e.body);
+    break_to_.pop_back();
+    scratch_.push_back(body_stm);
+    scratch_.push_back(f_->jump(test));
+    scratch_.push_back(f_->label(done));
+    return seq_from(base);
+}
+
+// i := lo; limit := hi; if i <= limit then loop: (body; if i < limit then
+// (i := i + 1; goto loop)). Testing i < limit before the increment keeps
+// the counter from overflowing when hi is the largest int.
+NodeId Translator::for_stm(const ForExp& e) {
+    std::size_t base = scratch_.size();
+    Label body = module_->new_label(), next = module_->new_label(), done = module_->new_label();
+    NodeId lo = exp(*e.lo);
+    in_memory_[e.slot] = e.escape;
+    scratch_.push_back(f_->move(local(e.slot, e.escape), lo));
+    Temp limit = f_->new_temp();
+    NodeId hi = exp(*e.hi);
+    scratch_.push_back(f_->move(f_->temp(limit), hi));
+    scratch_.push_back(f_->cjump(RelOp::LE, local(e.slot, e.escape), f_->temp(limit), body, done));
+    scratch_.push_back(f_->label(body));
+    break_to_.push_back(done);
+    NodeId body_stm = stm(*e.body);
+    break_to_.pop_back();
+    scratch_.push_back(body_stm);
+    scratch_.push_back(f_->cjump(RelOp::LT, local(e.slot, e.escape), f_->temp(limit), next, done));
+    scratch_.push_back(f_->label(next));
+    NodeId plus_one = f_->binop(BinOp::PLUS, local(e.slot, e.escape), f_->constant(1));
+    scratch_.push_back(f_->move(local(e.slot, e.escape), plus_one));
+    scratch_.push_back(f_->jump(body));
+    scratch_.push_back(f_->label(done));
+    return seq_from(base);
+}
+
+// ============================================================================
+// Conditions (Cx)
+// ============================================================================
+
+NodeId Translator::cond(const Exp& e, Label t, Label f) {
+    switch (e.kind) {
+        case ExpKind::INT:
+            return f_->jump(static_cast<const IntExp&>(e).value ? t : f);
+
+        case ExpKind::OP: {
+            const auto& op = static_cast<const OpExp&>(e);
+            if (op.op >= Op::EQ) return compare(op, t, f);
+            break;
+        }
+
+        case ExpKind::IF: {
+            // if a then b else c as a test: jump on b or on c (a & b and
+            // a | b are written this way)
+            const auto& if_exp = static_cast<const IfExp&>(e);
+            if (!if_exp.else_exp) break;
+            std::size_t base = scratch_.size();
+            Label then_label = module_->new_label(), else_label = module_->new_label();
+            NodeId test = cond(*if_exp.test, then_label, else_label);
+            scratch_.push_back(test);
+            scratch_.push_back(f_->label(then_label));
+            NodeId then_jump = cond(*if_exp.then_exp, t, f);
+            scratch_.push_back(then_jump);
+            scratch_.push_back(f_->label(else_label));
+            NodeId else_jump = cond(*if_exp.else_exp, t, f);
+            scratch_.push_back(else_jump);
+            return seq_from(base);
+        }
+
+        default:
+            break;
+    }
+    NodeId value = exp(e);
+    return f_->cjump(RelOp::NE, value, f_->constant(0), t, f);
+}
+
+NodeId Translator::compare(const OpExp& op, Label t, Label f) {
+    RelOp rel;
+    switch (op.op) {
+        case Op::EQ: rel = RelOp::EQ; break;
+        case Op::NEQ: rel = RelOp::NE; break;
+        case Op::LT: rel = RelOp::LT; break;
+        case Op::LE: rel = RelOp::LE; break;
+        case Op::GT: rel = RelOp::GT; break;
+        default: rel = RelOp::GE; break;
+    }
+    NodeId left = exp(*op.left);
+    NodeId right = exp(*op.right);
+    if (is_string(*op.left) || is_string(*op.right)) {
+        if (rel == RelOp::EQ || rel == RelOp::NE) {
+            // stringEqual(a, b) is 1 if equal: = jumps if it is not 0
+            left = runtime_call(STRING_EQUAL, left, right);
+            rel = rel == RelOp::EQ ? RelOp::NE : RelOp::EQ;
+        } else {
+            left = runtime_call(STRING_COMPARE, left, right);
+        }
+        right = f_->constant(0);
+    }
+    return f_->cjump(rel, left, right, t, f);
+}
+
+} // namespace tiger::ir
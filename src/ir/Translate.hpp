@@ -0,0 +1,101 @@
+#ifndef TIGER_IR_TRANSLATE_HPP
+#define TIGER_IR_TRANSLATE_HPP
+
+// ============================================================================
+// Translation of a checked, resolved AST to IR trees (Appel ch. 7).
+//
+// One walk per function body, each node visited once. An expression is
+// translated for the context it appears in, which is Appel's Ex / Nx / Cx
+// distinction without building the three forms first:
+//   exp(e)         its value (Ex)
+//   stm(e)         for effect only (Nx)
+//   cond(e, t, f)  a jump to t if it is nonzero, else to f (Cx); an if or
+//                  while test goes straight to CJUMPs, and a comparison
+//                  used as a value becomes one through a temp
+// Nested function declarations are skipped where they appear; every
+// function is translated into its own Function afterwards, from
+// Resolver::functions().
+//
+// Nodes are built in a Function the translator reuses, as are its scratch
+// lists, and then copied into the module at their exact size. A function
+// therefore costs two allocations however large it is: its nodes and its
+// operands.
+//
+// Frames (the target-independent part of Appel's Frame module):
+//   - word 0 of a frame holds its static link; slot s is word s + 1
+//   - a variable that escapes lives in its frame slot, MEM(fp + (s+1)*W);
+//     one that does not lives in the temp of its slot
+//   - an outer variable is reached by following `depth` static links
+//   - a call to a user function passes the static link as argument 0; a
+//     call to the library passes only the arguments
+// Parameters are assumed to be in their slots on entry: moving them there
+// from the calling convention's registers (the "view shift") is left to
+// the target frame.
+//
+// Records are allocRecord(n * W) with the fields stored by Field::slot;
+// arrays are initArray(size, init); string = and <> call stringEqual, the
+// other string comparisons stringCompare. Nil is CONST 0. There are no
+// bounds or nil checks yet.
+//
+// Needs the annotations of semantic::Resolver and, for string operands,
+// the types of semantic::TypeChecker; run it on the tree both have seen.
+// ============================================================================
+
+#include "ir/Tree.hpp"
+#include "parser/AST.hpp"
+#include "semantic/Resolver.hpp"
+#include "semantic/TypeChecker.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace tiger::ir {
+
+class Translator {
+public:
+    explicit Translator(const semantic::TypeChecker& types) : types_(types) {}
+
+    Module translate(const Program& prog, const semantic::Resolver& resolver);
+
+private:
+    const semantic::TypeChecker& types_;
+    Module* module_ = nullptr;
+    Function* f_ = nullptr;
+    Function work_{MAIN, 0, 0};       // the function being built
+
+    std::vector<bool> in_memory_;     // of the current function's slots
+    std::vector<Label> break_to_;     // innermost loop last
+    std::vector<NodeId> scratch_;     // call arguments and statement lists
+
+    void function(Label label, uint32_t slots, const Exp* body,
+                  const std::vector<TypeField>& params, bool returns_value);
+
+    NodeId exp(const Exp& e);
+    NodeId stm(const Exp& e);
+    NodeId cond(const Exp& e, Label t, Label f);
+
+    NodeId var(const Var& v);
+    NodeId frame(uint32_t depth);
+    NodeId slot(uint32_t depth, uint32_t slot);
+    NodeId local(uint32_t slot, bool escape);
+    NodeId call(const CallExp& call);
+    NodeId compare(const OpExp& op, Label t, Label f);
+    NodeId record(const RecordExp& rec);
+    NodeId if_stm(const IfExp& e);
+    NodeId if_value(const IfExp& e);
+    NodeId cond_value(const Exp& e);
+    NodeId while_stm(const WhileExp& e);
+    NodeId for_stm(const ForExp& e);
+    NodeId let(const LetExp& e, bool value);
+    NodeId sequence(const std::vector<ExpPtr>& exps, bool value, std::size_t base);
+    NodeId runtime_call(Label label, NodeId a, NodeId b);
+
+    // SEQ of the statements on scratch_ from `base` (popped), or a no-op.
+    NodeId seq_from(std::size_t base);
+    NodeId nop() { return f_->exp(f_->constant(0)); }
+    NodeId offset(NodeId base, int32_t bytes);
+    bool is_string(const Exp& e) const;
+};
+
+} // namespace tiger::ir
+
+#endif // TIGER_IR_TRANSLATE_HPP
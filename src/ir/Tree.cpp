@@ -0,0 +1,253 @@
+#include "ir/Tree.hpp"
+#include "semantic/BaseEnv.hpp"
+#include <charconv>
+
+namespace tiger::ir {
+
+static_assert(INIT_ARRAY == semantic::base_env::FUNCTION_COUNT,
+              "runtime helpers follow the library functions");
+
+NodeId Function::call(NodeId function, const NodeId* args, uint32_t count) {
+    auto first = static_cast<uint32_t>(operands_.size());
+    operands_.insert(operands_.end(), args, args + count);
+    return add(Kind::CALL, 0, function, first, count);
+}
+
+NodeId Function::cjump(RelOp op, NodeId left, NodeId right, Label t, Label f) {
+    auto targets = static_cast<uint32_t>(operands_.size());
+    operands_.push_back(t);
+    operands_.push_back(f);
+    return add(Kind::CJUMP, static_cast<uint8_t>(op), left, right, targets);
+}
+
+Label Module::add_string(std::string_view value) {
+    Label label = new_label();
+    strings_.push_back({label, arena_.copy(value)});
+    return label;
+}
+
+std::size_t Module::bytes() const {
+    std::size_t bytes = strings_.size() * sizeof(StringFragment);
+    for (const Function& f : functions_) bytes += sizeof(Function) + f.bytes();
+    for (const StringFragment& s : strings_) bytes += s.value.size() + 1;
+    return bytes;
+}
+
+std::size_t Module::nodes() const {
+    std::size_t nodes = 0;
+    for (const Function& f : functions_) nodes += f.size();
+    return nodes;
+}
+
+// ============================================================================
+// Dump
+// ============================================================================
+//
+//   function f.0 (params 2, slots 3, temps 7)
+//     MOVE(TEMP t4, BINOP(PLUS, TEMP t2, CONST 1))
+//     CJUMP(LT, TEMP t4, CONST 10, L12, L13)
+//     ...
+//   string L14 "hello\n"
+//
+// The SEQs of a function body are flattened to one statement per line;
+// nested ones (inside an ESEQ) are printed as SEQ(s1, s2). Runtime labels
+// print as their names, user functions as name.index, other labels as
+// L<n>, and temps as fp, rv or t<n>.
+
+namespace {
+
+constexpr const char* RUNTIME_NAMES[] = {
+    "print", "getchar", "ord", "chr", "size", "substring", "concat", "not", "exit",
+    "initArray", "allocRecord", "stringEqual", "stringCompare", "tigermain",
+};
+static_assert(sizeof(RUNTIME_NAMES) / sizeof(RUNTIME_NAMES[0]) == RUNTIME_LABEL_COUNT,
+              "a name for every runtime label");
+
+constexpr const char* KIND_NAMES[] = {
+    "CONST", "NAME", "TEMP", "BINOP", "MEM", "CALL", "ESEQ",
+    "MOVE", "EXP", "JUMP", "CJUMP", "SEQ", "LABEL",
+};
+static_assert(sizeof(KIND_NAMES) / sizeof(KIND_NAMES[0]) == KIND_COUNT,
+              "a name for every node kind");
+
+constexpr const char* BINOP_NAMES[] = {
+    "PLUS", "MINUS", "MUL", "DIV", "AND", "OR", "LSHIFT", "RSHIFT", "ARSHIFT", "XOR",
+};
+constexpr const char* RELOP_NAMES[] = {
+    "EQ", "NE", "LT", "GT", "LE", "GE", "ULT", "ULE", "UGT", "UGE",
+};
+
+class Dumper {
+public:
+    Dumper(const Module& module, std::string& out) : module_(module), out_(out) {}
+
+    void function(const Function& f) {
+        f_ = &f;
+        out_ += "function ";
+        label(f.label());
+        out_ += " (params ";
+        number(f.params());
+        out_ += ", slots ";
+        number(f.slots());
+        out_ += ", temps ";
+        number(f.temps());
+        out_ += ")\n";
+        if (f.body() == NO_NODE) return;
+
+        // Flatten the SEQ spine: the second half waits on the stack.
+        stack_.clear();
+        stack_.push_back(f.body());
+        while (!stack_.empty()) {
+            NodeId id = stack_.back();
+            stack_.pop_back();
+            const Node& n = f[id];
+            if (n.kind == Kind::SEQ) {
+                stack_.push_back(n.b);
+                stack_.push_back(n.a);
+                continue;
+            }
+            out_ += "  ";
+            node(id);
+            out_ += '\n';
+        }
+    }
+
+    void string(const StringFragment& s) {
+        out_ += "string ";
+        label(s.label);
+        out_ += " \"";
+        for (char c : s.value) {
+            switch (c) {
+                case '\n': out_ += "\\n"; break;
+                case '\t': out_ += "\\t"; break;
+                case '"': out_ += "\\\""; break;
+                case '\\': out_ += "\\\\"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 32 || static_cast<unsigned char>(c) > 126) {
+                        auto u = static_cast<unsigned char>(c);
+                        out_ += '\\';
+                        out_ += static_cast<char>('0' + u / 100);
+                        out_ += static_cast<char>('0' + u / 10 % 10);
+                        out_ += static_cast<char>('0' + u % 10);
+                    } else {
+                        out_ += c;
+                    }
+            }
+        }
+        out_ += "\"\n";
+    }
+
+private:
+    const Module& module_;
+    std::string& out_;
+    const Function* f_ = nullptr;
+    std::vector<NodeId> stack_;
+
+    void number(uint32_t n) { signed_number(static_cast<int64_t>(n)); }
+
+    void signed_number(int64_t n) {
+        char buf[24];
+        auto end = std::to_chars(buf, buf + sizeof(buf), n).ptr;
+        out_.append(buf, static_cast<std::size_t>(end - buf));
+    }
+
+    void label(Label l) {
+        if (l < RUNTIME_LABEL_COUNT) {
+            out_ += RUNTIME_NAMES[l];
+        } else if (l - RUNTIME_LABEL_COUNT < module_.function_names().size()) {
+            out_ += module_.function_names()[l - RUNTIME_LABEL_COUNT];
+            out_ += '.';
+            number(l - RUNTIME_LABEL_COUNT);
+        } else {
+            out_ += 'L';
+            number(l);
+        }
+    }
+
+    void temp(Temp t) {
+        if (t == FP) {
+            out_ += "fp";
+        } else if (t == RV) {
+            out_ += "rv";
+        } else {
+            out_ += 't';
+            number(t);
+        }
+    }
+
+    void node(NodeId id) {
+        const Node& n = (*f_)[id];
+        out_ += KIND_NAMES[static_cast<std::size_t>(n.kind)];
+        switch (n.kind) {
+            case Kind::CONST:
+                out_ += ' ';
+                signed_number(static_cast<int32_t>(n.a));
+                return;
+            case Kind::NAME:
+            case Kind::JUMP:
+            case Kind::LABEL:
+                out_ += ' ';
+                label(n.a);
+                return;
+            case Kind::TEMP:
+                out_ += ' ';
+                temp(n.a);
+                return;
+            case Kind::BINOP:
+                out_ += '(';
+                out_ += BINOP_NAMES[n.op];
+                out_ += ", ";
+                node(n.a);
+                out_ += ", ";
+                node(n.b);
+                break;
+            case Kind::MEM:
+            case Kind::EXP:
+                out_ += '(';
+                node(n.a);
+                break;
+            case Kind::CALL:
+                out_ += '(';
+                node(n.a);
+                for (uint32_t i = 0; i < n.c; i++) {
+                    out_ += ", ";
+                    node(f_->operands()[n.b + i]);
+                }
+                break;
+            case Kind::ESEQ:
+            case Kind::MOVE:
+            case Kind::SEQ:
+                out_ += '(';
+                node(n.a);
+                out_ += ", ";
+                node(n.b);
+                break;
+            case Kind::CJUMP:
+                out_ += '(';
+                out_ += RELOP_NAMES[n.op];
+                out_ += ", ";
+                node(n.a);
+                out_ += ", ";
+                node(n.b);
+                out_ += ", ";
+                label(f_->operands()[n.c]);
+                out_ += ", ";
+                label(f_->operands()[n.c + 1]);
+                break;
+        }
+        out_ += ')';
+    }
+};
+
+} // namespace
+
+std::string Module::dump() const {
+    std::string out;
+    out.reserve(nodes() * 12 + 64);
+    Dumper dumper(*this, out);
+    for (const Function& f : functions_) dumper.function(f);
+    for (const StringFragment& s : strings_) dumper.string(s);
+    return out;
+}
+
+} // namespace tiger::ir
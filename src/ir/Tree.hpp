@@ -0,0 +1,221 @@
+#ifndef TIGER_IR_TREE_HPP
+#define TIGER_IR_TREE_HPP
+
+// ============================================================================
+// Intermediate representation trees (Appel ch. 7, "Translation to
+// Intermediate Code"): the T_exp / T_stm language.
+//
+//   expressions  CONST i, NAME l, TEMP t, BINOP(op, e1, e2), MEM(e),
+//                CALL(f, args), ESEQ(s, e)
+//   statements   MOVE(dst, src), EXP(e), JUMP l, CJUMP(op, e1, e2, t, f),
+//                SEQ(s1, s2), LABEL l
+//
+// Nodes are not heap objects. Each function's nodes live in one array,
+// its arena, and refer to each other by 32-bit index into it; a node is
+// 16 bytes whatever its kind (see Node). Temps and labels are dense
+// integers rather than named objects:
+//   - temps are numbered per function: FP and RV, then one per frame slot
+//     (a variable that does not escape lives in the temp of its slot),
+//     then fresh ones
+//   - labels are numbered per module: the runtime's entry points (the
+//     library functions, in builtin order, then the runtime helpers and
+//     the main program), the user functions by Resolver id, then fresh
+//     labels for jumps and string literals
+// Only a dump gives them names.
+//
+// A module is the translation of one program: a function fragment per
+// user function plus one for the main program, and a string fragment per
+// string literal.
+// ============================================================================
+
+#include "util/Arena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tiger::ir {
+
+using NodeId = uint32_t;   // index into a Function's nodes
+using Temp = uint32_t;
+using Label = uint32_t;
+
+constexpr NodeId NO_NODE = UINT32_MAX;
+
+constexpr Temp FP = 0;            // frame pointer
+constexpr Temp RV = 1;            // return value
+constexpr Temp FIRST_SLOT_TEMP = 2;
+
+constexpr int32_t WORD_SIZE = 8;
+
+// Labels of the runtime. The library functions come first, in builtin
+// order, so a call to library function `id` (CallExp::func_id) jumps to
+// label `id`.
+enum RuntimeLabel : Label {
+    INIT_ARRAY = 9,      // initArray(size, init)
+    ALLOC_RECORD,        // allocRecord(bytes)
+    STRING_EQUAL,        // stringEqual(a, b): 1 if equal
+    STRING_COMPARE,      // stringCompare(a, b): <0, 0 or >0
+    MAIN,                // the main program
+    RUNTIME_LABEL_COUNT,
+};
+
+enum class Kind : uint8_t {
+    // expressions
+    CONST, NAME, TEMP, BINOP, MEM, CALL, ESEQ,
+    // statements
+    MOVE, EXP, JUMP, CJUMP, SEQ, LABEL,
+};
+
+constexpr std::size_t KIND_COUNT = static_cast<std::size_t>(Kind::LABEL) + 1;
+
+enum class BinOp : uint8_t {
+    PLUS, MINUS, MUL, DIV, AND, OR, LSHIFT, RSHIFT, ARSHIFT, XOR,
+};
+
+enum class RelOp : uint8_t {
+    EQ, NE, LT, GT, LE, GE, ULT, ULE, UGT, UGE,
+};
+
+// One node. What a, b and c hold depends on the kind:
+//   CONST  a = the value (an int32_t's bits)
+//   NAME   a = label
+//   TEMP   a = temp
+//   BINOP  op = BinOp, a = left, b = right
+//   MEM    a = address
+//   CALL   a = function, b = first argument in Function::operands(),
+//          c = argument count
+//   ESEQ   a = statement, b = expression
+//   MOVE   a = destination (TEMP or MEM), b = source
+//   EXP    a = expression
+//   JUMP   a = label
+//   CJUMP  op = RelOp, a = left, b = right, c = first of two entries in
+//          Function::operands(): the true label, then the false label
+//   SEQ    a = first, b = second
+//   LABEL  a = label
+struct Node {
+    Kind kind;
+    uint8_t op;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+};
+
+static_assert(sizeof(Node) == 16, "IR nodes are 16 bytes");
+
+// The IR of one function, and the arena its nodes live in.
+class Function {
+public:
+    Function(Label label, uint32_t params, uint32_t slots) { reset(label, params, slots); }
+
+    // Empties the function for reuse; the arena keeps its capacity. A copy
+    // of a function holds exactly its nodes, so a translator builds each
+    // function in one reused Function and keeps a copy.
+    void reset(Label label, uint32_t params, uint32_t slots) {
+        label_ = label;
+        params_ = params;
+        slots_ = slots;
+        temps_ = FIRST_SLOT_TEMP + slots;
+        body_ = NO_NODE;
+        nodes_.clear();
+        operands_.clear();
+    }
+
+    Label label() const { return label_; }
+    uint32_t params() const { return params_; }   // in slots 0..params-1
+    uint32_t slots() const { return slots_; }     // Resolver's frame_size
+    uint32_t temps() const { return temps_; }     // FP and RV included
+    NodeId body() const { return body_; }         // a statement
+    void set_body(NodeId body) { body_ = body; }
+
+    const Node& operator[](NodeId id) const { return nodes_[id]; }
+    std::size_t size() const { return nodes_.size(); }
+    const std::vector<uint32_t>& operands() const { return operands_; }
+
+    // Bytes of nodes and operands.
+    std::size_t bytes() const {
+        return nodes_.size() * sizeof(Node) + operands_.size() * sizeof(uint32_t);
+    }
+
+    Temp new_temp() { return temps_++; }
+    static Temp slot_temp(uint32_t slot) { return FIRST_SLOT_TEMP + slot; }
+
+    // Node constructors; each appends one node and returns its index.
+    NodeId constant(int32_t value) {
+        return add(Kind::CONST, 0, static_cast<uint32_t>(value));
+    }
+    NodeId name(Label label) { return add(Kind::NAME, 0, label); }
+    NodeId temp(Temp temp) { return add(Kind::TEMP, 0, temp); }
+    NodeId binop(BinOp op, NodeId left, NodeId right) {
+        return add(Kind::BINOP, static_cast<uint8_t>(op), left, right);
+    }
+    NodeId mem(NodeId address) { return add(Kind::MEM, 0, address); }
+    // Copies the `count` argument ids at `args` into operands().
+    NodeId call(NodeId function, const NodeId* args, uint32_t count);
+    NodeId eseq(NodeId stm, NodeId exp) { return add(Kind::ESEQ, 0, stm, exp); }
+    NodeId move(NodeId dst, NodeId src) { return add(Kind::MOVE, 0, dst, src); }
+    NodeId exp(NodeId exp) { return add(Kind::EXP, 0, exp); }
+    NodeId jump(Label label) { return add(Kind::JUMP, 0, label); }
+    NodeId cjump(RelOp op, NodeId left, NodeId right, Label t, Label f);
+    NodeId seq(NodeId first, NodeId second) { return add(Kind::SEQ, 0, first, second); }
+    NodeId label(Label label) { return add(Kind::LABEL, 0, label); }
+
+private:
+    Label label_;
+    uint32_t params_;
+    uint32_t slots_;
+    uint32_t temps_;
+    NodeId body_ = NO_NODE;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> operands_;   // call arguments, cjump targets
+
+    NodeId add(Kind kind, uint8_t op, uint32_t a, uint32_t b = 0, uint32_t c = 0) {
+        nodes_.push_back({kind, op, a, b, c});
+        return static_cast<NodeId>(nodes_.size() - 1);
+    }
+};
+
+struct StringFragment {
+    Label label;
+    std::string_view value;   // in the module's arena
+};
+
+class Module {
+public:
+    // functions()[0] is the main program; user function `id` (Resolver)
+    // follows at index id - base_env::FUNCTION_COUNT + 1.
+    std::vector<Function>& functions() { return functions_; }
+    const std::vector<Function>& functions() const { return functions_; }
+    const std::vector<StringFragment>& strings() const { return strings_; }
+
+    // Source names of the user functions, by label - RUNTIME_LABEL_COUNT.
+    std::vector<std::string_view>& function_names() { return function_names_; }
+    const std::vector<std::string_view>& function_names() const { return function_names_; }
+
+    Label new_label() { return label_count_++; }
+    Label label_count() const { return label_count_; }
+    void reserve_labels(Label count) { label_count_ = count; }
+
+    // A fresh label for a string literal; `value` is copied.
+    Label add_string(std::string_view value);
+    std::string_view copy(std::string_view s) { return arena_.copy(s); }
+
+    // Bytes held by the IR: function arenas and string fragments.
+    std::size_t bytes() const;
+    std::size_t nodes() const;
+
+    // The whole module as text, one statement per line (see Tree.cpp).
+    std::string dump() const;
+
+private:
+    std::vector<Function> functions_;
+    std::vector<StringFragment> strings_;
+    std::vector<std::string_view> function_names_;
+    Arena arena_{4096};
+    Label label_count_ = RUNTIME_LABEL_COUNT;
+};
+
+} // namespace tiger::ir
+
+#endif // TIGER_IR_TREE_HPP
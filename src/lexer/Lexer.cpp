@@ -25,7 +25,12 @@ static const std::unordered_map<std::string, TokenType> keywords = {
 };
 
 Lexer::Lexer(const std::string& source)
-    : source_(source), pos_(0), line_(1), column_(1), has_current_(false) {}
+    : source_(source), pos_(0), token_start_(0), line_(1), column_(1),
+      has_current_(false) {}
+
+Lexer::Lexer(const std::string& source, Position start)
+    : source_(source), pos_(0), token_start_(0), line_(start.line),
+      column_(start.column), has_current_(false) {}
 
 char Lexer::peek() const {
     if (pos_ >= source_.size()) return '\0';
@@ -59,7 +64,11 @@ void Lexer::add_error(const std::string& msg) {
 }
 
 Token Lexer::make_token(TokenType type, const std::string& text, Position start) {
-    return Token(type, text, start);
+    token_counts_[static_cast<size_t>(type)]++;
+    Token tok(type, text, start);
+    tok.offset = token_start_;
+    tok.end = pos_;
+    return tok;
 }
 
 // Tiger comments are /* ... */ and can nest
@@ -195,6 +204,7 @@ Token Lexer::next_token() {
     }
 
     skip_whitespace_and_comments();
+    token_start_ = pos_;
 
     if (at_end()) {
         return make_token(TokenType::END_OF_FILE, "", Position(line_, column_));
@@ -2,6 +2,7 @@
 #define TIGER_LEXER_HPP
 
 #include "Token.hpp"
+#include <array>
 #include <string>
 #include <vector>
 
@@ -10,6 +11,9 @@ namespace tiger {
 class Lexer {
 public:
     explicit Lexer(const std::string& source);
+    // Lexes a fragment whose first character sits at `start` in a larger
+    // file; token positions are reported in the file's coordinates.
+    Lexer(const std::string& source, Position start);
 
     Token next_token();
     Token peek_token();
@@ -21,14 +25,21 @@ public:
     const std::vector<std::string>& errors() const { return errors_; }
     bool has_errors() const { return !errors_.empty(); }
 
+    // Number of tokens produced so far, indexed by TokenType.
+    const std::array<size_t, TOKEN_TYPE_COUNT>& token_counts() const {
+        return token_counts_;
+    }
+
 private:
     std::string source_;
     size_t pos_;
+    size_t token_start_;
     int line_;
     int column_;
     Token current_;
     bool has_current_; // means "does it have lookahead?"
     std::vector<std::string> errors_;
+    std::array<size_t, TOKEN_TYPE_COUNT> token_counts_{};
 
     char peek() const;
     char peek_next() const;
@@ -1,6 +1,7 @@
 #ifndef TIGER_TOKEN_HPP
 #define TIGER_TOKEN_HPP
 
+#include <cstddef>
 #include <string>
 #include <ostream>
 
@@ -63,6 +64,10 @@ enum class TokenType {
     ERROR,
 };
 
+// Number of TokenType enumerators (ERROR is always last).
+constexpr std::size_t TOKEN_TYPE_COUNT =
+    static_cast<std::size_t>(TokenType::ERROR) + 1;
+
 const char* token_type_to_string(TokenType type);
 
 struct Position {
@@ -81,9 +86,13 @@ struct Token {
     // For INT_LIT
     int int_value;
 
-    Token() : type(TokenType::ERROR), int_value(0) {}
+    // Byte range [offset, end) of the token in the lexer's source.
+    size_t offset;
+    size_t end;
+
+    Token() : type(TokenType::ERROR), int_value(0), offset(0), end(0) {}
     Token(TokenType t, const std::string& txt, Position p)
-        : type(t), text(txt), pos(p), int_value(0) {}
+        : type(t), text(txt), pos(p), int_value(0), offset(0), end(0) {}
 };
 
 std::ostream& operator<<(std::ostream& os, const Token& tok);
@@ -1,9 +1,24 @@
+#include "interp/Interpreter.hpp"
+#include "ir/Translate.hpp"
+#include "interp/PartialEvaluator.hpp"
+#include "opt/ConstantFolder.hpp"
+#include "opt/DeadCodeEliminator.hpp"
 #include "util/ASTPrinter.hpp"
+#include "util/AstBinary.hpp"
+#include "util/AstStats.hpp"
+#include "util/ParseCache.hpp"
 #include "lexer/Lexer.hpp"
 #include "parser/Parser.hpp"
+#include "semantic/Purity.hpp"
+#include "semantic/Resolver.hpp"
+#include "semantic/TypeChecker.hpp"
+#include "util/ThreadPool.hpp"
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 void print_usage(const char* prog) {
     std::cerr << "Usage: " << prog << " [options] <file.tig>\n";
@@ -11,6 +26,32 @@ void print_usage(const char* prog) {
     std::cerr << "  --lex     Print tokens only\n";
     std::cerr << "  --parse   Parse and report errors (default)\n";
     std::cerr << "  --ast     Print the AST\n";
+    std::cerr << "  --check   Parse and type-check\n";
+    std::cerr << "  --run     Type-check and interpret the program\n";
+    std::cerr << "  --ir      Type-check and print the IR trees\n";
+    std::cerr << "  --memoize\n";
+    std::cerr << "            With --run, cache results of hot pure functions\n";
+    std::cerr << "  --fold    With --run or --ir, fold constants and simplify arithmetic first\n";
+    std::cerr << "  --dce     With --run, --ir or --ast-stats, remove unused declarations and\n";
+    std::cerr << "            unreachable code first (--ast-stats reports what went)\n";
+    std::cerr << "  --peval   With --run, evaluate constant calls and arithmetic first\n";
+    std::cerr << "  --jobs <N>\n";
+    std::cerr << "            Threads for --check (default: 1, 0 = all cores)\n";
+    std::cerr << "  --ast-stats[=text|json]\n";
+    std::cerr << "            Print structural statistics of the AST\n";
+    std::cerr << "  --emit-ast=bin|text\n";
+    std::cerr << "            Write the AST in binary or text form\n";
+    std::cerr << "  -o <file> Output file for --emit-ast (default: stdout)\n";
+    std::cerr << "  --cache-dir <dir>\n";
+    std::cerr << "            Reuse parse results cached in <dir>\n";
+    std::cerr << "            (default: $TIGER_CACHE_DIR, unset = no cache)\n";
+    std::cerr << "  --cache-size <MiB>\n";
+    std::cerr << "            Bound the cache directory size (default: 64)\n";
+    std::cerr << "  --cache-stats\n";
+    std::cerr << "            Print cache hits/misses to stderr on exit\n";
+    std::cerr << "\n";
+    std::cerr << "A binary AST written by --emit-ast=bin may be given as input\n";
+    std::cerr << "in place of a .tig file; it is loaded without parsing.\n";
 }
 
 std::string read_file(const std::string& path) {
@@ -40,27 +81,78 @@ void run_lexer(const std::string& source) {
     }
 }
 
-void run_parser(const std::string& source, bool print_ast) {
-    tiger::Lexer lexer(source);
-    tiger::Parser parser(lexer);
-
-    auto program = parser.parse();
-
-    if (lexer.has_errors()) {
+// Prints lexer/parser diagnostics; returns true if there were none.
+bool report_errors(const std::vector<std::string>& lexer_errors,
+                   const std::vector<std::string>& parser_errors) {
+    if (!lexer_errors.empty()) {
         std::cerr << "Lexer errors:\n";
-        for (const auto& err : lexer.errors()) {
+        for (const auto& err : lexer_errors) {
             std::cerr << "  " << err << "\n";
         }
     }
 
-    if (parser.has_errors()) {
+    if (!parser_errors.empty()) {
         std::cerr << "Parser errors:\n";
-        for (const auto& err : parser.errors()) {
+        for (const auto& err : parser_errors) {
             std::cerr << "  " << err << "\n";
         }
     }
 
-    if (!lexer.has_errors() && !parser.has_errors()) {
+    return lexer_errors.empty() && parser_errors.empty();
+}
+
+// Set from --cache-dir / $TIGER_CACHE_DIR; nullptr means no caching.
+static std::unique_ptr<tiger::ParseCache> parse_cache;
+
+// Parses the file, or decodes it directly if it holds a binary AST.
+// Returns nullptr (after reporting) if there were errors.
+std::unique_ptr<tiger::Program> load_program(
+        const std::string& path,
+        std::array<size_t, tiger::TOKEN_TYPE_COUNT>* token_counts = nullptr) {
+    if (tiger::AstBinaryReader::is_binary_file(path)) {
+        tiger::AstBinaryReader reader;
+        auto program = reader.load(path);
+        for (const auto& err : reader.errors()) {
+            std::cerr << "Error: " << err << "\n";
+        }
+        return program;
+    }
+
+    std::string source = read_file(path);
+
+    tiger::CachedParse cached;
+    if (parse_cache && parse_cache->lookup(source, cached)) {
+        if (token_counts) {
+            *token_counts = cached.token_counts;
+        }
+        if (!report_errors(cached.lexer_errors, cached.parser_errors)) {
+            return nullptr;
+        }
+        return std::move(cached.program);
+    }
+
+    tiger::Lexer lexer(source);
+    tiger::Parser parser(lexer);
+
+    auto program = parser.parse();
+
+    if (parse_cache) {
+        parse_cache->store(source, *program, lexer.errors(), parser.errors(),
+                           lexer.token_counts());
+    }
+    if (token_counts) {
+        *token_counts = lexer.token_counts();
+    }
+    if (!report_errors(lexer.errors(), parser.errors())) {
+        return nullptr;
+    }
+    return program;
+}
+
+void run_parser(const std::string& path, bool print_ast) {
+    auto program = load_program(path);
+
+    if (program) {
         if (print_ast) {
             tiger::AstPrinter printer(std::cout);
             printer.print(*program);
@@ -70,15 +162,191 @@ void run_parser(const std::string& source, bool print_ast) {
     }
 }
 
+// Returns false if the program did not parse or did not type-check.
+bool run_check(const std::string& path, unsigned jobs) {
+    auto program = load_program(path);
+    if (!program) return false;
+
+    std::unique_ptr<tiger::ThreadPool> pool;
+    if (jobs > 1) pool = std::make_unique<tiger::ThreadPool>(jobs);
+    tiger::semantic::TypeChecker checker(pool.get());
+    if (!checker.check(*program)) {
+        std::cerr << "Type errors:\n";
+        for (const auto& err : checker.errors()) {
+            std::cerr << "  " << err << "\n";
+        }
+        return false;
+    }
+    std::cout << "Type checking successful!\n";
+    return true;
+}
+
+// Optimizations run before interpreting, from the command line.
+struct RunOptions {
+    bool fold = false;
+    bool dce = false;
+    bool peval = false;
+    bool memoize = false;
+};
+
+// Exit status of the program: its exit() argument, or 1 if it did not
+// compile or stopped on a runtime error.
+int run_program(const std::string& path, const RunOptions& opts) {
+    auto program = load_program(path);
+    if (!program) return 1;
+
+    tiger::semantic::TypeChecker checker;
+    if (!checker.check(*program)) {
+        std::cerr << "Type errors:\n";
+        for (const auto& err : checker.errors()) {
+            std::cerr << "  " << err << "\n";
+        }
+        return 1;
+    }
+
+    // Folding first leaves constant tests for DCE, which must precede
+    // resolution (it removes declarations the Resolver would number).
+    if (opts.fold) {
+        tiger::ConstantFolder folder;
+        folder.fold(*program);
+    }
+    if (opts.dce) {
+        tiger::DeadCodeEliminator eliminator;
+        eliminator.eliminate(*program);
+    }
+    tiger::semantic::Resolver resolver;
+    resolver.resolve(*program);
+    tiger::semantic::Purity purity;
+    if (opts.memoize || opts.peval) purity.analyze(*program, resolver);
+    if (opts.peval) {
+        tiger::PartialEvaluator evaluator;
+        evaluator.evaluate(*program, resolver, purity);
+    }
+    tiger::Interpreter::Options options;
+    if (opts.memoize) options.memoize = &purity;
+    tiger::Interpreter interpreter(std::cout, std::cin, options);
+    if (!interpreter.run(*program, resolver)) {
+        std::cerr << "Runtime error:\n";
+        for (const auto& err : interpreter.errors()) {
+            std::cerr << "  " << err << "\n";
+        }
+        return 1;
+    }
+    return interpreter.exit_code();
+}
+
+// Returns false if the program did not parse or did not type-check.
+bool run_ir(const std::string& path, const RunOptions& opts) {
+    auto program = load_program(path);
+    if (!program) return false;
+
+    tiger::semantic::TypeChecker checker;
+    if (!checker.check(*program)) {
+        std::cerr << "Type errors:\n";
+        for (const auto& err : checker.errors()) {
+            std::cerr << "  " << err << "\n";
+        }
+        return false;
+    }
+    if (opts.fold) {
+        tiger::ConstantFolder folder;
+        folder.fold(*program);
+    }
+    if (opts.dce) {
+        tiger::DeadCodeEliminator eliminator;
+        eliminator.eliminate(*program);
+    }
+    tiger::semantic::Resolver resolver;
+    resolver.resolve(*program);
+    tiger::ir::Translator translator(checker);
+    std::cout << translator.translate(*program, resolver).dump();
+    return true;
+}
+
+// Returns false if the program did not parse or, with dce, did not
+// type-check: DCE relies on the checker's scoping and types.
+bool run_ast_stats(const std::string& path, bool json, bool dce) {
+    std::array<size_t, tiger::TOKEN_TYPE_COUNT> token_counts{};
+    auto program = load_program(path, &token_counts);
+    if (!program) return false;
+
+    if (dce) {
+        tiger::semantic::TypeChecker checker;
+        if (!checker.check(*program)) {
+            std::cerr << "Type errors:\n";
+            for (const auto& err : checker.errors()) {
+                std::cerr << "  " << err << "\n";
+            }
+            return false;
+        }
+        tiger::DeadCodeEliminator eliminator;
+        eliminator.eliminate(*program);
+        std::cerr << "dce: removed " << eliminator.removed_nodes() << " nodes: "
+                  << eliminator.removed_decs(tiger::DecKind::VAR) << " variables, "
+                  << eliminator.removed_decs(tiger::DecKind::FUNCTION) << " functions, "
+                  << eliminator.removed_decs(tiger::DecKind::TYPE) << " types, "
+                  << eliminator.removed_branches() << " constant branches, "
+                  << eliminator.removed_after_break() << " expressions after break\n";
+    }
+    // Sets the escape flags the stats count.
+    tiger::semantic::Resolver resolver;
+    resolver.resolve(*program);
+    tiger::AstStatsCollector collector;
+    tiger::AstStats stats = collector.collect(*program);
+    stats.tokens = token_counts;
+    if (json) {
+        stats.write_json(std::cout);
+    } else {
+        stats.write_text(std::cout);
+    }
+    return true;
+}
+
+// Writes the AST in binary form, or as AstPrinter's text, to `output`
+// (stdout if empty).
+void run_emit(const std::string& path, const std::string& output, bool binary) {
+    auto program = load_program(path);
+    if (!program) return;
+
+    std::ofstream file;
+    if (!output.empty()) {
+        file.open(output, binary ? std::ios::binary : std::ios::out);
+        if (!file) {
+            std::cerr << "Error: cannot open output file: " << output << "\n";
+            exit(1);
+        }
+    }
+    std::ostream& os = output.empty() ? std::cout : file;
+
+    if (binary) {
+        tiger::AstBinaryWriter writer;
+        writer.write(*program, os);
+    } else {
+        tiger::AstPrinter printer(os);
+        printer.print(*program);
+    }
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
         print_usage(argv[0]);
         return 1;
     }
 
-    enum class Mode { LEX, PARSE, AST };
+    enum class Mode { LEX, PARSE, AST, CHECK, RUN, IR, AST_STATS, EMIT_BIN, EMIT_TEXT };
     Mode mode = Mode::PARSE;
     std::string filename;
+    std::string output;
+    std::string cache_dir;
+    std::uint64_t cache_size = tiger::ParseCache::DEFAULT_MAX_BYTES;
+    bool cache_stats = false;
+    unsigned jobs = 1;
+    RunOptions run_options;
+
+    if (const char* env = std::getenv("TIGER_CACHE_DIR")) {
+        cache_dir = env;
+    }
+    bool json = false;
 
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -88,6 +356,40 @@ int main(int argc, char* argv[]) {
             mode = Mode::PARSE;
         } else if (arg == "--ast") {
             mode = Mode::AST;
+        } else if (arg == "--check") {
+            mode = Mode::CHECK;
+        } else if (arg == "--run") {
+            mode = Mode::RUN;
+        } else if (arg == "--ir") {
+            mode = Mode::IR;
+        } else if (arg == "--memoize") {
+            run_options.memoize = true;
+        } else if (arg == "--fold") {
+            run_options.fold = true;
+        } else if (arg == "--dce") {
+            run_options.dce = true;
+        } else if (arg == "--peval") {
+            run_options.peval = true;
+        } else if (arg == "--ast-stats" || arg == "--ast-stats=text") {
+            mode = Mode::AST_STATS;
+        } else if (arg == "--ast-stats=json") {
+            mode = Mode::AST_STATS;
+            json = true;
+        } else if (arg == "--emit-ast=bin") {
+            mode = Mode::EMIT_BIN;
+        } else if (arg == "--emit-ast=text") {
+            mode = Mode::EMIT_TEXT;
+        } else if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (arg == "--cache-size" && i + 1 < argc) {
+            cache_size = std::strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            jobs = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+        } else if (arg == "--cache-stats") {
+            cache_stats = true;
         } else if (arg == "--help" || arg == "-h") {
             print_usage(argv[0]);
             return 0;
@@ -101,19 +403,52 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    std::string source = read_file(filename);
+    if (!cache_dir.empty()) {
+        parse_cache = std::make_unique<tiger::ParseCache>(cache_dir, cache_size);
+        if (!parse_cache->enabled()) {
+            std::cerr << "Warning: cannot use cache directory: " << cache_dir << "\n";
+            parse_cache.reset();
+        }
+    }
 
+    int status = 0;
     switch (mode) {
         case Mode::LEX:
-            run_lexer(source);
+            run_lexer(read_file(filename));
             break;
         case Mode::PARSE:
-            run_parser(source, false);
+            run_parser(filename, false);
             break;
         case Mode::AST:
-            run_parser(source, true);
+            run_parser(filename, true);
+            break;
+        case Mode::CHECK:
+            status = run_check(filename, jobs) ? 0 : 1;
+            break;
+        case Mode::RUN:
+            status = run_program(filename, run_options);
+            break;
+        case Mode::IR:
+            status = run_ir(filename, run_options) ? 0 : 1;
             break;
+        case Mode::AST_STATS:
+            status = run_ast_stats(filename, json, run_options.dce) ? 0 : 1;
+            break;
+        case Mode::EMIT_BIN:
+            run_emit(filename, output, true);
+            break;
+        case Mode::EMIT_TEXT:
+            run_emit(filename, output, false);
+            break;
+    }
+
+    if (cache_stats && parse_cache) {
+        std::cerr << "cache: " << parse_cache->hits() << " hits, "
+                  << parse_cache->misses() << " misses, "
+                  << parse_cache->evictions() << " evictions, "
+                  << parse_cache->entry_count() << " entries, "
+                  << parse_cache->size_bytes() << " bytes\n";
     }
 
-    return 0;
+    return status;
 }
@@ -0,0 +1,236 @@
+#include "opt/ConstantFolder.hpp"
+#include "interp/Arith.hpp"
+#include <memory>
+
+namespace tiger {
+
+namespace {
+
+bool is_int(const Exp& exp, int value) {
+    return exp.kind == ExpKind::INT && static_cast<const IntExp&>(exp).value == value;
+}
+
+// If `exp` is the parser's encoding of -x, i.e. 0 - x, its x.
+ExpPtr* negated(ExpPtr& exp) {
+    if (exp->kind != ExpKind::OP) return nullptr;
+    auto& op = static_cast<OpExp&>(*exp);
+    return op.op == Op::MINUS && is_int(*op.left, 0) ? &op.right : nullptr;
+}
+
+} // namespace
+
+void ConstantFolder::fold(Program& prog) {
+    folded_ops_ = 0;
+    identities_ = 0;
+    folded_ifs_ = 0;
+    if (prog.exp) visit(prog.exp);
+}
+
+bool ConstantFolder::side_effect_free(const Exp& exp) {
+    switch (exp.kind) {
+        case ExpKind::INT:
+        case ExpKind::STRING:
+        case ExpKind::NIL:
+            return true;
+        case ExpKind::VAR:
+            return static_cast<const VarExp&>(exp).var->kind == VarKind::SIMPLE;
+        case ExpKind::OP: {
+            auto& op = static_cast<const OpExp&>(exp);
+            if (op.op == Op::DIVIDE && (op.right->kind != ExpKind::INT || is_int(*op.right, 0)))
+                return false;
+            return side_effect_free(*op.left) && side_effect_free(*op.right);
+        }
+        default:
+            return false;
+    }
+}
+
+// ============================================================================
+// Folding
+// ============================================================================
+
+void ConstantFolder::fold_op(ExpPtr& exp) {
+    auto& op = static_cast<OpExp&>(*exp);
+    const Exp& left = *op.left;
+    const Exp& right = *op.right;
+
+    if (left.kind == ExpKind::INT && right.kind == ExpKind::INT) {
+        int32_t result;
+        if (!arith::apply(op.op, static_cast<const IntExp&>(left).value,
+                          static_cast<const IntExp&>(right).value, result))
+            return;   // division by zero: keep the trap for run time
+        exp = std::make_unique<IntExp>(result, op.pos);
+        folded_ops_++;
+        return;
+    }
+
+    if (left.kind == ExpKind::STRING && right.kind == ExpKind::STRING) {
+        int order = static_cast<const StringExp&>(left).value.compare(
+            static_cast<const StringExp&>(right).value);
+        exp = std::make_unique<IntExp>(arith::compare(op.op, order), op.pos);
+        folded_ops_++;
+        return;
+    }
+
+    ExpPtr* keep = nullptr;   // the operand the whole OpExp reduces to
+    switch (op.op) {
+        case Op::PLUS:
+            if (is_int(right, 0)) keep = &op.left;
+            else if (is_int(left, 0)) keep = &op.right;
+            break;
+        case Op::MINUS:
+            if (is_int(right, 0)) keep = &op.left;
+            else if (is_int(left, 0)) keep = negated(op.right);
+            break;
+        case Op::TIMES:
+            if (is_int(right, 1)) {
+                keep = &op.left;
+            } else if (is_int(left, 1)) {
+                keep = &op.right;
+            } else if ((is_int(right, 0) && side_effect_free(left)) ||
+                       (is_int(left, 0) && side_effect_free(right))) {
+                exp = std::make_unique<IntExp>(0, op.pos);
+                identities_++;
+                return;
+            }
+            break;
+        case Op::DIVIDE:
+            if (is_int(right, 1)) keep = &op.left;
+            break;
+        default:
+            break;
+    }
+    if (keep) {
+        ExpPtr kept = std::move(*keep);
+        exp = std::move(kept);
+        identities_++;
+    }
+}
+
+bool ConstantFolder::take_branch(ExpPtr& exp) {
+    if (exp->kind != ExpKind::IF) return false;
+    auto& if_exp = static_cast<IfExp&>(*exp);
+    if (if_exp.test->kind != ExpKind::INT) return false;
+
+    ExpPtr taken;
+    if (static_cast<const IntExp&>(*if_exp.test).value != 0)
+        taken = std::move(if_exp.then_exp);
+    else if (if_exp.else_exp)
+        taken = std::move(if_exp.else_exp);
+    else
+        taken = std::make_unique<SeqExp>(std::vector<ExpPtr>{}, if_exp.pos);
+    exp = std::move(taken);
+    return true;
+}
+
+// ============================================================================
+// Walk
+// ============================================================================
+
+void ConstantFolder::visit(ExpPtr& exp) {
+    switch (exp->kind) {
+        case ExpKind::VAR:
+            visit(*static_cast<VarExp&>(*exp).var);
+            break;
+
+        case ExpKind::NIL:
+        case ExpKind::INT:
+        case ExpKind::STRING:
+        case ExpKind::BREAK:
+            break;
+
+        case ExpKind::CALL:
+            for (auto& arg : static_cast<CallExp&>(*exp).args) visit(arg);
+            break;
+
+        case ExpKind::OP: {
+            auto& op = static_cast<OpExp&>(*exp);
+            visit(op.left);
+            visit(op.right);
+            fold_op(exp);
+            break;
+        }
+
+        case ExpKind::RECORD:
+            for (auto& field : static_cast<RecordExp&>(*exp).fields) visit(field.exp);
+            break;
+
+        case ExpKind::SEQ:
+            for (auto& e : static_cast<SeqExp&>(*exp).exps) visit(e);
+            break;
+
+        case ExpKind::ASSIGN: {
+            auto& assign = static_cast<AssignExp&>(*exp);
+            visit(*assign.var);
+            visit(assign.exp);
+            break;
+        }
+
+        case ExpKind::IF: {
+            auto& if_exp = static_cast<IfExp&>(*exp);
+            visit(if_exp.test);
+            visit(if_exp.then_exp);
+            if (if_exp.else_exp) visit(if_exp.else_exp);
+            if (take_branch(exp)) folded_ifs_++;
+            break;
+        }
+
+        case ExpKind::WHILE: {
+            auto& loop = static_cast<WhileExp&>(*exp);
+            visit(loop.test);
+            visit(loop.body);
+            break;
+        }
+
+        case ExpKind::FOR: {
+            auto& loop = static_cast<ForExp&>(*exp);
+            visit(loop.lo);
+            visit(loop.hi);
+            visit(loop.body);
+            break;
+        }
+
+        case ExpKind::LET: {
+            auto& let = static_cast<LetExp&>(*exp);
+            visit(let.decs);
+            for (auto& e : let.body) visit(e);
+            break;
+        }
+
+        case ExpKind::ARRAY: {
+            auto& array = static_cast<ArrayExp&>(*exp);
+            visit(array.size);
+            visit(array.init);
+            break;
+        }
+    }
+}
+
+void ConstantFolder::visit(Var& var) {
+    switch (var.kind) {
+        case VarKind::SIMPLE:
+            break;
+        case VarKind::FIELD:
+            visit(*static_cast<FieldVar&>(var).var);
+            break;
+        case VarKind::SUBSCRIPT: {
+            auto& sub = static_cast<SubscriptVar&>(var);
+            visit(*sub.var);
+            visit(sub.index);
+            break;
+        }
+    }
+}
+
+void ConstantFolder::visit(std::vector<DecPtr>& decs) {
+    for (auto& dec : decs) {
+        if (dec->kind == DecKind::VAR) {
+            visit(static_cast<VarDec&>(*dec).init);
+        } else if (dec->kind == DecKind::FUNCTION) {
+            auto& function = static_cast<FunctionDec&>(*dec);
+            if (function.body) visit(function.body);
+        }
+    }
+}
+
+} // namespace tiger
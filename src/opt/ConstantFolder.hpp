@@ -0,0 +1,59 @@
+#ifndef TIGER_CONSTANT_FOLDER_HPP
+#define TIGER_CONSTANT_FOLDER_HPP
+
+// ============================================================================
+// Constant folding and algebraic simplification on the AST.
+//
+// Bottom-up, so a folded operand lets its parent fold too:
+//   - an OpExp on two int literals becomes the literal it evaluates to,
+//     with the Interpreter's semantics (arith::apply: 32-bit wraparound);
+//     a division by zero is left to trap at run time
+//   - a comparison of two string literals becomes 1 or 0
+//   - identities: x + 0, 0 + x, x - 0, x * 1, 1 * x, x / 1 become x, and
+//     0 - (0 - x), the parser's --x, becomes x; x * 0 and 0 * x become 0
+//     only if x is side-effect free (literals, simple variables, and
+//     arithmetic on them that cannot trap), since x is no longer evaluated
+//   - an IfExp whose test is an int literal becomes the branch taken, or
+//     () when that is a missing else
+// The unary minus is parsed as 0 - x, so -1 is folded to the literal -1.
+//
+// Runs after type checking (the identities rely on operands being ints)
+// and keeps the Resolver's annotations of the nodes it keeps. The result
+// need not type-check again: `if 1 then nil else r` becomes `nil`.
+// ============================================================================
+
+#include "parser/AST.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace tiger {
+
+class ConstantFolder {
+public:
+    void fold(Program& prog);
+
+    std::size_t folded_ops() const { return folded_ops_; }   // to a literal
+    std::size_t identities() const { return identities_; }
+    std::size_t folded_ifs() const { return folded_ifs_; }
+
+    // True if evaluating `exp` can neither trap nor have an effect.
+    static bool side_effect_free(const Exp& exp);
+
+    // If `exp` is an IfExp whose test is an int literal, replaces it with
+    // the branch taken, or () for a missing else, and returns true.
+    static bool take_branch(ExpPtr& exp);
+
+private:
+    std::size_t folded_ops_ = 0;
+    std::size_t identities_ = 0;
+    std::size_t folded_ifs_ = 0;
+
+    void visit(ExpPtr& exp);
+    void visit(Var& var);
+    void visit(std::vector<DecPtr>& decs);
+    void fold_op(ExpPtr& exp);
+};
+
+} // namespace tiger
+
+#endif // TIGER_CONSTANT_FOLDER_HPP
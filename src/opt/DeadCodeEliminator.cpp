@@ -0,0 +1,647 @@
+#include "opt/DeadCodeEliminator.hpp"
+#include "opt/ConstantFolder.hpp"
+#include <memory>
+
+namespace tiger {
+
+void DeadCodeEliminator::eliminate(Program& prog) {
+    nodes_.clear();
+    node_of_.clear();
+    lets_.clear();
+    roots_.clear();
+    owners_.assign(1, nullptr);
+    removed_decs_.fill(0);
+    removed_branches_ = 0;
+    removed_after_break_ = 0;
+    removed_nodes_ = 0;
+    if (!prog.exp) return;
+
+    prune(prog.exp);
+
+    values_.beginScope();
+    types_.beginScope();
+    collect(*prog.exp);
+    types_.endScope();
+    values_.endScope();
+
+    for (Node* root : roots_) mark(root);
+    while (keep_separators()) {}
+
+    sweep(*prog.exp);
+}
+
+// ============================================================================
+// Unreachable code
+// ============================================================================
+
+bool DeadCodeEliminator::always_breaks(const Exp& exp) {
+    switch (exp.kind) {
+        case ExpKind::BREAK:
+            return true;
+        case ExpKind::SEQ: {
+            auto& seq = static_cast<const SeqExp&>(exp);
+            return !seq.exps.empty() && always_breaks(*seq.exps.back());
+        }
+        case ExpKind::LET: {
+            auto& let = static_cast<const LetExp&>(exp);
+            return !let.body.empty() && always_breaks(*let.body.back());
+        }
+        case ExpKind::IF: {
+            auto& if_exp = static_cast<const IfExp&>(exp);
+            return if_exp.else_exp && always_breaks(*if_exp.then_exp) &&
+                   always_breaks(*if_exp.else_exp);
+        }
+        default:
+            return false;
+    }
+}
+
+// Prunes each expression, then drops those after the first that always
+// breaks.
+void DeadCodeEliminator::prune(std::vector<ExpPtr>& exps) {
+    for (std::size_t i = 0; i < exps.size(); i++) {
+        prune(exps[i]);
+        if (always_breaks(*exps[i]) && i + 1 < exps.size()) {
+            for (std::size_t j = i + 1; j < exps.size(); j++) removed_nodes_ += count(*exps[j]);
+            removed_after_break_ += exps.size() - i - 1;
+            exps.resize(i + 1);
+        }
+    }
+}
+
+void DeadCodeEliminator::prune(ExpPtr& exp) {
+    switch (exp->kind) {
+        case ExpKind::VAR:
+            prune(*static_cast<VarExp&>(*exp).var);
+            break;
+
+        case ExpKind::NIL:
+        case ExpKind::INT:
+        case ExpKind::STRING:
+        case ExpKind::BREAK:
+            break;
+
+        case ExpKind::CALL:
+            for (auto& arg : static_cast<CallExp&>(*exp).args) prune(arg);
+            break;
+
+        case ExpKind::OP: {
+            auto& op = static_cast<OpExp&>(*exp);
+            prune(op.left);
+            prune(op.right);
+            break;
+        }
+
+        case ExpKind::RECORD:
+            for (auto& field : static_cast<RecordExp&>(*exp).fields) prune(field.exp);
+            break;
+
+        case ExpKind::SEQ:
+            prune(static_cast<SeqExp&>(*exp).exps);
+            break;
+
+        case ExpKind::ASSIGN: {
+            auto& assign = static_cast<AssignExp&>(*exp);
+            prune(*assign.var);
+            prune(assign.exp);
+            break;
+        }
+
+        case ExpKind::IF: {
+            auto& if_exp = static_cast<IfExp&>(*exp);
+            prune(if_exp.test);
+            if (if_exp.test->kind != ExpKind::INT) {
+                prune(if_exp.then_exp);
+                if (if_exp.else_exp) prune(if_exp.else_exp);
+                break;
+            }
+            std::size_t before = count(*exp);
+            ConstantFolder::take_branch(exp);
+            removed_nodes_ += before - count(*exp);
+            removed_branches_++;
+            prune(exp);
+            break;
+        }
+
+        case ExpKind::WHILE: {
+            auto& loop = static_cast<WhileExp&>(*exp);
+            prune(loop.test);
+            prune(loop.body);
+            break;
+        }
+
+        case ExpKind::FOR: {
+            auto& loop = static_cast<ForExp&>(*exp);
+            prune(loop.lo);
+            prune(loop.hi);
+            prune(loop.body);
+            break;
+        }
+
+        case ExpKind::LET: {
+            auto& let = static_cast<LetExp&>(*exp);
+            for (auto& dec : let.decs) {
+                if (dec->kind == DecKind::VAR) {
+                    prune(static_cast<VarDec&>(*dec).init);
+                } else if (dec->kind == DecKind::FUNCTION) {
+                    auto& function = static_cast<FunctionDec&>(*dec);
+                    if (function.body) prune(function.body);
+                }
+            }
+            prune(let.body);
+            break;
+        }
+
+        case ExpKind::ARRAY: {
+            auto& array = static_cast<ArrayExp&>(*exp);
+            prune(array.size);
+            prune(array.init);
+            break;
+        }
+    }
+}
+
+void DeadCodeEliminator::prune(Var& var) {
+    if (var.kind == VarKind::FIELD) {
+        prune(*static_cast<FieldVar&>(var).var);
+    } else if (var.kind == VarKind::SUBSCRIPT) {
+        auto& sub = static_cast<SubscriptVar&>(var);
+        prune(*sub.var);
+        prune(sub.index);
+    }
+}
+
+// ============================================================================
+// Use graph
+// ============================================================================
+
+DeadCodeEliminator::Node* DeadCodeEliminator::new_node(const Dec& dec) {
+    nodes_.emplace_back();
+    node_of_[&dec] = &nodes_.back();
+    return &nodes_.back();
+}
+
+void DeadCodeEliminator::use(Node* node) {
+    if (!node) return;   // a library name, parameter or loop counter
+    if (Node* owner = owners_.back()) owner->uses.push_back(node);
+    else roots_.push_back(node);
+}
+
+void DeadCodeEliminator::use_type(const std::string& name) {
+    if (!name.empty()) use(types_.look(Symbol::intern(name)));
+}
+
+// Conservative: only what ConstantFolder calls side-effect free, and
+// records and arrays of literal size built from such values, is known
+// not to have an effect (or trap).
+bool DeadCodeEliminator::may_have_effect(const Exp& exp) {
+    switch (exp.kind) {
+        case ExpKind::RECORD:
+            for (const auto& field : static_cast<const RecordExp&>(exp).fields)
+                if (may_have_effect(*field.exp)) return true;
+            return false;
+        case ExpKind::ARRAY: {
+            auto& array = static_cast<const ArrayExp&>(exp);
+            return array.size->kind != ExpKind::INT ||
+                   static_cast<const IntExp&>(*array.size).value < 0 ||
+                   may_have_effect(*array.init);
+        }
+        case ExpKind::SEQ:
+            for (const auto& e : static_cast<const SeqExp&>(exp).exps)
+                if (may_have_effect(*e)) return true;
+            return false;
+        default:
+            return !ConstantFolder::side_effect_free(exp);
+    }
+}
+
+void DeadCodeEliminator::collect(Exp& exp) {
+    switch (exp.kind) {
+        case ExpKind::VAR:
+            collect(*static_cast<VarExp&>(exp).var);
+            break;
+
+        case ExpKind::NIL:
+        case ExpKind::INT:
+        case ExpKind::STRING:
+        case ExpKind::BREAK:
+            break;
+
+        case ExpKind::CALL: {
+            auto& call = static_cast<CallExp&>(exp);
+            use(values_.look(Symbol::intern(call.func)));
+            for (auto& arg : call.args) collect(*arg);
+            break;
+        }
+
+        case ExpKind::OP: {
+            auto& op = static_cast<OpExp&>(exp);
+            collect(*op.left);
+            collect(*op.right);
+            break;
+        }
+
+        case ExpKind::RECORD: {
+            auto& rec = static_cast<RecordExp&>(exp);
+            use_type(rec.type_id);
+            for (auto& field : rec.fields) collect(*field.exp);
+            break;
+        }
+
+        case ExpKind::SEQ:
+            for (auto& e : static_cast<SeqExp&>(exp).exps) collect(*e);
+            break;
+
+        case ExpKind::ASSIGN: {
+            auto& assign = static_cast<AssignExp&>(exp);
+            collect(*assign.var);
+            collect(*assign.exp);
+            break;
+        }
+
+        case ExpKind::IF: {
+            auto& if_exp = static_cast<IfExp&>(exp);
+            collect(*if_exp.test);
+            collect(*if_exp.then_exp);
+            if (if_exp.else_exp) collect(*if_exp.else_exp);
+            break;
+        }
+
+        case ExpKind::WHILE: {
+            auto& loop = static_cast<WhileExp&>(exp);
+            collect(*loop.test);
+            collect(*loop.body);
+            break;
+        }
+
+        case ExpKind::FOR: {
+            auto& loop = static_cast<ForExp&>(exp);
+            collect(*loop.lo);
+            collect(*loop.hi);
+            values_.beginScope();
+            values_.enter(Symbol::intern(loop.var), nullptr);
+            collect(*loop.body);
+            values_.endScope();
+            break;
+        }
+
+        case ExpKind::LET: {
+            auto& let = static_cast<LetExp&>(exp);
+            values_.beginScope();
+            types_.beginScope();
+            lets_.push_back({&let.decs, owners_.back()});
+            collect(let.decs);
+            for (auto& e : let.body) collect(*e);
+            types_.endScope();
+            values_.endScope();
+            break;
+        }
+
+        case ExpKind::ARRAY: {
+            auto& array = static_cast<ArrayExp&>(exp);
+            use_type(array.type_id);
+            collect(*array.size);
+            collect(*array.init);
+            break;
+        }
+    }
+}
+
+void DeadCodeEliminator::collect(const Var& var) {
+    switch (var.kind) {
+        case VarKind::SIMPLE:
+            use(values_.look(Symbol::intern(static_cast<const SimpleVar&>(var).name)));
+            break;
+        case VarKind::FIELD:
+            collect(*static_cast<const FieldVar&>(var).var);
+            break;
+        case VarKind::SUBSCRIPT: {
+            auto& sub = static_cast<const SubscriptVar&>(var);
+            collect(*sub.var);
+            collect(*sub.index);
+            break;
+        }
+    }
+}
+
+void DeadCodeEliminator::collect(const Ty& ty) {
+    switch (ty.kind) {
+        case TyKind::NAME:
+            use_type(static_cast<const NameTy&>(ty).name);
+            break;
+        case TyKind::RECORD:
+            for (const auto& field : static_cast<const RecordTy&>(ty).fields)
+                use_type(field.type_id);
+            break;
+        case TyKind::ARRAY:
+            use_type(static_cast<const ArrayTy&>(ty).element_type);
+            break;
+    }
+}
+
+// Batches as in TypeChecker::check_decs: a batch's types, or functions,
+// are all bound before any of them is walked.
+void DeadCodeEliminator::collect(std::vector<DecPtr>& decs) {
+    std::size_t i = 0;
+    while (i < decs.size()) {
+        DecKind kind = decs[i]->kind;
+        std::size_t end = i + 1;
+        while (kind != DecKind::VAR && end < decs.size() && decs[end]->kind == kind) end++;
+
+        if (kind == DecKind::VAR) {
+            auto& var = static_cast<VarDec&>(*decs[i]);
+            Node* node = new_node(var);
+            if (may_have_effect(*var.init)) use(node);
+            owners_.push_back(node);
+            use_type(var.type_id);
+            collect(*var.init);
+            owners_.pop_back();
+            values_.enter(Symbol::intern(var.name), node);
+        } else if (kind == DecKind::TYPE) {
+            std::size_t first = nodes_.size();
+            for (std::size_t j = i; j < end; j++) {
+                Node* node = new_node(*decs[j]);
+                types_.enter(Symbol::intern(static_cast<TypeDec&>(*decs[j]).name), node);
+            }
+            for (std::size_t j = i; j < end; j++) {
+                owners_.push_back(&nodes_[first + (j - i)]);
+                collect(*static_cast<TypeDec&>(*decs[j]).ty);
+                owners_.pop_back();
+            }
+        } else {
+            std::size_t first = nodes_.size();
+            for (std::size_t j = i; j < end; j++) {
+                Node* node = new_node(*decs[j]);
+                values_.enter(Symbol::intern(static_cast<FunctionDec&>(*decs[j]).name), node);
+            }
+            for (std::size_t j = i; j < end; j++) {
+                auto& function = static_cast<FunctionDec&>(*decs[j]);
+                owners_.push_back(&nodes_[first + (j - i)]);
+                for (const auto& param : function.params) use_type(param.type_id);
+                use_type(function.result_type);
+                values_.beginScope();
+                for (const auto& param : function.params)
+                    values_.enter(Symbol::intern(param.name), nullptr);
+                if (function.body) collect(*function.body);
+                values_.endScope();
+                owners_.pop_back();
+            }
+        }
+        i = end;
+    }
+}
+
+void DeadCodeEliminator::mark(Node* node) {
+    if (node->live) return;
+    std::vector<Node*> work{node};
+    node->live = true;
+    while (!work.empty()) {
+        Node* n = work.back();
+        work.pop_back();
+        for (Node* used : n->uses) {
+            if (!used->live) {
+                used->live = true;
+                work.push_back(used);
+            }
+        }
+    }
+}
+
+// Marks the first dead declaration between two live ones of the same
+// batch kind that another kind separates; true if it marked any.
+bool DeadCodeEliminator::keep_separators() {
+    bool marked = false;
+    for (const DecList& list : lets_) {
+        if (list.owner && !list.owner->live) continue;   // removed whole
+        const std::vector<DecPtr>& decs = *list.decs;
+        std::size_t prev = decs.size();   // last live declaration
+        for (std::size_t i = 0; i < decs.size(); i++) {
+            if (!live(*decs[i])) continue;
+            if (prev != decs.size() && decs[i]->kind != DecKind::VAR &&
+                decs[prev]->kind == decs[i]->kind) {
+                for (std::size_t j = prev + 1; j < i; j++) {
+                    if (decs[j]->kind != decs[i]->kind) {
+                        mark(node_of_.at(decs[j].get()));
+                        marked = true;
+                        break;
+                    }
+                }
+            }
+            prev = i;
+        }
+    }
+    return marked;
+}
+
+// ============================================================================
+// Removal
+// ============================================================================
+
+bool DeadCodeEliminator::live(const Dec& dec) const {
+    return node_of_.at(&dec)->live;
+}
+
+void DeadCodeEliminator::sweep(std::vector<DecPtr>& decs) {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < decs.size(); i++) {
+        if (!live(*decs[i])) {
+            removed_decs_[static_cast<std::size_t>(decs[i]->kind)]++;
+            removed_nodes_ += count(*decs[i]);
+            continue;
+        }
+        if (decs[i]->kind == DecKind::VAR) {
+            sweep(*static_cast<VarDec&>(*decs[i]).init);
+        } else if (decs[i]->kind == DecKind::FUNCTION) {
+            auto& function = static_cast<FunctionDec&>(*decs[i]);
+            if (function.body) sweep(*function.body);
+        }
+        decs[kept++] = std::move(decs[i]);
+    }
+    decs.resize(kept);
+}
+
+void DeadCodeEliminator::sweep(Exp& exp) {
+    switch (exp.kind) {
+        case ExpKind::VAR:
+            sweep(*static_cast<VarExp&>(exp).var);
+            break;
+
+        case ExpKind::NIL:
+        case ExpKind::INT:
+        case ExpKind::STRING:
+        case ExpKind::BREAK:
+            break;
+
+        case ExpKind::CALL:
+            for (auto& arg : static_cast<CallExp&>(exp).args) sweep(*arg);
+            break;
+
+        case ExpKind::OP: {
+            auto& op = static_cast<OpExp&>(exp);
+            sweep(*op.left);
+            sweep(*op.right);
+            break;
+        }
+
+        case ExpKind::RECORD:
+            for (auto& field : static_cast<RecordExp&>(exp).fields) sweep(*field.exp);
+            break;
+
+        case ExpKind::SEQ:
+            for (auto& e : static_cast<SeqExp&>(exp).exps) sweep(*e);
+            break;
+
+        case ExpKind::ASSIGN: {
+            auto& assign = static_cast<AssignExp&>(exp);
+            sweep(*assign.var);
+            sweep(*assign.exp);
+            break;
+        }
+
+        case ExpKind::IF: {
+            auto& if_exp = static_cast<IfExp&>(exp);
+            sweep(*if_exp.test);
+            sweep(*if_exp.then_exp);
+            if (if_exp.else_exp) sweep(*if_exp.else_exp);
+            break;
+        }
+
+        case ExpKind::WHILE: {
+            auto& loop = static_cast<WhileExp&>(exp);
+            sweep(*loop.test);
+            sweep(*loop.body);
+            break;
+        }
+
+        case ExpKind::FOR: {
+            auto& loop = static_cast<ForExp&>(exp);
+            sweep(*loop.lo);
+            sweep(*loop.hi);
+            sweep(*loop.body);
+            break;
+        }
+
+        case ExpKind::LET: {
+            auto& let = static_cast<LetExp&>(exp);
+            sweep(let.decs);
+            for (auto& e : let.body) sweep(*e);
+            break;
+        }
+
+        case ExpKind::ARRAY: {
+            auto& array = static_cast<ArrayExp&>(exp);
+            sweep(*array.size);
+            sweep(*array.init);
+            break;
+        }
+    }
+}
+
+void DeadCodeEliminator::sweep(Var& var) {
+    if (var.kind == VarKind::FIELD) {
+        sweep(*static_cast<FieldVar&>(var).var);
+    } else if (var.kind == VarKind::SUBSCRIPT) {
+        auto& sub = static_cast<SubscriptVar&>(var);
+        sweep(*sub.var);
+        sweep(*sub.index);
+    }
+}
+
+// ============================================================================
+// Node counts
+// ============================================================================
+
+std::size_t DeadCodeEliminator::count(const Exp& exp) {
+    std::size_t n = 1;
+    switch (exp.kind) {
+        case ExpKind::VAR:
+            n += count(*static_cast<const VarExp&>(exp).var);
+            break;
+        case ExpKind::NIL:
+        case ExpKind::INT:
+        case ExpKind::STRING:
+        case ExpKind::BREAK:
+            break;
+        case ExpKind::CALL:
+            for (const auto& arg : static_cast<const CallExp&>(exp).args) n += count(*arg);
+            break;
+        case ExpKind::OP: {
+            auto& op = static_cast<const OpExp&>(exp);
+            n += count(*op.left) + count(*op.right);
+            break;
+        }
+        case ExpKind::RECORD:
+            for (const auto& field : static_cast<const RecordExp&>(exp).fields)
+                n += count(*field.exp);
+            break;
+        case ExpKind::SEQ:
+            for (const auto& e : static_cast<const SeqExp&>(exp).exps) n += count(*e);
+            break;
+        case ExpKind::ASSIGN: {
+            auto& assign = static_cast<const AssignExp&>(exp);
+            n += count(*assign.var) + count(*assign.exp);
+            break;
+        }
+        case ExpKind::IF: {
+            auto& if_exp = static_cast<const IfExp&>(exp);
+            n += count(*if_exp.test) + count(*if_exp.then_exp);
+            if (if_exp.else_exp) n += count(*if_exp.else_exp);
+            break;
+        }
+        case ExpKind::WHILE: {
+            auto& loop = static_cast<const WhileExp&>(exp);
+            n += count(*loop.test) + count(*loop.body);
+            break;
+        }
+        case ExpKind::FOR: {
+            auto& loop = static_cast<const ForExp&>(exp);
+            n += count(*loop.lo) + count(*loop.hi) + count(*loop.body);
+            break;
+        }
+        case ExpKind::LET: {
+            auto& let = static_cast<const LetExp&>(exp);
+            for (const auto& dec : let.decs) n += count(*dec);
+            for (const auto& e : let.body) n += count(*e);
+            break;
+        }
+        case ExpKind::ARRAY: {
+            auto& array = static_cast<const ArrayExp&>(exp);
+            n += count(*array.size) + count(*array.init);
+            break;
+        }
+    }
+    return n;
+}
+
+std::size_t DeadCodeEliminator::count(const Var& var) {
+    switch (var.kind) {
+        case VarKind::FIELD:
+            return 1 + count(*static_cast<const FieldVar&>(var).var);
+        case VarKind::SUBSCRIPT: {
+            auto& sub = static_cast<const SubscriptVar&>(var);
+            return 1 + count(*sub.var) + count(*sub.index);
+        }
+        default:
+            return 1;
+    }
+}
+
+std::size_t DeadCodeEliminator::count(const Dec& dec) {
+    switch (dec.kind) {
+        case DecKind::VAR:
+            return 1 + count(*static_cast<const VarDec&>(dec).init);
+        case DecKind::TYPE:
+            return 1 + count(*static_cast<const TypeDec&>(dec).ty);
+        case DecKind::FUNCTION: {
+            auto& function = static_cast<const FunctionDec&>(dec);
+            return 1 + (function.body ? count(*function.body) : 0);
+        }
+    }
+    return 1;
+}
+
+std::size_t DeadCodeEliminator::count(const Ty&) {
+    return 1;
+}
+
+} // namespace tiger
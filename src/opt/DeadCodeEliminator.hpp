@@ -0,0 +1,110 @@
+#ifndef TIGER_DEAD_CODE_ELIMINATOR_HPP
+#define TIGER_DEAD_CODE_ELIMINATOR_HPP
+
+// ============================================================================
+// Removal of unreachable code and unused declarations.
+//
+// First unreachable code goes, bottom-up:
+//   - an IfExp whose test is an int literal becomes the branch taken (or
+//     () for a missing else): ConstantFolder::take_branch
+//   - in a SeqExp or let body, whatever follows an expression that always
+//     breaks (break itself, or a sequence, let or if that ends in one)
+//
+// Then a use graph over the declarations of every `let`: a declaration
+// uses the declarations its initializer, body or type mentions, and the
+// program expression (and each let body) uses what it mentions. A
+// variable whose initializer may have an effect (a call, an assignment,
+// an array of non-literal size, ...) counts as used by its let, so the
+// initializer still runs. Declarations not reachable from the program
+// expression are removed, with everything nested in them.
+//
+// Names are looked up with the type checker's scoping (batches of
+// functions and of types, a variable after its initializer), so this
+// needs no annotations and should run before semantic::Resolver: resolve
+// the tree it leaves. A dead declaration that separates two batches of
+// the same kind is kept, since merging them could change what a name in
+// them refers to.
+// ============================================================================
+
+#include "env/symbol.hpp"
+#include "parser/AST.hpp"
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace tiger {
+
+class DeadCodeEliminator {
+public:
+    void eliminate(Program& prog);
+
+    std::size_t removed_decs(DecKind kind) const {
+        return removed_decs_[static_cast<std::size_t>(kind)];
+    }
+    std::size_t removed_branches() const { return removed_branches_; }     // constant ifs
+    std::size_t removed_after_break() const { return removed_after_break_; }  // expressions
+    // Exp, Var, Dec and Ty nodes removed in all (as AstStats counts them).
+    std::size_t removed_nodes() const { return removed_nodes_; }
+
+private:
+    // A declaration: what it uses, and whether the program reaches it.
+    struct Node {
+        std::vector<Node*> uses;
+        bool live = false;
+    };
+
+    // A let's declarations, and the declaration the let is nested in.
+    struct DecList {
+        std::vector<DecPtr>* decs;
+        const Node* owner;
+    };
+
+    std::deque<Node> nodes_;
+    std::unordered_map<const Dec*, Node*> node_of_;
+    std::vector<DecList> lets_;
+    std::vector<Node*> roots_;
+    std::vector<Node*> owners_;      // innermost declaration being walked
+    SymbolTable<Node> values_;       // nullptr for parameters and loop counters
+    SymbolTable<Node> types_;
+
+    std::array<std::size_t, DEC_KIND_COUNT> removed_decs_{};
+    std::size_t removed_branches_ = 0;
+    std::size_t removed_after_break_ = 0;
+    std::size_t removed_nodes_ = 0;
+
+    // Unreachable code
+    void prune(ExpPtr& exp);
+    void prune(Var& var);
+    void prune(std::vector<ExpPtr>& exps);
+    static bool always_breaks(const Exp& exp);
+
+    // Use graph
+    Node* new_node(const Dec& dec);
+    void use(Node* node);
+    void use_type(const std::string& name);
+    void collect(Exp& exp);
+    void collect(const Var& var);
+    void collect(const Ty& ty);
+    void collect(std::vector<DecPtr>& decs);
+    static bool may_have_effect(const Exp& exp);
+
+    void mark(Node* node);
+    bool keep_separators();
+
+    // Removal
+    void sweep(Exp& exp);
+    void sweep(Var& var);
+    void sweep(std::vector<DecPtr>& decs);
+    bool live(const Dec& dec) const;
+
+    static std::size_t count(const Exp& exp);
+    static std::size_t count(const Var& var);
+    static std::size_t count(const Dec& dec);
+    static std::size_t count(const Ty& ty);
+};
+
+} // namespace tiger
+
+#endif // TIGER_DEAD_CODE_ELIMINATOR_HPP
@@ -2,6 +2,8 @@
 #define TIGER_AST_HPP
 
 #include "lexer/Token.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -19,6 +21,12 @@ using VarPtr = std::unique_ptr<Var>;
 using DecPtr = std::unique_ptr<Dec>;
 using TyPtr = std::unique_ptr<Ty>;
 
+// Annotations filled in by the semantic passes (semantic::Resolver: frame
+// slots and function ids; TypeChecker: record field slots) hold this until
+// the pass has run, and for names that do not resolve (the type checker
+// reports those).
+constexpr uint32_t UNRESOLVED = UINT32_MAX;
+
 // ============================================================================
 // Expressions
 // ============================================================================
@@ -41,11 +49,17 @@ enum class ExpKind {
     ARRAY,
 };
 
+constexpr std::size_t EXP_KIND_COUNT = static_cast<std::size_t>(ExpKind::ARRAY) + 1;
+
 struct Field {
     std::string name;
     ExpPtr exp;
     Position pos;
 
+    // TypeChecker: the field's index in its record type's declaration.
+    // Set while checking a const tree, hence mutable.
+    mutable uint32_t slot = UNRESOLVED;
+
     Field(const std::string& n, ExpPtr e, Position p)
         : name(n), exp(std::move(e)), pos(p) {}
 };
@@ -86,6 +100,11 @@ struct CallExp : Exp {
     std::string func;
     std::vector<ExpPtr> args;
 
+    // Resolver: the callee's id, and how many static links to follow from
+    // the caller's frame to the frame the callee was declared in.
+    uint32_t func_id = UNRESOLVED;
+    uint32_t depth = UNRESOLVED;
+
     CallExp(const std::string& f, std::vector<ExpPtr> a, Position p)
         : Exp(ExpKind::CALL, p), func(f), args(std::move(a)) {}
 };
@@ -95,6 +114,8 @@ enum class Op {
     EQ, NEQ, LT, LE, GT, GE,
 };
 
+constexpr std::size_t OP_COUNT = static_cast<std::size_t>(Op::GE) + 1;
+
 struct OpExp : Exp {
     ExpPtr left;
     Op op;
@@ -151,6 +172,9 @@ struct ForExp : Exp {
     ExpPtr hi;
     ExpPtr body;
 
+    uint32_t slot = UNRESOLVED;   // Resolver: loop variable's frame slot
+    bool escape = true;           // Resolver: as VarDec::escape
+
     ForExp(const std::string& v, ExpPtr l, ExpPtr h, ExpPtr b, Position p)
         : Exp(ExpKind::FOR, p), var(v),
           lo(std::move(l)), hi(std::move(h)), body(std::move(b)) {}
@@ -188,6 +212,8 @@ enum class VarKind {
     SUBSCRIPT,
 };
 
+constexpr std::size_t VAR_KIND_COUNT = static_cast<std::size_t>(VarKind::SUBSCRIPT) + 1;
+
 struct Var {
     VarKind kind;
     Position pos;
@@ -199,6 +225,11 @@ struct Var {
 struct SimpleVar : Var {
     std::string name;
 
+    // Resolver: static links to follow (0 = the current frame) and the
+    // variable's slot in that frame.
+    uint32_t depth = UNRESOLVED;
+    uint32_t slot = UNRESOLVED;
+
     SimpleVar(const std::string& n, Position p)
         : Var(VarKind::SIMPLE, p), name(n) {}
 };
@@ -207,6 +238,8 @@ struct FieldVar : Var {
     VarPtr var;
     std::string field;
 
+    mutable uint32_t slot = UNRESOLVED;   // TypeChecker: as Field::slot
+
     FieldVar(VarPtr v, const std::string& f, Position p)
         : Var(VarKind::FIELD, p), var(std::move(v)), field(f) {}
 };
@@ -229,11 +262,15 @@ enum class DecKind {
     FUNCTION,
 };
 
+constexpr std::size_t DEC_KIND_COUNT = static_cast<std::size_t>(DecKind::FUNCTION) + 1;
+
 struct TypeField {
     std::string name;
     std::string type_id;
     Position pos;
 
+    bool escape = true;   // parameters only; Resolver: as VarDec::escape
+
     TypeField(const std::string& n, const std::string& t, Position p)
         : name(n), type_id(t), pos(p) {}
 };
@@ -242,6 +279,19 @@ struct Dec {
     DecKind kind;
     Position pos;
 
+    // Lines by which this declaration and everything in it are still to
+    // move: IncrementalParser renumbers the declarations after an edit
+    // lazily. 0 in any tree it hands out through program().
+    int32_t line_shift = 0;
+
+    // Source bytes covered by the declaration's tokens, filled in by the
+    // Parser. `offset` is relative to the start of the enclosing Dec (or to
+    // the start of the file for declarations not nested in another), so an
+    // edit only shifts the declarations that follow it at each level
+    // rather than every node after it (see IncrementalParser).
+    size_t offset = 0;
+    size_t length = 0;
+
     explicit Dec(DecKind k, Position p) : kind(k), pos(p) {}
     virtual ~Dec() = default;
 };
@@ -251,6 +301,13 @@ struct VarDec : Dec {
     std::string type_id;  // empty if not specified
     ExpPtr init;
 
+    uint32_t slot = UNRESOLVED;   // Resolver: frame slot
+
+    // Resolver: true if a function nested in the declaring one uses the
+    // variable, so it must live in memory its frame's static link can
+    // reach. Before resolution every variable is assumed to escape.
+    bool escape = true;
+
     VarDec(const std::string& n, const std::string& t, ExpPtr i, Position p)
         : Dec(DecKind::VAR, p), name(n), type_id(t), init(std::move(i)) {}
 };
@@ -269,6 +326,11 @@ struct FunctionDec : Dec {
     std::string result_type;  // empty if void
     ExpPtr body;
 
+    // Resolver: the function's id and the slots its frame needs; parameter
+    // i is in slot i, locals follow.
+    uint32_t id = UNRESOLVED;
+    uint32_t frame_size = 0;
+
     FunctionDec(const std::string& n, std::vector<TypeField> p,
                 const std::string& r, ExpPtr b, Position pos)
         : Dec(DecKind::FUNCTION, pos), name(n), params(std::move(p)),
@@ -285,6 +347,8 @@ enum class TyKind {
     ARRAY,
 };
 
+constexpr std::size_t TY_KIND_COUNT = static_cast<std::size_t>(TyKind::ARRAY) + 1;
+
 struct Ty {
     TyKind kind;
     Position pos;
@@ -322,6 +386,8 @@ struct Program {
     ExpPtr exp;
     Position pos;
 
+    uint32_t frame_size = 0;   // Resolver: slots of the top-level frame
+
     Program(ExpPtr e, Position p) : exp(std::move(e)), pos(p) {}
 };
 
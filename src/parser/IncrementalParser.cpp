@@ -0,0 +1,613 @@
+#include "IncrementalParser.hpp"
+#include "Parser.hpp"
+#include <cctype>
+#include <cstring>
+
+namespace tiger {
+
+namespace {
+
+// ============================================================================
+// Locating the declaration to reparse
+// ============================================================================
+
+// Innermost declaration enclosing the edit: the owning slot in its
+// LetExp, the absolute offset of its first byte, and the line_shift still
+// pending on the declarations that enclose it.
+struct Enclosing {
+    DecPtr* slot = nullptr;
+    size_t begin = 0;
+    int32_t lines = 0;
+};
+
+class DecFinder {
+public:
+    DecFinder(size_t begin, size_t end) : begin_(begin), end_(end) {}
+
+    Enclosing find(Program& prog) {
+        exp(prog.exp.get(), 0);
+        return found_;
+    }
+
+private:
+    size_t begin_;
+    size_t end_;
+    Enclosing found_;
+    int32_t lines_ = 0;   // line_shift of the declarations entered
+
+    // A declaration encloses the edit if its first token survives the edit
+    // unchanged; an edit touching the first byte may merge it with the
+    // previous declaration.
+    bool encloses(const Dec& d, size_t abs) const {
+        return abs < begin_ && end_ <= abs + d.length;
+    }
+
+    bool exp(Exp* e, size_t base) {
+        if (!e) return false;
+        switch (e->kind) {
+            case ExpKind::VAR:
+                return var(static_cast<VarExp*>(e)->var.get(), base);
+            case ExpKind::CALL:
+                for (auto& a : static_cast<CallExp*>(e)->args) {
+                    if (exp(a.get(), base)) return true;
+                }
+                return false;
+            case ExpKind::OP: {
+                auto* op = static_cast<OpExp*>(e);
+                return exp(op->left.get(), base) || exp(op->right.get(), base);
+            }
+            case ExpKind::RECORD:
+                for (auto& f : static_cast<RecordExp*>(e)->fields) {
+                    if (exp(f.exp.get(), base)) return true;
+                }
+                return false;
+            case ExpKind::SEQ:
+                for (auto& x : static_cast<SeqExp*>(e)->exps) {
+                    if (exp(x.get(), base)) return true;
+                }
+                return false;
+            case ExpKind::ASSIGN: {
+                auto* a = static_cast<AssignExp*>(e);
+                return var(a->var.get(), base) || exp(a->exp.get(), base);
+            }
+            case ExpKind::IF: {
+                auto* i = static_cast<IfExp*>(e);
+                return exp(i->test.get(), base) || exp(i->then_exp.get(), base) ||
+                       exp(i->else_exp.get(), base);
+            }
+            case ExpKind::WHILE: {
+                auto* w = static_cast<WhileExp*>(e);
+                return exp(w->test.get(), base) || exp(w->body.get(), base);
+            }
+            case ExpKind::FOR: {
+                auto* f = static_cast<ForExp*>(e);
+                return exp(f->lo.get(), base) || exp(f->hi.get(), base) ||
+                       exp(f->body.get(), base);
+            }
+            case ExpKind::LET: {
+                auto* let = static_cast<LetExp*>(e);
+                for (auto& d : let->decs) {
+                    size_t abs = base + d->offset;
+                    if (encloses(*d, abs)) {
+                        found_ = {&d, abs, lines_};
+                        lines_ += d->line_shift;
+                        dec(d.get(), abs);
+                        return true;
+                    }
+                }
+                for (auto& x : let->body) {
+                    if (exp(x.get(), base)) return true;
+                }
+                return false;
+            }
+            case ExpKind::ARRAY: {
+                auto* a = static_cast<ArrayExp*>(e);
+                return exp(a->size.get(), base) || exp(a->init.get(), base);
+            }
+            default:
+                return false;
+        }
+    }
+
+    bool var(Var* v, size_t base) {
+        switch (v->kind) {
+            case VarKind::FIELD:
+                return var(static_cast<FieldVar*>(v)->var.get(), base);
+            case VarKind::SUBSCRIPT: {
+                auto* s = static_cast<SubscriptVar*>(v);
+                return var(s->var.get(), base) || exp(s->index.get(), base);
+            }
+            default:
+                return false;
+        }
+    }
+
+    // Looks for a deeper declaration inside `d`, whose children are
+    // relative to `abs`.
+    void dec(Dec* d, size_t abs) {
+        switch (d->kind) {
+            case DecKind::VAR:
+                exp(static_cast<VarDec*>(d)->init.get(), abs);
+                break;
+            case DecKind::FUNCTION:
+                exp(static_cast<FunctionDec*>(d)->body.get(), abs);
+                break;
+            case DecKind::TYPE:
+                break;
+        }
+    }
+};
+
+// ============================================================================
+// Updating the reused parts of the tree
+// ============================================================================
+
+// How the edit moved the text that follows it.
+struct Shift {
+    size_t begin;        // old byte range of the edit
+    size_t end;
+    size_t added;        // bytes of replacement text
+    const Dec* fresh;    // the spliced declaration, already up to date
+    bool positions;      // whether nodes outside `fresh` move other than
+                         // by whole lines (the tree has been renumbered)
+    int32_t lines;       // if not, the lines by which text after it moves
+    Position old_end;    // position of byte `end` before the edit
+    Position new_end;    // ... and after it
+
+    void move(Position& p) const {
+        if (p.line > old_end.line) {
+            p.line += new_end.line - old_end.line;
+        } else if (p.line == old_end.line && p.column >= old_end.column) {
+            p.line = new_end.line;
+            p.column += new_end.column - old_end.column;
+        }
+    }
+
+    void shift_offset(size_t& offset) const {
+        offset = offset + added - (end - begin);
+    }
+};
+
+class ShiftWalker {
+public:
+    explicit ShiftWalker(const Shift& s) : s_(s) {}
+
+    // `offsets` is true while walking the declarations that enclose the
+    // edit (and the top level): nested declarations there carry offsets
+    // relative to a base that precedes the edit and may need bumping.
+    // Elsewhere only positions can change. When the text after the edit
+    // moves by whole lines, a declaration after it only has its
+    // line_shift bumped; the nodes outside declarations are moved here.
+    void exp(Exp* e, size_t base, bool offsets) {
+        if (!e || (!offsets && !s_.positions)) return;
+        pos(e->pos);
+        switch (e->kind) {
+            case ExpKind::VAR:
+                var(static_cast<VarExp*>(e)->var.get(), base, offsets);
+                break;
+            case ExpKind::CALL:
+                for (auto& a : static_cast<CallExp*>(e)->args) {
+                    exp(a.get(), base, offsets);
+                }
+                break;
+            case ExpKind::OP: {
+                auto* op = static_cast<OpExp*>(e);
+                exp(op->left.get(), base, offsets);
+                exp(op->right.get(), base, offsets);
+                break;
+            }
+            case ExpKind::RECORD:
+                for (auto& f : static_cast<RecordExp*>(e)->fields) {
+                    pos(f.pos);
+                    exp(f.exp.get(), base, offsets);
+                }
+                break;
+            case ExpKind::SEQ:
+                for (auto& x : static_cast<SeqExp*>(e)->exps) {
+                    exp(x.get(), base, offsets);
+                }
+                break;
+            case ExpKind::ASSIGN: {
+                auto* a = static_cast<AssignExp*>(e);
+                var(a->var.get(), base, offsets);
+                exp(a->exp.get(), base, offsets);
+                break;
+            }
+            case ExpKind::IF: {
+                auto* i = static_cast<IfExp*>(e);
+                exp(i->test.get(), base, offsets);
+                exp(i->then_exp.get(), base, offsets);
+                exp(i->else_exp.get(), base, offsets);
+                break;
+            }
+            case ExpKind::WHILE: {
+                auto* w = static_cast<WhileExp*>(e);
+                exp(w->test.get(), base, offsets);
+                exp(w->body.get(), base, offsets);
+                break;
+            }
+            case ExpKind::FOR: {
+                auto* f = static_cast<ForExp*>(e);
+                exp(f->lo.get(), base, offsets);
+                exp(f->hi.get(), base, offsets);
+                exp(f->body.get(), base, offsets);
+                break;
+            }
+            case ExpKind::LET: {
+                auto* let = static_cast<LetExp*>(e);
+                for (auto& d : let->decs) {
+                    let_dec(d.get(), base, offsets);
+                }
+                for (auto& x : let->body) {
+                    exp(x.get(), base, offsets);
+                }
+                break;
+            }
+            case ExpKind::ARRAY: {
+                auto* a = static_cast<ArrayExp*>(e);
+                exp(a->size.get(), base, offsets);
+                exp(a->init.get(), base, offsets);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+private:
+    const Shift& s_;
+    int32_t pending_ = 0;   // line_shift of the declarations entered
+
+    void pos(Position& p) {
+        if (s_.positions) {
+            s_.move(p);
+        } else if (s_.lines && p.line + pending_ > s_.old_end.line) {
+            p.line += s_.lines;
+        }
+    }
+
+    void let_dec(Dec* d, size_t base, bool offsets) {
+        if (d == s_.fresh) return;
+        if (!offsets) {
+            dec(d, 0, false);
+            return;
+        }
+        size_t abs = base + d->offset;
+        if (abs + d->length <= s_.begin) return;  // entirely before the edit
+        if (abs >= s_.end) {
+            // After the edit: moves as a whole; its children are relative
+            // to it and keep their offsets.
+            s_.shift_offset(d->offset);
+            if (s_.lines) {
+                d->line_shift += s_.lines;
+            } else {
+                dec(d, 0, false);
+            }
+            return;
+        }
+        s_.shift_offset(d->length);  // encloses the edit
+        pending_ += d->line_shift;
+        dec(d, abs, true);
+        pending_ -= d->line_shift;
+    }
+
+    void dec(Dec* d, size_t abs, bool offsets) {
+        if (!offsets && !s_.positions) return;
+        pos(d->pos);
+        switch (d->kind) {
+            case DecKind::VAR:
+                exp(static_cast<VarDec*>(d)->init.get(), abs, offsets);
+                break;
+            case DecKind::TYPE:
+                ty(static_cast<TypeDec*>(d)->ty.get());
+                break;
+            case DecKind::FUNCTION: {
+                auto* f = static_cast<FunctionDec*>(d);
+                for (auto& p : f->params) pos(p.pos);
+                exp(f->body.get(), abs, offsets);
+                break;
+            }
+        }
+    }
+
+    void var(Var* v, size_t base, bool offsets) {
+        pos(v->pos);
+        switch (v->kind) {
+            case VarKind::FIELD:
+                var(static_cast<FieldVar*>(v)->var.get(), base, offsets);
+                break;
+            case VarKind::SUBSCRIPT: {
+                auto* s = static_cast<SubscriptVar*>(v);
+                var(s->var.get(), base, offsets);
+                exp(s->index.get(), base, offsets);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void ty(Ty* t) {
+        if (!t || !s_.positions) return;
+        pos(t->pos);
+        if (t->kind == TyKind::RECORD) {
+            for (auto& f : static_cast<RecordTy*>(t)->fields) pos(f.pos);
+        }
+    }
+};
+
+// Applies the pending Dec::line_shift of every declaration to the nodes
+// in it, and clears them.
+class Renumber {
+public:
+    void exp(Exp* e) {
+        if (!e) return;
+        pos(e->pos);
+        switch (e->kind) {
+            case ExpKind::VAR:
+                var(static_cast<VarExp*>(e)->var.get());
+                break;
+            case ExpKind::CALL:
+                for (auto& a : static_cast<CallExp*>(e)->args) exp(a.get());
+                break;
+            case ExpKind::OP: {
+                auto* op = static_cast<OpExp*>(e);
+                exp(op->left.get());
+                exp(op->right.get());
+                break;
+            }
+            case ExpKind::RECORD:
+                for (auto& f : static_cast<RecordExp*>(e)->fields) {
+                    pos(f.pos);
+                    exp(f.exp.get());
+                }
+                break;
+            case ExpKind::SEQ:
+                for (auto& x : static_cast<SeqExp*>(e)->exps) exp(x.get());
+                break;
+            case ExpKind::ASSIGN: {
+                auto* a = static_cast<AssignExp*>(e);
+                var(a->var.get());
+                exp(a->exp.get());
+                break;
+            }
+            case ExpKind::IF: {
+                auto* i = static_cast<IfExp*>(e);
+                exp(i->test.get());
+                exp(i->then_exp.get());
+                exp(i->else_exp.get());
+                break;
+            }
+            case ExpKind::WHILE: {
+                auto* w = static_cast<WhileExp*>(e);
+                exp(w->test.get());
+                exp(w->body.get());
+                break;
+            }
+            case ExpKind::FOR: {
+                auto* f = static_cast<ForExp*>(e);
+                exp(f->lo.get());
+                exp(f->hi.get());
+                exp(f->body.get());
+                break;
+            }
+            case ExpKind::LET: {
+                auto* let = static_cast<LetExp*>(e);
+                for (auto& d : let->decs) dec(d.get());
+                for (auto& x : let->body) exp(x.get());
+                break;
+            }
+            case ExpKind::ARRAY: {
+                auto* a = static_cast<ArrayExp*>(e);
+                exp(a->size.get());
+                exp(a->init.get());
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+private:
+    int32_t lines_ = 0;   // sum of line_shift of the declarations entered
+
+    void pos(Position& p) { p.line += lines_; }
+
+    void dec(Dec* d) {
+        int32_t shift = d->line_shift;
+        d->line_shift = 0;
+        lines_ += shift;
+        pos(d->pos);
+        switch (d->kind) {
+            case DecKind::VAR:
+                exp(static_cast<VarDec*>(d)->init.get());
+                break;
+            case DecKind::TYPE: {
+                Ty* t = static_cast<TypeDec*>(d)->ty.get();
+                if (!t) break;
+                pos(t->pos);
+                if (t->kind == TyKind::RECORD) {
+                    for (auto& f : static_cast<RecordTy*>(t)->fields) pos(f.pos);
+                }
+                break;
+            }
+            case DecKind::FUNCTION: {
+                auto* f = static_cast<FunctionDec*>(d);
+                for (auto& p : f->params) pos(p.pos);
+                exp(f->body.get());
+                break;
+            }
+        }
+        lines_ -= shift;
+    }
+
+    void var(Var* v) {
+        pos(v->pos);
+        switch (v->kind) {
+            case VarKind::FIELD:
+                var(static_cast<FieldVar*>(v)->var.get());
+                break;
+            case VarKind::SUBSCRIPT: {
+                auto* s = static_cast<SubscriptVar*>(v);
+                var(s->var.get());
+                exp(s->index.get());
+                break;
+            }
+            default:
+                break;
+        }
+    }
+};
+
+// Position reached after scanning `n` bytes from `p`, counted the way the
+// Lexer counts them.
+Position advance_position(Position p, const char* s, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (s[i] == '\n') {
+            p.line++;
+            p.column = 1;
+        } else {
+            p.column++;
+        }
+    }
+    return p;
+}
+
+// Whether only blanks separate byte `i` from the end of its line (or of
+// the file): the next token, if any, starts on a later line.
+bool rest_of_line_blank(const std::string& s, size_t i) {
+    for (; i < s.size() && s[i] != '\n'; i++) {
+        if (s[i] != ' ' && s[i] != '\t' && s[i] != '\r') return false;
+    }
+    return true;
+}
+
+bool is_word_char(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// Whether a token ending in `a` could continue into a token starting
+// with `b` (identifiers/numbers, ":=", "<=", "<>", ">=", comment openers).
+bool may_fuse(char a, char b) {
+    if (is_word_char(a) && is_word_char(b)) return true;
+    if ((a == ':' || a == '<' || a == '>') && (b == '=' || b == '>')) return true;
+    if (a == '/' && b == '*') return true;
+    return false;
+}
+
+} // namespace
+
+// ============================================================================
+// IncrementalParser
+// ============================================================================
+
+IncrementalParser::IncrementalParser(std::string source)
+    : source_(std::move(source)) {
+    parse_full();
+}
+
+void IncrementalParser::parse_full() {
+    Lexer lexer(source_);
+    Parser parser(lexer);
+    program_ = parser.parse();
+    lexer_errors_ = lexer.errors();
+    parser_errors_ = parser.errors();
+    last_reparsed_ = nullptr;
+    renumber_ = false;
+    full_count_++;
+}
+
+const Program& IncrementalParser::program() const {
+    renumber();
+    return *program_;
+}
+
+void IncrementalParser::renumber() const {
+    if (!renumber_) return;
+    Renumber().exp(program_->exp.get());
+    renumber_ = false;
+}
+
+bool IncrementalParser::apply(const TextEdit& edit) {
+    if (edit.offset > source_.size() ||
+        edit.length > source_.size() - edit.offset) {
+        return false;  // out of range: nothing to apply
+    }
+    if (!has_errors() && reparse(edit)) {
+        incremental_count_++;
+        return true;
+    }
+    source_.replace(edit.offset, edit.length, edit.text);
+    parse_full();
+    return false;
+}
+
+// Splices a reparsed declaration in for `edit`, or returns false with the
+// source untouched when a full parse is needed.
+bool IncrementalParser::reparse(const TextEdit& edit) {
+    size_t begin = edit.offset;
+    size_t end = edit.offset + edit.length;
+
+    DecFinder finder(begin, end);
+    Enclosing target = finder.find(*program_);
+    if (!target.slot) return false;
+
+    Dec& old = **target.slot;
+    size_t old_end = target.begin + old.length;
+    Position old_pos(old.pos.line + target.lines + old.line_shift, old.pos.column);
+
+    // Positions of the edit in old coordinates, scanning only the
+    // declaration's own text.
+    const char* src = source_.data();
+    Position at_begin = advance_position(old_pos, src + target.begin,
+                                         begin - target.begin);
+    Position at_end = advance_position(at_begin, src + begin, end - begin);
+    Position new_end = advance_position(at_begin, edit.text.data(),
+                                        edit.text.size());
+    // Text after the edit outside the declaration moves only if the line
+    // count changed or it shares the declaration's last line. By whole
+    // lines, unless a token after the declaration is on the line the edit
+    // ends on.
+    bool newline_after = std::memchr(src + end, '\n', old_end - end) != nullptr ||
+                         rest_of_line_blank(source_, old_end);
+    int32_t lines = newline_after ? new_end.line - at_end.line : 0;
+    bool positions = !newline_after && (new_end.line != at_end.line ||
+                                        new_end.column != at_end.column);
+
+    // Build the new fragment without touching source_ yet.
+    size_t region_end = old_end - edit.length + edit.text.size();
+    std::string fragment;
+    fragment.reserve(region_end - target.begin);
+    fragment.append(source_, target.begin, begin - target.begin);
+    fragment.append(edit.text);
+    fragment.append(source_, end, old_end - end);
+    if (fragment.empty()) return false;
+    if (old_end < source_.size() && may_fuse(fragment.back(), source_[old_end])) {
+        return false;
+    }
+
+    Lexer lexer(fragment, old_pos);
+    Parser parser(lexer);
+    DecPtr fresh = parser.parse_declaration();
+    if (!fresh || lexer.has_errors() || parser.has_errors()) return false;
+
+    // The fragment was lexed in current positions; the declarations
+    // around it may still have lines pending, which it must not get. A
+    // column shift is applied to the whole tree at once, so that needs
+    // it renumbered first.
+    if (positions) renumber();
+    fresh->offset = old.offset;
+    fresh->line_shift = positions ? 0 : -target.lines;
+    if (lines) renumber_ = true;
+
+    Shift shift{begin, end, edit.text.size(), fresh.get(), positions, lines,
+                at_end, new_end};
+    *target.slot = std::move(fresh);
+    ShiftWalker(shift).exp(program_->exp.get(), 0, true);
+
+    source_.replace(begin, edit.length, edit.text);
+    last_reparsed_ = target.slot->get();
+    return true;
+}
+
+} // namespace tiger
@@ -0,0 +1,82 @@
+#ifndef TIGER_INCREMENTAL_PARSER_HPP
+#define TIGER_INCREMENTAL_PARSER_HPP
+
+// ============================================================================
+// Incremental reparsing for editor / watch-mode use.
+//
+// Keeps the source text and its tree. An edit is applied by locating the
+// innermost declaration whose bytes (Dec::offset/length) enclose it,
+// reparsing just that declaration's text with Parser::parse_declaration,
+// and splicing the new subtree in place. Everything else is reused:
+// declarations after the edit only have their relative offset bumped.
+// Node positions outside the reparsed declaration move only when the edit
+// changes the line count or shifts columns on the declaration's last line:
+//   - by whole lines, the declarations after the edit only have their
+//     Dec::line_shift bumped; the next program() applies the shifts of
+//     all edits since the last one in a single walk of the tree
+//   - a column shift of the text after the declaration (rare: it must
+//     share the line the edit ends on) renumbers the tree at once
+//
+// Whenever the fragment cannot be proven to parse the same way in context
+// (the old tree had errors, no declaration encloses the edit, the
+// fragment does not parse cleanly as exactly one declaration, or its last
+// token could fuse with the next character) the whole file is reparsed.
+// ============================================================================
+
+#include "AST.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tiger {
+
+// Replace `length` bytes at `offset` with `text`.
+struct TextEdit {
+    size_t offset;
+    size_t length;
+    std::string text;
+};
+
+class IncrementalParser {
+public:
+    explicit IncrementalParser(std::string source);
+
+    // Applies the edit to the source and updates the tree. Returns true if
+    // only one declaration was reparsed, false if the file was reparsed.
+    bool apply(const TextEdit& edit);
+
+    const std::string& source() const { return source_; }
+    // Renumbers the pending line shifts first (see above).
+    const Program& program() const;
+
+    // Declaration spliced in by the last apply(); nullptr after a full parse.
+    const Dec* last_reparsed() const { return last_reparsed_; }
+
+    const std::vector<std::string>& lexer_errors() const { return lexer_errors_; }
+    const std::vector<std::string>& parser_errors() const { return parser_errors_; }
+    bool has_errors() const {
+        return !lexer_errors_.empty() || !parser_errors_.empty();
+    }
+
+    size_t incremental_count() const { return incremental_count_; }
+    size_t full_count() const { return full_count_; }
+
+private:
+    std::string source_;
+    std::unique_ptr<Program> program_;
+    std::vector<std::string> lexer_errors_;
+    std::vector<std::string> parser_errors_;
+    const Dec* last_reparsed_ = nullptr;
+    mutable bool renumber_ = false;   // some Dec::line_shift is not 0
+    size_t incremental_count_ = 0;
+    size_t full_count_ = 0;
+
+    void parse_full();
+    bool reparse(const TextEdit& edit);
+    void renumber() const;
+};
+
+} // namespace tiger
+
+#endif // TIGER_INCREMENTAL_PARSER_HPP
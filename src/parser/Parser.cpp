@@ -17,6 +17,7 @@ Token Parser::peek() {
 
 Token Parser::advance() {
     Token prev = current_;
+    prev_end_ = prev.end;
     current_ = lexer_.next_token();
     return prev;
 }
@@ -82,6 +83,16 @@ std::unique_ptr<Program> Parser::parse() {
     return std::make_unique<Program>(std::move(exp), pos);
 }
 
+DecPtr Parser::parse_declaration() {
+    DecPtr dec = parse_dec();
+
+    if (!check(TokenType::END_OF_FILE)) {
+        error("expected end of file");
+    }
+
+    return dec;
+}
+
 // ============================================================================
 // Expression parsing with operator precedence
 // Precedence (low to high):
@@ -514,19 +525,28 @@ VarPtr Parser::parse_lvalue_suffix(VarPtr base) {
 // ============================================================================
 
 DecPtr Parser::parse_dec() {
-    if (check(TokenType::TYPE)) {
-        return parse_type_dec();
-    }
-    if (check(TokenType::VAR)) {
-        return parse_var_dec();
-    }
-    if (check(TokenType::FUNCTION)) {
-        return parse_function_dec();
-    }
+    size_t begin = current_.offset;
+    size_t outer_base = dec_base_;
+    dec_base_ = begin;
 
-    error("expected declaration");
-    advance();  // skip bad token
-    return nullptr;
+    DecPtr dec;
+    if (check(TokenType::TYPE)) {
+        dec = parse_type_dec();
+    } else if (check(TokenType::VAR)) {
+        dec = parse_var_dec();
+    } else if (check(TokenType::FUNCTION)) {
+        dec = parse_function_dec();
+    } else {
+        error("expected declaration");
+        advance();  // skip bad token
+    }
+
+    dec_base_ = outer_base;
+    if (dec) {
+        dec->offset = begin - outer_base;
+        dec->length = prev_end_ - begin;
+    }
+    return dec;
 }
 
 DecPtr Parser::parse_type_dec() {
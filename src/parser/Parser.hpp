@@ -14,6 +14,10 @@ public:
 
     std::unique_ptr<Program> parse();
 
+    // Parses exactly one declaration followed by end of input; used by
+    // IncrementalParser to reparse a single edited declaration.
+    DecPtr parse_declaration();
+
     const std::vector<std::string>& errors() const { return errors_; }
     bool has_errors() const { return !errors_.empty(); }
 
@@ -22,6 +26,11 @@ private:
     Token current_;
     std::vector<std::string> errors_;
 
+    // Byte offsets for Dec::offset/length: end of the last consumed token
+    // and start of the innermost declaration being parsed.
+    size_t prev_end_ = 0;
+    size_t dec_base_ = 0;
+
     // Token handling
     Token peek();
     Token advance();
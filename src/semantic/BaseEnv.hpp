@@ -0,0 +1,91 @@
+#ifndef TIGER_BASE_ENV_HPP
+#define TIGER_BASE_ENV_HPP
+
+// ============================================================================
+// The base environment: what every Tiger program can use without declaring
+// it (Appel ch. 5, "Standard library").
+//
+//   types      int, string
+//   functions  print, getchar, ord, chr, size, substring, concat, not, exit
+//
+// All of it is constant data built by the compiler: the names are the
+// builtin symbols of symbol.hpp (ids 0..builtin::COUNT-1, already in the
+// interner), the types are the constant objects of Types.hpp, and the
+// signatures point at constant parameter arrays. Nothing is built when a
+// process starts; a lookup is an id range check and an array load.
+//
+// The checker keeps its scoped tables for user declarations and falls
+// back to type()/function() here when a name is not bound there.
+// ============================================================================
+
+#include "env/symbol.hpp"
+#include "semantic/Types.hpp"
+
+namespace tiger::semantic::base_env {
+
+namespace detail {
+inline constexpr const Type* S[] = {&STRING_TYPE};
+inline constexpr const Type* I[] = {&INT_TYPE};
+inline constexpr const Type* SS[] = {&STRING_TYPE, &STRING_TYPE};
+inline constexpr const Type* SII[] = {&STRING_TYPE, &INT_TYPE, &INT_TYPE};
+} // namespace detail
+
+struct TypeBinding {
+    Sym name;
+    const Type* type;
+};
+
+struct FunBinding {
+    Sym name;
+    FunSig sig;
+};
+
+// Indexed by builtin id.
+inline constexpr TypeBinding TYPES[] = {
+    {builtin::INT.sym(), &INT_TYPE},
+    {builtin::STRING.sym(), &STRING_TYPE},
+};
+
+// Indexed by builtin id - builtin::PRINT_ID.
+inline constexpr FunBinding FUNCTIONS[] = {
+    {builtin::PRINT.sym(),     {detail::S, 1, &UNIT_TYPE}},
+    {builtin::GETCHAR.sym(),   {nullptr, 0, &STRING_TYPE}},
+    {builtin::ORD.sym(),       {detail::S, 1, &INT_TYPE}},
+    {builtin::CHR.sym(),       {detail::I, 1, &STRING_TYPE}},
+    {builtin::SIZE.sym(),      {detail::S, 1, &INT_TYPE}},
+    {builtin::SUBSTRING.sym(), {detail::SII, 3, &STRING_TYPE}},
+    {builtin::CONCAT.sym(),    {detail::SS, 2, &STRING_TYPE}},
+    {builtin::NOT.sym(),       {detail::I, 1, &INT_TYPE}},
+    {builtin::EXIT.sym(),      {detail::I, 1, &UNIT_TYPE}},
+};
+
+constexpr std::size_t TYPE_COUNT = sizeof(TYPES) / sizeof(TYPES[0]);
+constexpr std::size_t FUNCTION_COUNT = sizeof(FUNCTIONS) / sizeof(FUNCTIONS[0]);
+
+static_assert(TYPE_COUNT == builtin::PRINT_ID, "types come first among builtin ids");
+static_assert(builtin::PRINT_ID + FUNCTION_COUNT == builtin::COUNT,
+              "every builtin symbol is bound");
+
+constexpr bool indexed_by_id() {
+    for (std::size_t i = 0; i < TYPE_COUNT; i++)
+        if (TYPES[i].name->id != i) return false;
+    for (std::size_t i = 0; i < FUNCTION_COUNT; i++)
+        if (FUNCTIONS[i].name->id != builtin::PRINT_ID + i) return false;
+    return true;
+}
+static_assert(indexed_by_id(), "TYPES and FUNCTIONS must be in builtin id order");
+
+// The builtin type named `sym`, or nullptr.
+constexpr const Type* type(Sym sym) {
+    return sym->id < TYPE_COUNT ? TYPES[sym->id].type : nullptr;
+}
+
+// The builtin function named `sym`, or nullptr.
+constexpr const FunSig* function(Sym sym) {
+    uint32_t i = sym->id - builtin::PRINT_ID;   // wraps for the type ids
+    return i < FUNCTION_COUNT ? &FUNCTIONS[i].sig : nullptr;
+}
+
+} // namespace tiger::semantic::base_env
+
+#endif // TIGER_BASE_ENV_HPP
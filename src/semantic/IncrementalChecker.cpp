@@ -0,0 +1,34 @@
+#include "IncrementalChecker.hpp"
+
+namespace tiger::semantic {
+
+IncrementalChecker::IncrementalChecker(std::string source) : parser_(std::move(source)) {
+    check(nullptr, 0, 0);
+}
+
+bool IncrementalChecker::apply(const TextEdit& edit) {
+    if (!parser_.apply(edit)) cached_ = false;   // every node is new
+    return check(parser_.last_reparsed(), edit.offset, edit.offset + edit.text.size());
+}
+
+bool IncrementalChecker::check(const Dec* reparsed, std::size_t edit_begin,
+                               std::size_t edit_end) {
+    if (parser_.has_errors()) {
+        // The tree may be partial; start over once it parses again.
+        checker_.reset_incremental();
+        checker_.errors_.clear();
+        checker_.error_positions_.clear();
+        checker_.exp_types_.clear();
+        cached_ = false;
+        return false;
+    }
+    if (!cached_) {
+        checker_.reset_incremental();
+        checker_.exp_types_.clear();
+        reparsed = nullptr;
+        cached_ = true;
+    }
+    return checker_.check_incremental(parser_.program(), reparsed, edit_begin, edit_end);
+}
+
+} // namespace tiger::semantic
@@ -0,0 +1,61 @@
+#ifndef TIGER_INCREMENTAL_CHECKER_HPP
+#define TIGER_INCREMENTAL_CHECKER_HPP
+
+// ============================================================================
+// Incremental semantic analysis for editor / watch-mode use.
+//
+// Pairs an IncrementalParser with a TypeChecker in incremental mode. After
+// an edit the parser reparses one declaration and keeps every other node;
+// the checker then walks the declarations and headers again, but walks a
+// function body only if
+//   - the edit touched it (it encloses the edit, or is new), or
+//   - the fingerprint of its dependencies changed: the bindings of the
+//     names it looked up outside itself, and its own signature.
+// Every other body replays its cached diagnostics (moved to where the
+// function is now) and keeps its entries in the type table. So a
+// body-only edit re-checks that body (and the bodies enclosing it), and a
+// signature change also re-checks the callers of that function.
+//
+// The result is always what a full check of the current source gives.
+// A full reparse, or a parse error, drops all cached results.
+// ============================================================================
+
+#include "parser/IncrementalParser.hpp"
+#include "semantic/TypeChecker.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace tiger::semantic {
+
+class IncrementalChecker {
+public:
+    // Parses and checks `source`.
+    explicit IncrementalChecker(std::string source);
+
+    // Applies the edit, reparses and re-checks. True if the program has no
+    // lexer, parser or type errors.
+    bool apply(const TextEdit& edit);
+
+    const IncrementalParser& parser() const { return parser_; }
+    const TypeChecker& checker() const { return checker_; }
+
+    // Type errors of the current source (empty while it does not parse).
+    const std::vector<std::string>& errors() const { return checker_.errors(); }
+    bool ok() const { return !parser_.has_errors() && !checker_.has_errors(); }
+
+    // Function bodies walked / replayed from the cache by the last check.
+    std::size_t bodies_checked() const { return checker_.bodies_checked_; }
+    std::size_t bodies_reused() const { return checker_.bodies_reused_; }
+
+private:
+    IncrementalParser parser_;
+    TypeChecker checker_;
+    bool cached_ = false;   // the checker's tables match the current tree
+
+    bool check(const Dec* reparsed, std::size_t edit_begin, std::size_t edit_end);
+};
+
+} // namespace tiger::semantic
+
+#endif // TIGER_INCREMENTAL_CHECKER_HPP
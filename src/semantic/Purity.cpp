@@ -0,0 +1,220 @@
+#include "semantic/Purity.hpp"
+#include "semantic/BaseEnv.hpp"
+
+namespace tiger::semantic {
+
+void Purity::analyze(const Program& prog, const Resolver& resolver) {
+    functions_.assign(resolver.functions().size(), FunctionInfo{});
+    unstable_.assign(prog.frame_size, false);
+    owners_.clear();
+    loops_ = 0;
+    if (prog.exp) visit(*prog.exp);
+
+    for (FunctionInfo& f : functions_) {
+        f.pure = !f.effects;
+        for (uint32_t slot : f.global_reads)
+            if (slot >= unstable_.size() || unstable_[slot]) f.pure = false;
+        f.closed = f.pure && f.global_reads.empty();
+    }
+    // Greatest fixed point: a function calling an impure one is impure,
+    // and one calling a function that is not closed is not closed.
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (FunctionInfo& f : functions_) {
+            for (uint32_t callee : f.callees) {
+                const FunctionInfo& g = functions_[callee];
+                if ((f.pure && !g.pure) || (f.closed && !g.closed)) {
+                    f.pure = f.pure && g.pure;
+                    f.closed = f.pure && g.closed;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    pure_count_ = 0;
+    for (const FunctionInfo& f : functions_) pure_count_ += f.pure;
+}
+
+bool Purity::pure(uint32_t function_id) const {
+    if (function_id < base_env::FUNCTION_COUNT) {
+        uint32_t id = builtin::PRINT_ID + function_id;
+        return id != builtin::PRINT_ID && id != builtin::GETCHAR_ID && id != builtin::EXIT_ID;
+    }
+    uint32_t i = function_id - static_cast<uint32_t>(base_env::FUNCTION_COUNT);
+    return i < functions_.size() && functions_[i].pure;
+}
+
+bool Purity::closed(uint32_t function_id) const {
+    if (function_id < base_env::FUNCTION_COUNT) return pure(function_id);
+    uint32_t i = function_id - static_cast<uint32_t>(base_env::FUNCTION_COUNT);
+    return i < functions_.size() && functions_[i].closed;
+}
+
+Purity::FunctionInfo* Purity::current() {
+    return owners_.empty() ? nullptr
+                           : &functions_[owners_.back() - base_env::FUNCTION_COUNT];
+}
+
+void Purity::effect() {
+    if (FunctionInfo* f = current()) f->effects = true;
+}
+
+void Purity::unstable(uint32_t slot) {
+    if (slot < unstable_.size()) unstable_[slot] = true;
+}
+
+// ============================================================================
+// Walk
+// ============================================================================
+
+void Purity::visit(const Exp& exp) {
+    switch (exp.kind) {
+        case ExpKind::VAR:
+            visit(*static_cast<const VarExp&>(exp).var, false);
+            break;
+
+        case ExpKind::NIL:
+        case ExpKind::INT:
+        case ExpKind::STRING:
+        case ExpKind::BREAK:
+            break;
+
+        case ExpKind::CALL: {
+            auto& call = static_cast<const CallExp&>(exp);
+            if (call.func_id == UNRESOLVED) {
+                effect();
+            } else if (call.func_id < base_env::FUNCTION_COUNT) {
+                if (!pure(call.func_id)) effect();
+            } else if (FunctionInfo* f = current()) {
+                f->callees.push_back(call.func_id -
+                                     static_cast<uint32_t>(base_env::FUNCTION_COUNT));
+            }
+            for (const auto& arg : call.args) visit(*arg);
+            break;
+        }
+
+        case ExpKind::OP: {
+            auto& op = static_cast<const OpExp&>(exp);
+            visit(*op.left);
+            visit(*op.right);
+            break;
+        }
+
+        case ExpKind::RECORD:
+            effect();
+            for (const auto& field : static_cast<const RecordExp&>(exp).fields)
+                visit(*field.exp);
+            break;
+
+        case ExpKind::SEQ:
+            for (const auto& e : static_cast<const SeqExp&>(exp).exps) visit(*e);
+            break;
+
+        case ExpKind::ASSIGN: {
+            auto& assign = static_cast<const AssignExp&>(exp);
+            visit(*assign.var, true);
+            visit(*assign.exp);
+            break;
+        }
+
+        case ExpKind::IF: {
+            auto& if_exp = static_cast<const IfExp&>(exp);
+            visit(*if_exp.test);
+            visit(*if_exp.then_exp);
+            if (if_exp.else_exp) visit(*if_exp.else_exp);
+            break;
+        }
+
+        case ExpKind::WHILE: {
+            auto& loop = static_cast<const WhileExp&>(exp);
+            loops_++;
+            visit(*loop.test);
+            visit(*loop.body);
+            loops_--;
+            break;
+        }
+
+        case ExpKind::FOR: {
+            auto& loop = static_cast<const ForExp&>(exp);
+            visit(*loop.lo);
+            visit(*loop.hi);
+            if (level() == 0) unstable(loop.slot);
+            loops_++;
+            visit(*loop.body);
+            loops_--;
+            break;
+        }
+
+        case ExpKind::LET: {
+            auto& let = static_cast<const LetExp&>(exp);
+            visit(let.decs);
+            for (const auto& e : let.body) visit(*e);
+            break;
+        }
+
+        case ExpKind::ARRAY: {
+            auto& array = static_cast<const ArrayExp&>(exp);
+            effect();
+            visit(*array.size);
+            visit(*array.init);
+            break;
+        }
+    }
+}
+
+void Purity::visit(const Var& var, bool assigned) {
+    switch (var.kind) {
+        case VarKind::SIMPLE: {
+            auto& simple = static_cast<const SimpleVar&>(var);
+            if (simple.depth == UNRESOLVED || simple.depth > level()) {
+                effect();
+            } else if (simple.depth > 0) {
+                uint32_t target = level() - simple.depth;
+                if (target == 0 && assigned) unstable(simple.slot);
+                if (target != 0 || assigned) {
+                    effect();
+                } else if (FunctionInfo* f = current()) {
+                    f->global_reads.push_back(simple.slot);
+                }
+            } else if (level() == 0 && assigned) {
+                unstable(simple.slot);
+            }
+            break;
+        }
+
+        case VarKind::FIELD:
+            effect();
+            visit(*static_cast<const FieldVar&>(var).var, false);
+            break;
+
+        case VarKind::SUBSCRIPT: {
+            auto& sub = static_cast<const SubscriptVar&>(var);
+            effect();
+            visit(*sub.var, false);
+            visit(*sub.index);
+            break;
+        }
+    }
+}
+
+void Purity::visit(const std::vector<DecPtr>& decs) {
+    for (const auto& dec : decs) {
+        if (dec->kind == DecKind::VAR) {
+            auto& var = static_cast<const VarDec&>(*dec);
+            visit(*var.init);
+            if (level() == 0 && loops_ > 0) unstable(var.slot);
+        } else if (dec->kind == DecKind::FUNCTION) {
+            auto& function = static_cast<const FunctionDec&>(*dec);
+            if (function.id == UNRESOLVED) continue;
+            std::size_t saved_loops = loops_;
+            owners_.push_back(function.id);
+            loops_ = 0;
+            if (function.body) visit(*function.body);
+            owners_.pop_back();
+            loops_ = saved_loops;
+        }
+    }
+}
+
+} // namespace tiger::semantic
@@ -0,0 +1,77 @@
+#ifndef TIGER_PURITY_HPP
+#define TIGER_PURITY_HPP
+
+// ============================================================================
+// Effect analysis: which functions are pure.
+//
+// A function is pure if a call's result depends only on its arguments and
+// the call does nothing else, so two calls with equal arguments can share
+// one result (what Interpreter's --memoize relies on). Its body, and the
+// body of every function it calls, must not
+//   - assign a variable outside the function's own frame,
+//   - read a variable outside its own frame that can change: anything in
+//     an enclosing function's frame (each activation has its own), or a
+//     top-level variable that is assigned, or declared inside a loop,
+//   - read, write or allocate records and arrays (a record is mutable, and
+//     a fresh one has an identity a shared result would lose),
+//   - do I/O: print, getchar, exit.
+// The other library functions (ord, chr, size, substring, concat, not)
+// are pure. Recursion is fine: functions start out pure and the call
+// graph is iterated until nothing changes.
+//
+// Runs on a resolved tree (semantic::Resolver); a name left UNRESOLVED
+// makes its function impure.
+// ============================================================================
+
+#include "parser/AST.hpp"
+#include "semantic/Resolver.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tiger::semantic {
+
+class Purity {
+public:
+    // Classifies the user functions of `prog`, which `resolver` resolved.
+    void analyze(const Program& prog, const Resolver& resolver);
+
+    // By Resolver function id; library functions are answered too.
+    bool pure(uint32_t function_id) const;
+
+    // Pure and, with everything it calls, reads no variable outside its
+    // own frame: a call with constant arguments can be evaluated before
+    // the program runs (PartialEvaluator).
+    bool closed(uint32_t function_id) const;
+
+    std::size_t pure_count() const { return pure_count_; }
+    std::size_t function_count() const { return functions_.size(); }
+
+private:
+    struct FunctionInfo {
+        bool effects = false;                 // impure on its own
+        std::vector<uint32_t> callees;        // user function ids
+        std::vector<uint32_t> global_reads;   // top-level slots it reads
+        bool pure = false;
+        bool closed = false;
+    };
+
+    std::vector<FunctionInfo> functions_;     // by id - FUNCTION_COUNT
+    std::vector<bool> unstable_;              // top-level slot may change
+    std::vector<uint32_t> owners_;            // function id per level, 1..
+    std::size_t loops_ = 0;                   // loops around top-level code
+    std::size_t pure_count_ = 0;
+
+    uint32_t level() const { return static_cast<uint32_t>(owners_.size()); }
+    FunctionInfo* current();
+    void effect();
+    void unstable(uint32_t slot);
+
+    void visit(const Exp& exp);
+    void visit(const Var& var, bool assigned);
+    void visit(const std::vector<DecPtr>& decs);
+};
+
+} // namespace tiger::semantic
+
+#endif // TIGER_PURITY_HPP
@@ -0,0 +1,223 @@
+#include "semantic/Resolver.hpp"
+#include "semantic/BaseEnv.hpp"
+#include <algorithm>
+
+namespace tiger::semantic {
+
+void Resolver::resolve(Program& prog) {
+    bindings_.clear();
+    frames_.clear();
+    functions_.clear();
+    unresolved_ = 0;
+
+    frames_.push_back({0, 0});
+    env_.beginScope();
+    if (prog.exp) resolve_exp(*prog.exp);
+    env_.endScope();
+    prog.frame_size = frames_.back().size;
+    frames_.clear();
+}
+
+uint32_t Resolver::new_slot() {
+    Frame& frame = frames_.back();
+    uint32_t slot = frame.next++;
+    frame.size = std::max(frame.size, frame.next);
+    return slot;
+}
+
+void Resolver::bind(const std::string& name, uint32_t index, bool* escape) {
+    if (escape) *escape = false;
+    bindings_.push_back({level(), index, escape});
+    env_.enter(Symbol::intern(name), &bindings_.back());
+}
+
+// ============================================================================
+// Expressions
+// ============================================================================
+
+void Resolver::resolve_exp(Exp& exp) {
+    switch (exp.kind) {
+        case ExpKind::VAR:
+            resolve_var(*static_cast<VarExp&>(exp).var);
+            break;
+
+        case ExpKind::NIL:
+        case ExpKind::INT:
+        case ExpKind::STRING:
+        case ExpKind::BREAK:
+            break;
+
+        case ExpKind::CALL:
+            resolve_call(static_cast<CallExp&>(exp));
+            break;
+
+        case ExpKind::OP: {
+            auto& op = static_cast<OpExp&>(exp);
+            resolve_exp(*op.left);
+            resolve_exp(*op.right);
+            break;
+        }
+
+        case ExpKind::RECORD:
+            for (auto& field : static_cast<RecordExp&>(exp).fields)
+                resolve_exp(*field.exp);
+            break;
+
+        case ExpKind::SEQ:
+            for (auto& e : static_cast<SeqExp&>(exp).exps) resolve_exp(*e);
+            break;
+
+        case ExpKind::ASSIGN: {
+            auto& assign = static_cast<AssignExp&>(exp);
+            resolve_var(*assign.var);
+            resolve_exp(*assign.exp);
+            break;
+        }
+
+        case ExpKind::IF: {
+            auto& if_exp = static_cast<IfExp&>(exp);
+            resolve_exp(*if_exp.test);
+            resolve_exp(*if_exp.then_exp);
+            if (if_exp.else_exp) resolve_exp(*if_exp.else_exp);
+            break;
+        }
+
+        case ExpKind::WHILE: {
+            auto& loop = static_cast<WhileExp&>(exp);
+            resolve_exp(*loop.test);
+            resolve_exp(*loop.body);
+            break;
+        }
+
+        case ExpKind::FOR: {
+            auto& loop = static_cast<ForExp&>(exp);
+            resolve_exp(*loop.lo);
+            resolve_exp(*loop.hi);
+            uint32_t saved = frames_.back().next;
+            env_.beginScope();
+            loop.slot = new_slot();
+            bind(loop.var, loop.slot, &loop.escape);
+            resolve_exp(*loop.body);
+            env_.endScope();
+            frames_.back().next = saved;
+            break;
+        }
+
+        case ExpKind::LET: {
+            auto& let = static_cast<LetExp&>(exp);
+            uint32_t saved = frames_.back().next;
+            env_.beginScope();
+            resolve_decs(let.decs);
+            for (auto& e : let.body) resolve_exp(*e);
+            env_.endScope();
+            frames_.back().next = saved;
+            break;
+        }
+
+        case ExpKind::ARRAY: {
+            auto& array = static_cast<ArrayExp&>(exp);
+            resolve_exp(*array.size);
+            resolve_exp(*array.init);
+            break;
+        }
+    }
+}
+
+void Resolver::resolve_var(Var& var) {
+    switch (var.kind) {
+        case VarKind::SIMPLE: {
+            auto& simple = static_cast<SimpleVar&>(var);
+            const Binding* binding = env_.look(Symbol::intern(simple.name));
+            if (binding && binding->variable()) {
+                simple.depth = level() - binding->level;
+                simple.slot = binding->index;
+                if (simple.depth > 0) *binding->escape = true;
+            } else {
+                simple.depth = simple.slot = UNRESOLVED;
+                unresolved_++;
+            }
+            break;
+        }
+
+        case VarKind::FIELD:
+            resolve_var(*static_cast<FieldVar&>(var).var);
+            break;
+
+        case VarKind::SUBSCRIPT: {
+            auto& sub = static_cast<SubscriptVar&>(var);
+            resolve_var(*sub.var);
+            resolve_exp(*sub.index);
+            break;
+        }
+    }
+}
+
+void Resolver::resolve_call(CallExp& call) {
+    Sym sym = Symbol::intern(call.func);
+    if (const Binding* binding = env_.look(sym)) {
+        if (!binding->variable()) {
+            call.func_id = binding->index;
+            call.depth = level() - binding->level;
+        } else {
+            call.func_id = call.depth = UNRESOLVED;
+            unresolved_++;
+        }
+    } else if (base_env::function(sym)) {
+        // Library functions take no static link.
+        call.func_id = sym->id - builtin::PRINT_ID;
+        call.depth = 0;
+    } else {
+        call.func_id = call.depth = UNRESOLVED;
+        unresolved_++;
+    }
+    for (auto& arg : call.args) resolve_exp(*arg);
+}
+
+// ============================================================================
+// Declarations
+// ============================================================================
+//
+// Batches as in TypeChecker::check_decs. Type declarations bind no values.
+
+void Resolver::resolve_decs(std::vector<DecPtr>& decs) {
+    std::size_t i = 0;
+    while (i < decs.size()) {
+        DecKind kind = decs[i]->kind;
+        std::size_t end = i + 1;
+        if (kind == DecKind::FUNCTION) {
+            while (end < decs.size() && decs[end]->kind == kind) end++;
+            resolve_function_batch(decs, i, end);
+        } else if (kind == DecKind::VAR) {
+            auto& dec = static_cast<VarDec&>(*decs[i]);
+            if (dec.init) resolve_exp(*dec.init);
+            dec.slot = new_slot();
+            bind(dec.name, dec.slot, &dec.escape);
+        }
+        i = end;
+    }
+}
+
+void Resolver::resolve_function_batch(std::vector<DecPtr>& decs, std::size_t begin,
+                                      std::size_t end) {
+    for (std::size_t i = begin; i < end; i++) {
+        auto& dec = static_cast<FunctionDec&>(*decs[i]);
+        dec.id = static_cast<uint32_t>(base_env::FUNCTION_COUNT + functions_.size());
+        functions_.push_back(&dec);
+        bind(dec.name, dec.id, nullptr);
+    }
+
+    for (std::size_t i = begin; i < end; i++) {
+        auto& dec = static_cast<FunctionDec&>(*decs[i]);
+        uint32_t params = static_cast<uint32_t>(dec.params.size());
+        frames_.push_back({params, params});
+        env_.beginScope();
+        for (uint32_t p = 0; p < params; p++)
+            bind(dec.params[p].name, p, &dec.params[p].escape);
+        if (dec.body) resolve_exp(*dec.body);
+        env_.endScope();
+        dec.frame_size = frames_.back().size;
+        frames_.pop_back();
+    }
+}
+
+} // namespace tiger::semantic
@@ -0,0 +1,96 @@
+#ifndef TIGER_RESOLVER_HPP
+#define TIGER_RESOLVER_HPP
+
+// ============================================================================
+// Static resolution of names to frame slots (Appel ch. 6, "Frames").
+//
+// Every function gets a frame: parameter i is slot i, and each variable
+// declared in its body (VarDec, for-loop counter) gets the next free slot.
+// The top-level expression has a frame of its own. Slots are reused once
+// the `let` or `for` that declared them ends, so a frame is as large as
+// the most variables live at once (FunctionDec::frame_size,
+// Program::frame_size).
+//
+// A use of a variable (SimpleVar) is annotated with
+//   depth  the number of static links to follow: 0 is the current frame,
+//          1 the frame of the enclosing function, ...
+//   slot   the variable's slot in that frame
+// and a call (CallExp) with the callee's id and the depth of the frame
+// the callee was declared in, which is the static link to pass it.
+// Library functions have ids 0..base_env::FUNCTION_COUNT-1, in builtin
+// order; user functions follow in declaration order (see functions()).
+//
+// Escape analysis (Appel 6.2, "FindEscape") comes with it: a variable,
+// parameter or loop counter escapes if it is used from a function nested
+// in the one that declares it (a use with depth > 0). VarDec::escape,
+// ForExp::escape and TypeField::escape are set accordingly. A variable
+// that does not escape is only ever touched through its own frame, so a
+// back end may keep it in a register.
+//
+// Scoping follows the type checker: the functions of a batch are all
+// bound before any body is resolved, a variable is bound after its
+// initializer, and a for-loop counter only in the loop body. Types are
+// not needed, so this can run on any parsed tree; a name that does not
+// resolve (or resolves to the wrong kind) is left UNRESOLVED for the type
+// checker to report.
+// ============================================================================
+
+#include "env/symbol.hpp"
+#include "parser/AST.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace tiger::semantic {
+
+class Resolver {
+public:
+    // Annotates every name in `prog`. May be called again (on the same or
+    // another program); each call starts from the base environment.
+    void resolve(Program& prog);
+
+    // User functions of the last program, by id - base_env::FUNCTION_COUNT.
+    const std::vector<FunctionDec*>& functions() const { return functions_; }
+
+    // Variable uses and calls of the last program left UNRESOLVED.
+    std::size_t unresolved() const { return unresolved_; }
+
+private:
+    // What a name is bound to: a variable in slot `index` of the frame at
+    // `level` (with its declaration's escape flag), or the function with
+    // id `index` declared at `level`.
+    struct Binding {
+        uint32_t level;
+        uint32_t index;
+        bool* escape;      // nullptr for functions
+
+        bool variable() const { return escape != nullptr; }
+    };
+
+    struct Frame {
+        uint32_t next;   // first free slot
+        uint32_t size;   // most slots in use at once
+    };
+
+    SymbolTable<const Binding> env_;
+    std::deque<Binding> bindings_;
+    std::vector<Frame> frames_;
+    std::vector<FunctionDec*> functions_;
+    std::size_t unresolved_ = 0;
+
+    uint32_t level() const { return static_cast<uint32_t>(frames_.size() - 1); }
+    uint32_t new_slot();
+    void bind(const std::string& name, uint32_t index, bool* escape);
+
+    void resolve_exp(Exp& exp);
+    void resolve_var(Var& var);
+    void resolve_call(CallExp& call);
+    void resolve_decs(std::vector<DecPtr>& decs);
+    void resolve_function_batch(std::vector<DecPtr>& decs, std::size_t begin,
+                                std::size_t end);
+};
+
+} // namespace tiger::semantic
+
+#endif // TIGER_RESOLVER_HPP
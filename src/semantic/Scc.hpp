@@ -0,0 +1,93 @@
+#ifndef TIGER_SCC_HPP
+#define TIGER_SCC_HPP
+
+// ============================================================================
+// Strongly connected components (Tarjan), without recursion.
+//
+// Nodes are 0..n-1; the graph is given in compressed form: the successors
+// of node v are targets[offsets[v] .. offsets[v+1]). Runs in O(n + edges)
+// with an explicit stack, so a 100k-long dependency chain does not
+// overflow the call stack.
+//
+// Components are numbered in the order Tarjan completes them, which is a
+// reverse topological order: every edge goes from a component to one with
+// a smaller or equal number. Processing components 0, 1, 2, ... therefore
+// sees each dependency before its users.
+// ============================================================================
+
+#include <cstdint>
+#include <vector>
+
+namespace tiger::semantic {
+
+struct SccResult {
+    std::vector<uint32_t> component;   // node -> component number
+    uint32_t count = 0;                // number of components
+};
+
+inline SccResult tarjan_scc(uint32_t n, const std::vector<uint32_t>& offsets,
+                            const std::vector<uint32_t>& targets) {
+    constexpr uint32_t UNVISITED = UINT32_MAX;
+
+    SccResult result;
+    result.component.assign(n, UNVISITED);
+    std::vector<uint32_t> index(n, UNVISITED);
+    std::vector<uint32_t> low(n, 0);
+    std::vector<uint32_t> stack;         // Tarjan's node stack
+    std::vector<bool> on_stack(n, false);
+
+    // DFS frames: node and position in its successor list.
+    struct Frame {
+        uint32_t node;
+        uint32_t next;
+    };
+    std::vector<Frame> dfs;
+    uint32_t counter = 0;
+
+    for (uint32_t root = 0; root < n; root++) {
+        if (index[root] != UNVISITED) continue;
+        dfs.push_back({root, offsets[root]});
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        on_stack[root] = true;
+
+        while (!dfs.empty()) {
+            Frame& f = dfs.back();
+            uint32_t v = f.node;
+            if (f.next < offsets[v + 1]) {
+                uint32_t w = targets[f.next++];
+                if (index[w] == UNVISITED) {
+                    index[w] = low[w] = counter++;
+                    stack.push_back(w);
+                    on_stack[w] = true;
+                    dfs.push_back({w, offsets[w]});   // invalidates f
+                } else if (on_stack[w] && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+                continue;
+            }
+
+            // All successors done: v is a root if nothing reached above it.
+            if (low[v] == index[v]) {
+                uint32_t w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    on_stack[w] = false;
+                    result.component[w] = result.count;
+                } while (w != v);
+                result.count++;
+            }
+            dfs.pop_back();
+            if (!dfs.empty()) {
+                uint32_t parent = dfs.back().node;
+                if (low[v] < low[parent]) low[parent] = low[v];
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace tiger::semantic
+
+#endif // TIGER_SCC_HPP
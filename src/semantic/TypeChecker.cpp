@@ -0,0 +1,970 @@
+#include "TypeChecker.hpp"
+#include "semantic/BaseEnv.hpp"
+#include "semantic/Scc.hpp"
+#include <algorithm>
+#include <array>
+#include <sstream>
+
+namespace tiger::semantic {
+
+// ============================================================================
+// ExpTypes
+// ============================================================================
+
+void ExpTypes::set(const Exp* exp, const Type* type) {
+    if ((used_ + 1) * 2 > slots_.size()) {
+        std::vector<Slot> old(slots_.size() * 2);
+        old.swap(slots_);
+        for (const Slot& s : old)
+            if (s.exp) slots_[find(s.exp)] = s;
+    }
+    Slot& s = slots_[find(exp)];
+    if (!s.exp) {
+        s.exp = exp;
+        used_++;
+    }
+    s.type = type;
+}
+
+void ExpTypes::clear() {
+    std::fill(slots_.begin(), slots_.end(), Slot{});
+    used_ = 0;
+}
+
+// ============================================================================
+// Base environment
+// ============================================================================
+//
+// Value entries for the library functions, indexed by builtin id (the
+// type names have no value entry), built at compile time from BaseEnv.
+
+namespace {
+
+constexpr std::array<ValueEntry, builtin::COUNT> make_builtin_values() {
+    std::array<ValueEntry, builtin::COUNT> values{};
+    for (std::size_t i = 0; i < base_env::FUNCTION_COUNT; i++)
+        values[builtin::PRINT_ID + i] = {nullptr, &base_env::FUNCTIONS[i].sig, false};
+    return values;
+}
+
+constexpr std::array<ValueEntry, builtin::COUNT> BUILTIN_VALUES = make_builtin_values();
+
+} // namespace
+
+// Own scopes first, then the enclosing checkers' (frozen while we run),
+// then the base environment.
+const Type* TypeChecker::find_type(Sym sym) const {
+    if (!dep_stack_.empty()) dep_stack_.back().push_back({sym, true});
+    for (const TypeChecker* c = this; c; c = c->parent_)
+        if (const Type* type = c->tenv_.look(sym)) return type;
+    return base_env::type(sym);
+}
+
+const Type* TypeChecker::lookup_type(const std::string& name, Position pos, bool raw) {
+    const Type* type = find_type(Symbol::intern(name));
+    if (!type) {
+        error(pos, "undefined type " + name);
+        return nullptr;
+    }
+    return raw ? type : actual(type);
+}
+
+const ValueEntry* TypeChecker::lookup_value(Sym sym) const {
+    if (!dep_stack_.empty()) dep_stack_.back().push_back({sym, false});
+    for (const TypeChecker* c = this; c; c = c->parent_)
+        if (const ValueEntry* entry = c->venv_.look(sym)) return entry;
+    if (sym->id < builtin::COUNT && BUILTIN_VALUES[sym->id].sig)
+        return &BUILTIN_VALUES[sym->id];
+    return nullptr;
+}
+
+const ValueEntry* TypeChecker::bind_value(Sym sym, const Type* type,
+                                          const FunSig* sig, bool read_only) {
+    values_.push_back({type, sig, read_only});
+    venv_.enter(sym, &values_.back());
+    return &values_.back();
+}
+
+// ============================================================================
+// Diagnostics
+// ============================================================================
+
+void TypeChecker::error(Position pos, const std::string& msg) {
+    std::ostringstream oss;
+    oss << pos.line << ":" << pos.column << ": error: " << msg;
+    errors_.push_back(oss.str());
+    error_positions_.push_back(pos);
+}
+
+void TypeChecker::expect(const Type* expected, const Type* actual, Position pos,
+                         const char* what) {
+    if (!compatible(expected, actual)) {
+        error(pos, std::string(what) + ": expected " + type_name(expected) +
+                   ", got " + type_name(actual));
+    }
+}
+
+// Marks `sym` as member `index` of the current batch; false if it
+// already was a member (the later declaration wins, as in the scope).
+bool TypeChecker::mark_in_batch(Sym sym, uint32_t index) {
+    if (sym->id >= batch_marks_.size()) {
+        std::size_t size = std::max<std::size_t>(Symbol::count(), sym->id + 1);
+        batch_marks_.resize(size, BatchMark{0, 0});
+    }
+    BatchMark& mark = batch_marks_[sym->id];
+    bool fresh = mark.batch != batch_;
+    mark = {batch_, index};
+    return fresh;
+}
+
+bool TypeChecker::in_batch(Sym sym, uint32_t& index) const {
+    if (sym->id >= batch_marks_.size() || batch_marks_[sym->id].batch != batch_) return false;
+    index = batch_marks_[sym->id].index;
+    return true;
+}
+
+// ============================================================================
+// Program
+// ============================================================================
+
+bool TypeChecker::check(const Program& prog) {
+    reset_incremental();
+    errors_.clear();
+    error_positions_.clear();
+    children_.clear();
+    exp_types_.clear();
+    values_.clear();
+    nodes_ = 0;
+    loop_depth_ = 0;
+
+    tenv_.beginScope();
+    venv_.beginScope();
+    if (prog.exp) check_exp(*prog.exp);
+    venv_.endScope();
+    tenv_.endScope();
+    return errors_.empty();
+}
+
+const Type* TypeChecker::type_of(const Exp* exp) const {
+    if (const Type* type = exp_types_.get(exp)) return type;
+    for (const TypeChecker& child : children_)
+        if (const Type* type = child.type_of(exp)) return type;
+    return nullptr;
+}
+
+std::size_t TypeChecker::typed_count() const {
+    std::size_t count = exp_types_.size();
+    for (const TypeChecker& child : children_) count += child.typed_count();
+    return count;
+}
+
+// ============================================================================
+// Expressions
+// ============================================================================
+
+const Type* TypeChecker::check_exp(const Exp& exp) {
+    nodes_++;
+    const Type* type = check_exp_inner(exp);
+    // Incremental passes keep the table, so a node whose address was
+    // reused must not keep a stale type: errors are recorded too.
+    if (type || incremental_) {
+        exp_types_.set(&exp, type);
+        typed_++;
+    }
+    return type;
+}
+
+const Type* TypeChecker::check_exp_inner(const Exp& exp) {
+    switch (exp.kind) {
+        case ExpKind::VAR:
+            return check_var(*static_cast<const VarExp&>(exp).var);
+
+        case ExpKind::NIL:
+            return &NIL_TYPE;
+
+        case ExpKind::INT:
+            return &INT_TYPE;
+
+        case ExpKind::STRING:
+            return &STRING_TYPE;
+
+        case ExpKind::CALL:
+            return check_call(static_cast<const CallExp&>(exp));
+
+        case ExpKind::OP:
+            return check_op(static_cast<const OpExp&>(exp));
+
+        case ExpKind::RECORD:
+            return check_record(static_cast<const RecordExp&>(exp));
+
+        case ExpKind::SEQ: {
+            const Type* type = &UNIT_TYPE;
+            for (const auto& e : static_cast<const SeqExp&>(exp).exps)
+                type = check_exp(*e);
+            return type;
+        }
+
+        case ExpKind::ASSIGN: {
+            auto& assign = static_cast<const AssignExp&>(exp);
+            if (assign.var->kind == VarKind::SIMPLE) {
+                auto& simple = static_cast<const SimpleVar&>(*assign.var);
+                const ValueEntry* entry = lookup_value(Symbol::intern(simple.name));
+                if (entry && entry->read_only)
+                    error(assign.pos, "cannot assign to loop variable " + simple.name);
+            }
+            const Type* var_type = check_var(*assign.var);
+            const Type* exp_type = check_exp(*assign.exp);
+            expect(var_type, exp_type, assign.exp->pos, "assignment");
+            return &UNIT_TYPE;
+        }
+
+        case ExpKind::IF: {
+            auto& if_exp = static_cast<const IfExp&>(exp);
+            expect(&INT_TYPE, check_exp(*if_exp.test), if_exp.test->pos, "if condition");
+            const Type* then_type = check_exp(*if_exp.then_exp);
+            if (!if_exp.else_exp) {
+                expect(&UNIT_TYPE, then_type, if_exp.then_exp->pos,
+                       "if-then without else must produce no value");
+                return &UNIT_TYPE;
+            }
+            const Type* else_type = check_exp(*if_exp.else_exp);
+            if (!compatible(then_type, else_type)) {
+                error(if_exp.pos, "if branches have different types: " +
+                                  type_name(then_type) + " and " + type_name(else_type));
+                return nullptr;
+            }
+            if (!then_type || !else_type) return nullptr;
+            return then_type->kind == TypeKind::NIL ? else_type : then_type;
+        }
+
+        case ExpKind::WHILE: {
+            auto& loop = static_cast<const WhileExp&>(exp);
+            expect(&INT_TYPE, check_exp(*loop.test), loop.test->pos, "while condition");
+            loop_depth_++;
+            expect(&UNIT_TYPE, check_exp(*loop.body), loop.body->pos,
+                   "while body must produce no value");
+            loop_depth_--;
+            return &UNIT_TYPE;
+        }
+
+        case ExpKind::FOR: {
+            auto& loop = static_cast<const ForExp&>(exp);
+            expect(&INT_TYPE, check_exp(*loop.lo), loop.lo->pos, "for lower bound");
+            expect(&INT_TYPE, check_exp(*loop.hi), loop.hi->pos, "for upper bound");
+            venv_.beginScope();
+            bind_value(Symbol::intern(loop.var), &INT_TYPE, nullptr, true);
+            loop_depth_++;
+            expect(&UNIT_TYPE, check_exp(*loop.body), loop.body->pos,
+                   "for body must produce no value");
+            loop_depth_--;
+            venv_.endScope();
+            return &UNIT_TYPE;
+        }
+
+        case ExpKind::BREAK:
+            if (loop_depth_ == 0) error(exp.pos, "break outside of a loop");
+            return &UNIT_TYPE;
+
+        case ExpKind::LET:
+            return check_let(static_cast<const LetExp&>(exp));
+
+        case ExpKind::ARRAY: {
+            auto& array = static_cast<const ArrayExp&>(exp);
+            const Type* type = lookup_type(array.type_id, array.pos);
+            expect(&INT_TYPE, check_exp(*array.size), array.size->pos, "array size");
+            const Type* init = check_exp(*array.init);
+            if (!type) return nullptr;
+            if (type->kind != TypeKind::ARRAY) {
+                error(array.pos, array.type_id + " is not an array type");
+                return nullptr;
+            }
+            expect(static_cast<const ArrayType*>(type)->element, init, array.init->pos,
+                   "array initializer");
+            return type;
+        }
+    }
+    return nullptr;
+}
+
+const Type* TypeChecker::check_call(const CallExp& call) {
+    const ValueEntry* entry = lookup_value(Symbol::intern(call.func));
+    const FunSig* sig = nullptr;
+    if (!entry) {
+        error(call.pos, "undefined function " + call.func);
+    } else if (!entry->sig) {
+        error(call.pos, call.func + " is not a function");
+    } else {
+        sig = entry->sig;
+        if (call.args.size() != sig->param_count) {
+            error(call.pos, call.func + " expects " + std::to_string(sig->param_count) +
+                            " arguments, got " + std::to_string(call.args.size()));
+        }
+    }
+
+    for (std::size_t i = 0; i < call.args.size(); i++) {
+        const Type* arg = check_exp(*call.args[i]);
+        if (sig && i < sig->param_count)
+            expect(sig->params[i], arg, call.args[i]->pos, "argument");
+    }
+    return sig ? sig->result : nullptr;
+}
+
+const Type* TypeChecker::check_op(const OpExp& op) {
+    const Type* left = check_exp(*op.left);
+    const Type* right = check_exp(*op.right);
+
+    switch (op.op) {
+        case Op::PLUS:
+        case Op::MINUS:
+        case Op::TIMES:
+        case Op::DIVIDE:
+            expect(&INT_TYPE, left, op.left->pos, "arithmetic operand");
+            expect(&INT_TYPE, right, op.right->pos, "arithmetic operand");
+            break;
+
+        case Op::LT:
+        case Op::LE:
+        case Op::GT:
+        case Op::GE:
+            if (left && left != &INT_TYPE && left != &STRING_TYPE) {
+                error(op.left->pos, "cannot order values of type " + type_name(left));
+            } else {
+                expect(left ? left : &INT_TYPE, right, op.right->pos, "comparison");
+            }
+            break;
+
+        case Op::EQ:
+        case Op::NEQ:
+            if (left && right && left->kind == TypeKind::NIL &&
+                right->kind == TypeKind::NIL) {
+                error(op.pos, "cannot compare nil with nil");
+            } else if (left == &UNIT_TYPE || right == &UNIT_TYPE) {
+                error(op.pos, "cannot compare values of type unit");
+            } else if (!compatible(left, right)) {
+                error(op.pos, "cannot compare " + type_name(left) + " with " +
+                              type_name(right));
+            }
+            break;
+    }
+    return &INT_TYPE;
+}
+
+const Type* TypeChecker::check_record(const RecordExp& rec) {
+    const Type* type = lookup_type(rec.type_id, rec.pos);
+    const RecordType* record = nullptr;
+    if (type && type->kind != TypeKind::RECORD) {
+        error(rec.pos, rec.type_id + " is not a record type");
+    } else if (type) {
+        record = static_cast<const RecordType*>(type);
+        if (rec.fields.size() != record->fields.size()) {
+            error(rec.pos, rec.type_id + " has " + std::to_string(record->fields.size()) +
+                           " fields, got " + std::to_string(rec.fields.size()));
+        }
+    }
+
+    for (std::size_t i = 0; i < rec.fields.size(); i++) {
+        const Field& field = rec.fields[i];
+        const Type* value = check_exp(*field.exp);
+        field.slot = UNRESOLVED;
+        if (!record || i >= record->fields.size()) continue;
+        const RecordField& expected = record->fields[i];
+        if (Symbol::intern(field.name) != expected.name) {
+            error(field.pos, "expected field " + std::string(Symbol::name(expected.name)) +
+                             ", got " + field.name);
+        } else {
+            // Initializers must come in declaration order, so the slot is
+            // the position; a record value is fields.size() slots.
+            field.slot = static_cast<uint32_t>(i);
+            expect(expected.type, value, field.exp->pos, "record field");
+        }
+    }
+    return record;
+}
+
+const Type* TypeChecker::check_let(const LetExp& let) {
+    tenv_.beginScope();
+    venv_.beginScope();
+    check_decs(let.decs);
+    const Type* type = &UNIT_TYPE;
+    for (const auto& e : let.body) type = check_exp(*e);
+    venv_.endScope();
+    tenv_.endScope();
+    return type;
+}
+
+// ============================================================================
+// Variables
+// ============================================================================
+
+const Type* TypeChecker::check_var(const Var& var) {
+    nodes_++;
+    switch (var.kind) {
+        case VarKind::SIMPLE: {
+            auto& simple = static_cast<const SimpleVar&>(var);
+            const ValueEntry* entry = lookup_value(Symbol::intern(simple.name));
+            if (!entry) {
+                error(var.pos, "undefined variable " + simple.name);
+                return nullptr;
+            }
+            if (entry->sig) {
+                error(var.pos, simple.name + " is a function, not a variable");
+                return nullptr;
+            }
+            return entry->type;
+        }
+
+        case VarKind::FIELD: {
+            auto& field = static_cast<const FieldVar&>(var);
+            field.slot = UNRESOLVED;
+            const Type* type = check_var(*field.var);
+            if (!type) return nullptr;
+            if (type->kind != TypeKind::RECORD) {
+                error(var.pos, "field access on non-record type " + type_name(type));
+                return nullptr;
+            }
+            auto* record = static_cast<const RecordType*>(type);
+            int i = record->field_index(Symbol::intern(field.field));
+            if (i < 0) {
+                error(var.pos, type_name(type) + " has no field " + field.field);
+                return nullptr;
+            }
+            field.slot = static_cast<uint32_t>(i);
+            return record->fields[i].type;
+        }
+
+        case VarKind::SUBSCRIPT: {
+            auto& sub = static_cast<const SubscriptVar&>(var);
+            const Type* type = check_var(*sub.var);
+            expect(&INT_TYPE, check_exp(*sub.index), sub.index->pos, "array index");
+            if (!type) return nullptr;
+            if (type->kind != TypeKind::ARRAY) {
+                error(var.pos, "subscript on non-array type " + type_name(type));
+                return nullptr;
+            }
+            return static_cast<const ArrayType*>(type)->element;
+        }
+    }
+    return nullptr;
+}
+
+// ============================================================================
+// Declarations
+// ============================================================================
+//
+// Consecutive type declarations, and consecutive function declarations,
+// form a batch that may refer to itself recursively: every name in the
+// batch is bound before any right-hand side is looked at.
+
+void TypeChecker::check_decs(const std::vector<DecPtr>& decs) {
+    std::size_t i = 0;
+    while (i < decs.size()) {
+        DecKind kind = decs[i]->kind;
+        std::size_t end = i + 1;
+        if (kind != DecKind::VAR) {
+            while (end < decs.size() && decs[end]->kind == kind) end++;
+        }
+        switch (kind) {
+            case DecKind::VAR:
+                check_var_dec(static_cast<const VarDec&>(*decs[i]));
+                break;
+            case DecKind::TYPE:
+                check_type_batch(decs, i, end);
+                break;
+            case DecKind::FUNCTION:
+                check_function_batch(decs, i, end);
+                break;
+        }
+        i = end;
+    }
+}
+
+void TypeChecker::check_var_dec(const VarDec& dec) {
+    nodes_++;
+    std::size_t saved_base = dec_base_;
+    bool saved_fresh = fresh_;
+    dec_base_ += dec.offset;
+    fresh_ = fresh_ || &dec == reparsed_;
+    const Type* init = check_exp(*dec.init);
+    dec_base_ = saved_base;
+    fresh_ = saved_fresh;
+    const Type* type = init;
+    if (!dec.type_id.empty()) {
+        type = lookup_type(dec.type_id, dec.pos);
+        expect(type, init, dec.init->pos, "variable initializer");
+    } else if (init && init->kind == TypeKind::NIL) {
+        error(dec.pos, "nil initializer of " + dec.name + " needs a record type");
+        type = nullptr;
+    }
+    bind_value(Symbol::intern(dec.name), type, nullptr, false);
+}
+
+// Every name of the batch is bound to a placeholder first, so right-hand
+// sides may refer to any of them. While translating, each reference to a
+// batch member becomes an edge of the batch's dependency graph; Tarjan's
+// algorithm then splits it into strongly connected components in one
+// linear pass. A component that is a cycle made only of aliases
+// (type a = b, type b = a) can never become a type and is reported once;
+// every other cycle goes through a record or array and is legal.
+// Components come out dependencies-first, so each alias is resolved by
+// following its chain to the first already-resolved name, and no chain is
+// walked twice.
+void TypeChecker::check_type_batch(const std::vector<DecPtr>& decs,
+                                   std::size_t begin, std::size_t end) {
+    constexpr uint32_t NONE = UINT32_MAX;
+    const uint32_t n = static_cast<uint32_t>(end - begin);
+    auto dec_at = [&](uint32_t i) -> const TypeDec& {
+        return static_cast<const TypeDec&>(*decs[begin + i]);
+    };
+
+    batch_++;
+    std::vector<NameType*> names(n);
+    for (uint32_t i = 0; i < n; i++) {
+        Sym sym = Symbol::intern(dec_at(i).name);
+        if (!mark_in_batch(sym, i))
+            error(dec_at(i).pos, "type " + dec_at(i).name + " declared twice");
+        names[i] = types_.name(sym);
+        tenv_.enter(sym, names[i]);
+    }
+
+    // Translate right-hand sides, recording edges in compressed form.
+    BatchGraph graph;
+    graph.offsets.reserve(n + 1);
+    std::vector<uint32_t> alias_of(n, NONE);   // batch member an alias names
+    std::vector<Type*> created;
+    for (uint32_t i = 0; i < n; i++) {
+        graph.offsets.push_back(static_cast<uint32_t>(graph.targets.size()));
+        nodes_ += 2;
+        names[i]->actual = translate_ty(*dec_at(i).ty, names[i]->name, created, graph);
+        if (dec_at(i).ty->kind == TyKind::NAME && graph.targets.size() > graph.offsets[i])
+            alias_of[i] = graph.targets.back();
+    }
+    graph.offsets.push_back(static_cast<uint32_t>(graph.targets.size()));
+
+    SccResult scc = tarjan_scc(n, graph.offsets, graph.targets);
+
+    // Members grouped by component (counting sort), components in order.
+    std::vector<uint32_t> start(scc.count + 1, 0);
+    for (uint32_t c : scc.component) start[c + 1]++;
+    for (uint32_t c = 0; c < scc.count; c++) start[c + 1] += start[c];
+    std::vector<uint32_t> members(n);
+    {
+        std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+        for (uint32_t i = 0; i < n; i++) members[fill[scc.component[i]]++] = i;
+    }
+
+    std::vector<const Type*> resolved(n, nullptr);
+    std::vector<bool> done(n, false);
+    std::vector<uint32_t> path;
+    for (uint32_t c = 0; c < scc.count; c++) {
+        uint32_t first = members[start[c]];
+        uint32_t size = start[c + 1] - start[c];
+        bool cyclic = size > 1 || alias_of[first] == first;
+        bool all_aliases = true;
+        for (uint32_t k = start[c]; k < start[c + 1]; k++)
+            all_aliases = all_aliases && alias_of[members[k]] != NONE;
+
+        if (cyclic && all_aliases) {
+            std::string cycle;
+            for (uint32_t k = start[c]; k < start[c + 1] && k < start[c] + 4; k++)
+                cycle += (cycle.empty() ? "" : ", ") + dec_at(members[k]).name;
+            if (size > 4) cycle += ", ... (" + std::to_string(size) + " types)";
+            error(dec_at(first).pos, "illegal cycle in type declarations: " + cycle);
+            for (uint32_t k = start[c]; k < start[c + 1]; k++) done[members[k]] = true;
+            continue;
+        }
+
+        for (uint32_t k = start[c]; k < start[c + 1]; k++) {
+            uint32_t cur = members[k];
+            path.clear();
+            while (!done[cur] && alias_of[cur] != NONE) {
+                path.push_back(cur);
+                cur = alias_of[cur];
+            }
+            const Type* type = done[cur] ? resolved[cur] : actual(names[cur]->actual);
+            path.push_back(cur);
+            for (uint32_t p : path) {
+                resolved[p] = type;
+                done[p] = true;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        names[i]->actual = resolved[i];
+        if (resolved[i]) tenv_.enter(names[i]->name, resolved[i]);
+    }
+
+    // No record or array keeps pointing at a placeholder.
+    for (Type* type : created) {
+        if (type->kind == TypeKind::RECORD) {
+            for (RecordField& f : static_cast<RecordType*>(type)->fields) f.type = actual(f.type);
+        } else {
+            auto* array = static_cast<ArrayType*>(type);
+            array->element = actual(array->element);
+        }
+    }
+    if (incremental_) fingerprint_batch(created);
+}
+
+// Looks up a name on the right-hand side of a type declaration; a
+// reference to a member of the current batch adds an edge to the graph.
+const Type* TypeChecker::batch_ref(const std::string& name, Position pos, BatchGraph& graph) {
+    Sym sym = Symbol::intern(name);
+    const Type* type = lookup_type(name, pos, true);
+    uint32_t member;
+    if (type && type->kind == TypeKind::NAME && in_batch(sym, member))
+        graph.targets.push_back(member);
+    return type;
+}
+
+const Type* TypeChecker::translate_ty(const Ty& ty, Sym name, std::vector<Type*>& created,
+                                      BatchGraph& graph) {
+    switch (ty.kind) {
+        case TyKind::NAME:
+            return batch_ref(static_cast<const NameTy&>(ty).name, ty.pos, graph);
+
+        case TyKind::RECORD: {
+            auto& record_ty = static_cast<const RecordTy&>(ty);
+            RecordType* record = types_.record(&ty, name);
+            record->name = name;
+            record->fields.clear();
+            for (const TypeField& f : record_ty.fields) {
+                Sym field = Symbol::intern(f.name);
+                if (record->field_index(field) >= 0)
+                    error(f.pos, "field " + f.name + " declared twice");
+                record->fields.push_back({field, batch_ref(f.type_id, f.pos, graph)});
+            }
+            created.push_back(record);
+            return record;
+        }
+
+        case TyKind::ARRAY: {
+            auto& array_ty = static_cast<const ArrayTy&>(ty);
+            ArrayType* array = types_.array(
+                &ty, name, batch_ref(array_ty.element_type, ty.pos, graph));
+            array->name = name;
+            created.push_back(array);
+            return array;
+        }
+    }
+    return nullptr;
+}
+
+// Functions need no graph: all headers of the batch are bound before any
+// body is checked, and a body only needs the callee's signature, so each
+// body is checked exactly once in any order.
+void TypeChecker::check_function_batch(const std::vector<DecPtr>& decs,
+                                       std::size_t begin, std::size_t end) {
+    batch_++;
+    std::vector<const FunSig*> sigs;
+    sigs.reserve(end - begin);
+    for (std::size_t i = begin; i < end; i++) {
+        auto& dec = static_cast<const FunctionDec&>(*decs[i]);
+        Sym sym = Symbol::intern(dec.name);
+        if (!mark_in_batch(sym, static_cast<uint32_t>(i - begin)))
+            error(dec.pos, "function " + dec.name + " declared twice");
+
+        std::vector<const Type*> params;
+        params.reserve(dec.params.size());
+        for (const TypeField& p : dec.params) params.push_back(lookup_type(p.type_id, p.pos));
+        const Type* result = dec.result_type.empty()
+            ? &UNIT_TYPE : lookup_type(dec.result_type, dec.pos);
+        sigs.push_back(types_.signature(std::move(params), result));
+        bind_value(sym, nullptr, sigs.back(), false);
+    }
+
+    if (incremental_) {
+        memo_stamp_++;
+        for (std::size_t i = begin; i < end; i++)
+            check_body_cached(static_cast<const FunctionDec&>(*decs[i]), sigs[i - begin]);
+        return;
+    }
+    if (pool_ && pool_->size() > 1 && end - begin > 1) {
+        check_bodies_parallel(decs, begin, end, sigs);
+        return;
+    }
+    for (std::size_t i = begin; i < end; i++)
+        check_body(static_cast<const FunctionDec&>(*decs[i]), sigs[i - begin]);
+}
+
+void TypeChecker::check_body(const FunctionDec& dec, const FunSig* sig) {
+    nodes_++;
+    venv_.beginScope();
+    batch_++;
+    for (std::size_t p = 0; p < dec.params.size(); p++) {
+        Sym sym = Symbol::intern(dec.params[p].name);
+        if (!mark_in_batch(sym, static_cast<uint32_t>(p)))
+            error(dec.params[p].pos, "parameter " + dec.params[p].name + " declared twice");
+        bind_value(sym, sig->params[p], nullptr, false);
+    }
+
+    std::size_t saved_loops = loop_depth_;
+    loop_depth_ = 0;   // break cannot leave the function
+    const Type* body = check_exp(*dec.body);
+    loop_depth_ = saved_loops;
+
+    expect(sig->result, body, dec.body->pos,
+           dec.result_type.empty() ? "procedure body must produce no value"
+                                   : "function body");
+    venv_.endScope();
+}
+
+// Bodies are split into contiguous chunks (a few per thread, so stealing
+// can even out uneven bodies), each checked by its own child. This checker
+// only waits, so its environments stay as the headers left them. Children
+// share the pool: a nested batch inside a body forks again, and a thread
+// waiting for it runs other tasks meanwhile. Concatenating the children's
+// errors in chunk order gives exactly the sequential order.
+void TypeChecker::check_bodies_parallel(const std::vector<DecPtr>& decs, std::size_t begin,
+                                        std::size_t end,
+                                        const std::vector<const FunSig*>& sigs) {
+    std::size_t n = end - begin;
+    std::size_t chunks = std::min<std::size_t>(n, std::size_t(pool_->size()) * 4);
+    std::size_t first_child = children_.size();
+    for (std::size_t c = 0; c < chunks; c++) children_.emplace_back(ChildTag{}, pool_, this);
+
+    ThreadPool::TaskGroup group;
+    for (std::size_t c = 0; c < chunks; c++) {
+        TypeChecker* child = &children_[first_child + c];
+        std::size_t lo = begin + n * c / chunks;
+        std::size_t hi = begin + n * (c + 1) / chunks;
+        pool_->submit(group, [child, &decs, &sigs, begin, lo, hi] {
+            for (std::size_t i = lo; i < hi; i++)
+                child->check_body(static_cast<const FunctionDec&>(*decs[i]), sigs[i - begin]);
+        });
+    }
+    pool_->wait(group);
+
+    for (std::size_t c = first_child; c < children_.size(); c++) {
+        TypeChecker& child = children_[c];
+        errors_.insert(errors_.end(), child.errors_.begin(), child.errors_.end());
+        nodes_ += child.nodes_;
+    }
+}
+
+// ============================================================================
+// Incremental mode
+// ============================================================================
+
+namespace {
+
+uint64_t mix(uint64_t h, uint64_t v) {
+    h = (h ^ v) * 0x9e3779b97f4a7c15ULL;
+    return h ^ (h >> 29);
+}
+
+// Fingerprints of the primitive types and of "no binding".
+constexpr uint64_t UNBOUND = 1;
+constexpr uint64_t PRIMITIVE = 2;   // + TypeKind
+
+} // namespace
+
+void TypeChecker::reset_incremental() {
+    incremental_ = false;
+    bodies_.clear();
+    type_fingerprints_.clear();
+    dep_stack_.clear();
+    reparsed_ = nullptr;
+    fresh_ = false;
+    dec_base_ = 0;
+    typed_ = 0;
+    live_bodies_ = 0;
+    bodies_checked_ = 0;
+    bodies_reused_ = 0;
+}
+
+// One pass over the whole program with the tables of the previous pass.
+// Garbage accumulates in them (types of nodes the edits freed, entries of
+// functions that no longer exist); once it outweighs what the program
+// uses, everything is dropped and the pass is redone from scratch.
+bool TypeChecker::check_incremental(const Program& prog, const Dec* reparsed,
+                                    std::size_t edit_begin, std::size_t edit_end) {
+    incremental_ = true;
+    reparsed_ = reparsed;
+    edit_begin_ = edit_begin;
+    edit_end_ = edit_end;
+    fresh_ = false;
+    dec_base_ = 0;
+    typed_ = 0;
+    live_bodies_ = 0;
+    bodies_checked_ = 0;
+    bodies_reused_ = 0;
+    errors_.clear();
+    error_positions_.clear();
+    children_.clear();
+    values_.clear();
+    nodes_ = 0;
+    loop_depth_ = 0;
+
+    tenv_.beginScope();
+    venv_.beginScope();
+    if (prog.exp) check_exp(*prog.exp);
+    venv_.endScope();
+    tenv_.endScope();
+
+    if (exp_types_.size() > 2 * typed_ + 4096 || bodies_.size() > 2 * live_bodies_ + 64) {
+        exp_types_.clear();
+        bodies_.clear();
+        return check_incremental(prog, nullptr, 0, 0);
+    }
+    return errors_.empty();
+}
+
+// A body is walked again if the edit may have changed it (it encloses or
+// touches the edit, or it is new), if it was never checked, or if a name
+// it depends on, or its own signature, now has another fingerprint.
+// Otherwise its diagnostics are replayed at its current position, and its
+// dependencies count as the enclosing body's.
+void TypeChecker::check_body_cached(const FunctionDec& dec, const FunSig* sig) {
+    std::size_t abs = dec_base_ + dec.offset;
+    bool touched = fresh_ || &dec == reparsed_ ||
+                   (abs <= edit_end_ && edit_begin_ <= abs + dec.length);
+
+    auto it = touched ? bodies_.end() : bodies_.find(&dec);
+    if (it != bodies_.end() && fingerprint(it->second.deps, sig) == it->second.fingerprint) {
+        const CachedBody& cached = it->second;
+        for (const CachedError& e : cached.errors) {
+            Position pos(dec.pos.line + e.line,
+                         e.line == 0 ? dec.pos.column + e.column : e.column);
+            errors_.push_back(std::to_string(pos.line) + ":" + std::to_string(pos.column) +
+                              e.text);
+            error_positions_.push_back(pos);
+        }
+        if (!dep_stack_.empty()) {
+            std::vector<Dep>& outer = dep_stack_.back();
+            outer.insert(outer.end(), cached.deps.begin(), cached.deps.end());
+        }
+        typed_ += cached.typed;
+        live_bodies_ += cached.bodies;
+        bodies_reused_++;
+        return;
+    }
+
+    std::size_t first_error = errors_.size();
+    std::size_t typed_before = typed_;
+    std::size_t bodies_before = live_bodies_;
+    std::size_t saved_base = dec_base_;
+    bool saved_fresh = fresh_;
+    dec_base_ = abs;
+    fresh_ = fresh_ || &dec == reparsed_;
+    dep_stack_.emplace_back();
+
+    check_body(dec, sig);
+    memo_stamp_++;   // nested batches reused the memo for their own scope
+
+    dec_base_ = saved_base;
+    fresh_ = saved_fresh;
+    std::vector<Dep> deps = std::move(dep_stack_.back());
+    dep_stack_.pop_back();
+    std::sort(deps.begin(), deps.end(), [](const Dep& a, const Dep& b) {
+        return a.sym != b.sym ? a.sym->id < b.sym->id : a.type < b.type;
+    });
+    deps.erase(std::unique(deps.begin(), deps.end(), [](const Dep& a, const Dep& b) {
+        return a.sym == b.sym && a.type == b.type;
+    }), deps.end());
+    if (!dep_stack_.empty()) {
+        std::vector<Dep>& outer = dep_stack_.back();
+        outer.insert(outer.end(), deps.begin(), deps.end());
+    }
+
+    live_bodies_++;
+    bodies_checked_++;
+    CachedBody& cached = bodies_[&dec];
+    cached.fingerprint = fingerprint(deps, sig);
+    cached.deps = std::move(deps);
+    cached.typed = typed_ - typed_before;
+    cached.bodies = live_bodies_ - bodies_before;
+    cached.errors.clear();
+    for (std::size_t i = first_error; i < errors_.size(); i++) {
+        Position pos = error_positions_[i];
+        const std::string& err = errors_[i];
+        std::size_t text = err.find(':', err.find(':') + 1);
+        int line = pos.line - dec.pos.line;
+        cached.errors.push_back({line, line == 0 ? pos.column - dec.pos.column : pos.column,
+                                 err.substr(text)});
+    }
+}
+
+// What the body's free names resolve to now: looked up in the
+// environment of the function's header, as when the body was checked.
+uint64_t TypeChecker::fingerprint(const std::vector<Dep>& deps, const FunSig* sig) const {
+    uint64_t h = sig_fingerprint(sig);
+    for (const Dep& dep : deps) {
+        std::size_t slot = std::size_t(dep.sym->id) * 2 + dep.type;
+        if (slot >= binding_memo_.size())
+            binding_memo_.resize(std::max<std::size_t>(slot + 1, Symbol::count() * 2),
+                                 MemoEntry{0, 0});
+        MemoEntry& memo = binding_memo_[slot];
+        if (memo.stamp != memo_stamp_) memo = {memo_stamp_, binding_fingerprint(dep)};
+        h = mix(mix(h, dep.sym->id), memo.fingerprint);
+    }
+    return h;
+}
+
+uint64_t TypeChecker::binding_fingerprint(const Dep& dep) const {
+    if (dep.type) {
+        const Type* type = nullptr;
+        for (const TypeChecker* c = this; c && !type; c = c->parent_)
+            type = c->tenv_.look(dep.sym);
+        if (!type) type = base_env::type(dep.sym);
+        return type ? type_fingerprint(actual(type)) : UNBOUND;
+    }
+    const ValueEntry* entry = nullptr;
+    for (const TypeChecker* c = this; c && !entry; c = c->parent_)
+        entry = c->venv_.look(dep.sym);
+    if (!entry && dep.sym->id < builtin::COUNT && BUILTIN_VALUES[dep.sym->id].sig)
+        entry = &BUILTIN_VALUES[dep.sym->id];
+    if (!entry) return UNBOUND;
+    if (entry->sig) return sig_fingerprint(entry->sig);
+    return mix(type_fingerprint(entry->type), entry->read_only ? 5 : 4);
+}
+
+uint64_t TypeChecker::sig_fingerprint(const FunSig* sig) const {
+    uint64_t h = mix(3, sig->param_count);
+    for (std::size_t i = 0; i < sig->param_count; i++)
+        h = mix(h, type_fingerprint(sig->params[i]));
+    return mix(h, type_fingerprint(sig->result));
+}
+
+uint64_t TypeChecker::type_fingerprint(const Type* type) const {
+    if (!type) return UNBOUND;
+    if (type->kind != TypeKind::RECORD && type->kind != TypeKind::ARRAY)
+        return PRIMITIVE + static_cast<uint64_t>(type->kind);
+    auto it = type_fingerprints_.find(type);
+    return it != type_fingerprints_.end() ? it->second
+                                          : reinterpret_cast<std::uintptr_t>(type);
+}
+
+// The records and arrays of one batch may refer to each other in cycles,
+// so they share a fingerprint of the whole batch: each type's identity
+// (TypeContext keeps one object per declaration), name and fields, with
+// references inside the batch by index and references outside by their
+// own fingerprint. Earlier batches are done, so this recurses no further;
+// a change anywhere a type can reach changes the type's fingerprint.
+void TypeChecker::fingerprint_batch(const std::vector<Type*>& created) {
+    std::unordered_map<const Type*, uint64_t> index;
+    for (std::size_t i = 0; i < created.size(); i++) index.emplace(created[i], i);
+    auto ref = [&](const Type* type) {
+        auto it = index.find(type);
+        return it != index.end() ? mix(7, it->second) : type_fingerprint(type);
+    };
+
+    uint64_t h = mix(6, created.size());
+    for (const Type* type : created) {
+        h = mix(mix(h, reinterpret_cast<std::uintptr_t>(type)),
+                static_cast<uint64_t>(type->kind));
+        if (type->kind == TypeKind::RECORD) {
+            auto* record = static_cast<const RecordType*>(type);
+            h = mix(mix(h, record->name->id), record->fields.size());
+            for (const RecordField& f : record->fields)
+                h = mix(mix(h, f.name->id), ref(f.type));
+        } else {
+            auto* array = static_cast<const ArrayType*>(type);
+            h = mix(mix(h, array->name->id), ref(array->element));
+        }
+    }
+    for (std::size_t i = 0; i < created.size(); i++)
+        type_fingerprints_[created[i]] = mix(h, i);
+}
+
+} // namespace tiger::semantic
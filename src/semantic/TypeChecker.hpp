@@ -0,0 +1,273 @@
+#ifndef TIGER_TYPE_CHECKER_HPP
+#define TIGER_TYPE_CHECKER_HPP
+
+// ============================================================================
+// Type checker (Appel ch. 5, "Type-checking expressions").
+//
+// Walks the tree once. Environments are scoped SymbolTables keyed by
+// interned names: one for types, one for variables and functions. Names
+// not found there fall back to the constant base environment (BaseEnv.hpp).
+//
+// Types are canonical objects (Types.hpp), so type equality is a pointer
+// compare. The type of every expression is recorded in a side table
+// (ExpTypes) keyed by node. The only thing written to the AST is where
+// each record field lives: Field::slot and FieldVar::slot, the field's
+// index in its record type, so a record can be an array of slots.
+//
+// A nullptr type means "already reported": it is compatible with anything,
+// so one mistake produces one diagnostic.
+//
+// Given a ThreadPool, the bodies of a function batch are checked in
+// parallel once its headers are bound. Each task gets a child checker
+// whose lookups fall through to the parent's environments; the parent is
+// blocked in ThreadPool::wait meanwhile, so those are read-only snapshots.
+// Children keep their own scopes, types and ExpTypes, and their errors are
+// appended in source order, so the result matches a sequential check.
+//
+// IncrementalChecker re-checks after an edit without walking the bodies
+// the edit cannot have changed (see check_body_cached).
+// ============================================================================
+
+#include "env/symbol.hpp"
+#include "parser/AST.hpp"
+#include "semantic/Types.hpp"
+#include "util/ThreadPool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tiger::semantic {
+
+class IncrementalChecker;
+
+// What a name in the value namespace is bound to.
+struct ValueEntry {
+    const Type* type;       // variable's type; nullptr for functions
+    const FunSig* sig;      // function's signature; nullptr for variables
+    bool read_only;         // for-loop counter
+};
+
+// Side table Exp* -> Type*: open addressing on the node address, so
+// recording and querying a type never allocates per node.
+class ExpTypes {
+public:
+    ExpTypes() : slots_(INITIAL_SLOTS) {}
+
+    // nullptr if the expression was not checked (or had an error).
+    const Type* get(const Exp* exp) const {
+        const Slot& s = slots_[find(exp)];
+        return s.exp ? s.type : nullptr;
+    }
+
+    void set(const Exp* exp, const Type* type);
+    void clear();
+
+    std::size_t size() const { return used_; }
+
+private:
+    static constexpr std::size_t INITIAL_SLOTS = 1024;   // power of two
+
+    struct Slot {
+        const Exp* exp = nullptr;
+        const Type* type = nullptr;
+    };
+
+    std::vector<Slot> slots_;
+    std::size_t used_ = 0;
+
+    std::size_t find(const Exp* exp) const {
+        std::size_t mask = slots_.size() - 1;
+        std::size_t i = static_cast<std::size_t>(
+            (reinterpret_cast<std::uintptr_t>(exp) * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+        while (slots_[i].exp && slots_[i].exp != exp) i = (i + 1) & mask;
+        return i;
+    }
+};
+
+class TypeChecker {
+    struct ChildTag {};
+
+public:
+    // With a pool of more than one thread, independent function bodies
+    // are checked concurrently. The pool must outlive the checker.
+    explicit TypeChecker(ThreadPool* pool = nullptr) : pool_(pool) {}
+
+    // Checks function bodies on behalf of `parent` (see check_function_batch).
+    TypeChecker(ChildTag, ThreadPool* pool, const TypeChecker* parent)
+        : pool_(pool), parent_(parent) {}
+
+    TypeChecker(const TypeChecker&) = delete;
+    TypeChecker& operator=(const TypeChecker&) = delete;
+
+    // Checks the whole program; true if there were no errors. May be
+    // called again (on the same or another program); each call starts
+    // from the base environment.
+    bool check(const Program& prog);
+
+    // Type recorded for `exp`, wherever in the program it was checked.
+    const Type* type_of(const Exp* exp) const;
+
+    // Expressions that were given a type.
+    std::size_t typed_count() const;
+
+    const std::vector<std::string>& errors() const { return errors_; }
+    bool has_errors() const { return !errors_.empty(); }
+
+    // AST nodes (expressions, variables, declarations, types) visited by
+    // the last check().
+    std::size_t nodes() const { return nodes_; }
+
+private:
+    friend class IncrementalChecker;
+
+    ThreadPool* pool_ = nullptr;
+    const TypeChecker* parent_ = nullptr;
+    std::deque<TypeChecker> children_;   // own the types made in their bodies
+
+    TypeContext types_;
+    SymbolTable<const Type> tenv_;
+    SymbolTable<const ValueEntry> venv_;
+    std::deque<ValueEntry> values_;
+    ExpTypes exp_types_;
+    std::vector<std::string> errors_;
+    std::size_t loop_depth_ = 0;
+    std::size_t nodes_ = 0;
+
+    // Members of the declaration batch being checked: batch_marks_[id] has
+    // batch == batch_ if the symbol is declared in it, at `index`.
+    struct BatchMark {
+        uint32_t batch;
+        uint32_t index;
+    };
+    std::vector<BatchMark> batch_marks_;
+    uint32_t batch_ = 0;
+
+    // Dependency edges between members of a type batch (see Scc.hpp).
+    struct BatchGraph {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> targets;
+    };
+
+    const Type* check_exp(const Exp& exp);
+    const Type* check_exp_inner(const Exp& exp);
+    const Type* check_var(const Var& var);
+    const Type* check_call(const CallExp& call);
+    const Type* check_op(const OpExp& op);
+    const Type* check_record(const RecordExp& rec);
+    const Type* check_let(const LetExp& let);
+
+    void check_decs(const std::vector<DecPtr>& decs);
+    void check_var_dec(const VarDec& dec);
+    void check_type_batch(const std::vector<DecPtr>& decs, std::size_t begin, std::size_t end);
+    void check_function_batch(const std::vector<DecPtr>& decs, std::size_t begin, std::size_t end);
+    void check_body(const FunctionDec& dec, const FunSig* sig);
+    void check_bodies_parallel(const std::vector<DecPtr>& decs, std::size_t begin,
+                               std::size_t end, const std::vector<const FunSig*>& sigs);
+    const Type* translate_ty(const Ty& ty, Sym name, std::vector<Type*>& created,
+                             BatchGraph& graph);
+    const Type* batch_ref(const std::string& name, Position pos, BatchGraph& graph);
+    bool mark_in_batch(Sym sym, uint32_t index);
+    bool in_batch(Sym sym, uint32_t& index) const;
+
+    // `raw` keeps placeholders of the batch being resolved.
+    const Type* lookup_type(const std::string& name, Position pos, bool raw = false);
+    const Type* find_type(Sym sym) const;
+    const ValueEntry* lookup_value(Sym sym) const;
+    const ValueEntry* bind_value(Sym sym, const Type* type, const FunSig* sig, bool read_only);
+
+    void expect(const Type* expected, const Type* actual, Position pos, const char* what);
+    void error(Position pos, const std::string& msg);
+
+    // ========================================================================
+    // Incremental mode (driven by IncrementalChecker)
+    // ========================================================================
+    //
+    // The type table is kept between passes. A FunctionDec the edit did not
+    // touch is the same node as before, so its body is unchanged; its check
+    // result can only change through the names it looked up outside itself.
+    // Each checked body records those names and a fingerprint of what they
+    // resolved to (and of its own signature); a later pass that finds the
+    // same fingerprint replays the body's diagnostics instead of walking it.
+
+    // A name a body looked up (value or type namespace).
+    struct Dep {
+        Sym sym;
+        bool type;
+    };
+
+    // A diagnostic relative to its function: `line` is a line delta, and
+    // `column` is a column delta only on the function's first line.
+    struct CachedError {
+        int line;
+        int column;
+        std::string text;   // ": error: ..." after the position
+    };
+
+    struct CachedBody {
+        uint64_t fingerprint = 0;
+        std::vector<Dep> deps;
+        std::vector<CachedError> errors;
+        std::size_t typed = 0;    // type table entries it set
+        std::size_t bodies = 0;   // cached bodies within it, itself included
+    };
+
+    bool incremental_ = false;
+    std::unordered_map<const FunctionDec*, CachedBody> bodies_;
+    std::unordered_map<const Type*, uint64_t> type_fingerprints_;
+    mutable std::vector<std::vector<Dep>> dep_stack_;
+    std::vector<Position> error_positions_;   // parallel to errors_
+
+    // What the last edit replaced: nodes inside `reparsed_` are new, and
+    // declarations around [edit_begin_, edit_end_) changed length.
+    const Dec* reparsed_ = nullptr;
+    std::size_t edit_begin_ = 0;
+    std::size_t edit_end_ = 0;
+    bool fresh_ = false;          // inside reparsed_
+    std::size_t dec_base_ = 0;    // absolute offset Dec::offset is relative to
+
+    // Fingerprints of bindings, by symbol id * 2 + type, valid while the
+    // stamp matches: all bodies of a batch start from the same scope.
+    struct MemoEntry {
+        uint32_t stamp;
+        uint64_t fingerprint;
+    };
+    mutable std::vector<MemoEntry> binding_memo_;
+    uint32_t memo_stamp_ = 0;
+
+    std::size_t typed_ = 0;           // type table entries set or replayed
+    std::size_t live_bodies_ = 0;     // cached bodies in the program
+    std::size_t bodies_checked_ = 0;
+    std::size_t bodies_reused_ = 0;
+
+    bool check_incremental(const Program& prog, const Dec* reparsed,
+                           std::size_t edit_begin, std::size_t edit_end);
+    void reset_incremental();
+    void check_body_cached(const FunctionDec& dec, const FunSig* sig);
+    void fingerprint_batch(const std::vector<Type*>& created);
+    uint64_t fingerprint(const std::vector<Dep>& deps, const FunSig* sig) const;
+    uint64_t binding_fingerprint(const Dep& dep) const;
+    uint64_t type_fingerprint(const Type* type) const;
+    uint64_t sig_fingerprint(const FunSig* sig) const;
+};
+
+// Follows placeholder NameTypes to the type they stand for.
+inline const Type* actual(const Type* type) {
+    while (type && type->kind == TypeKind::NAME)
+        type = static_cast<const NameType*>(type)->actual;
+    return type;
+}
+
+// Can a value of type `actual` be used where `expected` is required?
+// Same type, or nil for a record; nullptr (an error) fits anything.
+inline bool compatible(const Type* expected, const Type* actual) {
+    if (!expected || !actual || expected == actual) return true;
+    return (expected->kind == TypeKind::RECORD && actual->kind == TypeKind::NIL) ||
+           (expected->kind == TypeKind::NIL && actual->kind == TypeKind::RECORD);
+}
+
+} // namespace tiger::semantic
+
+#endif // TIGER_TYPE_CHECKER_HPP
@@ -0,0 +1,58 @@
+#include "Types.hpp"
+
+namespace tiger::semantic {
+
+// A declaration freed since an earlier check may have left its address
+// to a declaration of the other kind; that one gets a type of its own.
+
+RecordType* TypeContext::record(const Ty* origin, Sym name) {
+    auto [it, added] = by_origin_.emplace(origin, nullptr);
+    if (added || it->second->kind != TypeKind::RECORD) {
+        records_.emplace_back(name);
+        it->second = &records_.back();
+    }
+    return static_cast<RecordType*>(it->second);
+}
+
+ArrayType* TypeContext::array(const Ty* origin, Sym name, const Type* element) {
+    auto [it, added] = by_origin_.emplace(origin, nullptr);
+    if (added || it->second->kind != TypeKind::ARRAY) {
+        arrays_.emplace_back(name, element);
+        it->second = &arrays_.back();
+    }
+    auto* type = static_cast<ArrayType*>(it->second);
+    type->element = element;
+    return type;
+}
+
+NameType* TypeContext::name(Sym name) {
+    names_.emplace_back(name);
+    return &names_.back();
+}
+
+const FunSig* TypeContext::signature(std::vector<const Type*> params,
+                                     const Type* result) {
+    param_lists_.push_back(std::move(params));
+    const std::vector<const Type*>& p = param_lists_.back();
+    signatures_.push_back({p.data(), p.size(), result});
+    return &signatures_.back();
+}
+
+std::string type_name(const Type* type) {
+    if (!type) return "<error>";
+    switch (type->kind) {
+        case TypeKind::INT: return "int";
+        case TypeKind::STRING: return "string";
+        case TypeKind::NIL: return "nil";
+        case TypeKind::UNIT: return "unit";
+        case TypeKind::RECORD:
+            return std::string(Symbol::name(static_cast<const RecordType*>(type)->name));
+        case TypeKind::ARRAY:
+            return std::string(Symbol::name(static_cast<const ArrayType*>(type)->name));
+        case TypeKind::NAME:
+            return std::string(Symbol::name(static_cast<const NameType*>(type)->name));
+    }
+    return "<unknown>";
+}
+
+} // namespace tiger::semantic
@@ -0,0 +1,122 @@
+#ifndef TIGER_TYPES_HPP
+#define TIGER_TYPES_HPP
+
+// ============================================================================
+// Semantic types.
+//
+// Types are compared by pointer: every type the checker can see exists as
+// exactly one object. The primitive types are constant objects defined
+// here, so they need no allocation and are the same in every process.
+// Record and array types are created by a TypeContext, which hands out one
+// canonical object per declaration (Tiger types are nominal: two
+// declarations of `array of int` are different types), so asking for the
+// same declaration again returns the same pointer.
+//
+// NameType is only a placeholder while a batch of mutually recursive type
+// declarations is being resolved; once the batch is done no other type
+// points at it, and the checker never compares NameTypes.
+// ============================================================================
+
+#include "env/symbol.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tiger {
+struct Ty;
+}
+
+namespace tiger::semantic {
+
+enum class TypeKind : uint8_t {
+    INT,
+    STRING,
+    NIL,
+    UNIT,
+    RECORD,
+    ARRAY,
+    NAME,
+};
+
+struct Type {
+    TypeKind kind;
+};
+
+inline constexpr Type INT_TYPE{TypeKind::INT};
+inline constexpr Type STRING_TYPE{TypeKind::STRING};
+inline constexpr Type NIL_TYPE{TypeKind::NIL};
+inline constexpr Type UNIT_TYPE{TypeKind::UNIT};
+
+struct RecordField {
+    Sym name;
+    const Type* type;
+};
+
+struct RecordType : Type {
+    Sym name;
+    std::vector<RecordField> fields;
+
+    explicit RecordType(Sym n) : Type{TypeKind::RECORD}, name(n) {}
+
+    // Index of the field called `field`, or -1.
+    int field_index(Sym field) const {
+        for (std::size_t i = 0; i < fields.size(); i++)
+            if (fields[i].name == field) return static_cast<int>(i);
+        return -1;
+    }
+};
+
+struct ArrayType : Type {
+    Sym name;
+    const Type* element;
+
+    ArrayType(Sym n, const Type* e) : Type{TypeKind::ARRAY}, name(n), element(e) {}
+};
+
+struct NameType : Type {
+    Sym name;
+    const Type* actual = nullptr;   // nullptr until resolved
+
+    explicit NameType(Sym n) : Type{TypeKind::NAME}, name(n) {}
+};
+
+// A function's signature. `params` points at `param_count` types.
+struct FunSig {
+    const Type* const* params;
+    std::size_t param_count;
+    const Type* result;
+};
+
+// Owns every non-primitive type of one checking session.
+class TypeContext {
+public:
+    // The record/array type declared by `origin`; created empty on first
+    // request and returned again for the same declaration.
+    RecordType* record(const Ty* origin, Sym name);
+    ArrayType* array(const Ty* origin, Sym name, const Type* element);
+
+    NameType* name(Sym name);
+
+    // A signature whose parameter array lives as long as the context.
+    const FunSig* signature(std::vector<const Type*> params, const Type* result);
+
+    std::size_t type_count() const { return records_.size() + arrays_.size(); }
+
+private:
+    std::deque<RecordType> records_;
+    std::deque<ArrayType> arrays_;
+    std::deque<NameType> names_;
+    std::deque<std::vector<const Type*>> param_lists_;
+    std::deque<FunSig> signatures_;
+    std::unordered_map<const Ty*, Type*> by_origin_;
+};
+
+// "int", "string", a declared type's name, ... for diagnostics.
+std::string type_name(const Type* type);
+
+} // namespace tiger::semantic
+
+#endif // TIGER_TYPES_HPP
@@ -0,0 +1,72 @@
+#ifndef TIGER_ARENA_HPP
+#define TIGER_ARENA_HPP
+
+// ============================================================================
+// Chunked bump allocator for data that lives as long as its owner (interned
+// names, table keys). Memory is only released when the Arena is destroyed,
+// so pointers into it stay valid; nothing is destructed, so only
+// trivially destructible data belongs here.
+// ============================================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace tiger {
+
+class Arena {
+public:
+  static constexpr std::size_t DEFAULT_CHUNK = 64 * 1024;
+
+  explicit Arena(std::size_t chunk = DEFAULT_CHUNK) : chunk_(chunk) {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  Arena(Arena&&) = default;
+  Arena& operator=(Arena&&) = default;
+
+  // `bytes` aligned to `align` (a power of two). Requests larger than a
+  // chunk get a chunk of their own.
+  void* allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t)) {
+    std::size_t pad = (align - reinterpret_cast<std::uintptr_t>(next_) % align) % align;
+    if (pad + bytes > left_) {
+      std::size_t size = bytes + align > chunk_ ? bytes + align : chunk_;
+      chunks_.emplace_back(new char[size]);
+      next_ = chunks_.back().get();
+      left_ = size;
+      reserved_ += size;
+      pad = (align - reinterpret_cast<std::uintptr_t>(next_) % align) % align;
+    }
+    char* p = next_ + pad;
+    next_ = p + bytes;
+    left_ -= pad + bytes;
+    used_ += bytes;
+    return p;
+  }
+
+  // Copies `s` (plus a terminating '\0') into the arena.
+  std::string_view copy(std::string_view s) {
+    char* p = static_cast<char*>(allocate(s.size() + 1, 1));
+    std::memcpy(p, s.data(), s.size());
+    p[s.size()] = '\0';
+    return {p, s.size()};
+  }
+
+  std::size_t used() const { return used_; }
+  std::size_t reserved() const { return reserved_; }
+
+private:
+  std::size_t chunk_;
+  std::vector<std::unique_ptr<char[]>> chunks_;
+  char* next_ = nullptr;
+  std::size_t left_ = 0;
+  std::size_t used_ = 0;
+  std::size_t reserved_ = 0;
+};
+
+} // namespace tiger
+
+#endif // TIGER_ARENA_HPP
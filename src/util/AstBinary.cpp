@@ -0,0 +1,646 @@
+#include "AstBinary.hpp"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TIGER_HAVE_MMAP 1
+#endif
+
+namespace tiger {
+
+static const char MAGIC[4] = {'T', 'A', 'S', 'T'};
+
+// ============================================================================
+// Writer: primitives
+// ============================================================================
+
+void AstBinaryWriter::put_byte(std::uint8_t b) {
+    out_.push_back(static_cast<char>(b));
+}
+
+void AstBinaryWriter::put_varint(std::uint64_t v) {
+    while (v >= 0x80) {
+        put_byte(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    put_byte(static_cast<std::uint8_t>(v));
+}
+
+// zigzag: small negative numbers stay small (-1 -> 1, 1 -> 2, ...)
+void AstBinaryWriter::put_int(std::int64_t v) {
+    put_varint((static_cast<std::uint64_t>(v) << 1) ^
+               static_cast<std::uint64_t>(v >> 63));
+}
+
+void AstBinaryWriter::put_string(const std::string& s) {
+    auto [it, inserted] = string_ids_.try_emplace(
+        std::string_view(s), static_cast<std::uint32_t>(strings_.size()));
+    if (inserted) {
+        strings_.push_back(it->first);
+    }
+    put_varint(it->second);
+}
+
+void AstBinaryWriter::put_pos(Position pos) {
+    put_int(pos.line - line_);
+    put_varint(static_cast<std::uint64_t>(pos.column));
+    line_ = pos.line;
+}
+
+void AstBinaryWriter::put_type_fields(const std::vector<TypeField>& fields) {
+    put_varint(fields.size());
+    for (const auto& f : fields) {
+        put_pos(f.pos);
+        put_string(f.name);
+        put_string(f.type_id);
+    }
+}
+
+// ============================================================================
+// Writer: entry points
+// ============================================================================
+
+std::string AstBinaryWriter::encode(const Program& prog) {
+    out_.clear();
+    string_ids_.clear();
+    strings_.clear();
+    line_ = 1;
+
+    // Node stream first: it fills the string table as a side effect.
+    put_pos(prog.pos);
+    put_byte(prog.exp ? 1 : 0);
+    if (prog.exp) {
+        write_exp(*prog.exp);
+    }
+    std::string body = std::move(out_);
+
+    out_.clear();
+    out_.append(MAGIC, sizeof(MAGIC));
+    put_varint(AST_BINARY_VERSION);
+    put_varint(strings_.size());
+    for (const auto& s : strings_) {
+        put_varint(s.size());
+        out_.append(s.data(), s.size());
+    }
+    out_.append(body);
+    return std::move(out_);
+}
+
+void AstBinaryWriter::write(const Program& prog, std::ostream& os) {
+    std::string bytes = encode(prog);
+    os.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// ============================================================================
+// Writer: nodes
+// ============================================================================
+
+void AstBinaryWriter::write_exp(const Exp& exp) {
+    put_byte(static_cast<std::uint8_t>(exp.kind));
+    put_pos(exp.pos);
+
+    switch (exp.kind) {
+        case ExpKind::VAR:
+            write_var(*static_cast<const VarExp&>(exp).var);
+            break;
+        case ExpKind::NIL:
+        case ExpKind::BREAK:
+            break;
+        case ExpKind::INT:
+            put_int(static_cast<const IntExp&>(exp).value);
+            break;
+        case ExpKind::STRING:
+            put_string(static_cast<const StringExp&>(exp).value);
+            break;
+        case ExpKind::CALL: {
+            const auto& e = static_cast<const CallExp&>(exp);
+            put_string(e.func);
+            put_varint(e.args.size());
+            for (const auto& arg : e.args) write_exp(*arg);
+            break;
+        }
+        case ExpKind::OP: {
+            const auto& e = static_cast<const OpExp&>(exp);
+            put_byte(static_cast<std::uint8_t>(e.op));
+            write_exp(*e.left);
+            write_exp(*e.right);
+            break;
+        }
+        case ExpKind::RECORD: {
+            const auto& e = static_cast<const RecordExp&>(exp);
+            put_string(e.type_id);
+            put_varint(e.fields.size());
+            for (const auto& f : e.fields) {
+                put_pos(f.pos);
+                put_string(f.name);
+                write_exp(*f.exp);
+            }
+            break;
+        }
+        case ExpKind::SEQ: {
+            const auto& e = static_cast<const SeqExp&>(exp);
+            put_varint(e.exps.size());
+            for (const auto& ex : e.exps) write_exp(*ex);
+            break;
+        }
+        case ExpKind::ASSIGN: {
+            const auto& e = static_cast<const AssignExp&>(exp);
+            write_var(*e.var);
+            write_exp(*e.exp);
+            break;
+        }
+        case ExpKind::IF: {
+            const auto& e = static_cast<const IfExp&>(exp);
+            write_exp(*e.test);
+            write_exp(*e.then_exp);
+            put_byte(e.else_exp ? 1 : 0);
+            if (e.else_exp) write_exp(*e.else_exp);
+            break;
+        }
+        case ExpKind::WHILE: {
+            const auto& e = static_cast<const WhileExp&>(exp);
+            write_exp(*e.test);
+            write_exp(*e.body);
+            break;
+        }
+        case ExpKind::FOR: {
+            const auto& e = static_cast<const ForExp&>(exp);
+            put_string(e.var);
+            write_exp(*e.lo);
+            write_exp(*e.hi);
+            write_exp(*e.body);
+            break;
+        }
+        case ExpKind::LET: {
+            const auto& e = static_cast<const LetExp&>(exp);
+            put_varint(e.decs.size());
+            for (const auto& d : e.decs) write_dec(*d);
+            put_varint(e.body.size());
+            for (const auto& b : e.body) write_exp(*b);
+            break;
+        }
+        case ExpKind::ARRAY: {
+            const auto& e = static_cast<const ArrayExp&>(exp);
+            put_string(e.type_id);
+            write_exp(*e.size);
+            write_exp(*e.init);
+            break;
+        }
+    }
+}
+
+void AstBinaryWriter::write_var(const Var& var) {
+    put_byte(static_cast<std::uint8_t>(var.kind));
+    put_pos(var.pos);
+
+    switch (var.kind) {
+        case VarKind::SIMPLE:
+            put_string(static_cast<const SimpleVar&>(var).name);
+            break;
+        case VarKind::FIELD: {
+            const auto& v = static_cast<const FieldVar&>(var);
+            put_string(v.field);
+            write_var(*v.var);
+            break;
+        }
+        case VarKind::SUBSCRIPT: {
+            const auto& v = static_cast<const SubscriptVar&>(var);
+            write_var(*v.var);
+            write_exp(*v.index);
+            break;
+        }
+    }
+}
+
+void AstBinaryWriter::write_dec(const Dec& dec) {
+    put_byte(static_cast<std::uint8_t>(dec.kind));
+    put_pos(dec.pos);
+
+    switch (dec.kind) {
+        case DecKind::VAR: {
+            const auto& d = static_cast<const VarDec&>(dec);
+            put_string(d.name);
+            put_string(d.type_id);
+            write_exp(*d.init);
+            break;
+        }
+        case DecKind::TYPE: {
+            const auto& d = static_cast<const TypeDec&>(dec);
+            put_string(d.name);
+            write_ty(*d.ty);
+            break;
+        }
+        case DecKind::FUNCTION: {
+            const auto& d = static_cast<const FunctionDec&>(dec);
+            put_string(d.name);
+            put_type_fields(d.params);
+            put_string(d.result_type);
+            write_exp(*d.body);
+            break;
+        }
+    }
+}
+
+void AstBinaryWriter::write_ty(const Ty& ty) {
+    put_byte(static_cast<std::uint8_t>(ty.kind));
+    put_pos(ty.pos);
+
+    switch (ty.kind) {
+        case TyKind::NAME:
+            put_string(static_cast<const NameTy&>(ty).name);
+            break;
+        case TyKind::RECORD:
+            put_type_fields(static_cast<const RecordTy&>(ty).fields);
+            break;
+        case TyKind::ARRAY:
+            put_string(static_cast<const ArrayTy&>(ty).element_type);
+            break;
+    }
+}
+
+// ============================================================================
+// Reader: primitives
+// ============================================================================
+//
+// Malformed input never reads out of bounds: every primitive checks the
+// remaining length, records an error and returns a neutral value. Once an
+// error is recorded the caller's result is discarded.
+
+void AstBinaryReader::error(const std::string& msg) {
+    if (errors_.empty()) {
+        std::ostringstream oss;
+        oss << "binary AST: " << msg;
+        errors_.push_back(oss.str());
+    }
+    cur_ = end_;  // stop decoding
+}
+
+std::uint8_t AstBinaryReader::get_byte() {
+    if (cur_ >= end_) {
+        error("unexpected end of data");
+        return 0;
+    }
+    return *cur_++;
+}
+
+std::uint64_t AstBinaryReader::get_varint() {
+    std::uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (cur_ >= end_) {
+            error("unexpected end of data");
+            return 0;
+        }
+        std::uint8_t b = *cur_++;
+        v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    error("varint too long");
+    return 0;
+}
+
+std::int64_t AstBinaryReader::get_int() {
+    std::uint64_t v = get_varint();
+    return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+// A list length. Every element takes at least one byte, so a count larger
+// than the remaining input is corrupt (and must not drive a reserve()).
+std::uint64_t AstBinaryReader::get_count() {
+    std::uint64_t n = get_varint();
+    if (n > static_cast<std::uint64_t>(end_ - cur_)) {
+        error("count out of range");
+        return 0;
+    }
+    return n;
+}
+
+const std::string_view& AstBinaryReader::get_string() {
+    static const std::string_view empty;
+    std::uint64_t id = get_varint();
+    if (id >= strings_.size()) {
+        error("string index out of range");
+        return empty;
+    }
+    return strings_[id];
+}
+
+Position AstBinaryReader::get_pos() {
+    line_ += static_cast<int>(get_int());
+    int column = static_cast<int>(get_varint());
+    return Position(line_, column);
+}
+
+std::vector<TypeField> AstBinaryReader::get_type_fields() {
+    std::vector<TypeField> fields;
+    std::uint64_t n = get_count();
+    fields.reserve(n);
+    for (std::uint64_t i = 0; i < n; i++) {
+        Position pos = get_pos();
+        std::string name(get_string());
+        std::string type_id(get_string());
+        fields.emplace_back(name, type_id, pos);
+    }
+    return fields;
+}
+
+// ============================================================================
+// Reader: entry points
+// ============================================================================
+
+bool AstBinaryReader::is_binary(const char* data, std::size_t size) {
+    return size >= sizeof(MAGIC) && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool AstBinaryReader::is_binary_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char buf[sizeof(MAGIC)];
+    if (!file.read(buf, sizeof(buf))) return false;
+    return is_binary(buf, sizeof(buf));
+}
+
+std::unique_ptr<Program> AstBinaryReader::read(const char* data, std::size_t size) {
+    errors_.clear();
+    strings_.clear();
+    line_ = 1;
+
+    if (!is_binary(data, size)) {
+        errors_.push_back("binary AST: bad magic");
+        return nullptr;
+    }
+    cur_ = reinterpret_cast<const std::uint8_t*>(data) + sizeof(MAGIC);
+    end_ = reinterpret_cast<const std::uint8_t*>(data) + size;
+
+    std::uint64_t version = get_varint();
+    if (version != AST_BINARY_VERSION) {
+        error("unsupported version " + std::to_string(version));
+        return nullptr;
+    }
+
+    // String table: views point straight into the input buffer.
+    std::uint64_t count = get_count();
+    strings_.reserve(count);
+    for (std::uint64_t i = 0; i < count; i++) {
+        std::uint64_t len = get_varint();
+        if (len > static_cast<std::uint64_t>(end_ - cur_)) {
+            error("string length out of range");
+            return nullptr;
+        }
+        strings_.emplace_back(reinterpret_cast<const char*>(cur_), len);
+        cur_ += len;
+    }
+
+    Position pos = get_pos();
+    ExpPtr exp = get_byte() ? read_exp() : nullptr;
+
+    if (!has_errors() && cur_ != end_) {
+        error("trailing data");
+    }
+    if (has_errors()) {
+        return nullptr;
+    }
+    return std::make_unique<Program>(std::move(exp), pos);
+}
+
+std::unique_ptr<Program> AstBinaryReader::load(const std::string& path) {
+#ifdef TIGER_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        errors_.assign(1, "binary AST: cannot open file: " + path);
+        return nullptr;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        errors_.assign(1, "binary AST: cannot read file: " + path);
+        return nullptr;
+    }
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        errors_.assign(1, "binary AST: cannot map file: " + path);
+        return nullptr;
+    }
+    auto prog = read(static_cast<const char*>(map), size);
+    ::munmap(map, size);
+    return prog;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        errors_.assign(1, "binary AST: cannot open file: " + path);
+        return nullptr;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string bytes = buffer.str();
+    return read(bytes.data(), bytes.size());
+#endif
+}
+
+// ============================================================================
+// Reader: nodes
+// ============================================================================
+
+ExpPtr AstBinaryReader::read_exp() {
+    std::uint8_t kind = get_byte();
+    Position pos = get_pos();
+    if (kind >= EXP_KIND_COUNT) {
+        error("bad expression kind");
+    }
+    if (has_errors()) {
+        return std::make_unique<NilExp>(pos);
+    }
+
+    switch (static_cast<ExpKind>(kind)) {
+        case ExpKind::VAR:
+            return std::make_unique<VarExp>(read_var(), pos);
+        case ExpKind::NIL:
+            return std::make_unique<NilExp>(pos);
+        case ExpKind::BREAK:
+            return std::make_unique<BreakExp>(pos);
+        case ExpKind::INT:
+            return std::make_unique<IntExp>(static_cast<int>(get_int()), pos);
+        case ExpKind::STRING:
+            return std::make_unique<StringExp>(std::string(get_string()), pos);
+        case ExpKind::CALL: {
+            std::string func(get_string());
+            std::uint64_t n = get_count();
+            std::vector<ExpPtr> args;
+            args.reserve(n);
+            for (std::uint64_t i = 0; i < n && !has_errors(); i++) {
+                args.push_back(read_exp());
+            }
+            return std::make_unique<CallExp>(func, std::move(args), pos);
+        }
+        case ExpKind::OP: {
+            std::uint8_t op = get_byte();
+            if (op >= OP_COUNT) {
+                error("bad operator");
+                return std::make_unique<NilExp>(pos);
+            }
+            ExpPtr left = read_exp();
+            ExpPtr right = read_exp();
+            return std::make_unique<OpExp>(
+                std::move(left), static_cast<Op>(op), std::move(right), pos);
+        }
+        case ExpKind::RECORD: {
+            std::string type_id(get_string());
+            std::uint64_t n = get_count();
+            std::vector<Field> fields;
+            fields.reserve(n);
+            for (std::uint64_t i = 0; i < n && !has_errors(); i++) {
+                Position field_pos = get_pos();
+                std::string name(get_string());
+                ExpPtr exp = read_exp();
+                fields.emplace_back(name, std::move(exp), field_pos);
+            }
+            return std::make_unique<RecordExp>(type_id, std::move(fields), pos);
+        }
+        case ExpKind::SEQ: {
+            std::uint64_t n = get_count();
+            std::vector<ExpPtr> exps;
+            exps.reserve(n);
+            for (std::uint64_t i = 0; i < n && !has_errors(); i++) {
+                exps.push_back(read_exp());
+            }
+            return std::make_unique<SeqExp>(std::move(exps), pos);
+        }
+        case ExpKind::ASSIGN: {
+            VarPtr var = read_var();
+            ExpPtr exp = read_exp();
+            return std::make_unique<AssignExp>(std::move(var), std::move(exp), pos);
+        }
+        case ExpKind::IF: {
+            ExpPtr test = read_exp();
+            ExpPtr then_exp = read_exp();
+            ExpPtr else_exp = get_byte() ? read_exp() : nullptr;
+            return std::make_unique<IfExp>(
+                std::move(test), std::move(then_exp), std::move(else_exp), pos);
+        }
+        case ExpKind::WHILE: {
+            ExpPtr test = read_exp();
+            ExpPtr body = read_exp();
+            return std::make_unique<WhileExp>(std::move(test), std::move(body), pos);
+        }
+        case ExpKind::FOR: {
+            std::string var(get_string());
+            ExpPtr lo = read_exp();
+            ExpPtr hi = read_exp();
+            ExpPtr body = read_exp();
+            return std::make_unique<ForExp>(
+                var, std::move(lo), std::move(hi), std::move(body), pos);
+        }
+        case ExpKind::LET: {
+            std::uint64_t n = get_count();
+            std::vector<DecPtr> decs;
+            decs.reserve(n);
+            for (std::uint64_t i = 0; i < n && !has_errors(); i++) {
+                decs.push_back(read_dec());
+            }
+            n = get_count();
+            std::vector<ExpPtr> body;
+            body.reserve(n);
+            for (std::uint64_t i = 0; i < n && !has_errors(); i++) {
+                body.push_back(read_exp());
+            }
+            return std::make_unique<LetExp>(std::move(decs), std::move(body), pos);
+        }
+        case ExpKind::ARRAY: {
+            std::string type_id(get_string());
+            ExpPtr size = read_exp();
+            ExpPtr init = read_exp();
+            return std::make_unique<ArrayExp>(
+                type_id, std::move(size), std::move(init), pos);
+        }
+    }
+    return std::make_unique<NilExp>(pos);
+}
+
+VarPtr AstBinaryReader::read_var() {
+    std::uint8_t kind = get_byte();
+    Position pos = get_pos();
+    if (kind >= VAR_KIND_COUNT) {
+        error("bad variable kind");
+    }
+    if (has_errors()) {
+        return std::make_unique<SimpleVar>("", pos);
+    }
+
+    switch (static_cast<VarKind>(kind)) {
+        case VarKind::SIMPLE:
+            return std::make_unique<SimpleVar>(std::string(get_string()), pos);
+        case VarKind::FIELD: {
+            std::string field(get_string());
+            VarPtr var = read_var();
+            return std::make_unique<FieldVar>(std::move(var), field, pos);
+        }
+        case VarKind::SUBSCRIPT: {
+            VarPtr var = read_var();
+            ExpPtr index = read_exp();
+            return std::make_unique<SubscriptVar>(std::move(var), std::move(index), pos);
+        }
+    }
+    return std::make_unique<SimpleVar>("", pos);
+}
+
+DecPtr AstBinaryReader::read_dec() {
+    std::uint8_t kind = get_byte();
+    Position pos = get_pos();
+    if (kind >= DEC_KIND_COUNT) {
+        error("bad declaration kind");
+    }
+    if (has_errors()) {
+        return std::make_unique<VarDec>("", "", std::make_unique<NilExp>(pos), pos);
+    }
+
+    switch (static_cast<DecKind>(kind)) {
+        case DecKind::VAR: {
+            std::string name(get_string());
+            std::string type_id(get_string());
+            ExpPtr init = read_exp();
+            return std::make_unique<VarDec>(name, type_id, std::move(init), pos);
+        }
+        case DecKind::TYPE: {
+            std::string name(get_string());
+            TyPtr ty = read_ty();
+            return std::make_unique<TypeDec>(name, std::move(ty), pos);
+        }
+        case DecKind::FUNCTION: {
+            std::string name(get_string());
+            std::vector<TypeField> params = get_type_fields();
+            std::string result_type(get_string());
+            ExpPtr body = read_exp();
+            return std::make_unique<FunctionDec>(
+                name, std::move(params), result_type, std::move(body), pos);
+        }
+    }
+    return std::make_unique<VarDec>("", "", std::make_unique<NilExp>(pos), pos);
+}
+
+TyPtr AstBinaryReader::read_ty() {
+    std::uint8_t kind = get_byte();
+    Position pos = get_pos();
+    if (kind >= TY_KIND_COUNT) {
+        error("bad type kind");
+    }
+    if (has_errors()) {
+        return std::make_unique<NameTy>("", pos);
+    }
+
+    switch (static_cast<TyKind>(kind)) {
+        case TyKind::NAME:
+            return std::make_unique<NameTy>(std::string(get_string()), pos);
+        case TyKind::RECORD:
+            return std::make_unique<RecordTy>(get_type_fields(), pos);
+        case TyKind::ARRAY:
+            return std::make_unique<ArrayTy>(std::string(get_string()), pos);
+    }
+    return std::make_unique<NameTy>("", pos);
+}
+
+} // namespace tiger
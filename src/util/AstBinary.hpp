@@ -0,0 +1,101 @@
+#ifndef TIGER_AST_BINARY_HPP
+#define TIGER_AST_BINARY_HPP
+
+// ============================================================================
+// Compact binary encoding of a Program.
+//
+// Layout (all integers are LEB128 varints unless noted):
+//
+//   magic        4 bytes  "TAST"
+//   version      varint   AST_BINARY_VERSION
+//   strings      varint count, then per string: varint length + bytes
+//   program      position, then the root expression
+//
+// Nodes follow in pre-order. Each node starts with one kind byte (the
+// decoder always knows whether an Exp, Var, Dec or Ty comes next), then
+// its position, then its fields in declaration order:
+//   - identifiers and string literals: index into the string table
+//   - int literals: zigzag varint
+//   - child lists: varint length followed by the children
+//   - optional children (IfExp::else_exp): one presence byte
+//
+// Positions are stored as a zigzag line delta from the previous position
+// plus the column, so nearby nodes cost two bytes.
+// ============================================================================
+
+#include "parser/AST.hpp"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tiger {
+
+constexpr std::uint32_t AST_BINARY_VERSION = 1;
+
+class AstBinaryWriter {
+public:
+    std::string encode(const Program& prog);
+    void write(const Program& prog, std::ostream& os);
+
+private:
+    std::string out_;
+    std::unordered_map<std::string_view, std::uint32_t> string_ids_;
+    std::vector<std::string_view> strings_;
+    int line_ = 1;
+
+    void put_byte(std::uint8_t b);
+    void put_varint(std::uint64_t v);
+    void put_int(std::int64_t v);
+    void put_string(const std::string& s);
+    void put_pos(Position pos);
+    void put_type_fields(const std::vector<TypeField>& fields);
+
+    void write_exp(const Exp& exp);
+    void write_var(const Var& var);
+    void write_dec(const Dec& dec);
+    void write_ty(const Ty& ty);
+};
+
+class AstBinaryReader {
+public:
+    // True if the buffer starts with the binary AST magic.
+    static bool is_binary(const char* data, std::size_t size);
+    static bool is_binary_file(const std::string& path);
+
+    std::unique_ptr<Program> read(const char* data, std::size_t size);
+
+    // Maps the file into memory and decodes it in place.
+    std::unique_ptr<Program> load(const std::string& path);
+
+    const std::vector<std::string>& errors() const { return errors_; }
+    bool has_errors() const { return !errors_.empty(); }
+
+private:
+    const std::uint8_t* cur_ = nullptr;
+    const std::uint8_t* end_ = nullptr;
+    std::vector<std::string_view> strings_;
+    std::vector<std::string> errors_;
+    int line_ = 1;
+
+    void error(const std::string& msg);
+    std::uint8_t get_byte();
+    std::uint64_t get_varint();
+    std::int64_t get_int();
+    std::uint64_t get_count();
+    const std::string_view& get_string();
+    Position get_pos();
+    std::vector<TypeField> get_type_fields();
+
+    ExpPtr read_exp();
+    VarPtr read_var();
+    DecPtr read_dec();
+    TyPtr read_ty();
+};
+
+} // namespace tiger
+
+#endif // TIGER_AST_BINARY_HPP
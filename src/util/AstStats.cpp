@@ -0,0 +1,535 @@
+#include "AstStats.hpp"
+
+namespace tiger {
+
+// ============================================================================
+// Names
+// ============================================================================
+
+static const char* exp_kind_name(std::size_t k) {
+    static const char* names[EXP_KIND_COUNT] = {
+        "VarExp", "NilExp", "IntExp", "StringExp", "CallExp",
+        "OpExp", "RecordExp", "SeqExp", "AssignExp", "IfExp",
+        "WhileExp", "ForExp", "BreakExp", "LetExp", "ArrayExp",
+    };
+    return names[k];
+}
+
+static const char* var_kind_name(std::size_t k) {
+    static const char* names[VAR_KIND_COUNT] = {
+        "SimpleVar", "FieldVar", "SubscriptVar",
+    };
+    return names[k];
+}
+
+static const char* dec_kind_name(std::size_t k) {
+    static const char* names[DEC_KIND_COUNT] = {
+        "VarDec", "TypeDec", "FunctionDec",
+    };
+    return names[k];
+}
+
+static const char* ty_kind_name(std::size_t k) {
+    static const char* names[TY_KIND_COUNT] = {
+        "NameTy", "RecordTy", "ArrayTy",
+    };
+    return names[k];
+}
+
+static const char* local_kind_name(std::size_t k) {
+    static const char* names[LOCAL_KIND_COUNT] = {
+        "variable", "parameter", "loop_variable",
+    };
+    return names[k];
+}
+
+static const char* list_kind_name(std::size_t k) {
+    static const char* names[LIST_KIND_COUNT] = {
+        "call_args", "seq_exps", "record_fields", "let_decs",
+        "let_body", "function_params", "record_ty_fields",
+    };
+    return names[k];
+}
+
+// ============================================================================
+// Byte accounting
+// ============================================================================
+//
+// A node's footprint is sizeof(node) plus heap memory it owns directly:
+// strings that outgrew the small-string buffer, and vector capacity.
+// Child nodes are accounted for under their own kind.
+
+static std::size_t heap_bytes(const std::string& s) {
+    const char* begin = reinterpret_cast<const char*>(&s);
+    const char* data = s.data();
+    bool inline_buffer = data >= begin && data < begin + sizeof(s);
+    return inline_buffer ? 0 : s.capacity() + 1;
+}
+
+template <typename T>
+static std::size_t heap_bytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+static std::size_t heap_bytes(const std::vector<Field>& v) {
+    std::size_t n = v.capacity() * sizeof(Field);
+    for (const auto& f : v) n += heap_bytes(f.name);
+    return n;
+}
+
+static std::size_t heap_bytes(const std::vector<TypeField>& v) {
+    std::size_t n = v.capacity() * sizeof(TypeField);
+    for (const auto& f : v) n += heap_bytes(f.name) + heap_bytes(f.type_id);
+    return n;
+}
+
+static void add(NodeStats& s, std::size_t bytes) {
+    s.count++;
+    s.bytes += bytes;
+}
+
+// ============================================================================
+// Collector
+// ============================================================================
+
+AstStats AstStatsCollector::collect(const Program& prog) {
+    stats_ = AstStats{};
+    names_.clear();
+    depth_ = 0;
+    if (prog.exp) {
+        visit(*prog.exp);
+    }
+    stats_.unique_identifiers = names_.size();
+    return stats_;
+}
+
+void AstStatsCollector::enter() {
+    depth_++;
+    if (depth_ > stats_.max_depth) stats_.max_depth = depth_;
+    stats_.depth_histogram[depth_]++;
+}
+
+void AstStatsCollector::identifier(const std::string& name) {
+    if (name.empty()) return;
+    stats_.identifiers++;
+    names_.insert(name);
+}
+
+void AstStatsCollector::list(ListKind kind, std::size_t length) {
+    ListStats& l = stats_.lists[static_cast<std::size_t>(kind)];
+    l.lists++;
+    l.total += length;
+    if (length > l.max) l.max = length;
+    l.histogram[length]++;
+}
+
+void AstStatsCollector::local(LocalKind kind, bool escape) {
+    LocalStats& l = stats_.locals[static_cast<std::size_t>(kind)];
+    l.count++;
+    if (escape) l.escaping++;
+}
+
+void AstStatsCollector::visit(const Exp& exp) {
+    DepthGuard g(*this);
+    NodeStats& s = stats_.exps[static_cast<std::size_t>(exp.kind)];
+
+    switch (exp.kind) {
+        case ExpKind::VAR: {
+            const auto& e = static_cast<const VarExp&>(exp);
+            add(s, sizeof(VarExp));
+            visit(*e.var);
+            break;
+        }
+        case ExpKind::NIL:
+            add(s, sizeof(NilExp));
+            stats_.nil_literals++;
+            break;
+        case ExpKind::INT:
+            add(s, sizeof(IntExp));
+            stats_.int_literals++;
+            break;
+        case ExpKind::STRING: {
+            const auto& e = static_cast<const StringExp&>(exp);
+            add(s, sizeof(StringExp) + heap_bytes(e.value));
+            stats_.string_literals++;
+            stats_.string_literal_bytes += e.value.size();
+            break;
+        }
+        case ExpKind::CALL: {
+            const auto& e = static_cast<const CallExp&>(exp);
+            add(s, sizeof(CallExp) + heap_bytes(e.func) + heap_bytes(e.args));
+            identifier(e.func);
+            list(ListKind::CALL_ARGS, e.args.size());
+            for (const auto& arg : e.args) visit(*arg);
+            break;
+        }
+        case ExpKind::OP: {
+            const auto& e = static_cast<const OpExp&>(exp);
+            add(s, sizeof(OpExp));
+            visit(*e.left);
+            visit(*e.right);
+            break;
+        }
+        case ExpKind::RECORD: {
+            const auto& e = static_cast<const RecordExp&>(exp);
+            add(s, sizeof(RecordExp) + heap_bytes(e.type_id) + heap_bytes(e.fields));
+            identifier(e.type_id);
+            list(ListKind::RECORD_FIELDS, e.fields.size());
+            for (const auto& f : e.fields) {
+                identifier(f.name);
+                visit(*f.exp);
+            }
+            break;
+        }
+        case ExpKind::SEQ: {
+            const auto& e = static_cast<const SeqExp&>(exp);
+            add(s, sizeof(SeqExp) + heap_bytes(e.exps));
+            list(ListKind::SEQ_EXPS, e.exps.size());
+            for (const auto& ex : e.exps) visit(*ex);
+            break;
+        }
+        case ExpKind::ASSIGN: {
+            const auto& e = static_cast<const AssignExp&>(exp);
+            add(s, sizeof(AssignExp));
+            visit(*e.var);
+            visit(*e.exp);
+            break;
+        }
+        case ExpKind::IF: {
+            const auto& e = static_cast<const IfExp&>(exp);
+            add(s, sizeof(IfExp));
+            visit(*e.test);
+            visit(*e.then_exp);
+            if (e.else_exp) visit(*e.else_exp);
+            break;
+        }
+        case ExpKind::WHILE: {
+            const auto& e = static_cast<const WhileExp&>(exp);
+            add(s, sizeof(WhileExp));
+            visit(*e.test);
+            visit(*e.body);
+            break;
+        }
+        case ExpKind::FOR: {
+            const auto& e = static_cast<const ForExp&>(exp);
+            add(s, sizeof(ForExp) + heap_bytes(e.var));
+            identifier(e.var);
+            local(LocalKind::LOOP_VARIABLE, e.escape);
+            visit(*e.lo);
+            visit(*e.hi);
+            visit(*e.body);
+            break;
+        }
+        case ExpKind::BREAK:
+            add(s, sizeof(BreakExp));
+            break;
+        case ExpKind::LET: {
+            const auto& e = static_cast<const LetExp&>(exp);
+            add(s, sizeof(LetExp) + heap_bytes(e.decs) + heap_bytes(e.body));
+            list(ListKind::LET_DECS, e.decs.size());
+            list(ListKind::LET_BODY, e.body.size());
+            for (const auto& d : e.decs) visit(*d);
+            for (const auto& b : e.body) visit(*b);
+            break;
+        }
+        case ExpKind::ARRAY: {
+            const auto& e = static_cast<const ArrayExp&>(exp);
+            add(s, sizeof(ArrayExp) + heap_bytes(e.type_id));
+            identifier(e.type_id);
+            visit(*e.size);
+            visit(*e.init);
+            break;
+        }
+    }
+}
+
+void AstStatsCollector::visit(const Var& var) {
+    DepthGuard g(*this);
+    NodeStats& s = stats_.vars[static_cast<std::size_t>(var.kind)];
+
+    switch (var.kind) {
+        case VarKind::SIMPLE: {
+            const auto& v = static_cast<const SimpleVar&>(var);
+            add(s, sizeof(SimpleVar) + heap_bytes(v.name));
+            identifier(v.name);
+            break;
+        }
+        case VarKind::FIELD: {
+            const auto& v = static_cast<const FieldVar&>(var);
+            add(s, sizeof(FieldVar) + heap_bytes(v.field));
+            identifier(v.field);
+            visit(*v.var);
+            break;
+        }
+        case VarKind::SUBSCRIPT: {
+            const auto& v = static_cast<const SubscriptVar&>(var);
+            add(s, sizeof(SubscriptVar));
+            visit(*v.var);
+            visit(*v.index);
+            break;
+        }
+    }
+}
+
+void AstStatsCollector::visit(const Dec& dec) {
+    DepthGuard g(*this);
+    NodeStats& s = stats_.decs[static_cast<std::size_t>(dec.kind)];
+
+    switch (dec.kind) {
+        case DecKind::VAR: {
+            const auto& d = static_cast<const VarDec&>(dec);
+            add(s, sizeof(VarDec) + heap_bytes(d.name) + heap_bytes(d.type_id));
+            identifier(d.name);
+            identifier(d.type_id);
+            local(LocalKind::VARIABLE, d.escape);
+            visit(*d.init);
+            break;
+        }
+        case DecKind::TYPE: {
+            const auto& d = static_cast<const TypeDec&>(dec);
+            add(s, sizeof(TypeDec) + heap_bytes(d.name));
+            identifier(d.name);
+            visit(*d.ty);
+            break;
+        }
+        case DecKind::FUNCTION: {
+            const auto& d = static_cast<const FunctionDec&>(dec);
+            add(s, sizeof(FunctionDec) + heap_bytes(d.name) +
+                   heap_bytes(d.params) + heap_bytes(d.result_type));
+            identifier(d.name);
+            identifier(d.result_type);
+            list(ListKind::FUNCTION_PARAMS, d.params.size());
+            for (const auto& p : d.params) {
+                identifier(p.name);
+                identifier(p.type_id);
+                local(LocalKind::PARAMETER, p.escape);
+            }
+            visit(*d.body);
+            break;
+        }
+    }
+}
+
+void AstStatsCollector::visit(const Ty& ty) {
+    DepthGuard g(*this);
+    NodeStats& s = stats_.tys[static_cast<std::size_t>(ty.kind)];
+
+    switch (ty.kind) {
+        case TyKind::NAME: {
+            const auto& t = static_cast<const NameTy&>(ty);
+            add(s, sizeof(NameTy) + heap_bytes(t.name));
+            identifier(t.name);
+            break;
+        }
+        case TyKind::RECORD: {
+            const auto& t = static_cast<const RecordTy&>(ty);
+            add(s, sizeof(RecordTy) + heap_bytes(t.fields));
+            list(ListKind::RECORD_TY_FIELDS, t.fields.size());
+            for (const auto& f : t.fields) {
+                identifier(f.name);
+                identifier(f.type_id);
+            }
+            break;
+        }
+        case TyKind::ARRAY: {
+            const auto& t = static_cast<const ArrayTy&>(ty);
+            add(s, sizeof(ArrayTy) + heap_bytes(t.element_type));
+            identifier(t.element_type);
+            break;
+        }
+    }
+}
+
+// ============================================================================
+// Totals
+// ============================================================================
+
+template <std::size_t N>
+static void sum(const std::array<NodeStats, N>& a, std::size_t& count,
+                std::size_t& bytes) {
+    for (const auto& s : a) {
+        count += s.count;
+        bytes += s.bytes;
+    }
+}
+
+std::size_t AstStats::total_nodes() const {
+    std::size_t count = 0, bytes = 0;
+    sum(exps, count, bytes);
+    sum(vars, count, bytes);
+    sum(decs, count, bytes);
+    sum(tys, count, bytes);
+    return count;
+}
+
+std::size_t AstStats::total_bytes() const {
+    std::size_t count = 0, bytes = 0;
+    sum(exps, count, bytes);
+    sum(vars, count, bytes);
+    sum(decs, count, bytes);
+    sum(tys, count, bytes);
+    return bytes;
+}
+
+// ============================================================================
+// Text output
+// ============================================================================
+
+template <std::size_t N>
+static void write_nodes_text(std::ostream& os, const char* title,
+                             const std::array<NodeStats, N>& a,
+                             const char* (*name)(std::size_t)) {
+    os << title << ":\n";
+    for (std::size_t k = 0; k < N; k++) {
+        if (a[k].count == 0) continue;
+        os << "  " << name(k) << ": " << a[k].count << " nodes, "
+           << a[k].bytes << " bytes\n";
+    }
+}
+
+static void write_histogram_text(std::ostream& os,
+                                 const std::map<std::size_t, std::size_t>& h) {
+    bool first = true;
+    for (const auto& [key, n] : h) {
+        os << (first ? "" : " ") << key << ":" << n;
+        first = false;
+    }
+}
+
+void AstStats::write_text(std::ostream& os) const {
+    os << "nodes: " << total_nodes() << "\n";
+    os << "bytes: " << total_bytes() << "\n";
+    write_nodes_text(os, "expressions", exps, exp_kind_name);
+    write_nodes_text(os, "variables", vars, var_kind_name);
+    write_nodes_text(os, "declarations", decs, dec_kind_name);
+    write_nodes_text(os, "types", tys, ty_kind_name);
+
+    os << "depth:\n";
+    os << "  max: " << max_depth << "\n";
+    os << "  histogram: ";
+    write_histogram_text(os, depth_histogram);
+    os << "\n";
+
+    os << "lists:\n";
+    for (std::size_t k = 0; k < LIST_KIND_COUNT; k++) {
+        const ListStats& l = lists[k];
+        if (l.lists == 0) continue;
+        os << "  " << list_kind_name(k) << ": " << l.lists << " lists, "
+           << l.total << " children, max " << l.max << ", histogram ";
+        write_histogram_text(os, l.histogram);
+        os << "\n";
+    }
+
+    os << "locals:\n";
+    for (std::size_t k = 0; k < LOCAL_KIND_COUNT; k++) {
+        const LocalStats& l = locals[k];
+        if (l.count == 0) continue;
+        os << "  " << local_kind_name(k) << ": " << l.count << " ("
+           << l.escaping << " escaping, " << l.count - l.escaping << " not)\n";
+    }
+
+    os << "identifiers: " << identifiers << " (" << unique_identifiers
+       << " unique)\n";
+    os << "literals:\n";
+    os << "  int: " << int_literals << "\n";
+    os << "  string: " << string_literals << " (" << string_literal_bytes
+       << " bytes)\n";
+    os << "  nil: " << nil_literals << "\n";
+
+    os << "tokens:\n";
+    for (std::size_t k = 0; k < TOKEN_TYPE_COUNT; k++) {
+        if (tokens[k] == 0) continue;
+        os << "  " << token_type_to_string(static_cast<TokenType>(k)) << ": "
+           << tokens[k] << "\n";
+    }
+}
+
+// ============================================================================
+// JSON output
+// ============================================================================
+
+template <std::size_t N>
+static void write_nodes_json(std::ostream& os, const char* title,
+                             const std::array<NodeStats, N>& a,
+                             const char* (*name)(std::size_t)) {
+    os << "  \"" << title << "\": {";
+    bool first = true;
+    for (std::size_t k = 0; k < N; k++) {
+        if (a[k].count == 0) continue;
+        os << (first ? "" : ", ") << "\"" << name(k) << "\": {\"count\": "
+           << a[k].count << ", \"bytes\": " << a[k].bytes << "}";
+        first = false;
+    }
+    os << "},\n";
+}
+
+static void write_histogram_json(std::ostream& os,
+                                 const std::map<std::size_t, std::size_t>& h) {
+    os << "{";
+    bool first = true;
+    for (const auto& [key, n] : h) {
+        os << (first ? "" : ", ") << "\"" << key << "\": " << n;
+        first = false;
+    }
+    os << "}";
+}
+
+void AstStats::write_json(std::ostream& os) const {
+    os << "{\n";
+    os << "  \"nodes\": " << total_nodes() << ",\n";
+    os << "  \"bytes\": " << total_bytes() << ",\n";
+    write_nodes_json(os, "expressions", exps, exp_kind_name);
+    write_nodes_json(os, "variables", vars, var_kind_name);
+    write_nodes_json(os, "declarations", decs, dec_kind_name);
+    write_nodes_json(os, "types", tys, ty_kind_name);
+
+    os << "  \"depth\": {\"max\": " << max_depth << ", \"histogram\": ";
+    write_histogram_json(os, depth_histogram);
+    os << "},\n";
+
+    os << "  \"lists\": {";
+    bool first = true;
+    for (std::size_t k = 0; k < LIST_KIND_COUNT; k++) {
+        const ListStats& l = lists[k];
+        if (l.lists == 0) continue;
+        os << (first ? "" : ", ") << "\"" << list_kind_name(k)
+           << "\": {\"lists\": " << l.lists << ", \"children\": " << l.total
+           << ", \"max\": " << l.max << ", \"histogram\": ";
+        write_histogram_json(os, l.histogram);
+        os << "}";
+        first = false;
+    }
+    os << "},\n";
+
+    os << "  \"locals\": {";
+    first = true;
+    for (std::size_t k = 0; k < LOCAL_KIND_COUNT; k++) {
+        const LocalStats& l = locals[k];
+        if (l.count == 0) continue;
+        os << (first ? "" : ", ") << "\"" << local_kind_name(k)
+           << "\": {\"count\": " << l.count << ", \"escaping\": " << l.escaping << "}";
+        first = false;
+    }
+    os << "},\n";
+
+    os << "  \"identifiers\": {\"total\": " << identifiers
+       << ", \"unique\": " << unique_identifiers << "},\n";
+    os << "  \"literals\": {\"int\": " << int_literals
+       << ", \"string\": " << string_literals
+       << ", \"string_bytes\": " << string_literal_bytes
+       << ", \"nil\": " << nil_literals << "},\n";
+
+    os << "  \"tokens\": {";
+    first = true;
+    for (std::size_t k = 0; k < TOKEN_TYPE_COUNT; k++) {
+        if (tokens[k] == 0) continue;
+        os << (first ? "" : ", ") << "\""
+           << token_type_to_string(static_cast<TokenType>(k)) << "\": "
+           << tokens[k];
+        first = false;
+    }
+    os << "}\n";
+    os << "}\n";
+}
+
+} // namespace tiger
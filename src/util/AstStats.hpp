@@ -0,0 +1,118 @@
+#ifndef TIGER_AST_STATS_HPP
+#define TIGER_AST_STATS_HPP
+
+#include "parser/AST.hpp"
+#include <array>
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace tiger {
+
+// Child lists whose length distribution is tracked.
+enum class ListKind {
+    CALL_ARGS,
+    SEQ_EXPS,
+    RECORD_FIELDS,
+    LET_DECS,
+    LET_BODY,
+    FUNCTION_PARAMS,
+    RECORD_TY_FIELDS,
+};
+
+constexpr std::size_t LIST_KIND_COUNT =
+    static_cast<std::size_t>(ListKind::RECORD_TY_FIELDS) + 1;
+
+// Declarations of a frame slot, for the escape counts.
+enum class LocalKind {
+    VARIABLE,        // VarDec
+    PARAMETER,       // FunctionDec parameter
+    LOOP_VARIABLE,   // ForExp counter
+};
+
+constexpr std::size_t LOCAL_KIND_COUNT =
+    static_cast<std::size_t>(LocalKind::LOOP_VARIABLE) + 1;
+
+// Per node type: how many nodes, and how many bytes they occupy
+// (sizeof the node plus heap storage owned directly by it).
+struct NodeStats {
+    std::size_t count = 0;
+    std::size_t bytes = 0;
+};
+
+struct ListStats {
+    std::size_t lists = 0;
+    std::size_t total = 0;
+    std::size_t max = 0;
+    std::map<std::size_t, std::size_t> histogram;  // length -> lists
+};
+
+// The escape flags set by semantic::Resolver. On a tree that was not
+// resolved every local counts as escaping.
+struct LocalStats {
+    std::size_t count = 0;
+    std::size_t escaping = 0;
+};
+
+// Structural statistics of one parsed program, gathered in a single walk.
+struct AstStats {
+    std::array<NodeStats, EXP_KIND_COUNT> exps{};
+    std::array<NodeStats, VAR_KIND_COUNT> vars{};
+    std::array<NodeStats, DEC_KIND_COUNT> decs{};
+    std::array<NodeStats, TY_KIND_COUNT> tys{};
+    std::array<ListStats, LIST_KIND_COUNT> lists{};
+    std::array<LocalStats, LOCAL_KIND_COUNT> locals{};
+
+    std::size_t max_depth = 0;
+    std::map<std::size_t, std::size_t> depth_histogram;  // depth -> nodes
+
+    std::size_t identifiers = 0;         // every identifier occurrence
+    std::size_t unique_identifiers = 0;
+    std::size_t int_literals = 0;
+    std::size_t string_literals = 0;
+    std::size_t string_literal_bytes = 0;
+    std::size_t nil_literals = 0;
+
+    std::array<std::size_t, TOKEN_TYPE_COUNT> tokens{};
+
+    std::size_t total_nodes() const;
+    std::size_t total_bytes() const;
+
+    void write_text(std::ostream& os) const;
+    void write_json(std::ostream& os) const;
+};
+
+class AstStatsCollector {
+public:
+    AstStats collect(const Program& prog);
+
+private:
+    AstStats stats_;
+    std::unordered_set<std::string_view> names_;
+    std::size_t depth_ = 0;
+
+    void visit(const Exp& exp);
+    void visit(const Var& var);
+    void visit(const Dec& dec);
+    void visit(const Ty& ty);
+
+    void enter();
+    void identifier(const std::string& name);
+    void list(ListKind kind, std::size_t length);
+    void local(LocalKind kind, bool escape);
+
+    class DepthGuard {
+    public:
+        explicit DepthGuard(AstStatsCollector& c) : c_(c) { c_.enter(); }
+        ~DepthGuard() { c_.depth_--; }
+    private:
+        AstStatsCollector& c_;
+    };
+};
+
+} // namespace tiger
+
+#endif // TIGER_AST_STATS_HPP
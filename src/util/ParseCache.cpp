@@ -0,0 +1,301 @@
+#include "ParseCache.hpp"
+#include "AstBinary.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <system_error>
+
+#ifndef TIGER_VERSION
+#define TIGER_VERSION "dev"
+#endif
+
+namespace fs = std::filesystem;
+
+namespace tiger {
+
+// Entry file layout (little-endian, fixed width):
+//
+//   magic          4 bytes "TPCE"
+//   key            u64  hash of version + source
+//   check          u64  second hash of the source (different seed)
+//   source size    u64
+//   token counts   TOKEN_TYPE_COUNT x u64
+//   lexer errors   u32 count, then per error: u32 length + bytes
+//   parser errors  u32 count, then per error: u32 length + bytes
+//   AST            binary AST (AstBinary.hpp) up to end of file
+
+static const char ENTRY_MAGIC[4] = {'T', 'P', 'C', 'E'};
+static const char* ENTRY_SUFFIX = ".tpc";
+static const char* TMP_MARKER = ".tmp.";
+
+static std::uint64_t version_seed() {
+    std::string version = std::string(TIGER_VERSION) + "/ast" +
+                          std::to_string(AST_BINARY_VERSION);
+    return util::hash_bytes(version.data(), version.size());
+}
+
+static std::uint64_t source_key(const std::string& source) {
+    static const std::uint64_t seed = version_seed();
+    return util::hash_bytes(source.data(), source.size(), seed);
+}
+
+static std::uint64_t source_check(const std::string& source) {
+    return util::hash_bytes(source.data(), source.size(), 0x7469676572ULL);
+}
+
+// ============================================================================
+// Encoding helpers
+// ============================================================================
+
+static void put_u64(std::string& out, std::uint64_t v) {
+    char buf[8];
+    std::memcpy(buf, &v, 8);
+    out.append(buf, 8);
+}
+
+static void put_u32(std::string& out, std::uint32_t v) {
+    char buf[4];
+    std::memcpy(buf, &v, 4);
+    out.append(buf, 4);
+}
+
+static void put_strings(std::string& out, const std::vector<std::string>& v) {
+    put_u32(out, static_cast<std::uint32_t>(v.size()));
+    for (const auto& s : v) {
+        put_u32(out, static_cast<std::uint32_t>(s.size()));
+        out.append(s);
+    }
+}
+
+// Cursor over an entry; any short read makes ok() false.
+class EntryReader {
+public:
+    EntryReader(const char* p, std::size_t n) : cur_(p), end_(p + n) {}
+
+    bool ok() const { return ok_; }
+    const char* cur() const { return cur_; }
+    std::size_t remaining() const { return static_cast<std::size_t>(end_ - cur_); }
+
+    bool bytes(void* dst, std::size_t n) {
+        if (!ok_ || remaining() < n) return ok_ = false;
+        std::memcpy(dst, cur_, n);
+        cur_ += n;
+        return true;
+    }
+
+    std::uint64_t u64() { std::uint64_t v = 0; bytes(&v, 8); return v; }
+    std::uint32_t u32() { std::uint32_t v = 0; bytes(&v, 4); return v; }
+
+    std::vector<std::string> strings() {
+        std::vector<std::string> v;
+        std::uint32_t n = u32();
+        for (std::uint32_t i = 0; i < n && ok_; i++) {
+            std::uint32_t len = u32();
+            if (!ok_ || remaining() < len) {
+                ok_ = false;
+                break;
+            }
+            v.emplace_back(cur_, len);
+            cur_ += len;
+        }
+        return v;
+    }
+
+private:
+    const char* cur_;
+    const char* end_;
+    bool ok_ = true;
+};
+
+// ============================================================================
+// ParseCache
+// ============================================================================
+
+ParseCache::ParseCache(const std::string& dir, std::uint64_t max_bytes)
+    : dir_(dir), max_bytes_(max_bytes) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    enabled_ = !ec && fs::is_directory(dir_, ec);
+}
+
+std::string ParseCache::entry_path(std::uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx",
+                  static_cast<unsigned long long>(key));
+    return (fs::path(dir_) / (std::string(name) + ENTRY_SUFFIX)).string();
+}
+
+bool ParseCache::lookup(const std::string& source, CachedParse& out) {
+    if (!enabled_) {
+        misses_++;
+        return false;
+    }
+
+    std::uint64_t key = source_key(source);
+    std::string path = entry_path(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        misses_++;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string bytes = buffer.str();
+    file.close();
+
+    EntryReader r(bytes.data(), bytes.size());
+    char magic[4] = {};
+    r.bytes(magic, 4);
+    bool valid = r.ok() && std::memcmp(magic, ENTRY_MAGIC, 4) == 0 &&
+                 r.u64() == key && r.u64() == source_check(source) &&
+                 r.u64() == source.size();
+
+    CachedParse entry;
+    if (valid) {
+        for (auto& n : entry.token_counts) n = static_cast<size_t>(r.u64());
+        entry.lexer_errors = r.strings();
+        entry.parser_errors = r.strings();
+        valid = r.ok();
+    }
+    if (valid) {
+        AstBinaryReader reader;
+        entry.program = reader.read(r.cur(), r.remaining());
+        valid = entry.program != nullptr;
+    }
+
+    if (!valid) {
+        // Stale format or a colliding key: drop it and parse normally.
+        std::error_code ec;
+        fs::remove(path, ec);
+        misses_++;
+        return false;
+    }
+
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    out = std::move(entry);
+    hits_++;
+    return true;
+}
+
+void ParseCache::store(const std::string& source, const Program& prog,
+                       const std::vector<std::string>& lexer_errors,
+                       const std::vector<std::string>& parser_errors,
+                       const std::array<size_t, TOKEN_TYPE_COUNT>& token_counts) {
+    if (!enabled_) return;
+
+    std::uint64_t key = source_key(source);
+
+    std::string bytes;
+    bytes.append(ENTRY_MAGIC, 4);
+    put_u64(bytes, key);
+    put_u64(bytes, source_check(source));
+    put_u64(bytes, source.size());
+    for (size_t n : token_counts) put_u64(bytes, n);
+    put_strings(bytes, lexer_errors);
+    put_strings(bytes, parser_errors);
+    AstBinaryWriter writer;
+    bytes += writer.encode(prog);
+
+    // Unique temp name per process and call, then an atomic rename.
+    static const unsigned long long nonce =
+        (static_cast<unsigned long long>(std::random_device{}()) << 32) ^
+        std::random_device{}();
+    static std::atomic<unsigned> counter{0};
+    std::ostringstream tmp_name;
+    tmp_name << entry_path(key) << TMP_MARKER << std::hex << nonce << "."
+             << counter++;
+    std::string tmp = tmp_name.str();
+    {
+        std::ofstream file(tmp, std::ios::binary);
+        if (!file) return;
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            file.close();
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp, entry_path(key), ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return;
+    }
+
+    evict();
+}
+
+// Removes least recently used entries until the cache fits max_bytes_.
+// Temp files of in-flight writers are left alone unless they are old
+// enough to have been abandoned by a crashed process.
+void ParseCache::evict() {
+    struct Item {
+        fs::path path;
+        fs::file_time_type time;
+        std::uint64_t size;
+    };
+    std::vector<Item> items;
+    std::uint64_t total = 0;
+
+    auto stale = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    std::error_code ec;
+    for (const auto& de : fs::directory_iterator(dir_, ec)) {
+        if (de.path().extension() != ENTRY_SUFFIX) {
+            std::error_code e;
+            if (de.path().filename().string().find(TMP_MARKER) != std::string::npos &&
+                de.last_write_time(e) < stale && !e) {
+                fs::remove(de.path(), e);
+            }
+            continue;
+        }
+        std::error_code e1, e2;
+        std::uint64_t size = de.file_size(e1);
+        auto time = de.last_write_time(e2);
+        if (e1 || e2) continue;
+        items.push_back({de.path(), time, size});
+        total += size;
+    }
+    if (total <= max_bytes_) return;
+
+    std::sort(items.begin(), items.end(),
+              [](const Item& a, const Item& b) { return a.time < b.time; });
+    for (const auto& item : items) {
+        if (total <= max_bytes_) break;
+        if (fs::remove(item.path, ec)) {
+            evictions_++;
+        }
+        total -= item.size;
+    }
+}
+
+std::uint64_t ParseCache::entry_count() const {
+    std::uint64_t n = 0;
+    std::error_code ec;
+    for (const auto& de : fs::directory_iterator(dir_, ec)) {
+        if (de.path().extension() == ENTRY_SUFFIX) n++;
+    }
+    return n;
+}
+
+std::uint64_t ParseCache::size_bytes() const {
+    std::uint64_t total = 0;
+    std::error_code ec;
+    for (const auto& de : fs::directory_iterator(dir_, ec)) {
+        if (de.path().extension() != ENTRY_SUFFIX) continue;
+        std::error_code e;
+        std::uint64_t size = de.file_size(e);
+        if (!e) total += size;
+    }
+    return total;
+}
+
+} // namespace tiger
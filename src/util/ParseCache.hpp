@@ -0,0 +1,73 @@
+#ifndef TIGER_PARSE_CACHE_HPP
+#define TIGER_PARSE_CACHE_HPP
+
+// ============================================================================
+// On-disk parse cache, keyed by a hash of the source bytes and the
+// compiler version. An entry holds everything `tiger` needs to skip the
+// Lexer and Parser: the binary AST (util/AstBinary.hpp), the lexer and
+// parser diagnostics, and the token counts reported by --ast-stats.
+//
+// Entries are written to a temporary file and renamed into place, so a
+// concurrent reader sees either no entry or a complete one. A hit bumps
+// the entry's mtime; when the directory grows past max_bytes the entries
+// with the oldest mtime are removed first (LRU).
+// ============================================================================
+
+#include "lexer/Token.hpp"
+#include "parser/AST.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tiger {
+
+struct CachedParse {
+    std::unique_ptr<Program> program;
+    std::vector<std::string> lexer_errors;
+    std::vector<std::string> parser_errors;
+    std::array<size_t, TOKEN_TYPE_COUNT> token_counts{};
+};
+
+class ParseCache {
+public:
+    static constexpr std::uint64_t DEFAULT_MAX_BYTES = 64ull << 20;
+
+    explicit ParseCache(const std::string& dir,
+                        std::uint64_t max_bytes = DEFAULT_MAX_BYTES);
+
+    // Fills `out` and returns true on a hit.
+    bool lookup(const std::string& source, CachedParse& out);
+
+    void store(const std::string& source, const Program& prog,
+               const std::vector<std::string>& lexer_errors,
+               const std::vector<std::string>& parser_errors,
+               const std::array<size_t, TOKEN_TYPE_COUNT>& token_counts);
+
+    std::uint64_t hits() const { return hits_; }
+    std::uint64_t misses() const { return misses_; }
+    std::uint64_t evictions() const { return evictions_; }
+
+    // Current number of entries and their total size on disk.
+    std::uint64_t entry_count() const;
+    std::uint64_t size_bytes() const;
+
+    const std::string& dir() const { return dir_; }
+    bool enabled() const { return enabled_; }
+
+private:
+    std::string dir_;
+    std::uint64_t max_bytes_;
+    bool enabled_ = false;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+    std::uint64_t evictions_ = 0;
+
+    std::string entry_path(std::uint64_t key) const;
+    void evict();
+};
+
+} // namespace tiger
+
+#endif // TIGER_PARSE_CACHE_HPP
@@ -0,0 +1,121 @@
+#include "ThreadPool.hpp"
+
+namespace tiger {
+
+namespace {
+
+// Which pool this thread works for, and its deque there.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local unsigned current_index = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = 1;
+    for (unsigned i = 0; i < threads; i++) queues_.push_back(std::make_unique<Queue>());
+    for (unsigned i = 1; i < threads; i++) workers_.emplace_back([this, i] { worker_loop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_.store(true);
+    }
+    wake_.notify_all();
+    for (std::thread& t : workers_) t.join();
+}
+
+unsigned ThreadPool::self() const {
+    return current_pool == this ? current_index : 0;
+}
+
+void ThreadPool::submit(TaskGroup& group, std::function<void()> task) {
+    group.pending_.fetch_add(1, std::memory_order_relaxed);
+    Queue& q = *queues_[self()];
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back({std::move(task), &group});
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    {
+        // Pairs with the predicate check in worker_loop: no lost wakeups.
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_one();
+}
+
+// Runs one task: the newest of our own, else the oldest of someone else's.
+bool ThreadPool::try_run(unsigned self) {
+    Task task;
+    bool found = false;
+    {
+        Queue& q = *queues_[self];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            found = true;
+        }
+    }
+    for (unsigned k = 1; !found && k < queues_.size(); k++) {
+        Queue& q = *queues_[(self + k) % queues_.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            found = true;
+            steals_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (!found) return false;
+
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    TaskGroup& group = *task.group;
+    try {
+        task.fn();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        if (!group.error_) group.error_ = std::current_exception();
+    }
+    if (group.pending_.fetch_sub(1, std::memory_order_release) == 1) {
+        // The last task: wake a wait() sleeping on the group.
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        wake_.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::wait(TaskGroup& group) {
+    unsigned me = self();
+    while (group.pending_.load(std::memory_order_acquire) != 0) {
+        if (try_run(me)) continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [&] {
+            return group.pending_.load(std::memory_order_acquire) == 0 ||
+                   queued_.load(std::memory_order_acquire) != 0;
+        });
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        error.swap(group.error_);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void ThreadPool::worker_loop(unsigned index) {
+    current_pool = this;
+    current_index = index;
+    while (!stop_.load()) {
+        if (try_run(index)) continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] {
+            return stop_.load() || queued_.load(std::memory_order_acquire) != 0;
+        });
+    }
+}
+
+} // namespace tiger
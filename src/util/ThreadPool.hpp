@@ -0,0 +1,98 @@
+#ifndef TIGER_THREAD_POOL_HPP
+#define TIGER_THREAD_POOL_HPP
+
+// ============================================================================
+// Work-stealing thread pool for fork/join work (parallel type checking).
+//
+// `threads` is the total parallelism: threads - 1 workers are started and
+// the thread that calls wait() works too. Every worker has its own deque:
+// it pushes and pops at the back (newest first, good locality for nested
+// tasks) and, when empty, steals from the front of another deque (oldest
+// first, which tends to be the biggest piece of work). Threads that are
+// not workers push to a shared deque that workers steal from.
+//
+// wait(group) does not block while work is queued: it runs queued tasks
+// (its own or stolen) until the group is done, so tasks may themselves
+// submit and wait on nested groups without deadlocking the pool. With
+// nothing left to run it sleeps until the group's last task (running on
+// another thread) finishes or more work is queued.
+//
+// A task that throws counts as finished; wait() rethrows the first
+// exception of its group once every task of the group is done.
+// ============================================================================
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tiger {
+
+class ThreadPool {
+public:
+    // Tasks submitted together and waited for together.
+    class TaskGroup {
+    public:
+        TaskGroup() = default;
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+    private:
+        friend class ThreadPool;
+        std::atomic<std::size_t> pending_{0};
+        std::exception_ptr error_;   // first one thrown; under sleep_mutex_
+    };
+
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Total parallelism, including the waiting thread.
+    unsigned size() const { return static_cast<unsigned>(queues_.size()); }
+
+    void submit(TaskGroup& group, std::function<void()> task);
+
+    // Returns once every task submitted to `group` has finished; rethrows
+    // the first exception one of them threw.
+    void wait(TaskGroup& group);
+
+    // Tasks taken from another thread's deque (for benchmarks).
+    std::size_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Task {
+        std::function<void()> fn;
+        TaskGroup* group;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // queues_[0] is shared by non-worker threads; worker i owns queues_[i].
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<std::size_t> steals_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;   // work queued, a group done, or stop
+
+    unsigned self() const;
+    bool try_run(unsigned self);
+    void worker_loop(unsigned index);
+};
+
+} // namespace tiger
+
+#endif // TIGER_THREAD_POOL_HPP
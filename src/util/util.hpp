@@ -1,16 +1,137 @@
 #ifndef TIGER_UTIL_HPP
 #define TIGER_UTIL_HPP
 
+#include <cstdint>
+#include <cstring>     // std::memcpy
 #include <functional>  // std::hash
 #include <string>
+#include <string_view>
 
 namespace tiger::util {
 
-// Wraps std::hash<std::string> for use across EnvTable, Symbol, etc.
-inline std::size_t hash(const std::string& key) {
-  return std::hash<std::string>{}(key);
+// Wraps std::hash<std::string_view> for use across EnvTable, Symbol, etc.
+// Takes a view so callers can hash slices without building a std::string;
+// the value equals std::hash<std::string> of the same characters.
+inline std::size_t hash(std::string_view key) {
+  return std::hash<std::string_view>{}(key);
 }
 
+// 64-bit hash of a byte range, 8 bytes per step, for large inputs
+// (whole source files) where std::hash is not guaranteed to be fast or
+// stable across runs. The finalizer is MurmurHash3's fmix64.
+inline std::uint64_t hash_bytes(const void* data, std::size_t len,
+                                std::uint64_t seed = 0) {
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  const std::uint64_t m1 = 0xff51afd7ed558ccdULL;
+  const std::uint64_t m2 = 0xc4ceb9fe1a85ec53ULL;
+  std::uint64_t h = seed ^ (len * 0x9e3779b97f4a7c15ULL);
+
+  auto step = [&](std::uint64_t k) {
+    h ^= k * m1;
+    h = ((h << 31) | (h >> 33)) * m2;
+  };
+  for (; len >= 8; p += 8, len -= 8) {
+    std::uint64_t k;
+    std::memcpy(&k, p, 8);
+    step(k);
+  }
+  if (len > 0) {
+    std::uint64_t k = 0;
+    std::memcpy(&k, p, len);
+    step(k);
+  }
+
+  h ^= h >> 33;
+  h *= m1;
+  h ^= h >> 33;
+  h *= m2;
+  h ^= h >> 33;
+  return h;
+}
+
+// ============================================================================
+// Hash policies
+// ============================================================================
+//
+// A policy is a copyable function object `uint64_t operator()(string_view)`.
+// Symbol, EnvTable and the benchmarks take one as a template parameter so
+// the function can be swapped without touching the tables.
+//
+//   StdHash   std::hash, same value as util::hash above.
+//   WordHash  for identifiers: at most two (overlapping) unaligned loads
+//             for names up to 16 bytes, one 64x64→128 multiply to mix, and
+//             an optional seed so hashes differ from run to run. constexpr,
+//             so tables of fixed names can be hashed at compile time; the
+//             byte-wise loads compile to single little-endian word loads.
+
+struct StdHash {
+  std::uint64_t operator()(std::string_view key) const { return hash(key); }
+};
+
+struct WordHash {
+  std::uint64_t seed = 0;
+
+  constexpr std::uint64_t operator()(std::string_view key) const {
+    const char* p = key.data();
+    std::size_t len = key.size();
+    std::uint64_t s = seed ^ K0;
+    std::uint64_t a = 0, b = 0;
+    if (len <= 16) {
+      if (len >= 8) {
+        a = load64(p);
+        b = load64(p + len - 8);
+      } else if (len >= 4) {
+        a = load32(p);
+        b = load32(p + len - 4);
+      } else if (len > 0) {
+        a = (byte(p[0]) << 16) | (byte(p[len >> 1]) << 8) | byte(p[len - 1]);
+      }
+    } else {
+      std::size_t n = len;
+      for (; n > 16; p += 16, n -= 16)
+        s = mix(load64(p) ^ K1, load64(p + 8) ^ s);
+      a = load64(p + n - 16);   // last 16 bytes, may overlap the loop's
+      b = load64(p + n - 8);
+    }
+    return mix(K1 ^ len, mix(a ^ K1, b ^ s));
+  }
+
+private:
+  static constexpr std::uint64_t K0 = 0xa0761d6478bd642fULL;
+  static constexpr std::uint64_t K1 = 0xe7037ed1a0b428dbULL;
+
+  static constexpr std::uint64_t byte(char c) {
+    return static_cast<unsigned char>(c);
+  }
+  static constexpr std::uint64_t load32(const char* p) {
+    return byte(p[0]) | byte(p[1]) << 8 | byte(p[2]) << 16 | byte(p[3]) << 24;
+  }
+  static constexpr std::uint64_t load64(const char* p) {
+    return load32(p) | load32(p + 4) << 32;
+  }
+  // Both halves of the 128-bit product, folded.
+  static constexpr std::uint64_t mix(std::uint64_t x, std::uint64_t y) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 u128;   // GCC/Clang
+    u128 r = static_cast<u128>(x) * y;
+    return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#else
+    // MSVC and other compilers without a 128-bit type: the same product
+    // from four 32x32 -> 64 multiplies.
+    constexpr std::uint64_t M = 0xffffffffULL;
+    std::uint64_t p00 = (x & M) * (y & M), p01 = (x & M) * (y >> 32);
+    std::uint64_t p10 = (x >> 32) * (y & M), p11 = (x >> 32) * (y >> 32);
+    std::uint64_t mid = (p00 >> 32) + (p01 & M) + (p10 & M);
+    std::uint64_t lo = (mid << 32) | (p00 & M);
+    std::uint64_t hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    return lo ^ hi;
+#endif
+  }
+};
+
+// Policy used when none is given.
+using DefaultHash = WordHash;
+
 } // namespace tiger::util
 
 #endif // TIGER_UTIL_HPP
@@ -0,0 +1,122 @@
+#ifndef TIGER_TEST_PIPELINE_HPP
+#define TIGER_TEST_PIPELINE_HPP
+
+// ============================================================================
+// The front end as the pass tests use it: parse and type-check a source
+// that must be valid, resolve it, and look at the tree or at what the
+// interpreter makes of it. A test that runs its pass between checking and
+// resolving calls check() and resolves itself; the others call compile().
+// Tests of the checker and resolver themselves start from parse().
+// ============================================================================
+
+#include "interp/Interpreter.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "semantic/Purity.hpp"
+#include "semantic/Resolver.hpp"
+#include "semantic/TypeChecker.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace tiger::test {
+
+// A test extends it with the pass under test.
+struct Compiled {
+    std::unique_ptr<Program> program;
+    semantic::Resolver resolver;
+    semantic::Purity purity;
+};
+
+// Parses `source`, which must have no lexer or parser errors.
+inline std::unique_ptr<Program> parse(const std::string& source) {
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto program = parser.parse();
+    for (const auto& err : parser.errors()) std::cerr << source << "\n  " << err << "\n";
+    assert(!lexer.has_errors() && !parser.has_errors());
+    return program;
+}
+
+inline bool type_checks(Program& prog, semantic::TypeChecker& checker) {
+    bool ok = checker.check(prog);
+    for (const auto& err : checker.errors()) std::cerr << "  " << err << "\n";
+    return ok;
+}
+
+inline bool type_checks(Program& prog) {
+    semantic::TypeChecker checker;
+    return type_checks(prog, checker);
+}
+
+// Parses `source` into c.program and type-checks it with `checker`, which
+// a pass that needs the types keeps; both must succeed.
+inline void check(Compiled& c, const std::string& source, semantic::TypeChecker& checker) {
+    c.program = parse(source);
+    bool ok = type_checks(*c.program, checker);
+    if (!ok) std::cerr << source << "\n";
+    assert(ok);
+}
+
+inline void check(Compiled& c, const std::string& source) {
+    semantic::TypeChecker checker;
+    check(c, source, checker);
+}
+
+// Checks, resolves and analyzes the purity of `source`. C is Compiled or a
+// test's extension of it, constructed from `args`.
+template <typename C = Compiled, typename... Args>
+std::unique_ptr<C> compile(const std::string& source, Args&&... args) {
+    auto c = std::make_unique<C>(std::forward<Args>(args)...);
+    check(*c, source);
+    c->resolver.resolve(*c->program);
+    c->purity.analyze(*c->program, c->resolver);
+    return c;
+}
+
+// The initializer of the top-level let's variable `name`.
+inline const Exp& init_of(const Compiled& c, const std::string& name) {
+    assert(c.program->exp->kind == ExpKind::LET);
+    for (const auto& dec : static_cast<const LetExp&>(*c.program->exp).decs) {
+        if (dec->kind == DecKind::VAR && static_cast<const VarDec&>(*dec).name == name)
+            return *static_cast<const VarDec&>(*dec).init;
+    }
+    assert(false && "no such variable");
+    std::abort();
+}
+
+inline bool is_int(const Exp& exp, int value) {
+    return exp.kind == ExpKind::INT && static_cast<const IntExp&>(exp).value == value;
+}
+
+inline bool is_string(const Exp& exp, const std::string& value) {
+    return exp.kind == ExpKind::STRING && static_cast<const StringExp&>(exp).value == value;
+}
+
+inline bool is_var(const Exp& exp, const std::string& name) {
+    if (exp.kind != ExpKind::VAR) return false;
+    const Var& var = *static_cast<const VarExp&>(exp).var;
+    return var.kind == VarKind::SIMPLE && static_cast<const SimpleVar&>(var).name == name;
+}
+
+// Output, then the error or the result, of running `c`: "out|result".
+inline std::string run(const Compiled& c) {
+    std::ostringstream out;
+    std::istringstream in;
+    Interpreter interp(out, in);
+    bool ok = interp.run(*c.program, c.resolver);
+    std::string s = out.str() + "|";
+    if (!ok) return s + interp.errors()[0];
+    Value v = interp.result();
+    if (v.kind == ValueKind::INT) s += std::to_string(v.i);
+    if (v.kind == ValueKind::STRING) s += std::string(v.str());
+    return s;
+}
+
+} // namespace tiger::test
+
+#endif // TIGER_TEST_PIPELINE_HPP
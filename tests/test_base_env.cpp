@@ -0,0 +1,64 @@
+#undef NDEBUG
+#include "env/symbol.hpp"
+#include "semantic/BaseEnv.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+using namespace tiger;
+using namespace tiger::semantic;
+
+static size_t allocations = 0;
+
+void* operator new(size_t n) {
+  allocations++;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// Usable in constant expressions: nothing here runs at startup.
+static_assert(base_env::type(builtin::STRING.sym()) == &STRING_TYPE);
+static_assert(base_env::function(builtin::SUBSTRING.sym())->param_count == 3);
+static_assert(base_env::function(builtin::INT.sym()) == nullptr);
+
+int main() {
+  // 1. the interner returns the constant entries for builtin names, and
+  // setting up the pool (first use) allocates nothing
+  size_t before = allocations;
+  Sym print = Symbol::intern("print");
+  assert(allocations == before);
+  assert(print == builtin::PRINT.sym());
+  for (Sym sym : builtin::ALL) {
+    assert(Symbol::intern(Symbol::name(sym)) == sym);
+    assert(Symbol::hash(sym) == SymbolHash{}(Symbol::name(sym)));
+  }
+  assert(Symbol::name(builtin::SUBSTRING.sym()) == "substring");
+  assert(Symbol::name(builtin::SUBSTRING.sym()).data()[9] == '\0');
+
+  // 2. user names get ids after the reserved ones
+  Sym user = Symbol::intern("user_name");
+  assert(Symbol::id(user) >= builtin::COUNT);
+  assert(Symbol::count() == builtin::COUNT + 1);
+  assert(Symbol::stats().symbols == Symbol::count());
+
+  // 3. lookups: types and functions live in separate namespaces
+  assert(base_env::type(Symbol::intern("int")) == &INT_TYPE);
+  assert(base_env::type(Symbol::intern("print")) == nullptr);
+  assert(base_env::function(Symbol::intern("string")) == nullptr);
+  assert(base_env::type(user) == nullptr);
+  assert(base_env::function(user) == nullptr);
+
+  const FunSig* concat = base_env::function(Symbol::intern("concat"));
+  assert(concat && concat->param_count == 2 && concat->result == &STRING_TYPE);
+  assert(concat->params[0] == &STRING_TYPE && concat->params[1] == &STRING_TYPE);
+  const FunSig* getchar_sig = base_env::function(Symbol::intern("getchar"));
+  assert(getchar_sig->param_count == 0 && getchar_sig->result == &STRING_TYPE);
+  assert(base_env::function(Symbol::intern("exit"))->result == &UNIT_TYPE);
+  assert(base_env::function(Symbol::intern("not"))->params[0] == &INT_TYPE);
+
+  std::cout << "All base environment tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,185 @@
+#undef NDEBUG
+#include "TestPipeline.hpp"
+#include "opt/ConstantFolder.hpp"
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace tiger;
+using namespace tiger::semantic;
+using namespace tiger::test;
+
+struct Folded : Compiled {
+    ConstantFolder folder;
+};
+
+static std::unique_ptr<Folded> compile(const std::string& source, bool fold = true) {
+    auto c = test::compile<Folded>(source);
+    if (fold) c->folder.fold(*c->program);
+    return c;
+}
+
+// Deterministic generator of random int expressions over a, b, tick(n)
+// (which prints), constant and variable ifs, and divisions that may trap.
+struct Random {
+    uint64_t state;
+    uint32_t next() {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<uint32_t>(state >> 33);
+    }
+    uint32_t below(uint32_t n) { return next() % n; }
+};
+
+static std::string random_exp(Random& r, int depth) {
+    static const char* LITERALS[] = {"0", "1", "2", "7", "-1", "2147483647",
+                                     "(-2147483647 - 1)", "65536"};
+    static const char* OPS[] = {"+", "-", "*", "/", "=", "<>", "<", "<=", ">", ">="};
+    uint32_t pick = depth <= 0 ? r.below(3) : r.below(9);
+    switch (pick) {
+        case 0: return LITERALS[r.below(8)];
+        case 1: return r.below(2) ? "a" : "b";
+        case 2: return "tick(" + std::string(LITERALS[r.below(4)]) + ")";
+        case 3: return "-" + random_exp(r, depth - 1);
+        case 4:
+            return "(if " + random_exp(r, depth - 1) + " then " + random_exp(r, depth - 1) +
+                   " else " + random_exp(r, depth - 1) + ")";
+        case 5:
+            return "(" + random_exp(r, depth - 1) + (r.below(2) ? " * 0)" : " * 1)");
+        case 6:
+            return "(" + random_exp(r, depth - 1) + (r.below(2) ? " + 0)" : " / 1)");
+        default:
+            return "(" + random_exp(r, depth - 1) + " " + OPS[r.below(10)] + " " +
+                   random_exp(r, depth - 1) + ")";
+    }
+}
+
+int main() {
+    // 1. Literal arithmetic, with the interpreter's wraparound and division
+    {
+        auto c = compile("let var x := 2 * 3 + 4\n"
+                         "    var neg := -1\n"
+                         "    var wrap := 2147483647 + 1\n"
+                         "    var min_div := (-2147483647 - 1) / -1\n"
+                         "    var trunc := -7 / 2\n"
+                         "    var cmp := (3 < 4) + (4 <= 4) + (5 > 6) + (1 = 1) + (1 <> 1)\n"
+                         "    var str := (\"abc\" < \"abd\") + (\"x\" = \"x\") + (\"b\" >= \"c\")\n"
+                         "in x end");
+        assert(is_int(init_of(*c, "x"), 10));
+        assert(is_int(init_of(*c, "neg"), -1));
+        assert(is_int(init_of(*c, "wrap"), -2147483647 - 1));
+        assert(is_int(init_of(*c, "min_div"), -2147483647 - 1));
+        assert(is_int(init_of(*c, "trunc"), -3));
+        assert(is_int(init_of(*c, "cmp"), 3));
+        assert(is_int(init_of(*c, "str"), 2));
+        assert(c->folder.identities() == 0 && c->folder.folded_ifs() == 0);
+        std::cout << "Test 1 (literal arithmetic) passed!\n";
+    }
+
+    // 2. Division by zero is left to trap at run time
+    {
+        const std::string src = "let var z := 10 / (5 - 5) in z end";
+        auto c = compile(src);
+        auto& z = init_of(*c, "z");
+        assert(z.kind == ExpKind::OP && is_int(*static_cast<const OpExp&>(z).right, 0));
+        assert(run(*c) == run(*compile(src, false)));
+        assert(run(*c).find("1:17: error: division by zero") != std::string::npos);
+        std::cout << "Test 2 (division by zero) passed!\n";
+    }
+
+    // 3. Identities, and x * 0 only for side-effect-free x
+    {
+        const std::string src =
+            "type ints = array of int\n"
+            "var a := ints[3] of 5\n"
+            "var x := 6\n"
+            "var y := 0\n"
+            "function f(): int = (print(\"f\"); 4)\n"
+            "var p1 := x + 0\n"
+            "var p2 := 0 + x\n"
+            "var m1 := x - 0\n"
+            "var t1 := x * 1\n"
+            "var t2 := 1 * x\n"
+            "var d1 := x / 1\n"
+            "var nn := - - x\n"
+            "var z1 := (x + 3 * x) * 0\n"
+            "var z2 := 0 * (x / 2)\n"
+            "var k1 := f() * 0\n"
+            "var k2 := a[7] * 0\n"
+            "var k3 := (x / y) * 0\n"
+            "var k4 := 0 - x\n";
+        auto c = compile("let " + src + "in x end");
+        for (const char* name : {"p1", "p2", "m1", "t1", "t2", "d1", "nn"})
+            assert(is_var(init_of(*c, name), "x"));
+        assert(is_int(init_of(*c, "z1"), 0));
+        assert(is_int(init_of(*c, "z2"), 0));
+        for (const char* name : {"k1", "k2", "k3", "k4"})
+            assert(init_of(*c, name).kind == ExpKind::OP);
+        assert(c->folder.identities() == 9);
+
+        // the kept effects still happen, in order: f prints, then a[7] traps
+        std::string kept = run(*c);
+        assert(kept == run(*compile("let " + src + "in x end", false)));
+        assert(kept.rfind("f|", 0) == 0 && kept.find("index 7 out of range") != std::string::npos);
+        std::cout << "Test 3 (identities) passed!\n";
+    }
+
+    // 4. If with a constant test, folding through the branches
+    {
+        auto c = compile("let var x := 3\n"
+                         "    var i1 := if 2 > 1 then x + 0 else x * 2\n"
+                         "    var i2 := if 1 - 1 then \"yes\" else \"no\"\n"
+                         "    var i3 := (if 0 then print(\"never\"); 1 + 1)\n"
+                         "    var i4 := if x then 1 else 2\n"
+                         "in i1 end");
+        assert(is_var(init_of(*c, "i1"), "x"));
+        auto& i2 = init_of(*c, "i2");
+        assert(i2.kind == ExpKind::STRING && static_cast<const StringExp&>(i2).value == "no");
+        auto& i3 = static_cast<const SeqExp&>(init_of(*c, "i3"));
+        assert(i3.kind == ExpKind::SEQ && i3.exps[0]->kind == ExpKind::SEQ &&
+               static_cast<const SeqExp&>(*i3.exps[0]).exps.empty() && is_int(*i3.exps[1], 2));
+        assert(init_of(*c, "i4").kind == ExpKind::IF);
+        assert(c->folder.folded_ifs() == 3);
+        assert(run(*c) == "|3");
+        std::cout << "Test 4 (constant if) passed!\n";
+    }
+
+    // 5. Folding inside functions and loops keeps what they compute
+    {
+        const std::string src =
+            "let function scale(n: int): int = n * (2 + 2) * 1 - 0\n"
+            "    var total := 0\n"
+            "in for i := 1 to 10 - 5 do total := total + scale(i) + (if 0 then 100 else -1); total end";
+        auto c = compile(src);
+        assert(c->folder.folded_ops() >= 3 && c->folder.folded_ifs() == 1);
+        assert(run(*c) == run(*compile(src, false)));
+        assert(run(*c) == "|" + std::to_string(4 * 15 - 5));
+        std::cout << "Test 5 (functions and loops) passed!\n";
+    }
+
+    // 6. Random expressions: folded and unfolded programs agree
+    {
+        Random r{42};
+        int folded = 0;
+        for (int i = 0; i < 1500; i++) {
+            std::string src =
+                "let var a := " + std::to_string(static_cast<int32_t>(r.next()) % 100) + "\n"
+                "    var b := " + std::to_string(static_cast<int32_t>(r.next())) + "\n"
+                "    function tick(n: int): int = (print(\"t\"); print(chr(48 + n - n / 10 * 10)); n)\n"
+                "in " + random_exp(r, 4) + " end";
+            auto c = compile(src);
+            std::string expected = run(*compile(src, false));
+            if (run(*c) != expected) {
+                std::cerr << src << "\n  folded:   " << run(*c) << "\n  unfolded: " << expected << "\n";
+                assert(false);
+            }
+            folded += c->folder.folded_ops() + c->folder.identities() + c->folder.folded_ifs() > 0;
+        }
+        assert(folded > 500);
+        std::cout << "Test 6 (random expressions) passed!\n";
+    }
+
+    std::cout << "\nAll constant folding tests passed!\n";
+    return 0;
+}
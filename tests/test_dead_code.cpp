@@ -0,0 +1,189 @@
+#undef NDEBUG
+#include "TestPipeline.hpp"
+#include "opt/DeadCodeEliminator.hpp"
+#include "util/AstStats.hpp"
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace tiger;
+using namespace tiger::semantic;
+using namespace tiger::test;
+
+struct Pruned : Compiled {
+    DeadCodeEliminator eliminator;
+};
+
+// Checks `source`, removes dead code (if `dce`), and resolves what is left.
+// The pruned tree must still type-check, and the node counts must agree
+// with AstStats.
+static std::unique_ptr<Pruned> compile(const std::string& source, bool dce = true) {
+    auto c = std::make_unique<Pruned>();
+    check(*c, source);
+    if (dce) {
+        std::size_t before = AstStatsCollector().collect(*c->program).total_nodes();
+        c->eliminator.eliminate(*c->program);
+        std::size_t after = AstStatsCollector().collect(*c->program).total_nodes();
+        assert(before - after == c->eliminator.removed_nodes());
+        assert(type_checks(*c->program));
+    }
+    c->resolver.resolve(*c->program);
+    assert(c->resolver.unresolved() == 0);
+    return c;
+}
+
+// Names of the declarations of the top-level let, in order.
+static std::string decs_of(const Compiled& c) {
+    std::string names;
+    for (const auto& dec : static_cast<const LetExp&>(*c.program->exp).decs) {
+        if (!names.empty()) names += " ";
+        switch (dec->kind) {
+            case DecKind::VAR: names += static_cast<const VarDec&>(*dec).name; break;
+            case DecKind::TYPE: names += static_cast<const TypeDec&>(*dec).name; break;
+            case DecKind::FUNCTION: names += static_cast<const FunctionDec&>(*dec).name; break;
+        }
+    }
+    return names;
+}
+
+static bool same_behaviour(const std::string& source) {
+    return run(*compile(source, false)) == run(*compile(source));
+}
+
+int main() {
+    // 1. Unused declarations of each kind go; used ones stay
+    {
+        const std::string src =
+            "let type used = {a: int}\n"
+            "    type unused = array of string\n"
+            "    var x := 1\n"
+            "    var y := \"never read\"\n"
+            "    function f(n: int): int = n + x\n"
+            "    function g(n: int): int = n * 2\n"
+            "    var r := used{a = 4}\n"
+            "in f(r.a) end";
+        auto c = compile(src);
+        assert(decs_of(*c) == "used x f r");
+        assert(c->eliminator.removed_decs(DecKind::VAR) == 1);
+        assert(c->eliminator.removed_decs(DecKind::FUNCTION) == 1);
+        assert(c->eliminator.removed_decs(DecKind::TYPE) == 1);
+        assert(c->eliminator.removed_nodes() == 2 + 2 + 5);   // y; unused; g
+        assert(run(*c) == "|5" && same_behaviour(src));
+        std::cout << "Test 1 (unused declarations) passed!\n";
+    }
+
+    // 2. Reachability is transitive; dead cycles go whole
+    {
+        const std::string src =
+            "let type t = int\n"
+            "    type list = {head: t, tail: list}\n"
+            "    function len(l: list): int = if l = nil then 0 else 1 + len(l.tail)\n"
+            "    function even(n: int): int = if n = 0 then 1 else odd(n - 1)\n"
+            "    function odd(n: int): int = if n = 0 then 0 else even(n - 1)\n"
+            "    function helper(): int = 7\n"
+            "    function only_dead_uses(): int = helper()\n"
+            "in len(list{head = 1, tail = list{head = 2, tail = nil}}) end";
+        auto c = compile(src);
+        assert(decs_of(*c) == "t list len");
+        assert(c->eliminator.removed_decs(DecKind::FUNCTION) == 4);
+        assert(run(*c) == "|2" && same_behaviour(src));
+        std::cout << "Test 2 (transitive uses) passed!\n";
+    }
+
+    // 3. Initializers that may have an effect are kept
+    {
+        const std::string src =
+            "let type ints = array of int\n"
+            "    type point = {x: int, y: int}\n"
+            "    var n := 3\n"
+            "    function loud(): int = (print(\"!\"); 1)\n"
+            "    var a := loud()\n"
+            "    var b := ints[n] of 0\n"
+            "    var c := ints[2] of n\n"
+            "    var p := point{x = n, y = n / 1}\n"
+            "    var q := point{x = 1, y = 10 / n}\n"
+            "    var s := (n := 5; n)\n"
+            "in 0 end";
+        auto c = compile(src);
+        assert(decs_of(*c) == "ints point n loud a b q s");
+        assert(run(*c) == "!|0" && same_behaviour(src));
+        std::cout << "Test 3 (effects kept) passed!\n";
+    }
+
+    // 4. Nested lets, shadowing, parameters and loop counters
+    {
+        const std::string src =
+            "let var x := 100\n"
+            "    var k := 5\n"
+            "    function f(x: int): int =\n"
+            "        let var unused := x * 2\n"
+            "            var x := x + 1\n"
+            "            function dead(): int = unused\n"
+            "        in x end\n"
+            "    function g(): int = let var sum := 0 in for k := 1 to 3 do sum := sum + k; sum end\n"
+            "in f(1) + g() end";
+        auto c = compile(src);
+        assert(decs_of(*c) == "f g");   // every use of x and k is of an inner one
+        auto& f = static_cast<const FunctionDec&>(
+            *static_cast<const LetExp&>(*c->program->exp).decs[0]);
+        assert(static_cast<const LetExp&>(*f.body).decs.size() == 1);
+        assert(c->eliminator.removed_decs(DecKind::VAR) == 3);
+        assert(c->eliminator.removed_decs(DecKind::FUNCTION) == 1);
+        assert(run(*c) == "|8" && same_behaviour(src));
+        std::cout << "Test 4 (scoping) passed!\n";
+    }
+
+    // 5. Constant branches and code after break are dropped first
+    {
+        const std::string src =
+            "let function only_in_dead_branch(): int = 1\n"
+            "    function used(): int = 2\n"
+            "    var i := 0\n"
+            "in while 1 do (i := i + 1; if i > 3 then (print(\"done\"); break; print(\"never\")));\n"
+            "   if 0 then only_in_dead_branch() else used() + i end";
+        auto c = compile(src);
+        assert(decs_of(*c) == "used i");
+        assert(c->eliminator.removed_branches() == 1);
+        assert(c->eliminator.removed_after_break() == 1);
+        assert(run(*c) == "done|6" && same_behaviour(src));
+
+        auto d = compile("let var n := 0 in for i := 1 to 5 do (n := n + i;\n"
+                         "    (if n > 3 then break else break); n := 100; print(\"x\")); n end");
+        assert(d->eliminator.removed_after_break() == 2);
+        assert(run(*d) == "|1");
+        std::cout << "Test 5 (unreachable code) passed!\n";
+    }
+
+    // 6. A dead declaration that separates two batches stays
+    {
+        const std::string src =
+            "let function g(): int = 1\n"
+            "in let function f(): int = g()\n"
+            "       var separator := 0\n"
+            "       function g(): int = 2\n"
+            "   in f() + g() * 10 end\n"
+            "end";
+        auto c = compile(src);
+        auto& inner = static_cast<const LetExp&>(
+            *static_cast<const LetExp&>(*c->program->exp).body[0]);
+        assert(inner.decs.size() == 3);   // f and the inner g stay apart
+        assert(run(*c) == "|21" && same_behaviour(src));
+
+        auto d = compile("let type t = int\n"
+                         "in let type u = t\n"
+                         "       var separator := 0\n"
+                         "       type t = string\n"
+                         "       var v : u := 5\n"
+                         "       var w : t := \"abc\"\n"
+                         "   in v + size(w) end\n"
+                         "end");
+        auto& types = static_cast<const LetExp&>(
+            *static_cast<const LetExp&>(*d->program->exp).body[0]);
+        assert(types.decs.size() == 5 && run(*d) == "|8");
+        std::cout << "Test 6 (batch separators) passed!\n";
+    }
+
+    std::cout << "\nAll dead code tests passed!\n";
+    return 0;
+}
@@ -1,6 +1,9 @@
+#undef NDEBUG
 #include "env/EnvTable.hpp"
 #include <cassert>
 #include <iostream>
+#include <string>
+#include <unordered_set>
 
 struct IntBinding : tiger::Binding {
   int value;
@@ -36,6 +39,89 @@ int main() {
   table.pop("x");
   assert(table.lookup("x") == nullptr);
 
+  // 7. mark/rollback undoes a whole scope, restoring shadowed bindings
+  table.insert("x", std::make_unique<IntBinding>(1));
+  tiger::EnvTable::Mark outer = table.mark();
+  table.insert("x", std::make_unique<IntBinding>(2));
+  table.insert("y", std::make_unique<IntBinding>(3));
+  assert(static_cast<IntBinding*>(table.lookup("x"))->value == 2);
+  table.rollback(outer);
+  assert(static_cast<IntBinding*>(table.lookup("x"))->value == 1);
+  assert(table.lookup("y") == nullptr);
+
+  // 8. pop inside a scope, then rollback skips the popped binding
+  outer = table.mark();
+  table.insert("x", std::make_unique<IntBinding>(4));
+  table.insert("z", std::make_unique<IntBinding>(5));
+  table.pop("x");
+  assert(static_cast<IntBinding*>(table.lookup("x"))->value == 1);
+  table.rollback(outer);
+  assert(static_cast<IntBinding*>(table.lookup("x"))->value == 1);
+  assert(table.lookup("z") == nullptr);
+  assert(table.size() == 1);
+
+  // 9. bindings popped out of order leave the log once the ones after
+  // them are popped too, but never past a mark
+  outer = table.mark();
+  for (int i = 0; i < 1000; i++) {
+    table.insert("a", std::make_unique<IntBinding>(6));
+    table.insert("b", std::make_unique<IntBinding>(7));
+    table.pop("a");
+    table.pop("b");
+  }
+  assert(table.mark() == outer);
+  table.insert("a", std::make_unique<IntBinding>(8));
+  outer = table.mark();
+  table.pop("a");
+  table.insert("w", std::make_unique<IntBinding>(9));
+  table.rollback(outer);
+  assert(table.lookup("w") == nullptr && table.lookup("a") == nullptr);
+  assert(static_cast<IntBinding*>(table.lookup("x"))->value == 1);
+
+  // 10. thousands of keys: the table grows and every key stays reachable
+  outer = table.mark();
+  for (int i = 0; i < 20000; i++)
+    table.insert("k" + std::to_string(i), std::make_unique<IntBinding>(i));
+  for (int i = 0; i < 20000; i++)
+    assert(static_cast<IntBinding*>(table.lookup("k" + std::to_string(i)))->value == i);
+  assert(table.lookup("k20000") == nullptr);
+  table.rollback(outer);
+  assert(table.lookup("k123") == nullptr);
+  assert(table.size() == 1);
+
+  // 11. other hash policies: same behaviour, and WordHash is seeded and
+  // sees every byte of names around its 4/8/16-byte load boundaries
+  {
+    tiger::BasicEnvTable<tiger::util::StdHash> std_table;
+    tiger::BasicEnvTable<tiger::util::WordHash> seeded(tiger::util::WordHash{42});
+    for (int i = 0; i < 5000; i++) {
+      std_table.insert("v" + std::to_string(i), std::make_unique<IntBinding>(i));
+      seeded.insert("v" + std::to_string(i), std::make_unique<IntBinding>(i));
+    }
+    for (int i = 0; i < 5000; i++) {
+      assert(static_cast<IntBinding*>(std_table.lookup("v" + std::to_string(i)))->value == i);
+      assert(static_cast<IntBinding*>(seeded.lookup("v" + std::to_string(i)))->value == i);
+    }
+
+    tiger::util::WordHash h0, h1{1};
+    assert(h0("counter") == h0(std::string("counter")));
+    assert(h0("counter") != h1("counter"));
+    std::unordered_set<std::uint64_t> seen;
+    size_t count = 0;
+    for (size_t len = 0; len <= 40; len++) {
+      std::string name(len, 'a');
+      seen.insert(h0(name));
+      count++;
+      for (size_t i = 0; i < len; i++) {
+        std::string flipped = name;
+        flipped[i] = 'b';
+        seen.insert(h0(flipped));
+        count++;
+      }
+    }
+    assert(seen.size() == count);
+  }
+
   std::cout << "All EnvTable tests passed!\n";
   return 0;
 }
@@ -0,0 +1,264 @@
+#undef NDEBUG
+#include "lexer/Lexer.hpp"
+#include "parser/IncrementalParser.hpp"
+#include "parser/Parser.hpp"
+#include "util/ASTPrinter.hpp"
+#include "util/AstBinary.hpp"
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+using namespace tiger;
+
+static std::string print(const Program& prog) {
+    std::ostringstream oss;
+    AstPrinter printer(oss);
+    printer.print(prog);
+    return oss.str();
+}
+
+// Dec::offset/length of every declaration, in source order.
+static void collect_decs(const Exp* e, std::vector<std::pair<size_t, size_t>>& out);
+
+static void collect_var(const Var* v, std::vector<std::pair<size_t, size_t>>& out) {
+    if (v->kind == VarKind::FIELD) {
+        collect_var(static_cast<const FieldVar*>(v)->var.get(), out);
+    } else if (v->kind == VarKind::SUBSCRIPT) {
+        auto* s = static_cast<const SubscriptVar*>(v);
+        collect_var(s->var.get(), out);
+        collect_decs(s->index.get(), out);
+    }
+}
+
+static void collect_decs(const Exp* e, std::vector<std::pair<size_t, size_t>>& out) {
+    if (!e) return;
+    switch (e->kind) {
+        case ExpKind::VAR:
+            collect_var(static_cast<const VarExp*>(e)->var.get(), out);
+            break;
+        case ExpKind::CALL:
+            for (auto& a : static_cast<const CallExp*>(e)->args) collect_decs(a.get(), out);
+            break;
+        case ExpKind::OP:
+            collect_decs(static_cast<const OpExp*>(e)->left.get(), out);
+            collect_decs(static_cast<const OpExp*>(e)->right.get(), out);
+            break;
+        case ExpKind::RECORD:
+            for (auto& f : static_cast<const RecordExp*>(e)->fields) collect_decs(f.exp.get(), out);
+            break;
+        case ExpKind::SEQ:
+            for (auto& x : static_cast<const SeqExp*>(e)->exps) collect_decs(x.get(), out);
+            break;
+        case ExpKind::ASSIGN:
+            collect_var(static_cast<const AssignExp*>(e)->var.get(), out);
+            collect_decs(static_cast<const AssignExp*>(e)->exp.get(), out);
+            break;
+        case ExpKind::IF: {
+            auto* i = static_cast<const IfExp*>(e);
+            collect_decs(i->test.get(), out);
+            collect_decs(i->then_exp.get(), out);
+            collect_decs(i->else_exp.get(), out);
+            break;
+        }
+        case ExpKind::WHILE:
+            collect_decs(static_cast<const WhileExp*>(e)->test.get(), out);
+            collect_decs(static_cast<const WhileExp*>(e)->body.get(), out);
+            break;
+        case ExpKind::FOR: {
+            auto* f = static_cast<const ForExp*>(e);
+            collect_decs(f->lo.get(), out);
+            collect_decs(f->hi.get(), out);
+            collect_decs(f->body.get(), out);
+            break;
+        }
+        case ExpKind::LET: {
+            auto* let = static_cast<const LetExp*>(e);
+            for (auto& d : let->decs) {
+                out.emplace_back(d->offset, d->length);
+                if (d->kind == DecKind::VAR) {
+                    collect_decs(static_cast<const VarDec*>(d.get())->init.get(), out);
+                } else if (d->kind == DecKind::FUNCTION) {
+                    collect_decs(static_cast<const FunctionDec*>(d.get())->body.get(), out);
+                }
+            }
+            for (auto& x : let->body) collect_decs(x.get(), out);
+            break;
+        }
+        case ExpKind::ARRAY:
+            collect_decs(static_cast<const ArrayExp*>(e)->size.get(), out);
+            collect_decs(static_cast<const ArrayExp*>(e)->init.get(), out);
+            break;
+        default:
+            break;
+    }
+}
+
+// The incremental tree must match a full parse of the same text exactly:
+// structure, names, positions (via the binary encoding) and byte ranges.
+static void check_against_full(const IncrementalParser& inc) {
+    Lexer lexer(inc.source());
+    Parser parser(lexer);
+    auto full = parser.parse();
+
+    bool full_errors = lexer.has_errors() || parser.has_errors();
+    assert(inc.has_errors() == full_errors);
+    if (full_errors) return;
+
+    assert(print(inc.program()) == print(*full));
+    AstBinaryWriter w1, w2;
+    assert(w1.encode(inc.program()) == w2.encode(*full));
+
+    std::vector<std::pair<size_t, size_t>> a, b;
+    collect_decs(inc.program().exp.get(), a);
+    collect_decs(full->exp.get(), b);
+    assert(a == b);
+}
+
+static const char* BASE = R"(/* incremental reparse fixture */
+let
+    type point = {x: int, y: int}
+    type ints = array of int
+    var counter := 0
+    function add(a: int, b: int): int = a + b
+    function norm(p: point): int =
+        let var dx := p.x * p.x
+            var dy := p.y * p.y
+        in dx + dy end
+    function fill(n: int): ints =
+        let var arr := ints [n] of 0
+        in for i := 0 to n - 1 do arr[i] := add(i, counter);
+           arr
+        end
+    function loop(n: int) =
+        while n > 0 do (counter := counter + 1; if n = 3 then break)
+    var origin := point {x = 1, y = -2}
+    var name := "tiger" var k:=add(1,2)
+in
+    loop(10);
+    norm(origin) + size(name) + k;
+    fill(4)
+end
+)";
+
+int main() {
+    // 1. an in-place edit reparses one declaration and matches a full parse
+    {
+        IncrementalParser inc(BASE);
+        assert(!inc.has_errors());
+        std::string src = BASE;
+        size_t at = src.find("a + b");
+        assert(inc.apply({at + 4, 1, "a * 2"}));
+        assert(inc.last_reparsed() && inc.last_reparsed()->kind == DecKind::FUNCTION);
+        check_against_full(inc);
+
+        // inserting a line inside a nested declaration renumbers later lines
+        at = inc.source().find("var dy");
+        assert(inc.apply({at + 3, 0, "\n           "}));
+        assert(inc.last_reparsed()->kind == DecKind::VAR);
+        check_against_full(inc);
+
+        // a column change on a shared last line moves the next declaration
+        at = inc.source().find("\"tiger\"");
+        assert(inc.apply({at + 1, 5, "cat"}));
+        check_against_full(inc);
+    }
+
+    // 2. edits that cannot be isolated fall back to a full parse
+    {
+        // the fragment parses alone, but "c" fuses with the following "var"
+        IncrementalParser fused("let var a := (b)var c := 1 in a end");
+        assert(!fused.apply({15, 1, ") + c"}));
+        assert(fused.has_errors());
+        check_against_full(fused);
+
+        IncrementalParser broken("let var a := 1 in a end");
+        assert(!broken.apply({13, 1, "("}));
+        assert(broken.has_errors());
+        assert(!broken.apply({13, 1, "2"}));  // old tree had errors
+        assert(!broken.has_errors());
+        check_against_full(broken);
+        assert(broken.apply({13, 1, "3"}));
+        check_against_full(broken);
+    }
+
+    // 3. randomized edits against a full reparse; broken edits are undone
+    // so the incremental path keeps being exercised
+    {
+        std::string base = "(" + std::string(BASE) + ";\n" + std::string(BASE) + ")\n";
+        IncrementalParser inc(base);
+        assert(!inc.has_errors());
+
+        std::mt19937 rng(20261018);
+        const char* snippets[] = {" ", "\n", "1", "x", " + 1", "/* c */", "\"s\"",
+                                  "\n\n  ", "(", ")", ":=", "var", "7 * 3", ";"};
+        const char chars[] = "abxyz0123456789 +-*/()\n;:=<>";
+        for (int iter = 0; iter < 3000; iter++) {
+            const std::string& src = inc.source();
+            size_t at = rng() % (src.size() + 1);
+            TextEdit edit{at, 0, ""};
+            switch (rng() % 4) {
+                case 0:
+                    if (at < src.size()) {
+                        edit.length = 1;
+                        edit.text = std::string(1, chars[rng() % (sizeof(chars) - 1)]);
+                    }
+                    break;
+                case 1:
+                    if (at < src.size() && std::isdigit(static_cast<unsigned char>(src[at]))) {
+                        edit.length = 1;
+                        edit.text = std::string(1, static_cast<char>('0' + rng() % 10));
+                    } else {
+                        edit.text = "\n";
+                    }
+                    break;
+                case 2:
+                    edit.text = snippets[rng() % (sizeof(snippets) / sizeof(snippets[0]))];
+                    break;
+                default:
+                    edit.length = std::min<size_t>(src.size() - at, 1 + rng() % 3);
+                    break;
+            }
+            std::string removed = src.substr(edit.offset, edit.length);
+            inc.apply(edit);
+            check_against_full(inc);
+
+            if (inc.has_errors()) {
+                inc.apply({edit.offset, edit.text.size(), removed});
+                check_against_full(inc);
+            }
+        }
+        assert(inc.incremental_count() > 500);
+        std::cout << "randomized: " << inc.incremental_count() << " incremental, "
+                  << inc.full_count() << " full\n";
+    }
+
+    // 4. line shifts of several edits are applied together when the tree
+    // is next read, including shifts pending around a reparsed declaration.
+    // Blanks are inserted and removed next to blanks, so no token changes
+    // and the program always parses.
+    {
+        std::string base = "(" + std::string(BASE) + ";\n" + std::string(BASE) + ")\n";
+        IncrementalParser inc(base);
+        std::mt19937 rng(7);
+        const char* snippets[] = {"\n", "\n\n  ", " ", "\n    "};
+        auto blank = [](char c) { return c == ' ' || c == '\n'; };
+        for (int iter = 0; iter < 4000; iter++) {
+            const std::string& src = inc.source();
+            size_t at = 1 + rng() % (src.size() - 2);
+            if (!blank(src[at])) continue;
+            if (rng() % 2 == 0 && (blank(src[at - 1]) || blank(src[at + 1]))) {
+                inc.apply({at, 1, ""});
+            } else {
+                inc.apply({at, 0, snippets[rng() % 4]});
+            }
+            assert(!inc.has_errors());
+            if (iter % 16 == 15) check_against_full(inc);
+        }
+        check_against_full(inc);
+        assert(inc.incremental_count() > 1500);
+    }
+
+    std::cout << "All incremental parser tests passed!\n";
+    return 0;
+}
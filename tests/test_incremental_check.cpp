@@ -0,0 +1,250 @@
+#undef NDEBUG
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "semantic/IncrementalChecker.hpp"
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace tiger;
+using namespace tiger::semantic;
+
+// Every expression of the tree, in source order.
+static void collect(const Exp* e, std::vector<const Exp*>& out);
+
+static void collect_var(const Var* v, std::vector<const Exp*>& out) {
+    if (v->kind == VarKind::FIELD) {
+        collect_var(static_cast<const FieldVar*>(v)->var.get(), out);
+    } else if (v->kind == VarKind::SUBSCRIPT) {
+        collect_var(static_cast<const SubscriptVar*>(v)->var.get(), out);
+        collect(static_cast<const SubscriptVar*>(v)->index.get(), out);
+    }
+}
+
+static void collect(const Exp* e, std::vector<const Exp*>& out) {
+    if (!e) return;
+    out.push_back(e);
+    switch (e->kind) {
+        case ExpKind::VAR: collect_var(static_cast<const VarExp*>(e)->var.get(), out); break;
+        case ExpKind::CALL:
+            for (const auto& a : static_cast<const CallExp*>(e)->args) collect(a.get(), out);
+            break;
+        case ExpKind::OP:
+            collect(static_cast<const OpExp*>(e)->left.get(), out);
+            collect(static_cast<const OpExp*>(e)->right.get(), out);
+            break;
+        case ExpKind::RECORD:
+            for (const auto& f : static_cast<const RecordExp*>(e)->fields) collect(f.exp.get(), out);
+            break;
+        case ExpKind::SEQ:
+            for (const auto& x : static_cast<const SeqExp*>(e)->exps) collect(x.get(), out);
+            break;
+        case ExpKind::ASSIGN:
+            collect_var(static_cast<const AssignExp*>(e)->var.get(), out);
+            collect(static_cast<const AssignExp*>(e)->exp.get(), out);
+            break;
+        case ExpKind::IF: {
+            auto* i = static_cast<const IfExp*>(e);
+            collect(i->test.get(), out);
+            collect(i->then_exp.get(), out);
+            collect(i->else_exp.get(), out);
+            break;
+        }
+        case ExpKind::WHILE:
+            collect(static_cast<const WhileExp*>(e)->test.get(), out);
+            collect(static_cast<const WhileExp*>(e)->body.get(), out);
+            break;
+        case ExpKind::FOR: {
+            auto* f = static_cast<const ForExp*>(e);
+            collect(f->lo.get(), out);
+            collect(f->hi.get(), out);
+            collect(f->body.get(), out);
+            break;
+        }
+        case ExpKind::LET: {
+            auto* let = static_cast<const LetExp*>(e);
+            for (const auto& d : let->decs) {
+                if (d->kind == DecKind::VAR) collect(static_cast<const VarDec&>(*d).init.get(), out);
+                if (d->kind == DecKind::FUNCTION)
+                    collect(static_cast<const FunctionDec&>(*d).body.get(), out);
+            }
+            for (const auto& x : let->body) collect(x.get(), out);
+            break;
+        }
+        case ExpKind::ARRAY:
+            collect(static_cast<const ArrayExp*>(e)->size.get(), out);
+            collect(static_cast<const ArrayExp*>(e)->init.get(), out);
+            break;
+        default:
+            break;
+    }
+}
+
+// Record field slots the checker annotated `e` with (its own fields, or
+// the field accesses of the variable it reads).
+static std::vector<uint32_t> field_slots(const Exp* e) {
+    std::vector<uint32_t> slots;
+    if (e->kind == ExpKind::RECORD) {
+        for (const auto& f : static_cast<const RecordExp*>(e)->fields) slots.push_back(f.slot);
+    } else if (e->kind == ExpKind::VAR) {
+        for (const Var* v = static_cast<const VarExp*>(e)->var.get(); v->kind != VarKind::SIMPLE;) {
+            if (v->kind == VarKind::FIELD) {
+                slots.push_back(static_cast<const FieldVar*>(v)->slot);
+                v = static_cast<const FieldVar*>(v)->var.get();
+            } else {
+                v = static_cast<const SubscriptVar*>(v)->var.get();
+            }
+        }
+    }
+    return slots;
+}
+
+// The incremental result is exactly a full check of the current source:
+// same diagnostics in the same order, same type (and field slots) for
+// every expression.
+static void assert_same_as_full(const IncrementalChecker& ic) {
+    Lexer lexer(ic.parser().source());
+    Parser parser(lexer);
+    auto program = parser.parse();
+    if (lexer.has_errors() || parser.has_errors()) {
+        assert(ic.parser().has_errors() && ic.errors().empty());
+        return;
+    }
+    TypeChecker full;
+    full.check(*program);
+    for (std::size_t i = 0; i < std::max(full.errors().size(), ic.errors().size()); i++) {
+        if (i >= full.errors().size() || i >= ic.errors().size() ||
+            full.errors()[i] != ic.errors()[i]) {
+            std::cerr << "full:        " << (i < full.errors().size() ? full.errors()[i] : "-")
+                      << "\nincremental: " << (i < ic.errors().size() ? ic.errors()[i] : "-")
+                      << "\n";
+            assert(false);
+        }
+    }
+
+    std::vector<const Exp*> mine, theirs;
+    collect(ic.parser().program().exp.get(), mine);
+    collect(program->exp.get(), theirs);
+    assert(mine.size() == theirs.size());
+    for (std::size_t i = 0; i < mine.size(); i++) {
+        assert(type_name(ic.checker().type_of(mine[i])) == type_name(full.type_of(theirs[i])));
+        assert(field_slots(mine[i]) == field_slots(theirs[i]));
+    }
+}
+
+// Replaces the first occurrence of `from` (after `after`) with `to`.
+static bool replace(IncrementalChecker& ic, const std::string& from, const std::string& to,
+                    const std::string& after = "") {
+    std::size_t start = after.empty() ? 0 : ic.parser().source().find(after);
+    std::size_t at = ic.parser().source().find(from, start);
+    assert(start != std::string::npos && at != std::string::npos);
+    bool ok = ic.apply(TextEdit{at, from.size(), to});
+    assert_same_as_full(ic);
+    return ok;
+}
+
+static const char* PROGRAM =
+    "let\n"
+    "  type point = {x: int, y: int}\n"
+    "  type ints = array of int\n"
+    "  var origin := point{x = 0, y = 0}\n"
+    "  function f0(a: int): int = a + 1\n"
+    "  function f1(a: int): int = f0(a) * 2\n"
+    "  function f2(p: point): int = p.x + p.y\n"
+    "  function f3(n: int): int =\n"
+    "    let function g(k: int): int = k + n\n"
+    "    in g(n) + f1(n) end\n"
+    "  function f4(s: string): int = size(s) + \"oops\"\n"
+    "  function f5(a: int): int = let var xs := ints[a] of 0 in xs[0] end\n"
+    "in\n"
+    "  f3(f2(origin)) + f5(1)\n"
+    "end\n";
+
+int main() {
+    // 1. the first check walks everything and matches a full check
+    IncrementalChecker ic(PROGRAM);
+    assert_same_as_full(ic);
+    assert(ic.errors().size() == 1);   // f4
+    assert(ic.bodies_checked() == 7 && ic.bodies_reused() == 0);
+
+    // 2. a body-only edit walks that body only
+    replace(ic, "a + 1", "a + 7");
+    assert(ic.bodies_checked() == 1 && ic.bodies_reused() == 5);
+
+    // 3. a signature change also walks the callers of the function
+    replace(ic, "f0(a: int)", "f0(a: string)");
+    assert(ic.errors().size() == 3);   // f0 body, f1's call, f4
+    assert(ic.bodies_checked() == 2 && ic.bodies_reused() == 4);
+    replace(ic, "f0(a: string)", "f0(a: int)");
+    assert(ic.bodies_checked() == 2 && ic.errors().size() == 1);
+
+    // 4. a type change walks the bodies that can see its declaration
+    // group: f2 (point) and f5 (ints, declared with point)
+    replace(ic, "y: int}", "y: string}");
+    assert(ic.bodies_checked() == 2 && ic.errors().size() == 3);   // origin, f2, f4
+    replace(ic, "y: string}", "y: int}");
+    // swapping the fields moves p.x and p.y to the other slot in f2
+    replace(ic, "{x: int, y: int}", "{y: int, x: int}");
+    assert(ic.bodies_checked() == 2 && ic.errors().size() == 3);   // origin twice, f4
+    replace(ic, "{y: int, x: int}", "{x: int, y: int}");
+
+    // 5. an edit that adds a line moves the replayed diagnostic of f4
+    std::string before = ic.errors()[0];
+    replace(ic, "= f0(a) * 2", "=\n    f0(a) * 2");
+    assert(ic.bodies_checked() == 1 && ic.errors()[0] != before);
+
+    // 6. an edit in a nested function walks it and the body around it
+    replace(ic, "k + n", "k * n");
+    assert(ic.bodies_checked() == 2 && ic.bodies_reused() == 5);
+
+    // 7. a parse error drops the cache; the next clean parse rebuilds it
+    assert(!replace(ic, "xs[0] end", "xs[0] + end"));
+    replace(ic, "xs[0] + end", "xs[0] end");
+    assert(ic.bodies_checked() == 7);
+
+    // 8. random edits of digits, operators and lines all match a full check
+    {
+        std::mt19937 rng(42);
+        const std::string ops[] = {"+", "-", "*"};
+        for (int step = 0; step < 300; step++) {
+            const std::string& src = ic.parser().source();
+            std::size_t at = rng() % src.size();
+            char c = src[at];
+            TextEdit edit{at, 0, ""};
+            if (c >= '0' && c <= '9') {
+                edit = {at, 1, std::string(1, static_cast<char>('0' + rng() % 10))};
+            } else if (c == '+' || c == '-' || c == '*') {
+                edit = {at, 1, ops[rng() % 3]};
+            } else if (c == '\n' && at > 0) {
+                edit = {at, 0, rng() % 2 ? "\n" : "  "};
+            } else if (c == '"') {
+                edit = {at, 0, "x"};   // "oops" -> "xoops" or an unterminated one
+            } else {
+                continue;
+            }
+            ic.apply(edit);
+            assert_same_as_full(ic);
+        }
+    }
+
+    // 9. many functions, one body edited: one body walked
+    {
+        std::string src = "let\n";
+        for (int i = 0; i < 500; i++)
+            src += "  function h" + std::to_string(i) + "(n: int): int = n + " +
+                   std::to_string(i) + (i ? " + h" + std::to_string(i - 1) + "(n)" : "") + "\n";
+        src += "in h499(1) end\n";
+        IncrementalChecker big(src);
+        assert(big.ok() && big.bodies_checked() == 500);
+        std::size_t at = big.parser().source().find("n + 250 ");
+        big.apply(TextEdit{at + 4, 3, "7"});
+        assert(big.ok() && big.bodies_checked() == 1 && big.bodies_reused() == 499);
+        assert_same_as_full(big);
+    }
+
+    std::cout << "All incremental checker tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,277 @@
+#undef NDEBUG
+#include "TestPipeline.hpp"
+#include "semantic/BaseEnv.hpp"
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace tiger;
+using namespace tiger::semantic;
+using namespace tiger::test;
+
+struct Run {
+    bool ok;
+    Value result;
+    std::string output;
+    int exit_code;
+    std::string error;
+    std::size_t calls;
+    std::size_t hits;
+    std::string text;
+};
+
+static Run run(const std::string& source, bool memoize = false, const std::string& input = "") {
+    auto c = compile(source);
+    std::ostringstream out;
+    std::istringstream in(input);
+    Interpreter::Options options;
+    if (memoize) options.memoize = &c->purity;
+    Interpreter interp(out, in, options);
+    Run r;
+    r.ok = interp.run(*c->program, c->resolver);
+    r.result = interp.result();
+    r.output = out.str();
+    r.exit_code = interp.exit_code();
+    r.error = interp.errors().empty() ? "" : interp.errors()[0];
+    r.calls = interp.calls();
+    r.hits = interp.cache_hits();
+    // a string result may point into the interpreter's heap
+    if (r.result.kind == ValueKind::STRING) r.text = std::string(r.result.str());
+    return r;
+}
+
+static int32_t int_of(const std::string& source) {
+    Run r = run(source);
+    assert(r.ok && r.result.kind == ValueKind::INT);
+    return r.result.i;
+}
+
+static std::string output_of(const std::string& source, bool memoize = false) {
+    Run r = run(source, memoize);
+    if (!r.ok) std::cerr << source << "\n  " << r.error << "\n";
+    assert(r.ok);
+    return r.output;
+}
+
+static bool traps(const std::string& source, const std::string& what) {
+    Run r = run(source);
+    if (r.ok || r.error.find(what) == std::string::npos) {
+        std::cerr << source << "\n  got: " << r.error << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Purity of the user function declared `index`-th.
+static bool pure(const Compiled& c, std::size_t index) {
+    return c.purity.pure(static_cast<uint32_t>(base_env::FUNCTION_COUNT + index));
+}
+
+int main() {
+    // 1. integers: 32-bit wrap, division truncates toward zero
+    assert(int_of("1 + 2 * 3 - 8 / 2") == 3);
+    assert(int_of("-7 / 2") == -3);
+    assert(int_of("7 / -2") == -3);
+    assert(int_of("2147483647 + 1") == -2147483647 - 1);
+    assert(int_of("let var m := -2147483647 - 1 in m / -1 end") == -2147483647 - 1);
+    assert(int_of("65536 * 65536 + 7") == 7);
+    assert(int_of("(3 < 4) + (4 <= 4) + (5 > 6) + (6 >= 7) + (1 = 1) + (1 <> 1)") == 3);
+
+    // 2. strings compare by content
+    assert(int_of("size(concat(\"ab\", \"cde\"))") == 5);
+    assert(int_of("concat(\"a\", \"b\") = \"ab\"") == 1);
+    assert(int_of("(\"abc\" < \"abd\") + (\"b\" > \"abc\") + (\"\" < \"a\")") == 3);
+    assert(int_of("ord(\"A\") + ord(\"\")") == 64);
+    assert(int_of("ord(chr(200))") == 200);
+    assert(output_of("print(substring(\"hello world\", 6, 5))") == "world");
+    assert(int_of("not(0) * 2 + not(5)") == 2);
+
+    // 3. records and arrays: fields by slot, sharing, nil
+    assert(int_of("let type p = {x: int, y: int}\n"
+                  "    var a := p{x = 1, y = 2} var b := a\n"
+                  "in b.y := 40; a.x + a.y end") == 41);
+    assert(int_of("let type l = {hd: int, tl: l}\n"
+                  "    var xs := l{hd = 1, tl = l{hd = 2, tl = l{hd = 3, tl = nil}}}\n"
+                  "    var sum := 0\n"
+                  "in while xs <> nil do (sum := sum + xs.hd; xs := xs.tl); sum end") == 6);
+    assert(int_of("let type p = {x: int} var n : p := nil\n"
+                  "in (p{x = 1} = p{x = 1}) + (n = nil) end") == 1);
+    assert(int_of("let type a = array of int var v := a[5] of 2\n"
+                  "in v[0] := 10; v[4] := v[0] + v[3]; v[4] end") == 12);
+
+    // 4. loops and break
+    assert(int_of("let var s := 0 in for i := 1 to 10 do s := s + i; s end") == 55);
+    assert(int_of("let var s := 0 in for i := 1 to 10 do (if i = 4 then break; s := s + i); s end") == 6);
+    assert(int_of("let var n := 0 in\n"
+                  "  for i := 0 to 9 do for j := 0 to 9 do (if j = 2 then break; n := n + 1);\n"
+                  "  n end") == 20);
+    assert(int_of("let var n := 0 in for i := 2147483646 to 2147483647 do n := n + 1; n end") == 2);
+    assert(int_of("let var i := 0 in while 1 do (i := i + 1; if i = 7 then break); i end") == 7);
+    assert(int_of("let var n := 0 in for i := 5 to 1 do n := 1; n end") == 0);
+
+    // 5. functions: recursion, static links, escaping variables
+    assert(int_of("let function f(n: int): int = if n = 0 then 1 else n * f(n - 1) in f(10) end") ==
+           3628800);
+    assert(int_of("let function even(n: int): int = if n = 0 then 1 else odd(n - 1)\n"
+                  "    function odd(n: int): int = if n = 0 then 0 else even(n - 1)\n"
+                  "in even(100) + odd(7) end") == 2);
+    assert(int_of("let function outer(a: int): int =\n"
+                  "      let var count := 0\n"
+                  "          function bump(k: int) = count := count + k + a\n"
+                  "          function twice(k: int) = (bump(k); bump(k))\n"
+                  "      in twice(1); twice(2); count end\n"
+                  "in outer(10) + outer(100) end") == 46 + 406);
+    assert(int_of("let function sum(n: int): int =\n"        // static link vs. caller
+                  "      let function go(i: int): int = if i > n then 0 else i + go(i + 1)\n"
+                  "      in go(1) end\n"
+                  "in sum(4) * 100 + sum(3) end") == 1006);
+
+    // 6. I/O and exit
+    {
+        Run r = run("let var a := getchar() var b := getchar() var c := getchar()\n"
+                    "in print(concat(b, a)); print(c); size(c) end", false, "xy");
+        assert(r.ok && r.output == "yx" && r.result.i == 0);
+    }
+    {
+        Run r = run("(print(\"a\"); exit(7); print(\"b\"); 1)");
+        assert(r.ok && r.output == "a" && r.exit_code == 7 && r.result.kind == ValueKind::UNIT);
+    }
+    assert(output_of("for i := 0 to 2 do (print(chr(ord(\"0\") + i)); print(\"\\n\"))") ==
+           "0\n1\n2\n");
+
+    // 7. runtime errors stop the program and say where
+    assert(traps("let type p = {x: int} var v : p := nil in v.x end", "1:44: error: field x of nil"));
+    assert(traps("let type a = array of int var v := a[3] of 0 in v[3] end", "index 3 out of range"));
+    assert(traps("let type a = array of int var v := a[3] of 0 in v[-1] := 1 end", "index -1"));
+    assert(traps("let var z := 0 in 10 / z end", "division by zero"));
+    assert(traps("chr(256)", "chr(256) out of range"));
+    assert(traps("substring(\"abc\", 2, 2)", "out of range"));
+    assert(traps("let type a = array of int in a[-1] of 0 end", "negative array size"));
+    {
+        auto c = compile("let function f(n: int): int = f(n + 1) in f(0) end");
+        std::ostringstream out;
+        std::istringstream in;
+        Interpreter::Options options;
+        options.max_call_depth = 500;
+        Interpreter interp(out, in, options);
+        assert(!interp.run(*c->program, c->resolver));
+        assert(interp.errors()[0].find("call depth limit (500) exceeded in f") != std::string::npos);
+    }
+    {
+        // Runaway recursion ends in a trap, not a stack overflow, however
+        // large the frames of this build are
+        auto c = compile("let function sum(n: int): int = let var s := sum(n + 1) in s + n end\n"
+                         "in sum(2) end");
+        std::ostringstream out;
+        std::istringstream in;
+        Interpreter::Options options;
+        options.max_call_depth = UINT32_MAX;
+        options.max_stack_bytes = 1u << 20;
+        Interpreter interp(out, in, options);
+        assert(!interp.run(*c->program, c->resolver));
+        assert(interp.errors()[0].find("stack limit (1048576 bytes) exceeded in sum") !=
+               std::string::npos);
+
+        Run r = run("let function f(n: int): int = if n = 0 then 0 else 1 + f(n - 1) in f(1000000) end");
+        assert(!r.ok && r.error.find("limit") != std::string::npos);
+    }
+    {
+        Run r = run("(print(\"before\"); 1 / 0; print(\"after\"))");
+        assert(!r.ok && r.output == "before");
+    }
+
+    // 8. purity
+    {
+        auto c = compile(
+            "let var limit := 10\n"
+            "    var count := 0\n"
+            "    type p = {x: int}\n"
+            "    function fib(n: int): int = if n < 2 then n else fib(n - 1) + fib(n - 2)\n"   // 0
+            "    function clamp(n: int): int = if n > limit then limit else n\n"                // 1
+            "    function tick(): int = (count := count + 1; count)\n"                          // 2
+            "    function reads(): int = count\n"                                               // 3
+            "    function say(s: string) = print(s)\n"                                          // 4
+            "    function uses_tick(n: int): int = n + tick()\n"                                // 5
+            "    function alloc(n: int): p = p{x = n}\n"                                        // 6
+            "    function field(v: p): int = v.x\n"                                             // 7
+            "    function str(s: string): string = concat(s, chr(ord(s) + 1))\n"               // 8
+            "    function outer(a: int): int =\n"                                               // 9
+            "        let var local := a\n"
+            "            function inner(k: int): int = k + a\n"                                 // 10
+            "            function own(k: int): int = let var t := k in t := t * 2; t end\n"     // 11
+            "        in local := local + own(a); local end\n"
+            "in for i := 0 to 2 do\n"
+            "     let var step := i\n"
+            "         function by_step(k: int): int = k * step\n"                               // 12
+            "     in count := by_step(i) end;\n"
+            "   fib(clamp(20)) + outer(1)\n"
+            "end");
+        assert(pure(*c, 0) && pure(*c, 1));
+        assert(!pure(*c, 2) && !pure(*c, 3) && !pure(*c, 4) && !pure(*c, 5));
+        assert(!pure(*c, 6) && !pure(*c, 7));
+        assert(pure(*c, 8));
+        assert(pure(*c, 9));               // assigns its own local only, calls own
+        assert(!pure(*c, 10));             // reads the enclosing activation's parameter
+        assert(pure(*c, 11));
+        assert(!pure(*c, 12));             // `step` is declared in a loop
+        assert(c->purity.pure(builtin::CONCAT_ID - builtin::PRINT_ID));
+        assert(!c->purity.pure(builtin::PRINT_ID - builtin::PRINT_ID));
+        assert(c->purity.pure_count() == 5 && c->purity.function_count() == 13);
+    }
+
+    // 9. memoization: same results, fewer calls; impure functions are never cached
+    {
+        const std::string fib =
+            "let function fib(n: int): int = if n < 2 then n else fib(n - 1) + fib(n - 2)\n"
+            "in fib(24) end";
+        Run plain = run(fib), memo = run(fib, true);
+        assert(plain.ok && memo.ok && plain.result.i == 46368 && memo.result.i == 46368);
+        assert(memo.hits > 0 && memo.calls < plain.calls / 100);
+
+        const std::string impure =
+            "let var count := 0\n"
+            "    function tick(n: int): int = (count := count + 1; n + count)\n"
+            "    var sum := 0\n"
+            "in for i := 1 to 100 do sum := sum + tick(1); sum end";
+        Run a = run(impure), b = run(impure, true);
+        assert(a.result.i == b.result.i && b.hits == 0);
+
+        // string arguments are keyed by content; string results survive the cache
+        Run s = run("let function twice(s: string): string = concat(s, s)\n"
+                    "    var total := 0\n"
+                    "in for i := 1 to 50 do total := total + size(twice(concat(\"a\", \"b\")));\n"
+                    "   twice(\"xy\") end", true);
+        assert(s.ok && s.hits > 0 && s.text == "xyxy");
+
+        // a bounded cache: colliding entries are replaced, results stay right
+        auto c = compile(fib);
+        std::ostringstream out;
+        std::istringstream in;
+        Interpreter::Options options;
+        options.memoize = &c->purity;
+        options.cache_entries = 2;
+        options.hot_calls = 1;
+        Interpreter interp(out, in, options);
+        assert(interp.run(*c->program, c->resolver) && interp.result().i == 46368);
+        assert(interp.run(*c->program, c->resolver) && interp.result().i == 46368);   // rerun
+
+        // the key is the arguments as passed, not as the body left them
+        const std::string assigns =
+            "let function f(n: int): int = let var r := n * 2 in n := 5; r end\n"
+            "    var s := 0\n"
+            "in for i := 1 to 10 do s := s + f(2130); s * 1000 + f(5) end";
+        Run p = run(assigns), q = run(assigns, true);
+        assert(p.ok && q.ok && p.result.i == 42600010 && q.result.i == 42600010);
+        assert(q.hits > 0);
+
+        // no arguments: one key, the empty one
+        Run k = run("let function k(): int = 7\n"
+                    "    var s := 0\n"
+                    "in for i := 1 to 20 do s := s + k(); s end", true);
+        assert(k.ok && k.result.i == 140 && k.hits > 0);
+    }
+
+    std::cout << "All interpreter tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,264 @@
+#undef NDEBUG
+#include "TestPipeline.hpp"
+#include "ir/Translate.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace tiger;
+using namespace tiger::ir;
+
+static Module translate(const std::string& source) {
+    test::Compiled c;
+    semantic::TypeChecker checker;
+    test::check(c, source, checker);
+    c.resolver.resolve(*c.program);
+    return Translator(checker).translate(*c.program, c.resolver);
+}
+
+static bool expect_dump(const std::string& source, const std::string& expected) {
+    std::string dump = translate(source).dump();
+    if (dump == expected) return true;
+    std::cerr << source << "\n--- expected\n" << expected << "--- got\n" << dump;
+    return false;
+}
+
+// Checks that every function is a tree of well-kinded nodes: each node is
+// reached from the body exactly once, expressions and statements sit where
+// the grammar puts them, and temps and labels are in range. Fresh labels
+// are each defined once (or name a string) and all of them are used.
+struct WellFormed {
+    const Module& module;
+    const Function* f = nullptr;
+    std::vector<int> seen;
+    std::vector<int> defined;   // by label
+
+    explicit WellFormed(const Module& m) : module(m), defined(m.label_count(), 0) {}
+
+    static bool is_exp(Kind k) { return k <= Kind::ESEQ; }
+
+    void label(Label l) { assert(l < module.label_count()); }
+
+    void exp(NodeId id) {
+        assert(is_exp(node(id).kind));
+        const Node& n = (*f)[id];
+        switch (n.kind) {
+            case Kind::NAME: label(n.a); break;
+            case Kind::TEMP: assert(n.a < f->temps()); break;
+            case Kind::BINOP: exp(n.a); exp(n.b); break;
+            case Kind::MEM: exp(n.a); break;
+            case Kind::CALL:
+                exp(n.a);
+                assert(n.b + n.c <= f->operands().size());
+                for (uint32_t i = 0; i < n.c; i++) exp(f->operands()[n.b + i]);
+                break;
+            case Kind::ESEQ: stm(n.a); exp(n.b); break;
+            default: break;
+        }
+    }
+
+    void stm(NodeId id) {
+        assert(!is_exp(node(id).kind));
+        const Node& n = (*f)[id];
+        switch (n.kind) {
+            case Kind::MOVE:
+                assert((*f)[n.a].kind == Kind::TEMP || (*f)[n.a].kind == Kind::MEM);
+                exp(n.a);
+                exp(n.b);
+                break;
+            case Kind::EXP: exp(n.a); break;
+            case Kind::JUMP: label(n.a); break;
+            case Kind::CJUMP:
+                exp(n.a);
+                exp(n.b);
+                label(f->operands()[n.c]);
+                label(f->operands()[n.c + 1]);
+                break;
+            case Kind::SEQ: stm(n.a); stm(n.b); break;
+            case Kind::LABEL: label(n.a); defined[n.a]++; break;
+            default: break;
+        }
+    }
+
+    const Node& node(NodeId id) {
+        assert(id < f->size());
+        assert(seen[id]++ == 0);
+        return (*f)[id];
+    }
+
+    bool check() {
+        for (const Function& fn : module.functions()) {
+            f = &fn;
+            seen.assign(fn.size(), 0);
+            stm(fn.body());
+            for (int s : seen) assert(s == 1);
+        }
+        for (const StringFragment& s : module.strings()) defined[s.label]++;
+        Label first_fresh = RUNTIME_LABEL_COUNT + static_cast<Label>(module.functions().size() - 1);
+        for (Label l = 0; l < module.label_count(); l++) assert(defined[l] == (l >= first_fresh));
+        return true;
+    }
+};
+
+int main() {
+    static_assert(sizeof(Node) == 16);
+
+    // 1. Locals that do not escape live in temps
+    {
+        assert(expect_dump("let var a := 1 var b := a + 2 in a * b end",
+                           "function tigermain (params 0, slots 2, temps 4)\n"
+                           "  MOVE(TEMP t2, CONST 1)\n"
+                           "  MOVE(TEMP t3, BINOP(PLUS, TEMP t2, CONST 2))\n"
+                           "  EXP(BINOP(MUL, TEMP t2, TEMP t3))\n"));
+        std::cout << "Test 1 (temps) passed!\n";
+    }
+
+    // 2. Escaping variables, static links and calls
+    {
+        assert(expect_dump(
+            "let var x := 5\n"
+            "    function f(y: int): int = let function g(): int = x + y in g() end\n"
+            "in f(1) end",
+            "function tigermain (params 0, slots 1, temps 3)\n"
+            "  MOVE(MEM(BINOP(PLUS, TEMP fp, CONST 8)), CONST 5)\n"
+            "  EXP(CALL(NAME f.0, TEMP fp, CONST 1))\n"
+            "function f.0 (params 1, slots 1, temps 3)\n"
+            "  MOVE(TEMP rv, CALL(NAME g.1, TEMP fp))\n"
+            "function g.1 (params 0, slots 0, temps 2)\n"
+            "  MOVE(TEMP rv, BINOP(PLUS, MEM(BINOP(PLUS, MEM(MEM(TEMP fp)), CONST 8)), "
+            "MEM(BINOP(PLUS, MEM(TEMP fp), CONST 8))))\n"));
+        std::cout << "Test 2 (frames and static links) passed!\n";
+    }
+
+    // 3. Loops, break and if
+    {
+        assert(expect_dump(
+            "let var s := 0 in\n"
+            "  while s < 10 do (s := s + 1; if s = 5 then break);\n"
+            "  for i := 0 to 3 do s := s - i;\n"
+            "  if s > 2 then s := 0 else s := 1\n"
+            "end",
+            "function tigermain (params 0, slots 2, temps 5)\n"
+            "  MOVE(TEMP t2, CONST 0)\n"
+            "  LABEL L14\n"
+            "  CJUMP(LT, TEMP t2, CONST 10, L15, L16)\n"
+            "  LABEL L15\n"
+            "  MOVE(TEMP t2, BINOP(PLUS, TEMP t2, CONST 1))\n"
+            "  CJUMP(EQ, TEMP t2, CONST 5, L17, L18)\n"
+            "  LABEL L17\n"
+            "  JUMP L16\n"
+            "  LABEL L18\n"
+            "  JUMP L14\n"
+            "  LABEL L16\n"
+            "  MOVE(TEMP t3, CONST 0)\n"
+            "  MOVE(TEMP t4, CONST 3)\n"
+            "  CJUMP(LE, TEMP t3, TEMP t4, L19, L21)\n"
+            "  LABEL L19\n"
+            "  MOVE(TEMP t2, BINOP(MINUS, TEMP t2, TEMP t3))\n"
+            "  CJUMP(LT, TEMP t3, TEMP t4, L20, L21)\n"
+            "  LABEL L20\n"
+            "  MOVE(TEMP t3, BINOP(PLUS, TEMP t3, CONST 1))\n"
+            "  JUMP L19\n"
+            "  LABEL L21\n"
+            "  CJUMP(GT, TEMP t2, CONST 2, L22, L23)\n"
+            "  LABEL L22\n"
+            "  MOVE(TEMP t2, CONST 0)\n"
+            "  JUMP L24\n"
+            "  LABEL L23\n"
+            "  MOVE(TEMP t2, CONST 1)\n"
+            "  LABEL L24\n"));
+        std::cout << "Test 3 (control flow) passed!\n";
+    }
+
+    // 4. Comparisons as values, string comparisons, nested tests
+    {
+        assert(expect_dump(
+            "let var a := 3 var s := \"x\"\n"
+            "    var c := a < 4 var e := s = \"y\" var n := s <> \"y\" var o := s >= \"y\"\n"
+            "in if (if a > 1 then a < 5 else 0) then print(s) end",
+            "function tigermain (params 0, slots 6, temps 12)\n"
+            "  MOVE(TEMP t2, CONST 3)\n"
+            "  MOVE(TEMP t3, NAME L14)\n"
+            "  MOVE(TEMP t4, ESEQ(SEQ(MOVE(TEMP t8, CONST 1), SEQ(CJUMP(LT, TEMP t2, CONST 4, L15, L16), "
+            "SEQ(LABEL L16, SEQ(MOVE(TEMP t8, CONST 0), LABEL L15)))), TEMP t8))\n"
+            "  MOVE(TEMP t5, ESEQ(SEQ(MOVE(TEMP t9, CONST 1), SEQ(CJUMP(NE, CALL(NAME stringEqual, "
+            "TEMP t3, NAME L19), CONST 0, L17, L18), SEQ(LABEL L18, SEQ(MOVE(TEMP t9, CONST 0), "
+            "LABEL L17)))), TEMP t9))\n"
+            "  MOVE(TEMP t6, ESEQ(SEQ(MOVE(TEMP t10, CONST 1), SEQ(CJUMP(EQ, CALL(NAME stringEqual, "
+            "TEMP t3, NAME L22), CONST 0, L20, L21), SEQ(LABEL L21, SEQ(MOVE(TEMP t10, CONST 0), "
+            "LABEL L20)))), TEMP t10))\n"
+            "  MOVE(TEMP t7, ESEQ(SEQ(MOVE(TEMP t11, CONST 1), SEQ(CJUMP(GE, CALL(NAME stringCompare, "
+            "TEMP t3, NAME L25), CONST 0, L23, L24), SEQ(LABEL L24, SEQ(MOVE(TEMP t11, CONST 0), "
+            "LABEL L23)))), TEMP t11))\n"
+            "  CJUMP(GT, TEMP t2, CONST 1, L28, L29)\n"
+            "  LABEL L28\n"
+            "  CJUMP(LT, TEMP t2, CONST 5, L26, L27)\n"
+            "  LABEL L29\n"
+            "  JUMP L27\n"
+            "  LABEL L26\n"
+            "  EXP(CALL(NAME print, TEMP t3))\n"
+            "  LABEL L27\n"
+            "string L14 \"x\"\n"
+            "string L19 \"y\"\n"
+            "string L22 \"y\"\n"
+            "string L25 \"y\"\n"));
+        std::cout << "Test 4 (conditions) passed!\n";
+    }
+
+    // 5. Records, arrays, fields and subscripts
+    {
+        assert(expect_dump(
+            "let type r = {a: int, b: string} type v = array of r\n"
+            "    var x := r{a = 1, b = \"q\\n\"} var y := v[2] of x\n"
+            "in y[1].b := \"z\"; x.a end",
+            "function tigermain (params 0, slots 2, temps 5)\n"
+            "  MOVE(TEMP t2, ESEQ(SEQ(MOVE(TEMP t4, CALL(NAME allocRecord, CONST 16)), "
+            "SEQ(MOVE(MEM(TEMP t4), CONST 1), MOVE(MEM(BINOP(PLUS, TEMP t4, CONST 8)), NAME L14))), "
+            "TEMP t4))\n"
+            "  MOVE(TEMP t3, CALL(NAME initArray, CONST 2, TEMP t2))\n"
+            "  MOVE(MEM(BINOP(PLUS, MEM(BINOP(PLUS, TEMP t3, BINOP(MUL, CONST 1, CONST 8))), "
+            "CONST 8)), NAME L15)\n"
+            "  EXP(MEM(TEMP t2))\n"
+            "string L14 \"q\\n\"\n"
+            "string L15 \"z\"\n"));
+        std::cout << "Test 5 (records and arrays) passed!\n";
+    }
+
+    // 6. Larger programs: well-formed trees, dense labels, linear size
+    {
+        auto program = [](int functions) {
+            std::string s = "let type point = {x: int, y: int}\n    var total := 0\n";
+            for (int i = 0; i < functions; i++) {
+                std::string n = std::to_string(i);
+                s += "    function f" + n + "(a: int, b: int): int =\n"
+                     "        let var p := point{x = a, y = b}\n"
+                     "            function inner(k: int): int = k * p.x + total\n"
+                     "        in for i := a to b do (total := total + inner(i); if total > 99 then break);\n"
+                     "           if p.y < a then f" + n + "(b, a) else p.x + inner(b)\n"
+                     "        end\n";
+            }
+            return s + "in f" + std::to_string(functions - 1) + "(1, 2); print(\"done\") end";
+        };
+        Module small = translate(program(100));
+        Module large = translate(program(200));
+        assert(WellFormed(small).check() && WellFormed(large).check());
+        assert(large.functions().size() == 401);
+        Module empty = translate(program(1));
+        std::size_t per_function = (small.nodes() - empty.nodes()) / 99;
+        assert(small.nodes() - empty.nodes() == 99 * per_function);
+        assert(large.nodes() - small.nodes() == 100 * per_function);
+
+        for (const char* src : {"let var a := 3 var s := \"x\" var c := a < 4 var e := s = \"y\"\n"
+                                "in if (if a > 1 then a < 5 else 0) then print(s) end",
+                                "let var x := 5 function f(y: int): int = x + y in f(1) end",
+                                "while 1 do break", "()", "nil"}) {
+            Module m = translate(src);
+            assert(WellFormed(m).check());
+        }
+        std::cout << "Test 6 (well-formed, linear) passed!\n";
+    }
+
+    std::cout << "\nAll IR tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,111 @@
+#undef NDEBUG
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "util/ASTPrinter.hpp"
+#include "util/ParseCache.hpp"
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+static std::string print(const tiger::Program& prog) {
+    std::ostringstream oss;
+    tiger::AstPrinter printer(oss);
+    printer.print(prog);
+    return oss.str();
+}
+
+// Parses `source` and stores the result, as the driver does on a miss.
+static std::string parse_and_store(tiger::ParseCache& cache,
+                                   const std::string& source) {
+    tiger::Lexer lexer(source);
+    tiger::Parser parser(lexer);
+    auto prog = parser.parse();
+    cache.store(source, *prog, lexer.errors(), parser.errors(),
+                lexer.token_counts());
+    return print(*prog);
+}
+
+static void set_age(const std::string& dir, int seconds_ago) {
+    auto when = fs::file_time_type::clock::now() - std::chrono::seconds(seconds_ago);
+    for (const auto& de : fs::directory_iterator(dir)) {
+        fs::last_write_time(de.path(), when);
+    }
+}
+
+int main() {
+    std::string dir = "test_parse_cache.dir";
+    fs::remove_all(dir);
+
+    const std::string a = "let var x := 1 in x + 2 end";
+    const std::string b = "let function f(n: int): int = n * 2 in f(21) end";
+    const std::string c = "(1; \"two\"; nil)";
+    const std::string bad = "let var := in end";
+
+    {
+        tiger::ParseCache cache(dir);
+        assert(cache.enabled());
+
+        // 1. cold lookup misses, warm lookup hits with the same tree
+        tiger::CachedParse hit;
+        assert(!cache.lookup(a, hit));
+        std::string printed = parse_and_store(cache, a);
+        assert(cache.lookup(a, hit));
+        assert(print(*hit.program) == printed);
+        assert(hit.token_counts[static_cast<size_t>(tiger::TokenType::LET)] == 1);
+        assert(cache.hits() == 1 && cache.misses() == 1);
+
+        // 2. diagnostics are cached with the tree
+        parse_and_store(cache, bad);
+        assert(cache.lookup(bad, hit));
+        assert(!hit.parser_errors.empty());
+
+        // 3. a different source never hits
+        assert(!cache.lookup(a + " ", hit));
+    }
+
+    // 4. a corrupted entry is a miss and gets removed
+    for (const auto& de : fs::directory_iterator(dir)) {
+        std::ofstream(de.path(), std::ios::binary | std::ios::trunc) << "TPCE junk";
+    }
+    {
+        tiger::ParseCache cache(dir);
+        tiger::CachedParse hit;
+        assert(!cache.lookup(a, hit));
+        assert(!cache.lookup(bad, hit));
+        assert(cache.entry_count() == 0);
+    }
+
+    // 5. LRU eviction: the entry not touched since is evicted first
+    {
+        tiger::ParseCache probe(dir);
+        parse_and_store(probe, a);
+        std::uint64_t entry_size = probe.size_bytes();
+        fs::remove_all(dir);
+
+        tiger::ParseCache cache(dir, entry_size * 5 / 2);  // room for two
+        parse_and_store(cache, a);
+        set_age(dir, 100);
+        parse_and_store(cache, b);
+        set_age(dir, 50);
+
+        tiger::CachedParse hit;
+        assert(cache.lookup(a, hit));   // a is now the most recent
+        parse_and_store(cache, c);      // over budget: evicts b
+
+        assert(cache.evictions() == 1);
+        assert(cache.entry_count() == 2);
+        assert(cache.lookup(a, hit));
+        assert(cache.lookup(c, hit));
+        assert(!cache.lookup(b, hit));
+        assert(cache.size_bytes() <= entry_size * 5 / 2);
+    }
+
+    fs::remove_all(dir);
+    std::cout << "All ParseCache tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,167 @@
+#undef NDEBUG
+#include "TestPipeline.hpp"
+#include "interp/PartialEvaluator.hpp"
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace tiger;
+using namespace tiger::semantic;
+using namespace tiger::test;
+
+struct Evaluated : Compiled {
+    PartialEvaluator evaluator;
+
+    explicit Evaluated(PartialEvaluator::Options options) : evaluator(options) {}
+};
+
+static std::unique_ptr<Evaluated> compile(const std::string& source, bool peval = true,
+                                          PartialEvaluator::Options options = {}) {
+    auto c = test::compile<Evaluated>(source, options);
+    if (peval) c->evaluator.evaluate(*c->program, c->resolver, c->purity);
+    return c;
+}
+
+// Running `source` gives the same result with and without evaluation.
+static bool same_behaviour(const std::string& source) {
+    return run(*compile(source, false)) == run(*compile(source));
+}
+
+int main() {
+    // 1. Literal arithmetic and comparisons, nested
+    {
+        auto c = compile("let var x := 2 * 3 + 4\n"
+                         "    var y := -5\n"
+                         "    var z := (1 < 2) + (\"abc\" >= \"abd\")\n"
+                         "    var w := 2147483647 + 1\n"
+                         "in x + y + z end");
+        assert(is_int(init_of(*c, "x"), 10));
+        assert(is_int(init_of(*c, "y"), -5));
+        assert(is_int(init_of(*c, "z"), 1));
+        assert(is_int(init_of(*c, "w"), -2147483647 - 1));   // wraps as at run time
+        assert(c->evaluator.folded_calls() == 0 && c->evaluator.left_for_run_time() == 0);
+        std::cout << "Test 1 (literal arithmetic) passed!\n";
+    }
+
+    // 2. Calls to closed functions with constant arguments
+    {
+        const std::string src =
+            "let function fact(n: int): int = if n < 2 then 1 else n * fact(n - 1)\n"
+            "    function fib(n: int): int = if n < 2 then n else fib(n - 1) + fib(n - 2)\n"
+            "    var n := fact(10)\n"
+            "    var m := fib(2 * 10) - fact(3 + 1)\n"
+            "in n + m end";
+        auto c = compile(src);
+        assert(is_int(init_of(*c, "n"), 3628800));
+        assert(is_int(init_of(*c, "m"), 6765 - 24));
+        assert(c->evaluator.folded_calls() == 3 && c->evaluator.steps() > 0);
+        assert(run(*c) == "|" + std::to_string(3628800 + 6765 - 24));
+        assert(same_behaviour(src));
+        std::cout << "Test 2 (pure calls) passed!\n";
+    }
+
+    // 3. String results, including library functions
+    {
+        auto c = compile("let function twice(s: string): string = concat(s, s)\n"
+                         "    var a := twice(concat(\"ab\", chr(67)))\n"
+                         "    var b := substring(\"hello\", 1, 3)\n"
+                         "    var k := ord(\"A\") + size(a)\n"
+                         "    var e := concat(\"\", \"x\")\n"
+                         "in concat(a, b) end");
+        assert(is_string(init_of(*c, "a"), "abCabC"));
+        assert(is_string(init_of(*c, "b"), "ell"));
+        assert(is_string(init_of(*c, "e"), "x"));
+        assert(init_of(*c, "k").kind == ExpKind::OP);   // size(a) reads a variable
+        assert(run(*c) == "|abCabCell");
+        std::cout << "Test 3 (strings) passed!\n";
+    }
+
+    // 4. Only closed calls with constant arguments are evaluated
+    {
+        const std::string src =
+            "let var base := 10\n"
+            "    function add(x: int): int = x + base\n"
+            "    function sq(x: int): int = x * x\n"
+            "    function loud(x: int): int = (print(\"!\"); x)\n"
+            "    function mix(x: int, y: int): int = x + y\n"
+            "    var a := add(1)\n"
+            "    var b := loud(2)\n"
+            "    var c := mix(base, sq(3))\n"
+            "    var d := getchar()\n"
+            "in a + b + c + size(d) end";
+        auto c = compile(src);
+        assert(init_of(*c, "a").kind == ExpKind::CALL);   // reads a global
+        assert(init_of(*c, "b").kind == ExpKind::CALL);   // prints
+        assert(init_of(*c, "d").kind == ExpKind::CALL);   // reads input
+        auto& mix = static_cast<const CallExp&>(init_of(*c, "c"));
+        assert(mix.kind == ExpKind::CALL && is_int(*mix.args[1], 9));   // sq(3) inside
+        assert(c->evaluator.folded_calls() == 1);
+        assert(same_behaviour(src));
+        assert(run(*c) == "!|32");
+        std::cout << "Test 4 (closed calls only) passed!\n";
+    }
+
+    // 5. Traps are left for run time, with the same error
+    {
+        const std::string src =
+            "let function inv(x: int): int = 100 / x\n"
+            "    var ok := inv(4)\n"
+            "    var bad := inv(0)\n"
+            "    var c := chr(300)\n"
+            "in ok + bad end";
+        auto c = compile(src);
+        assert(is_int(init_of(*c, "ok"), 25));
+        assert(init_of(*c, "bad").kind == ExpKind::CALL);
+        assert(init_of(*c, "c").kind == ExpKind::CALL);
+        assert(c->evaluator.left_for_run_time() == 2);
+        assert(run(*c).find("1:37: error: division by zero") != std::string::npos);
+        assert(same_behaviour(src));
+
+        auto d = compile("let var z := 1 / 0 in z end");
+        assert(init_of(*d, "z").kind == ExpKind::OP && d->evaluator.left_for_run_time() == 1);
+        assert(run(*d).find("division by zero") != std::string::npos);
+        std::cout << "Test 5 (traps) passed!\n";
+    }
+
+    // 6. The step budget, and recursion too deep to finish
+    {
+        const std::string src =
+            "let function count(n: int): int = (let var s := 0 in for i := 1 to n do s := s + i; s end)\n"
+            "    function down(n: int): int = if n = 0 then 0 else down(n - 1)\n"
+            "    var small := count(100)\n"
+            "    var large := count(100000)\n"
+            "    var deep := down(1500)\n"
+            "in small + large + deep end";
+        PartialEvaluator::Options options;
+        options.step_budget = 10000;
+        auto c = compile(src, true, options);
+        assert(is_int(init_of(*c, "small"), 5050));
+        assert(init_of(*c, "large").kind == ExpKind::CALL);   // over budget
+        assert(init_of(*c, "deep").kind == ExpKind::CALL);    // too deep
+        assert(c->evaluator.left_for_run_time() == 2);
+        assert(same_behaviour(src));
+
+        options.step_budget = 10000000;
+        auto d = compile(src, true, options);
+        assert(is_int(init_of(*d, "large"), 705082704));   // 5000050000 mod 2^32
+        std::cout << "Test 6 (step budget) passed!\n";
+    }
+
+    // 7. Constants inside function bodies and loops; unit results stay
+    {
+        const std::string src =
+            "let function f(x: int): int = x * (3 * 4)\n"
+            "    function nothing(x: int) = ()\n"
+            "    var total := 0\n"
+            "in for i := 1 to 2 + 3 do (nothing(1); total := total + f(i) + f(2)); total end";
+        auto c = compile(src);
+        assert(c->evaluator.folded_ops() == 2 && c->evaluator.folded_calls() == 1);
+        assert(same_behaviour(src));
+        assert(run(*c) == "|" + std::to_string(12 * 15 + 24 * 5));
+        std::cout << "Test 7 (nested constants) passed!\n";
+    }
+
+    std::cout << "\nAll partial evaluation tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,263 @@
+#undef NDEBUG
+#include "TestPipeline.hpp"
+#include "semantic/BaseEnv.hpp"
+#include "semantic/Resolver.hpp"
+#include "util/AstStats.hpp"
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace tiger;
+using namespace tiger::semantic;
+using tiger::test::parse;
+
+// Collects the annotated nodes in source order.
+struct Collect {
+    std::vector<const SimpleVar*> vars;
+    std::vector<const CallExp*> calls;
+    std::vector<const VarDec*> var_decs;
+    std::vector<const FunctionDec*> functions;
+    std::vector<const ForExp*> loops;
+
+    void exp(const Exp& e) {
+        switch (e.kind) {
+            case ExpKind::VAR: var(*static_cast<const VarExp&>(e).var); break;
+            case ExpKind::CALL: {
+                auto& call = static_cast<const CallExp&>(e);
+                calls.push_back(&call);
+                for (const auto& a : call.args) exp(*a);
+                break;
+            }
+            case ExpKind::OP: {
+                auto& op = static_cast<const OpExp&>(e);
+                exp(*op.left);
+                exp(*op.right);
+                break;
+            }
+            case ExpKind::SEQ:
+                for (const auto& x : static_cast<const SeqExp&>(e).exps) exp(*x);
+                break;
+            case ExpKind::ASSIGN: {
+                auto& assign = static_cast<const AssignExp&>(e);
+                var(*assign.var);
+                exp(*assign.exp);
+                break;
+            }
+            case ExpKind::IF: {
+                auto& i = static_cast<const IfExp&>(e);
+                exp(*i.test);
+                exp(*i.then_exp);
+                if (i.else_exp) exp(*i.else_exp);
+                break;
+            }
+            case ExpKind::FOR: {
+                auto& f = static_cast<const ForExp&>(e);
+                loops.push_back(&f);
+                exp(*f.lo);
+                exp(*f.hi);
+                exp(*f.body);
+                break;
+            }
+            case ExpKind::LET: {
+                auto& let = static_cast<const LetExp&>(e);
+                for (const auto& d : let.decs) {
+                    if (d->kind == DecKind::VAR) {
+                        auto& v = static_cast<const VarDec&>(*d);
+                        var_decs.push_back(&v);
+                        exp(*v.init);
+                    } else if (d->kind == DecKind::FUNCTION) {
+                        auto& f = static_cast<const FunctionDec&>(*d);
+                        functions.push_back(&f);
+                        exp(*f.body);
+                    }
+                }
+                for (const auto& b : let.body) exp(*b);
+                break;
+            }
+            default: break;
+        }
+    }
+
+    void var(const Var& v) {
+        if (v.kind == VarKind::SIMPLE) vars.push_back(&static_cast<const SimpleVar&>(v));
+        else if (v.kind == VarKind::FIELD) var(*static_cast<const FieldVar&>(v).var);
+        else {
+            auto& sub = static_cast<const SubscriptVar&>(v);
+            var(*sub.var);
+            exp(*sub.index);
+        }
+    }
+};
+
+struct Resolved {
+    std::unique_ptr<Program> program;
+    Resolver resolver;
+    Collect nodes;
+};
+
+static std::unique_ptr<Resolved> resolve(const std::string& source) {
+    auto r = std::make_unique<Resolved>();
+    r->program = parse(source);
+    r->resolver.resolve(*r->program);
+    r->nodes.exp(*r->program->exp);
+    return r;
+}
+
+static bool at(const SimpleVar* v, uint32_t depth, uint32_t slot) {
+    return v->depth == depth && v->slot == slot;
+}
+
+int main() {
+    const uint32_t USER = static_cast<uint32_t>(base_env::FUNCTION_COUNT);
+
+    // 1. top-level variables take consecutive slots
+    {
+        auto r = resolve("let var a := 1 var b := a var c := b in a + c end");
+        auto& n = r->nodes;
+        assert(n.var_decs[0]->slot == 0 && n.var_decs[1]->slot == 1 && n.var_decs[2]->slot == 2);
+        assert(at(n.vars[0], 0, 0));   // b := a
+        assert(at(n.vars[1], 0, 1));   // c := b
+        assert(at(n.vars[2], 0, 0) && at(n.vars[3], 0, 2));
+        assert(r->program->frame_size == 3);
+        assert(r->resolver.unresolved() == 0);
+    }
+
+    // 2. parameters are slots 0..n-1, locals follow; outer variables are
+    //    reached through static links
+    {
+        auto r = resolve("let var g := 7\n"
+                         "    function f(x: int, y: int): int =\n"
+                         "      let var z := x + g\n"
+                         "          function h(w: int): int = w + z + x + g\n"
+                         "      in h(y) + z end\n"
+                         "in f(1, 2) end");
+        auto& n = r->nodes;
+        const FunctionDec* f = n.functions[0];
+        const FunctionDec* h = n.functions[1];
+        assert(f->id == USER && h->id == USER + 1);
+        assert(f->frame_size == 3 && h->frame_size == 1);
+        assert(r->program->frame_size == 1);
+        assert(n.var_decs[1]->slot == 2);                    // z
+        assert(at(n.vars[0], 0, 0) && at(n.vars[1], 1, 0));  // x + g
+        assert(at(n.vars[2], 0, 0));                         // w
+        assert(at(n.vars[3], 1, 2));                         // z
+        assert(at(n.vars[4], 1, 0));                         // x
+        assert(at(n.vars[5], 2, 0));                         // g
+        assert(at(n.vars[6], 0, 1) && at(n.vars[7], 0, 2));  // h(y) + z
+        // h(y) from f: h is declared in f's frame; f(1, 2) from the top
+        assert(n.calls[0]->func_id == h->id && n.calls[0]->depth == 0);
+        assert(n.calls[1]->func_id == f->id && n.calls[1]->depth == 0);
+        assert(r->resolver.functions().size() == 2);
+        assert(r->resolver.functions()[f->id - USER] == f);
+    }
+
+    // 3. recursion and mutual recursion: a batch is bound before its bodies,
+    //    and a call from a function's own body passes its static link
+    {
+        auto r = resolve("let function even(n: int): int = if n = 0 then 1 else odd(n - 1)\n"
+                         "    function odd(n: int): int = if n = 0 then 0 else even(n - 1)\n"
+                         "in even(10) end");
+        auto& n = r->nodes;
+        assert(n.calls[0]->func_id == USER + 1 && n.calls[0]->depth == 1);
+        assert(n.calls[1]->func_id == USER && n.calls[1]->depth == 1);
+        assert(n.calls[2]->func_id == USER && n.calls[2]->depth == 0);
+    }
+
+    // 4. shadowing, and slots reused after a let ends
+    {
+        auto r = resolve("let var a := 1 in\n"
+                         "  (let var a := a + 1 var b := a in b end;\n"
+                         "   let var c := 3 in c + a end)\n"
+                         "end");
+        auto& n = r->nodes;
+        assert(n.var_decs[1]->slot == 1 && n.var_decs[2]->slot == 2);
+        assert(at(n.vars[0], 0, 0));                        // inner a := outer a
+        assert(at(n.vars[1], 0, 1) && at(n.vars[2], 0, 2)); // b := a; b
+        assert(n.var_decs[3]->slot == 1);                   // c reuses a's slot
+        assert(at(n.vars[3], 0, 1) && at(n.vars[4], 0, 0)); // c + outer a
+        assert(r->program->frame_size == 3);
+    }
+
+    // 5. for-loop counters take a slot inside the body only
+    {
+        auto r = resolve("let var n := 10 var s := 0 in\n"
+                         "  for i := 0 to n do (for j := i to n do s := s + j);\n"
+                         "  for k := 1 to 2 do s := s + k;\n"
+                         "  s\n"
+                         "end");
+        auto& n = r->nodes;
+        assert(n.loops[0]->slot == 2 && n.loops[1]->slot == 3 && n.loops[2]->slot == 2);
+        assert(at(n.vars[0], 0, 0));                        // to n
+        assert(at(n.vars[1], 0, 2) && at(n.vars[2], 0, 0)); // j := i to n
+        assert(at(n.vars[5], 0, 3));                        // + j
+        assert(r->program->frame_size == 4);
+    }
+
+    // 6. library functions have the builtin ids; user functions may shadow them
+    {
+        auto r = resolve("(print(chr(ord(\"a\"))); exit(0);\n"
+                         " let function print(s: string) = () in print(\"x\") end)");
+        auto& n = r->nodes;
+        assert(n.calls[0]->func_id == builtin::PRINT_ID - builtin::PRINT_ID);
+        assert(n.calls[1]->func_id == builtin::CHR_ID - builtin::PRINT_ID);
+        assert(n.calls[2]->func_id == builtin::ORD_ID - builtin::PRINT_ID);
+        assert(n.calls[3]->func_id == builtin::EXIT_ID - builtin::PRINT_ID);
+        assert(n.calls[4]->func_id == USER && n.calls[4]->depth == 0);
+        assert(base_env::FUNCTIONS[n.calls[1]->func_id].name == builtin::CHR.sym());
+    }
+
+    // 7. a variable hides a function of the same name and vice versa;
+    //    unknown names stay UNRESOLVED
+    {
+        auto r = resolve("let function f() = () var f := 1 in f(); f + g + h() end");
+        auto& n = r->nodes;
+        assert(n.calls[0]->func_id == UNRESOLVED && n.calls[0]->depth == UNRESOLVED);
+        assert(at(n.vars[0], 0, 0));
+        assert(n.vars[1]->slot == UNRESOLVED && n.vars[1]->depth == UNRESOLVED);
+        assert(n.calls[1]->func_id == UNRESOLVED);
+        assert(r->resolver.unresolved() == 3);
+    }
+
+    // 8. resolving again starts over
+    {
+        auto r = resolve("let function f(a: int): int = a in f(1) end");
+        r->resolver.resolve(*r->program);
+        assert(r->nodes.functions[0]->id == USER);
+        assert(r->resolver.functions().size() == 1);
+        auto other = parse("let var x := 1 in y end");
+        r->resolver.resolve(*other);
+        assert(r->resolver.functions().empty() && r->resolver.unresolved() == 1);
+        assert(other->frame_size == 1);
+    }
+
+    // 9. escape analysis: only uses from nested functions make a local escape
+    {
+        auto r = resolve("let var a := 1 var b := 2\n"
+                         "    function f(x: int, y: int): int =\n"
+                         "      let var z := x\n"
+                         "          function g(): int = y + a\n"
+                         "      in for i := 0 to z do (let function h() = print(chr(i)) in h() end); g() end\n"
+                         "in for j := 0 to b do (); f(a, b) end");
+        auto& n = r->nodes;
+        const FunctionDec* f = n.functions[0];
+        assert(n.var_decs[0]->escape && !n.var_decs[1]->escape);   // a, b
+        assert(!f->params[0].escape && f->params[1].escape);        // x, y
+        assert(!n.var_decs[2]->escape);                             // z
+        assert(n.loops[0]->escape && !n.loops[1]->escape);          // i, j
+        AstStats stats = AstStatsCollector().collect(*r->program);
+        auto locals = [&](LocalKind k) { return stats.locals[static_cast<std::size_t>(k)]; };
+        assert(locals(LocalKind::VARIABLE).count == 3 && locals(LocalKind::VARIABLE).escaping == 1);
+        assert(locals(LocalKind::PARAMETER).count == 2 && locals(LocalKind::PARAMETER).escaping == 1);
+        assert(locals(LocalKind::LOOP_VARIABLE).count == 2 &&
+               locals(LocalKind::LOOP_VARIABLE).escaping == 1);
+
+        // unresolved, every local is assumed to escape
+        auto fresh = parse("let var a := 1 in a end");
+        assert(static_cast<const VarDec&>(*static_cast<const LetExp&>(*fresh->exp).decs[0]).escape);
+    }
+
+    std::cout << "test_resolver: all tests passed\n";
+    return 0;
+}
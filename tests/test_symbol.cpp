@@ -0,0 +1,223 @@
+#undef NDEBUG
+#include "env/symbol.hpp"
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using tiger::Sym;
+using tiger::Symbol;
+
+int main() {
+  // 1. same name -> same handle, different names -> different handles
+  Sym a = Symbol::intern("foo");
+  assert(a == Symbol::intern(std::string("fo") + "o"));
+  assert(a != Symbol::intern("bar"));
+  assert(Symbol::name(a) == "foo");
+  assert(Symbol::intern("") == Symbol::intern(""));
+
+  // 2. slices of a buffer intern without a temporary and match std::string
+  std::string source = "let var foo := bar in foo end";
+  Sym slice = Symbol::intern(std::string_view(source).substr(8, 3));
+  assert(slice == a);
+  assert(Symbol::intern(std::string_view(source).substr(15, 3)) == Symbol::intern("bar"));
+  assert(Symbol::name(slice).data()[3] == '\0');
+
+  // 3. a name longer than an arena chunk gets its own storage
+  std::string huge(200000, 'x');
+  Sym big = Symbol::intern(huge);
+  assert(Symbol::name(big) == huge);
+  assert(Symbol::intern(huge) == big);
+
+  // 4. many names in one thread: handles survive table growth
+  std::vector<Sym> first;
+  for (int i = 0; i < 20000; i++)
+    first.push_back(Symbol::intern("grow" + std::to_string(i)));
+  for (int i = 0; i < 20000; i++) {
+    assert(Symbol::intern("grow" + std::to_string(i)) == first[i]);
+    assert(Symbol::name(first[i]) == "grow" + std::to_string(i));
+  }
+
+  // 5. threads interning overlapping names all agree on every handle
+  const int threads = 8;
+  const int names = 5000;
+  std::vector<std::vector<Sym>> seen(
+      threads, std::vector<Sym>(names));
+  std::vector<std::thread> pool;
+  for (int t = 0; t < threads; t++) {
+    pool.emplace_back([t, &seen] {
+      // Each thread walks the names in a different order, several times.
+      for (int round = 0; round < 4; round++) {
+        for (int k = 0; k < names; k++) {
+          int i = (k * 7 + t * 977 + round * 131) % names;
+          Sym sym = Symbol::intern("shared" + std::to_string(i));
+          if (round > 0) assert(seen[t][i] == sym);
+          seen[t][i] = sym;
+        }
+      }
+    });
+  }
+  for (auto& th : pool) th.join();
+
+  for (int i = 0; i < names; i++) {
+    for (int t = 1; t < threads; t++) assert(seen[t][i] == seen[0][i]);
+    assert(Symbol::name(seen[0][i]) == "shared" + std::to_string(i));
+    assert(Symbol::intern("shared" + std::to_string(i)) == seen[0][i]);
+  }
+
+  // 6. ids are dense and unique
+  std::vector<bool> used(Symbol::count(), false);
+  for (int i = 0; i < names; i++) {
+    uint32_t id = Symbol::id(seen[0][i]);
+    assert(id < Symbol::count());
+    assert(!used[id]);
+    used[id] = true;
+  }
+
+  // 7. DenseSymbolTable and both SymbolTable hash policies agree under
+  // random scope churn, including symbols interned after they were created
+  {
+    tiger::SymbolTable<int> map_table;
+    tiger::SymbolTable<int, tiger::SymCachedHash> cached_table;
+    tiger::DenseSymbolTable<int> dense_table;
+    std::vector<int> values(64);
+    std::mt19937 rng(32);
+    int depth = 0;
+    for (int step = 0; step < 20000; step++) {
+      Sym sym = Symbol::intern("scoped" + std::to_string(rng() % 300));
+      switch (rng() % 6) {
+        case 0:
+          map_table.beginScope();
+          cached_table.beginScope();
+          dense_table.beginScope();
+          depth++;
+          break;
+        case 1:
+          if (depth > 0) {
+            map_table.endScope();
+            cached_table.endScope();
+            dense_table.endScope();
+            depth--;
+          }
+          break;
+        case 2: {
+          int* v = &values[rng() % values.size()];
+          map_table.enter(sym, v);
+          cached_table.enter(sym, v);
+          dense_table.enter(sym, v);
+          break;
+        }
+        default:
+          assert(map_table.look(sym) == dense_table.look(sym));
+          assert(cached_table.look(sym) == dense_table.look(sym));
+      }
+    }
+  }
+
+  // 8. the cached hash is the interner's policy applied to the name
+  for (int i = 0; i < names; i++) {
+    Sym sym = seen[0][i];
+    assert(Symbol::hash(sym) == tiger::SymbolHash{}(Symbol::name(sym)));
+  }
+
+  // 9. PersistentSymbolTable: a scope is the version saved before it, so it
+  // agrees with SymbolTable under the same churn; every snapshot keeps
+  // answering as it did when taken, also with hashes that fully collide
+  {
+    struct ConstantHash {
+      uint64_t operator()(Sym) const { return 42; }
+    };
+    struct LowBitsHash {   // equal in all but the last level
+      uint64_t operator()(Sym sym) const { return sym->id & 3; }
+    };
+    auto churn = [](auto table) {
+      using Table = decltype(table);
+      tiger::SymbolTable<int> reference;
+      std::vector<Table> scopes;
+      struct Snapshot {
+        Table version;
+        std::vector<std::pair<Sym, int*>> answers;
+      };
+      std::vector<Snapshot> snapshots;
+      std::vector<int> values(64);
+      std::mt19937 rng(41);
+      for (int step = 0; step < 20000; step++) {
+        Sym sym = Symbol::intern("persistent" + std::to_string(rng() % 300));
+        switch (rng() % 7) {
+          case 0:
+            reference.beginScope();
+            scopes.push_back(table);
+            break;
+          case 1:
+            if (!scopes.empty()) {
+              reference.endScope();
+              table = scopes.back();
+              scopes.pop_back();
+            }
+            break;
+          case 2: {
+            int* v = &values[rng() % values.size()];
+            reference.enter(sym, v);
+            size_t expected = table.size() + (table.look(sym) ? 0 : 1);
+            // the rvalue form updates unshared nodes in place; saved
+            // scopes and snapshots must not notice
+            table = rng() % 2 ? table.enter(sym, v) : std::move(table).enter(sym, v);
+            assert(table.size() == expected && table.look(sym) == v);
+            break;
+          }
+          case 3: {
+            Snapshot snap{table, {}};
+            for (int k = 0; k < 8; k++) {
+              Sym q = Symbol::intern("persistent" + std::to_string(rng() % 300));
+              snap.answers.push_back({q, table.look(q)});
+            }
+            assert(snap.version.same(table));
+            snapshots.push_back(std::move(snap));
+            break;
+          }
+          default:
+            assert(table.look(sym) == reference.look(sym));
+        }
+      }
+      for (const Snapshot& snap : snapshots)
+        for (const auto& [q, v] : snap.answers) assert(snap.version.look(q) == v);
+    };
+    churn(tiger::PersistentSymbolTable<int>());
+    churn(tiger::PersistentSymbolTable<int, tiger::SymAddressHash>());
+    churn(tiger::PersistentSymbolTable<int, ConstantHash>());
+    churn(tiger::PersistentSymbolTable<int, LowBitsHash>());
+
+    // threads read one shared version while the owner keeps entering
+    tiger::PersistentSymbolTable<int> base;
+    std::vector<Sym> keys;
+    std::vector<int> values(1000);
+    for (int i = 0; i < 1000; i++) {
+      keys.push_back(Symbol::intern("shared" + std::to_string(i)));
+      base = base.enter(keys.back(), &values[i]);
+    }
+    assert(base.size() == 1000);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+      readers.emplace_back([snapshot = base, &keys, &values] {
+        for (int round = 0; round < 20; round++) {
+          auto mine = snapshot;
+          for (int i = 0; i < 1000; i++) assert(mine.look(keys[i]) == &values[i]);
+          mine = mine.enter(keys[round], nullptr);
+          assert(mine.look(keys[round]) == nullptr && snapshot.look(keys[round]));
+        }
+      });
+    }
+    for (int i = 0; i < 1000; i++) base = base.enter(keys[i], nullptr);
+    for (auto& t : readers) t.join();
+    assert(base.size() == 1000 && base.look(keys[0]) == nullptr);
+  }
+
+  tiger::SymbolPoolStats stats = Symbol::stats();
+  assert(stats.symbols >= 20000 + names + 3);
+  assert(stats.name_bytes <= stats.arena_bytes);
+
+  std::cout << "All Symbol tests passed!\n";
+  return 0;
+}
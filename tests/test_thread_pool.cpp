@@ -0,0 +1,118 @@
+#undef NDEBUG
+#include "util/ThreadPool.hpp"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tiger;
+
+// Sums 1..n by splitting in half until a piece is small: every level
+// submits two tasks and waits for them from inside a task.
+static long sum_range(ThreadPool& pool, long lo, long hi) {
+    if (hi - lo < 64) {
+        long s = 0;
+        for (long i = lo; i < hi; i++) s += i;
+        return s;
+    }
+    long mid = lo + (hi - lo) / 2;
+    long left = 0, right = 0;
+    ThreadPool::TaskGroup group;
+    pool.submit(group, [&] { left = sum_range(pool, lo, mid); });
+    pool.submit(group, [&] { right = sum_range(pool, mid, hi); });
+    pool.wait(group);
+    return left + right;
+}
+
+int main() {
+    // 1. a pool of one thread runs everything in wait()
+    {
+        ThreadPool pool(1);
+        assert(pool.size() == 1);
+        int ran = 0;
+        ThreadPool::TaskGroup group;
+        for (int i = 0; i < 10; i++) pool.submit(group, [&] { ran++; });
+        pool.wait(group);
+        assert(ran == 10);
+    }
+
+    // 2. every task runs exactly once, whatever the thread count
+    for (unsigned threads : {2u, 4u, 8u}) {
+        ThreadPool pool(threads);
+        assert(pool.size() == threads);
+        std::vector<std::atomic<int>> hits(1000);
+        ThreadPool::TaskGroup group;
+        for (auto& h : hits) pool.submit(group, [&h] { h++; });
+        pool.wait(group);
+        for (auto& h : hits) assert(h.load() == 1);
+
+        // the pool is reusable after a wait
+        std::atomic<int> more{0};
+        ThreadPool::TaskGroup again;
+        for (int i = 0; i < 100; i++) pool.submit(again, [&] { more++; });
+        pool.wait(again);
+        assert(more.load() == 100);
+    }
+
+    // 3. nested fork/join does not deadlock, even with more groups
+    // waiting than threads
+    for (unsigned threads : {1u, 2u, 4u}) {
+        ThreadPool pool(threads);
+        const long n = 100000;
+        assert(sum_range(pool, 0, n) == n * (n - 1) / 2);
+    }
+
+    // 4. an empty group is done immediately
+    {
+        ThreadPool pool(4);
+        ThreadPool::TaskGroup group;
+        pool.wait(group);
+    }
+
+    // 5. a task that throws: the rest of the group still runs, wait()
+    // rethrows, and the pool and group are usable afterwards
+    for (unsigned threads : {1u, 3u}) {
+        ThreadPool pool(threads);
+        ThreadPool::TaskGroup group;
+        std::atomic<int> ran{0};
+        for (int i = 0; i < 20; i++) {
+            pool.submit(group, [&ran, i] {
+                ran++;
+                if (i % 7 == 3) throw std::runtime_error("task " + std::to_string(i));
+            });
+        }
+        bool thrown = false;
+        try {
+            pool.wait(group);
+        } catch (const std::runtime_error& e) {
+            thrown = std::string(e.what()).rfind("task ", 0) == 0;
+        }
+        assert(thrown && ran == 20);
+        pool.submit(group, [&ran] { ran++; });
+        pool.wait(group);
+        assert(ran == 21);
+    }
+
+    // 6. waiting on a long task another thread runs: wait() sleeps, and
+    // wakes when it is done
+    {
+        ThreadPool pool(2);
+        ThreadPool::TaskGroup group;
+        std::atomic<bool> started{false}, finished{false};
+        pool.submit(group, [&] {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            finished = true;
+        });
+        while (!started) std::this_thread::yield();   // taken by the worker
+        pool.wait(group);
+        assert(finished);
+    }
+
+    std::cout << "All thread pool tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,233 @@
+#undef NDEBUG
+#include "TestPipeline.hpp"
+#include "semantic/Scc.hpp"
+#include "semantic/TypeChecker.hpp"
+#include "util/ThreadPool.hpp"
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace tiger;
+using namespace tiger::semantic;
+using tiger::test::parse;
+
+static bool ok(const std::string& source) {
+    auto program = parse(source);
+    TypeChecker checker;
+    bool result = checker.check(*program);
+    for (const auto& err : checker.errors()) std::cerr << "  " << err << "\n";
+    return result;
+}
+
+// True if checking fails with exactly one diagnostic containing `what`.
+static bool fails(const std::string& source, const std::string& what) {
+    auto program = parse(source);
+    TypeChecker checker;
+    if (checker.check(*program) || checker.errors().size() != 1) return false;
+    return checker.errors()[0].find(what) != std::string::npos;
+}
+
+// Body expression of `let ... in <exp> end`.
+static const Exp* let_body(const Program& prog, size_t i = 0) {
+    return static_cast<const LetExp*>(prog.exp.get())->body[i].get();
+}
+
+int main() {
+    // 1. well-typed programs, including the examples' constructs
+    assert(ok("let var sum := 0 in for j := 1 to 10 do sum := sum + j; sum end"));
+    assert(ok("let type point = {x: int, y: int}\n"
+              "    type line = {start: point, finish: point}\n"
+              "    var l := line{start = point{x = 1, y = 2}, finish = nil}\n"
+              "in l.start.x := 0; l.finish = nil end"));
+    assert(ok("let type intArray = array of int\n"
+              "    var arr := intArray[10] of 0\n"
+              "    function fact(n: int): int = if n <= 1 then 1 else n * fact(n - 1)\n"
+              "in arr[0] := fact(5) end"));
+    assert(ok("while 1 do (if 1 then break; ())"));
+    assert(ok("(print(concat(\"a\", chr(ord(\"b\")))); size(substring(\"abc\", 0, 1)) + not(0))"));
+
+    // 2. recursive types and mutually recursive functions in one batch
+    assert(ok("let type list = {hd: int, tl: list}\n"
+              "    type tree = {left: forest, value: int}\n"
+              "    type forest = array of tree\n"
+              "    function even(n: int): int = if n = 0 then 1 else odd(n - 1)\n"
+              "    function odd(n: int): int = if n = 0 then 0 else even(n - 1)\n"
+              "    var l := list{hd = 1, tl = list{hd = 2, tl = nil}}\n"
+              "in l.tl.tl.hd + even(4) end"));
+
+    // 3. types are canonical: equality is a pointer compare, aliases are
+    // the type they name, and record fields never see a placeholder
+    {
+        auto program = parse("let type a = b type b = int type r = {next: r, v: a}\n"
+                             "    var x : a := 1\n"
+                             "    var q := r{next = nil, v = x}\n"
+                             "in x; r{next = nil, v = 2}; q.next end");
+        TypeChecker checker;
+        assert(checker.check(*program));
+        assert(checker.type_of(let_body(*program, 0)) == &INT_TYPE);
+        const Type* r1 = checker.type_of(let_body(*program, 1));
+        assert(r1 && r1->kind == TypeKind::RECORD);
+        auto* rec = static_cast<const RecordType*>(r1);
+        assert(rec->fields[0].type == r1 && rec->fields[1].type == &INT_TYPE);
+        assert(checker.type_of(let_body(*program, 2)) == r1);
+
+        // checking the same tree again yields the same type objects
+        assert(checker.check(*program));
+        assert(checker.type_of(let_body(*program, 1)) == r1);
+        assert(checker.nodes() > 10);
+    }
+
+    // 4. Tiger types are nominal: equal structure, different declarations
+    assert(fails("let type a = {x: int} type b = {x: int} var v : a := b{x = 1} in v end",
+                 "expected a, got b"));
+
+    // 5. one diagnostic per mistake
+    assert(fails("x + 1", "undefined variable x"));
+    assert(fails("let var s := \"s\" in s + 1 end", "arithmetic operand"));
+    assert(fails("f(1)", "undefined function f"));
+    assert(fails("print(1)", "argument: expected string, got int"));
+    assert(fails("substring(\"a\", 1)", "expects 3 arguments, got 2"));
+    assert(fails("let var n := nil in n end", "needs a record type"));
+    assert(fails("nil = nil", "cannot compare nil with nil"));
+    assert(fails("if 1 then 2 else \"s\"", "different types"));
+    assert(fails("if 1 then 2", "without else"));
+    assert(fails("break", "break outside of a loop"));
+    assert(fails("while 1 do let function f() = break in f() end", "break outside"));
+    assert(fails("for i := 0 to 9 do i := 1", "loop variable i"));
+    assert(fails("let type p = {x: int} var v := p{y = 1} in 0 end", "expected field x"));
+    assert(fails("let type t = int var v := t[2] of 0 in 0 end", "not an array type"));
+    assert(fails("let function f(a: int, a: int) = () in 0 end", "parameter a declared twice"));
+    assert(fails("let function f(): int = \"s\" in 0 end", "function body"));
+    assert(fails("let function f() = 1 in 0 end", "procedure body"));
+    assert(fails("let var v := 1 in v.x end", "non-record type int"));
+
+    // 6. an alias cycle is reported once, and uses of its names do not
+    // cascade; cycles through a record or array are legal
+    {
+        auto program = parse("let type a = b type b = a var v : a := 1 in v end");
+        TypeChecker checker;
+        assert(!checker.check(*program));
+        assert(checker.errors().size() == 1);
+        assert(checker.errors()[0].find("illegal cycle in type declarations: a, b") !=
+               std::string::npos);
+    }
+    assert(fails("let type a = a in 0 end", "illegal cycle"));
+    assert(fails("let type a = int type b = c type c = d type d = b in 0 end", "b, c, d"));
+    assert(ok("let type a = b type b = {x: a, y: c} type c = array of a\n"
+              "    var v : a := b{x = nil, y = c[2] of nil}\n"
+              "in v.y[1] := v.x; v.x = v end"));
+
+    // tarjan_scc: components, numbered dependencies-first
+    {
+        // 0 -> 1 -> 2 -> 0,  3 -> 1,  4 (alone),  5 -> 5
+        std::vector<uint32_t> offsets = {0, 1, 2, 3, 4, 4, 5};
+        std::vector<uint32_t> targets = {1, 2, 0, 1, 5};
+        SccResult scc = tarjan_scc(6, offsets, targets);
+        assert(scc.count == 4);
+        assert(scc.component[0] == scc.component[1] && scc.component[1] == scc.component[2]);
+        assert(scc.component[3] > scc.component[0]);
+        assert(scc.component[4] != scc.component[5]);
+        for (uint32_t v = 0; v < 6; v++)
+            for (uint32_t e = offsets[v]; e < offsets[v + 1]; e++)
+                assert(scc.component[targets[e]] <= scc.component[v]);
+    }
+
+    // 7. long alias chains, declared in either order, resolve to the end
+    {
+        for (bool forward : {true, false}) {
+            const int n = 2000;
+            std::string src = "let ";
+            for (int k = 0; k < n; k++) {
+                int i = forward ? k : n - 1 - k;
+                src += "type t" + std::to_string(i) + " = " +
+                       (i + 1 < n ? "t" + std::to_string(i + 1) : std::string("int")) + "\n";
+            }
+            src += "var x : t0 := 1 in x end";
+            auto program = parse(src);
+            TypeChecker checker;
+            assert(checker.check(*program));
+            assert(checker.type_of(let_body(*program)) == &INT_TYPE);
+        }
+    }
+
+    // 8. user declarations shadow the base environment
+    assert(ok("let function print(n: int): int = n in print(1) + 1 end"));
+    assert(ok("let type string = int var s : string := 3 in s + 1 end"));
+
+    // 9. bodies checked in parallel: same diagnostics in the same order,
+    // same types, and bodies see outer names and nested batches fork again
+    {
+        std::string src = "let type point = {x: int, y: int}\n"
+                          "    var base := 10\n";
+        for (int i = 0; i < 200; i++) {
+            std::string f = "f" + std::to_string(i);
+            std::string next = "f" + std::to_string((i + 1) % 200);
+            src += "    function " + f + "(n: int): int =\n"
+                   "        let type cell = {v: int, p: point}\n"
+                   "            function inner(c: cell): int = c.v + c.p.x\n"
+                   "            function other(k: int): int = if k > 0 then inner(cell{v = k, p = nil}) else base\n"
+                   "            var base := \"shadows\"\n"
+                   "        in ";
+            if (i % 17 == 0) src += "base + n";                 // string + int
+            else if (i % 23 == 0) src += "undefined_" + f + "(n)";
+            else src += "other(n) + " + next + "(n - 1)";
+            src += " end\n";
+        }
+        src += "in f0(3) end";
+        auto program = parse(src);
+
+        TypeChecker sequential;
+        sequential.check(*program);
+        assert(sequential.errors().size() == 12 + 8);
+
+        for (unsigned threads : {2u, 3u, 8u}) {
+            ThreadPool pool(threads);
+            TypeChecker parallel(&pool);
+            for (int run = 0; run < 2; run++) {   // check() may be repeated
+                parallel.check(*program);
+                assert(parallel.errors() == sequential.errors());
+                assert(parallel.nodes() == sequential.nodes());
+                assert(parallel.typed_count() == sequential.typed_count());
+                auto* let = static_cast<const LetExp*>(program->exp.get());
+                for (const auto& dec : let->decs) {
+                    if (dec->kind != DecKind::FUNCTION) continue;
+                    const Exp* body = static_cast<const FunctionDec&>(*dec).body.get();
+                    assert(type_name(parallel.type_of(body)) ==
+                           type_name(sequential.type_of(body)));
+                    auto* inner = static_cast<const LetExp*>(body);
+                    assert(parallel.type_of(inner->body[0].get()) ==
+                           sequential.type_of(inner->body[0].get()));
+                }
+                assert(parallel.type_of(let_body(*program)) == &INT_TYPE);
+            }
+        }
+    }
+
+    // 10. record fields are annotated with their slot in the record type;
+    // anything that does not check is left UNRESOLVED
+    {
+        auto program = parse("let type p = {x: int, y: string, z: p}\n"
+                             "    var v := p{x = 1, y = \"s\", z = nil}\n"
+                             "in v.z.y; v.x; p{x = 2, z = nil, y = \"t\"}; v.w end");
+        TypeChecker checker;
+        assert(!checker.check(*program));
+        auto* let = static_cast<const LetExp*>(program->exp.get());
+        auto& init = static_cast<const RecordExp&>(*static_cast<const VarDec&>(*let->decs[1]).init);
+        for (uint32_t i = 0; i < 3; i++) assert(init.fields[i].slot == i);
+        auto field = [&](std::size_t i) {
+            auto& var = *static_cast<const VarExp*>(let->body[i].get())->var;
+            return static_cast<const FieldVar*>(&var);
+        };
+        assert(field(0)->slot == 1);
+        assert(static_cast<const FieldVar&>(*field(0)->var).slot == 2);
+        assert(field(1)->slot == 0);
+        auto& swapped = static_cast<const RecordExp&>(*let->body[2]);
+        assert(swapped.fields[0].slot == 0);
+        assert(swapped.fields[1].slot == UNRESOLVED && swapped.fields[2].slot == UNRESOLVED);
+        assert(field(3)->slot == UNRESOLVED);
+    }
+
+    std::cout << "All type checker tests passed!\n";
+    return 0;
+}